@@ -1,5 +1,7 @@
 #version 450
 
+#extension GL_EXT_nonuniform_qualifier : require
+
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 layout(location = 2) in vec3 fragNormal;
@@ -7,8 +9,8 @@ layout(location = 3) in vec3 fragWorldPos;
 
 layout(location = 0) out vec4 outColor;
 
-// Texture sampler
-layout(set = 0, binding = 1) uniform sampler2D texSampler;
+// Bindless texture table (TextureManager), indexed by material.textureIndex
+layout(set = 1, binding = 0) uniform sampler2D textures[];
 
 // Material push constants
 layout(push_constant) uniform MaterialData {
@@ -16,16 +18,15 @@ layout(push_constant) uniform MaterialData {
   vec4 emissiveColor;  // RGB + intensity
   vec4 specularColor;  // RGB + shininess
   vec3 hoverTint;      // RGB tint for hover highlighting (1,1,1 = no tint)
-  uint flags;          // Material flags
   float alphaThreshold;
-  uint useTexture;     // 1 = sample texture
+  uint textureIndex;   // Slot in the texture table
 } material;
 
-// Material flags
-const uint FLAG_HAS_TEXTURE = 1u;
-const uint FLAG_HAS_ALPHA_TEST = 2u;
-const uint FLAG_TWO_SIDED = 4u;
-const uint FLAG_UNLIT = 8u;
+// Permutation features (gfx::ShaderFeature), fixed per pipeline so the branches below are
+// resolved when the pipeline is compiled
+layout(constant_id = 0) const bool TEXTURED = true;
+layout(constant_id = 1) const bool ALPHA_TEST = false;
+layout(constant_id = 2) const bool UNLIT = false;
 
 // Simple directional light
 const vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
@@ -37,9 +38,9 @@ void main() {
 
   // Get base color from texture or vertex color
   vec4 baseColor;
-  if (material.useTexture == 1u) {
+  if (TEXTURED) {
     // UVs already in correct coordinate system (V-flipped during W3D parsing)
-    baseColor = texture(texSampler, fragTexCoord);
+    baseColor = texture(textures[material.textureIndex], fragTexCoord);
   } else {
     baseColor = vec4(fragColor, 1.0);
   }
@@ -48,16 +49,14 @@ void main() {
   baseColor *= material.diffuseColor;
 
   // Alpha test
-  if ((material.flags & FLAG_HAS_ALPHA_TEST) != 0u) {
-    if (baseColor.a < material.alphaThreshold) {
-      discard;
-    }
+  if (ALPHA_TEST && baseColor.a < material.alphaThreshold) {
+    discard;
   }
 
   vec3 result;
 
   // Check if unlit
-  if ((material.flags & FLAG_UNLIT) != 0u) {
+  if (UNLIT) {
     result = baseColor.rgb + material.emissiveColor.rgb;
   } else {
     // Ambient
@@ -0,0 +1,22 @@
+#version 450
+
+// GPU picking.
+// Drawn with the mesh vertex shaders into a tiny R32_UINT target around the cursor: each
+// fragment writes which mesh and triangle covers it, the depth test keeps the nearest.
+// Encoding: encodePickId() in src/render/pick_id.cpp
+
+layout(location = 0) out uint outId;
+
+const uint TRIANGLE_BITS = 20;
+const uint TRIANGLE_MASK = (1u << TRIANGLE_BITS) - 1u;
+
+// PickPushConstant: the draw's mesh and the index of its first triangle within the mesh
+layout(push_constant) uniform PickData {
+  uint meshIndex;
+  uint firstTriangle;
+} pick;
+
+void main() {
+  uint triangle = pick.firstTriangle + uint(gl_PrimitiveID);
+  outId = ((pick.meshIndex + 1u) << TRIANGLE_BITS) | (triangle & TRIANGLE_MASK);
+}
@@ -4,9 +4,10 @@ layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
-// Push constant for hover tint
+// Push constant for hover tint (jointRadius is consumed by the joint vertex shader)
 layout(push_constant) uniform HoverData {
   vec3 hoverTint;  // RGB tint for hover highlighting (1,1,1 = no tint)
+  float jointRadius;
 } hover;
 
 void main() {
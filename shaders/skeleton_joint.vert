@@ -0,0 +1,33 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+  mat4 model;
+  mat4 view;
+  mat4 proj;
+} ubo;
+
+// Bone world transforms (shared with GPU skinning)
+layout(set = 0, binding = 2) readonly buffer BoneMatrices {
+  mat4 bones[];
+};
+
+layout(push_constant) uniform SkeletonData {
+  vec3 hoverTint;    // Used by the fragment stage
+  float jointRadius; // Joint sphere radius in world units
+} skeleton;
+
+// Per-vertex: unit sphere position
+layout(location = 0) in vec3 inPosition;
+
+// Per-instance: bone to place the sphere on
+layout(location = 1) in uint inBoneIndex;
+layout(location = 2) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+  vec3 center = bones[inBoneIndex][3].xyz;
+  vec4 worldPos = ubo.model * vec4(center + inPosition * skeleton.jointRadius, 1.0);
+  gl_Position = ubo.proj * ubo.view * worldPos;
+  fragColor = inColor;
+}
@@ -0,0 +1,25 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+  mat4 model;
+  mat4 view;
+  mat4 proj;
+} ubo;
+
+// Bone world transforms (shared with GPU skinning)
+layout(set = 0, binding = 2) readonly buffer BoneMatrices {
+  mat4 bones[];
+};
+
+layout(location = 0) in uint inBoneIndex;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+  // Line endpoint is the bone origin (translation column of its world transform)
+  vec3 bonePos = bones[inBoneIndex][3].xyz;
+  vec4 worldPos = ubo.model * vec4(bonePos, 1.0);
+  gl_Position = ubo.proj * ubo.view * worldPos;
+  fragColor = inColor;
+}
@@ -4,13 +4,27 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
   mat4 model;
   mat4 view;
   mat4 proj;
+  mat4 normalMatrix; // transpose(inverse(model)), computed on the CPU
+  // Dequantization of 16-bit positions (identity for float ones)
+  vec4 positionScale;
+  vec4 positionOffset;
 } ubo;
 
+// Compact vertex formats store the normal octahedral-encoded in two snorm16 lanes
+layout(constant_id = 0) const bool OCT_NORMALS = false;
+
 // Bone matrices storage buffer (SSBO)
 layout(set = 0, binding = 2) readonly buffer BoneMatrices {
   mat4 bones[];
 };
 
+// Per-instance placement, indexed by gl_InstanceIndex. Instances rotate, translate and scale
+// uniformly, so their upper 3x3 also transforms normals. Slot 0 holds the identity for draws
+// of the single model.
+layout(set = 0, binding = 3) readonly buffer InstanceTransforms {
+  mat4 instances[];
+};
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
@@ -22,14 +36,27 @@ layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out vec3 fragNormal;
 layout(location = 3) out vec3 fragWorldPos;
 
+// Mirrors unpackOctNormal() in vertex_format.cpp
+vec3 octDecode(vec2 oct) {
+  vec3 n = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
 void main() {
+  vec3 position = inPosition * ubo.positionScale.xyz + ubo.positionOffset.xyz;
+  vec3 normal = OCT_NORMALS ? octDecode(inNormal.xy) : inNormal;
+
   // Rigid skinning (matches legacy Matrix3D::Transform_Vector)
   // Each vertex is influenced by exactly one bone
   mat4 boneMatrix = bones[inBoneIndex];
 
-  // Transform position by bone matrix, then by model matrix
-  vec4 skinnedPos = boneMatrix * vec4(inPosition, 1.0);
-  vec4 worldPos = ubo.model * skinnedPos;
+  // Transform position by bone matrix, then by instance and model matrix
+  mat4 instance = instances[gl_InstanceIndex];
+  vec4 skinnedPos = boneMatrix * vec4(position, 1.0);
+  vec4 worldPos = ubo.model * instance * skinnedPos;
 
   gl_Position = ubo.proj * ubo.view * worldPos;
 
@@ -39,9 +66,8 @@ void main() {
   // Transform normal: rotation only (legacy clears translation before transforming normals)
   // Extract rotation from bone matrix (upper 3x3)
   mat3 boneRotation = mat3(boneMatrix);
-  // Apply bone rotation then model normal matrix
-  mat3 normalMatrix = mat3(transpose(inverse(ubo.model)));
-  fragNormal = normalMatrix * (boneRotation * inNormal);
+  // Apply bone rotation, instance rotation, then model normal matrix
+  fragNormal = mat3(ubo.normalMatrix) * (mat3(instance) * (boneRotation * normal));
 
   fragWorldPos = worldPos.xyz;
 }
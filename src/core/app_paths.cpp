@@ -77,6 +77,14 @@ std::optional<std::filesystem::path> AppPaths::settingsFilePath() {
   return *dir / "settings.json";
 }
 
+std::optional<std::filesystem::path> AppPaths::pipelineCachePath() {
+  auto dir = appDataDir();
+  if (!dir) {
+    return std::nullopt;
+  }
+  return *dir / "pipeline_cache.bin";
+}
+
 bool AppPaths::ensureAppDataDir() {
   auto dir = appDataDir();
   if (!dir) {
@@ -28,6 +28,10 @@ public:
   /// Returns nullopt if app data directory cannot be determined.
   static std::optional<std::filesystem::path> settingsFilePath();
 
+  /// Get path for the Vulkan pipeline cache saved between sessions.
+  /// Returns nullopt if app data directory cannot be determined.
+  static std::optional<std::filesystem::path> pipelineCachePath();
+
   /// Ensure the application data directory exists.
   /// Returns true if directory exists or was created successfully.
   static bool ensureAppDataDir();
@@ -1,13 +1,19 @@
 #include "application.hpp"
 
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
+#include "core/app_paths.hpp"
+#include "core/png_writer.hpp"
 #include "ui/hover_tooltip.hpp"
 #include "ui/model_browser.hpp"
 #include "ui/settings_window.hpp"
@@ -32,6 +38,26 @@ void Application::setInitialModel(const std::string &path) {
   initialModelPath_ = path;
 }
 
+void Application::setHeadless(const HeadlessOptions &options) {
+  headless_ = options;
+}
+
+void Application::setPipelineCacheEnabled(bool enabled) {
+  pipelineCacheEnabled_ = enabled;
+}
+
+void Application::setRecordThreads(uint32_t threads) {
+  recordThreads_ = threads;
+}
+
+void Application::setVertexFormat(gfx::VertexFormat format) {
+  vertexFormat_ = format;
+}
+
+void Application::setGeneratedLODRatios(std::vector<float> ratios) {
+  generatedLODRatios_ = std::move(ratios);
+}
+
 void Application::framebufferResizeCallback(GLFWwindow *window, int /*width*/, int /*height*/) {
   auto *app = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
   app->renderer_.setFramebufferResized(true);
@@ -66,16 +92,30 @@ void Application::initWindow() {
 
 void Application::initVulkan() {
 #ifdef W3D_DEBUG
-  context_.init(window_, true); // Enable validation in debug builds
+  constexpr bool enableValidation = true; // Enable validation in debug builds
 #else
-  context_.init(window_, false); // Disable validation in release builds
+  constexpr bool enableValidation = false; // Disable validation in release builds
 #endif
+  if (pipelineCacheEnabled_) {
+    if (auto cachePath = AppPaths::pipelineCachePath()) {
+      context_.setPipelineCacheFile(*cachePath);
+    }
+  }
+
+  if (headless_) {
+    context_.initHeadless(headless_->width, headless_->height, enableValidation);
+  } else {
+    context_.init(window_, enableValidation);
+  }
 
   // Create skeleton renderer
+  auto pipelineStart = std::chrono::steady_clock::now();
   skeletonRenderer_.create(context_);
+  std::chrono::duration<double, std::milli> pipelineTime =
+      std::chrono::steady_clock::now() - pipelineStart;
 
   // Create bone matrix buffer for GPU skinning
-  boneMatrixBuffer_.create(context_);
+  boneMatrixBuffer_.create();
 
   // Initialize texture manager and create default texture
   textureManager_.init(context_);
@@ -108,7 +148,10 @@ void Application::initVulkan() {
   initializeBigArchiveManager();
 
   // Initialize renderer
+  pipelineStart = std::chrono::steady_clock::now();
   renderer_.init(window_, context_, imguiBackend_, textureManager_, boneMatrixBuffer_);
+  pipelineTime += std::chrono::steady_clock::now() - pipelineStart;
+  pipelineStartupMs_ = pipelineTime.count();
 }
 
 void Application::initUI() {
@@ -184,10 +227,22 @@ void Application::initUI() {
   // Welcome message
   console_->info("W3D Viewer initialized");
   console_->log("Use File > Open to load a W3D model");
+
+  size_t cacheBytes = context_.pipelineCacheLoadedSize();
+  std::string cacheState = cacheBytes > 0 ? std::to_string(cacheBytes) + " byte pipeline cache"
+                                          : std::string("cold pipeline cache");
+  console_->log("Pipelines created in " + std::to_string(std::lround(pipelineStartupMs_)) +
+                " ms with " + cacheState);
 }
 
 void Application::loadW3DFile(const std::filesystem::path &path) {
   auto logCallback = [this](const std::string &msg) {
+    // Headless runs have no console window
+    if (!console_) {
+      std::cout << msg << "\n";
+      return;
+    }
+
     // Determine message type based on content
     if (msg.find("Error") != std::string::npos || msg.find("Failed") != std::string::npos) {
       console_->error(msg);
@@ -204,7 +259,11 @@ void Application::loadW3DFile(const std::filesystem::path &path) {
                                   animationPlayer_, camera_, logCallback);
 
   if (!result.success) {
-    console_->error(result.error);
+    if (console_) {
+      console_->error(result.error);
+    } else {
+      std::cerr << "Error: " << result.error << "\n";
+    }
     return;
   }
 
@@ -267,9 +326,10 @@ void Application::updateHover() {
   proj[1][1] *= -1; // Vulkan Y-flip
 
   // Update hover detector with ray
+  glm::vec2 cursor(static_cast<float>(mouseX), static_cast<float>(mouseY));
   hoverDetector_.update(
-      glm::vec2(static_cast<float>(mouseX), static_cast<float>(mouseY)),
-      glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height)), view, proj);
+      cursor, glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height)), view,
+      proj);
 
   // Test skeleton first (priority over meshes)
   if (renderState_.showSkeleton && skeletonRenderer_.hasData()) {
@@ -278,10 +338,16 @@ void Application::updateHover() {
 
   // Test meshes
   if (renderState_.showMesh) {
-    if (renderState_.useHLodModel && hlodModel_.hasData()) {
+    if (renderState_.gpuPicking && renderer_.canPick()) {
+      // The next frame renders the IDs under the cursor; the latest pick read back names the
+      // triangle, so no triangle is tested here
+      renderer_.requestPick(cursor);
+      applyGpuPick();
+    } else if (renderState_.useHLodModel && hlodModel_.hasData()) {
       if (renderState_.useSkinnedRendering && hlodModel_.hasSkinning()) {
-        // Test skinned meshes (uses rest-pose geometry)
-        hoverDetector_.testHLodSkinnedMeshes(hlodModel_);
+        // Test skinned meshes, posed by the palette they are drawn with
+        hoverDetector_.testHLodSkinnedMeshes(hlodModel_, boneMatrixBuffer_.data(),
+                                             boneMatrixBuffer_.boneCount());
       } else {
         // Test regular meshes with bone-space ray transformation
         const SkeletonPose *pose = skeletonPose_.isValid() ? &skeletonPose_ : nullptr;
@@ -293,6 +359,30 @@ void Application::updateHover() {
   }
 }
 
+void Application::applyGpuPick() {
+  const auto &pick = renderer_.pickResult();
+  auto picked = pick ? decodePickId(pick->id) : std::nullopt;
+  if (!picked) {
+    return;
+  }
+
+  // Only a pick of the mesh set drawn now, before its meshes changed, names one of them
+  bool hlod = renderState_.useHLodModel && hlodModel_.hasData();
+  bool skinned = hlod && renderState_.useSkinnedRendering && hlodModel_.hasSkinning();
+  if (hlod && pick->revision == hlodModel_.revision()) {
+    if (skinned && pick->set == PickSet::HLodSkinnedMeshes) {
+      hoverDetector_.pickHLodSkinnedMesh(hlodModel_, picked->meshIndex, picked->triangleIndex,
+                                         boneMatrixBuffer_.data(), boneMatrixBuffer_.boneCount());
+    } else if (!skinned && pick->set == PickSet::HLodMeshes) {
+      const SkeletonPose *pose = skeletonPose_.isValid() ? &skeletonPose_ : nullptr;
+      hoverDetector_.pickHLodMesh(hlodModel_, picked->meshIndex, picked->triangleIndex, pose);
+    }
+  } else if (!hlod && pick->set == PickSet::Meshes &&
+             pick->revision == renderableMesh_.revision()) {
+    hoverDetector_.pickMesh(renderableMesh_, picked->meshIndex, picked->triangleIndex);
+  }
+}
+
 void Application::drawUI() {
   // Build UI context with current application state
   UIContext ctx;
@@ -306,6 +396,10 @@ void Application::drawUI() {
   ctx.skeletonPose = &skeletonPose_;
   ctx.animationPlayer = &animationPlayer_;
   ctx.hoverState = &hoverDetector_.state();
+  ctx.renderStats = &renderer_.queueStats();
+  ctx.recordStats = &renderer_.recordStats();
+  ctx.gpuProfiler = &renderer_.gpuProfiler();
+  ctx.instanceBuckets = &renderer_.instanceBuckets();
   ctx.settings = &appSettings_;
 
   // BIG archive status
@@ -368,52 +462,182 @@ void Application::mainLoop() {
 
     // Update animation
     animationPlayer_.update(deltaTime);
+    applyAnimation();
 
-    // Apply animation to pose only when frame changes
-    if (modelLoader_.loadedFile() && animationPlayer_.animationCount() > 0 &&
-        !modelLoader_.loadedFile()->hierarchies.empty()) {
-      float currentFrame = animationPlayer_.currentFrame();
-      if (currentFrame != renderState_.lastAppliedFrame || !animationPlayer_.isPlaying()) {
-        animationPlayer_.applyToPose(skeletonPose_, modelLoader_.loadedFile()->hierarchies[0]);
+    updateLOD();
 
-        // Wait for current frame fence before updating any per-frame GPU resources
-        renderer_.waitForCurrentFrame();
-        uint32_t frameIndex = renderer_.currentFrame();
+    // Start ImGui frame
+    imguiBackend_.newFrame();
+    drawUI();
 
-        // Update skeleton debug visualization (double-buffered)
-        skeletonRenderer_.updateFromPose(context_, frameIndex, skeletonPose_);
+    // Draw frame
+    FrameContext frameCtx{camera_,           renderableMesh_, hlodModel_,
+                          skeletonRenderer_, hoverDetector_,  renderState_};
+    renderer_.drawFrame(frameCtx);
+  }
 
-        // Update bone matrix buffer for GPU skinning (double-buffered)
-        if (renderState_.useSkinnedRendering && skeletonPose_.isValid()) {
-          auto skinningMatrices = skeletonPose_.getSkinningMatrices();
-          boneMatrixBuffer_.update(frameIndex, skinningMatrices);
-        }
+  context_.device().waitIdle();
+}
 
-        renderState_.lastAppliedFrame = currentFrame;
-      }
-    }
+void Application::applyAnimation() {
+  // Apply animation to pose only when frame changes
+  if (!modelLoader_.loadedFile() || animationPlayer_.animationCount() == 0 ||
+      modelLoader_.loadedFile()->hierarchies.empty()) {
+    return;
+  }
 
-    // Update LOD selection based on camera distance
-    if (renderState_.useHLodModel && hlodModel_.hasData()) {
-      auto extent = context_.swapchainExtent();
-      float screenHeight = static_cast<float>(extent.height);
-      float fovY = glm::radians(45.0f); // Must match projection FOV
-      float cameraDistance = camera_.distance();
+  float currentFrame = animationPlayer_.currentFrame();
+  if (currentFrame != renderState_.lastAppliedFrame || !animationPlayer_.isPlaying()) {
+    animationPlayer_.applyToPose(skeletonPose_, modelLoader_.loadedFile()->hierarchies[0]);
+
+    // Refresh bone positions used for skeleton hover detection
+    skeletonRenderer_.updateFromPose(skeletonPose_);
 
-      hlodModel_.updateLOD(screenHeight, fovY, cameraDistance);
+    // Update the bone palette. Read by GPU skinning and by the skeleton overlay, so it is
+    // kept current even for static rendering. Skinning matrices are the bone world
+    // transforms, so pass them without copying. The renderer uploads the palette into
+    // its per-frame ring buffer, so no fence wait is needed here.
+    if (skeletonPose_.isValid()) {
+      boneMatrixBuffer_.update(skeletonPose_.allTransforms());
     }
 
-    // Start ImGui frame
-    imguiBackend_.newFrame();
-    drawUI();
+    renderState_.lastAppliedFrame = currentFrame;
+  }
+}
+
+void Application::updateLOD() {
+  // Update LOD selection based on camera distance
+  if (renderState_.useHLodModel && hlodModel_.hasData()) {
+    auto extent = context_.swapchainExtent();
+    float screenHeight = static_cast<float>(extent.height);
+    float fovY = glm::radians(45.0f); // Must match projection FOV
+    float cameraDistance = camera_.distance();
+
+    hlodModel_.updateLOD(screenHeight, fovY, cameraDistance);
+  }
+}
+
+void Application::runHeadless() {
+  const HeadlessOptions &options = *headless_;
+
+  initVulkan();
+  loadW3DFile(initialModelPath_);
+  if (!hlodModel_.hasData() && !renderableMesh_.hasData()) {
+    throw std::runtime_error("No renderable mesh data in " + initialModelPath_);
+  }
+
+  // One orbit around the model over the run; animation advances at a fixed step so runs of
+  // the same model are comparable
+  constexpr float FRAME_STEP = 1.0f / 60.0f;
+  const float startYaw = camera_.yaw();
+  std::vector<double> cpuFrameMs;
+  std::vector<double> gpuFrameMs;
+  std::vector<double> recordMs;
+  cpuFrameMs.reserve(options.frames);
+  recordMs.reserve(options.frames);
+
+  // Pass invocation counts are part of the report only when asked for: the statistics
+  // queries would otherwise skew the frame times they are reported with
+  const auto &gpuScopes = renderer_.gpuProfiler().scopes();
+  std::vector<std::vector<double>> gpuPassMs(gpuScopes.size());
+  renderState_.gpuPipelineStatistics = options.pipelineStatistics;
+
+  for (uint32_t frame = 0; frame < options.frames; ++frame) {
+    auto frameStart = std::chrono::steady_clock::now();
+
+    float orbit = static_cast<float>(frame) / static_cast<float>(options.frames);
+    camera_.setYaw(startYaw + glm::two_pi<float>() * orbit);
+    animationPlayer_.update(FRAME_STEP);
+    applyAnimation();
+    updateLOD();
 
-    // Draw frame
     FrameContext frameCtx{camera_,           renderableMesh_, hlodModel_,
                           skeletonRenderer_, hoverDetector_,  renderState_};
     renderer_.drawFrame(frameCtx);
-  }
 
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - frameStart;
+    cpuFrameMs.push_back(elapsed.count());
+    recordMs.push_back(renderer_.recordStats().totalMs);
+    if (auto gpuTime = renderer_.takeGpuFrameTime()) {
+      gpuFrameMs.push_back(*gpuTime);
+    }
+    for (size_t i = 0; i < gpuScopes.size(); ++i) {
+      if (gpuScopes[i].lastMs) {
+        gpuPassMs[i].push_back(*gpuScopes[i].lastMs);
+      }
+    }
+  }
   context_.device().waitIdle();
+
+  BenchmarkReport report;
+  report.model = std::filesystem::path(initialModelPath_).filename().string();
+  report.device = std::string(context_.physicalDevice().getProperties().deviceName.data());
+  report.width = context_.swapchainExtent().width;
+  report.height = context_.swapchainExtent().height;
+  report.cpuFrameMs = summarizeTimings(std::move(cpuFrameMs));
+  report.gpuFrameMs = summarizeTimings(std::move(gpuFrameMs));
+  report.renderStats = renderer_.queueStats();
+  report.recordThreads = renderer_.recordStats().threads;
+  report.recordMs = summarizeTimings(std::move(recordMs));
+  report.pipelineStartupMs = pipelineStartupMs_;
+  report.pipelineCacheBytes = context_.pipelineCacheLoadedSize();
+  report.vertexFormat = gfx::vertexFormatName(renderer_.meshFormat());
+  report.vertexBytes =
+      static_cast<size_t>(hlodModel_.vertexBytes() + renderableMesh_.vertexBytes());
+  report.indexBytes = static_cast<size_t>(hlodModel_.indexBytes() + renderableMesh_.indexBytes());
+  VertexCacheStats cacheStats = hlodModel_.vertexCacheStats();
+  cacheStats.add(renderableMesh_.vertexCacheStats());
+  report.acmrBefore = cacheStats.acmrBefore();
+  report.acmrAfter = cacheStats.acmrAfter();
+  if (renderer_.gpuProfiler().hasTimestamps()) {
+    for (size_t i = 0; i < gpuScopes.size(); ++i) {
+      GpuPassReport pass;
+      pass.name = gpuScopes[i].name;
+      pass.ms = summarizeTimings(std::move(gpuPassMs[i]));
+      pass.hasStatistics =
+          options.pipelineStatistics && renderer_.gpuProfiler().hasPipelineStatistics();
+      pass.vertexInvocations = gpuScopes[i].counts.vertexInvocations;
+      pass.fragmentInvocations = gpuScopes[i].counts.fragmentInvocations;
+      report.gpuPasses.push_back(std::move(pass));
+    }
+  }
+
+  std::cout << "Rendered " << options.frames << " frames of " << report.model << " at "
+            << report.width << "x" << report.height << " on " << report.device << "\n";
+  std::cout << "CPU frame ms: p50 " << report.cpuFrameMs.p50 << ", p90 " << report.cpuFrameMs.p90
+            << ", p99 " << report.cpuFrameMs.p99 << "\n";
+  if (report.gpuFrameMs.samples > 0) {
+    std::cout << "GPU frame ms: p50 " << report.gpuFrameMs.p50 << ", p90 "
+              << report.gpuFrameMs.p90 << ", p99 " << report.gpuFrameMs.p99 << "\n";
+  }
+  for (const auto &pass : report.gpuPasses) {
+    std::cout << "GPU " << pass.name << " ms: p50 " << pass.ms.p50 << ", p99 " << pass.ms.p99
+              << "\n";
+  }
+  std::cout << "Draw recording ms: p50 " << report.recordMs.p50 << ", p99 "
+            << report.recordMs.p99 << " ("
+            << (report.recordThreads > 0 ? std::to_string(report.recordThreads) + " threads"
+                                         : std::string("inline"))
+            << ")\n";
+  std::cout << "Pipeline startup ms: " << report.pipelineStartupMs << " ("
+            << (report.pipelineCacheBytes > 0 ? "warm" : "cold") << " pipeline cache)\n";
+  std::cout << "Vertex memory: " << report.vertexBytes << " bytes (" << report.vertexFormat
+            << " format)\n";
+  std::cout << "Index memory: " << report.indexBytes << " bytes, vertex cache ACMR "
+            << report.acmrBefore << " -> " << report.acmrAfter << "\n";
+
+  if (!options.benchmarkPath.empty()) {
+    writeBenchmarkReport(options.benchmarkPath, report);
+    std::cout << "Benchmark report written to " << options.benchmarkPath.string() << "\n";
+  }
+  if (!options.screenshotPath.empty()) {
+    auto pixels = context_.readOffscreenImage(renderer_.lastImageIndex());
+    writePng(options.screenshotPath, report.width, report.height, pixels);
+    std::cout << "Final frame written to " << options.screenshotPath.string() << "\n";
+  }
+
+  cleanup();
 }
 
 void Application::cleanup() {
@@ -425,6 +649,11 @@ void Application::cleanup() {
     appSettings_.windowHeight = height;
   }
 
+  // A command-line thread count applies to this session only
+  if (!recordThreads_) {
+    appSettings_.recordThreads = static_cast<int>(renderState_.recordThreads);
+  }
+
   imguiBackend_.cleanup();
   renderer_.cleanup();
 
@@ -448,6 +677,29 @@ void Application::run() {
   // Apply display settings from persistent storage to render state
   renderState_.showMesh = appSettings_.showMesh;
   renderState_.showSkeleton = appSettings_.showSkeleton;
+  constexpr int maxRecordThreads = static_cast<int>(RenderState::MAX_RECORD_THREADS);
+  renderState_.recordThreads = recordThreads_.value_or(
+      static_cast<uint32_t>(std::clamp(appSettings_.recordThreads, 0, maxRecordThreads)));
+
+  // Models encode their vertices when loaded, so the format is fixed for the session
+  gfx::VertexFormat vertexFormat = vertexFormat_.value_or(gfx::VertexFormat::Quantized);
+  if (!vertexFormat_) {
+    if (auto saved = gfx::parseVertexFormat(appSettings_.vertexFormat)) {
+      vertexFormat = *saved;
+    } else {
+      std::cerr << "Warning: Unknown vertex format in settings: " << appSettings_.vertexFormat
+                << "\n";
+    }
+  }
+  hlodModel_.setVertexFormat(vertexFormat);
+  renderableMesh_.setVertexFormat(vertexFormat);
+  hlodModel_.setGeneratedLODRatios(generatedLODRatios_);
+
+  // Headless runs leave settings untouched
+  if (headless_) {
+    runHeadless();
+    return;
+  }
 
   initWindow();
   initVulkan();
@@ -6,7 +6,9 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "core/benchmark.hpp"
 #include "core/render_state.hpp"
 #include "core/renderer.hpp"
 #include "core/settings.hpp"
@@ -63,6 +65,33 @@ public:
    */
   void setInitialModel(const std::string &path);
 
+  /**
+   * Render the initial model offscreen instead of opening a window: no UI, a fixed number
+   * of frames orbiting the model, then a timing summary (and optional report/screenshot).
+   */
+  void setHeadless(const HeadlessOptions &options);
+
+  /**
+   * Enable/disable loading and saving the Vulkan pipeline cache in the app data directory.
+   */
+  void setPipelineCacheEnabled(bool enabled);
+
+  /**
+   * Record mesh draws on this many threads (0: inline), overriding the saved setting for
+   * this session.
+   */
+  void setRecordThreads(uint32_t threads);
+
+  /**
+   * Upload mesh vertices in this format, overriding the saved setting for this session.
+   */
+  void setVertexFormat(gfx::VertexFormat format);
+
+  /**
+   * Generate simplified LOD levels at these triangle ratios for models with a single level.
+   */
+  void setGeneratedLODRatios(std::vector<float> ratios);
+
 private:
   static constexpr uint32_t WIDTH = 1280;
   static constexpr uint32_t HEIGHT = 720;
@@ -78,7 +107,11 @@ private:
 
   // Main loop
   void mainLoop();
+  void runHeadless();
+  void applyAnimation();
+  void updateLOD();
   void updateHover();
+  void applyGpuPick();
   void drawUI();
 
   // Cleanup
@@ -96,6 +129,14 @@ private:
   std::string customTexturePath_;
   std::string initialModelPath_;
   bool debugMode_ = false;
+  std::optional<HeadlessOptions> headless_;
+  bool pipelineCacheEnabled_ = true;
+  std::optional<uint32_t> recordThreads_;         // Command-line override of the saved setting
+  std::optional<gfx::VertexFormat> vertexFormat_; // Command-line override of the saved setting
+  std::vector<float> generatedLODRatios_;
+
+  // Time spent creating the renderers' pipelines in initVulkan
+  double pipelineStartupMs_ = 0.0;
 
   // Window and context
   GLFWwindow *window_ = nullptr;
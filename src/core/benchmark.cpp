@@ -0,0 +1,125 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace w3d {
+
+namespace {
+
+// Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double> &sorted, double p) {
+  auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+nlohmann::json timingJson(const TimingSummary &timing) {
+  return {
+      {"samples", timing.samples},
+      {"mean",    timing.mean   },
+      {"min",     timing.min    },
+      {"max",     timing.max    },
+      {"p50",     timing.p50    },
+      {"p90",     timing.p90    },
+      {"p95",     timing.p95    },
+      {"p99",     timing.p99    }
+  };
+}
+
+nlohmann::json bindJson(const StateChangeCounts &counts) {
+  return {
+      {"pipelines",     counts.pipelines    },
+      {"vertexBuffers", counts.vertexBuffers},
+      {"materials",     counts.materials    }
+  };
+}
+
+nlohmann::json passJson(const GpuPassReport &pass) {
+  nlohmann::json invocations = nullptr;
+  if (pass.hasStatistics) {
+    invocations = {
+        {"vertex",   pass.vertexInvocations  },
+        {"fragment", pass.fragmentInvocations}
+    };
+  }
+  return {
+      {"name",        pass.name          },
+      {"ms",          timingJson(pass.ms)},
+      {"invocations", invocations        }
+  };
+}
+
+} // namespace
+
+TimingSummary summarizeTimings(std::vector<double> samples) {
+  TimingSummary summary;
+  if (samples.empty()) {
+    return summary;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  summary.samples = samples.size();
+  summary.mean =
+      std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+  summary.min = samples.front();
+  summary.max = samples.back();
+  summary.p50 = percentile(samples, 50.0);
+  summary.p90 = percentile(samples, 90.0);
+  summary.p95 = percentile(samples, 95.0);
+  summary.p99 = percentile(samples, 99.0);
+  return summary;
+}
+
+nlohmann::json toJson(const BenchmarkReport &report) {
+  nlohmann::json json;
+  json["model"] = report.model;
+  json["device"] = report.device;
+  json["resolution"] = {report.width, report.height};
+  json["cpuFrameMs"] = timingJson(report.cpuFrameMs);
+  json["gpuFrameMs"] =
+      report.gpuFrameMs.samples > 0 ? timingJson(report.gpuFrameMs) : nlohmann::json(nullptr);
+  json["gpuPasses"] = nlohmann::json::array();
+  for (const auto &pass : report.gpuPasses) {
+    json["gpuPasses"].push_back(passJson(pass));
+  }
+  json["renderStats"] = {
+      {"draws",            report.renderStats.draws                },
+      {"translucentDraws", report.renderStats.translucentDraws     },
+      {"binds",            bindJson(report.renderStats.sorted)     },
+      {"unsortedBinds",    bindJson(report.renderStats.submitted)  }
+  };
+  json["recording"] = {
+      {"threads", report.recordThreads       },
+      {"ms",      timingJson(report.recordMs)}
+  };
+  json["pipelineStartup"] = {
+      {"ms",         report.pipelineStartupMs },
+      {"cacheBytes", report.pipelineCacheBytes}
+  };
+  json["vertices"] = {
+      {"format", report.vertexFormat},
+      {"bytes",  report.vertexBytes }
+  };
+  json["indices"] = {
+      {"bytes",      report.indexBytes},
+      {"acmrBefore", report.acmrBefore},
+      {"acmrAfter",  report.acmrAfter }
+  };
+  return json;
+}
+
+void writeBenchmarkReport(const std::filesystem::path &path, const BenchmarkReport &report) {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Failed to open benchmark report: " + path.string());
+  }
+  file << toJson(report).dump(2) << "\n";
+  if (!file) {
+    throw std::runtime_error("Failed to write benchmark report: " + path.string());
+  }
+}
+
+} // namespace w3d
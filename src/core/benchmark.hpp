@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "render/render_queue.hpp"
+
+#include <nlohmann/json.hpp>
+
+namespace w3d {
+
+/**
+ * Options of a headless run: the model is rendered offscreen for a fixed number of frames
+ * while the camera orbits it once.
+ */
+struct HeadlessOptions {
+  uint32_t frames = 300;
+  uint32_t width = 1280;
+  uint32_t height = 720;
+  std::filesystem::path benchmarkPath;  // JSON report (empty: summary on stdout only)
+  std::filesystem::path screenshotPath; // PNG of the final frame (empty: none)
+  // Count shader invocations per pass. The queries add work to the timed frames, so timing
+  // runs leave them off.
+  bool pipelineStatistics = false;
+};
+
+/**
+ * Distribution of a series of frame times in milliseconds.
+ * Percentiles use the nearest-rank method.
+ */
+struct TimingSummary {
+  size_t samples = 0;
+  double mean = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p95 = 0.0;
+  double p99 = 0.0;
+};
+
+/**
+ * GPU time of one pass measured by the GPU profiler.
+ */
+struct GpuPassReport {
+  std::string name;
+  TimingSummary ms;
+  bool hasStatistics = false; // Invocation counts below are valid (of the final frame)
+  uint64_t vertexInvocations = 0;
+  uint64_t fragmentInvocations = 0;
+};
+
+/**
+ * Results of a headless benchmark run.
+ */
+struct BenchmarkReport {
+  std::string model;
+  std::string device;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  TimingSummary cpuFrameMs;
+  TimingSummary gpuFrameMs;       // No samples when the device has no graphics timestamps
+  RenderQueueStats renderStats;   // Of the final frame
+  uint32_t recordThreads = 0;     // Threads recording draws (0: inline)
+  TimingSummary recordMs;         // CPU time recording the mesh draws of each frame
+  double pipelineStartupMs = 0.0; // Creating the renderers' pipelines at startup
+  size_t pipelineCacheBytes = 0;  // Pipeline cache data loaded from disk (0: cold start)
+  std::string vertexFormat;       // Of the drawn mesh set (see gfx::vertexFormatName)
+  size_t vertexBytes = 0;         // GPU memory of the loaded models' vertex buffers
+  size_t indexBytes = 0;          // GPU memory of the loaded models' index buffers
+  double acmrBefore = 0.0;        // Vertex cache misses per triangle before optimization
+  double acmrAfter = 0.0;         // Vertex cache misses per triangle after optimization
+
+  // Per-pass GPU times; empty when the device has no graphics timestamps
+  std::vector<GpuPassReport> gpuPasses;
+};
+
+/**
+ * Summarize frame times (ms). An empty series gives an all-zero summary.
+ */
+TimingSummary summarizeTimings(std::vector<double> samples);
+
+/**
+ * Report as JSON; the GPU entry is null without timestamp samples, and a pass's invocations
+ * are null without pipeline statistics.
+ */
+nlohmann::json toJson(const BenchmarkReport &report);
+
+/**
+ * Write the JSON report to a file.
+ * @throws std::runtime_error if the file cannot be written
+ */
+void writeBenchmarkReport(const std::filesystem::path &path, const BenchmarkReport &report);
+
+} // namespace w3d
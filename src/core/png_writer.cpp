@@ -0,0 +1,129 @@
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace w3d {
+
+namespace {
+
+constexpr size_t MAX_STORED_BLOCK = 65535; // Largest deflate block without compression
+
+const std::array<uint32_t, 256> &crcTable() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+  return table;
+}
+
+uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0xFFFFFFFFu) {
+  const auto &table = crcTable();
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+void appendU32(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 24));
+  out.push_back(static_cast<uint8_t>(value >> 16));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void appendChunk(std::vector<uint8_t> &out, std::string_view type,
+                 const std::vector<uint8_t> &data) {
+  appendU32(out, static_cast<uint32_t>(data.size()));
+  size_t typeStart = out.size();
+  out.insert(out.end(), type.begin(), type.end());
+  out.insert(out.end(), data.begin(), data.end());
+  uint32_t crc = crc32(out.data() + typeStart, out.size() - typeStart);
+  appendU32(out, crc ^ 0xFFFFFFFFu);
+}
+
+// zlib stream of stored (uncompressed) deflate blocks
+std::vector<uint8_t> zlibStore(const std::vector<uint8_t> &raw) {
+  std::vector<uint8_t> out;
+  out.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK * 5 + 16);
+  out.push_back(0x78); // Deflate, 32K window
+  out.push_back(0x01); // No preset dictionary, check bits
+
+  size_t offset = 0;
+  do {
+    size_t length = std::min(raw.size() - offset, MAX_STORED_BLOCK);
+    bool last = offset + length == raw.size();
+    out.push_back(last ? 1 : 0);
+    out.push_back(static_cast<uint8_t>(length));
+    out.push_back(static_cast<uint8_t>(length >> 8));
+    out.push_back(static_cast<uint8_t>(~length));
+    out.push_back(static_cast<uint8_t>(~length >> 8));
+    out.insert(out.end(), raw.begin() + static_cast<ptrdiff_t>(offset),
+               raw.begin() + static_cast<ptrdiff_t>(offset + length));
+    offset += length;
+  } while (offset < raw.size());
+
+  // Adler-32 of the uncompressed data
+  uint32_t a = 1, b = 0;
+  for (uint8_t byte : raw) {
+    a = (a + byte) % 65521u;
+    b = (b + a) % 65521u;
+  }
+  appendU32(out, (b << 16) | a);
+  return out;
+}
+
+} // namespace
+
+std::vector<uint8_t> encodePng(uint32_t width, uint32_t height, const std::vector<uint8_t> &rgba) {
+  size_t rowSize = static_cast<size_t>(width) * 4;
+  if (width == 0 || height == 0 || rgba.size() != rowSize * height) {
+    throw std::runtime_error("PNG data does not match image size");
+  }
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+  std::vector<uint8_t> header;
+  appendU32(header, width);
+  appendU32(header, height);
+  header.insert(header.end(), {8, 6, 0, 0, 0}); // 8-bit RGBA, deflate, no filter, no interlace
+  appendChunk(png, "IHDR", header);
+
+  // Each scanline is prefixed with its filter type (0: none)
+  std::vector<uint8_t> scanlines;
+  scanlines.reserve((rowSize + 1) * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    scanlines.push_back(0);
+    auto row = rgba.begin() + static_cast<ptrdiff_t>(rowSize * y);
+    scanlines.insert(scanlines.end(), row, row + static_cast<ptrdiff_t>(rowSize));
+  }
+  appendChunk(png, "IDAT", zlibStore(scanlines));
+  appendChunk(png, "IEND", {});
+  return png;
+}
+
+void writePng(const std::filesystem::path &path, uint32_t width, uint32_t height,
+              const std::vector<uint8_t> &rgba) {
+  std::vector<uint8_t> png = encodePng(width, height, rgba);
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Failed to open image file: " + path.string());
+  }
+  file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+  if (!file) {
+    throw std::runtime_error("Failed to write image file: " + path.string());
+  }
+}
+
+} // namespace w3d
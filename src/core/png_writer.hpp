@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace w3d {
+
+/**
+ * Encode 8-bit RGBA pixels (rows top to bottom, tightly packed) as a PNG.
+ * The image data is stored uncompressed, which keeps the encoder dependency-free; files are
+ * larger than a compressing encoder's but any PNG reader accepts them.
+ * @throws std::runtime_error if rgba does not hold width * height pixels
+ */
+std::vector<uint8_t> encodePng(uint32_t width, uint32_t height, const std::vector<uint8_t> &rgba);
+
+/**
+ * Encode and write a PNG file.
+ * @throws std::runtime_error if encoding fails or the file cannot be written
+ */
+void writePng(const std::filesystem::path &path, uint32_t width, uint32_t height,
+              const std::vector<uint8_t> &rgba);
+
+} // namespace w3d
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "render/hover_detector.hpp"
 
 namespace w3d {
@@ -20,6 +22,24 @@ struct RenderState {
   bool useHLodModel = false;
   bool useSkinnedRendering = false;
 
+  // Threads recording mesh draws into secondary command buffers (0: inline, one thread)
+  static constexpr uint32_t MAX_RECORD_THREADS = 8;
+  uint32_t recordThreads = 0;
+
+  // Replay the recorded mesh draws while camera, model, hover and animation are unchanged
+  bool reuseDrawCommands = true;
+
+  // Pose skinned meshes once per frame in a compute pre-pass and draw the posed vertices
+  // (otherwise the skinned vertex shader poses them in every draw)
+  bool computeSkinning = true;
+
+  // Hover meshes by the IDs a picking pass renders under the cursor, read back a frame later,
+  // instead of ray testing every triangle (if the device supports it)
+  bool gpuPicking = false;
+
+  // Count vertex and fragment invocations per pass in the GPU profiler (if supported)
+  bool gpuPipelineStatistics = false;
+
   // Animation state tracking
   float lastAppliedFrame = -1.0f;
 
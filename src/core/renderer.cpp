@@ -3,7 +3,10 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstring>
 #include <stdexcept>
 
 namespace w3d {
@@ -15,6 +18,75 @@ using gfx::TextureManager;
 using gfx::UniformBufferObject;
 using gfx::VulkanContext;
 
+namespace {
+
+const glm::vec3 HOVER_TINT(1.5f, 1.5f, 1.3f); // Warm highlight
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Push a packet's material, with the hover tint applied
+void pushMaterial(vk::CommandBuffer cmd, vk::PipelineLayout layout, const GPUMaterial &material,
+                  const glm::vec3 &tint) {
+  MaterialPushConstant constants{};
+  constants.diffuseColor = material.diffuseColor;
+  constants.emissiveColor = material.emissiveColor;
+  constants.specularColor = material.specularColor;
+  constants.hoverTint = tint;
+  constants.alphaThreshold = material.alphaThreshold;
+  constants.textureIndex = material.textureIndex;
+  cmd.pushConstants(layout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(MaterialPushConstant),
+                    &constants);
+}
+
+// Push the mesh and first triangle of a draw into the picking target
+void pushPick(vk::CommandBuffer cmd, vk::PipelineLayout layout, size_t meshIndex,
+              uint32_t firstTriangle) {
+  PickPushConstant constants{static_cast<uint32_t>(meshIndex), firstTriangle};
+  cmd.pushConstants(layout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(PickPushConstant),
+                    &constants);
+}
+
+// Draw an HLod mesh set's visible, unhidden meshes into the picking target. Each draw is a
+// whole mesh, so its triangles are numbered from 0 as getTriangle() numbers them.
+template <typename MeshT, typename HiddenFunc>
+void drawPickMeshes(vk::CommandBuffer cmd, vk::PipelineLayout layout,
+                    const std::vector<MeshT> &meshes, const std::vector<size_t> &visible,
+                    HiddenFunc hidden) {
+  for (size_t i : visible) {
+    if (i >= PICK_MAX_MESHES || hidden(i)) {
+      continue;
+    }
+    pushPick(cmd, layout, i, 0);
+    cmd.drawIndexed(meshes[i].indexCount, 1, meshes[i].firstIndex, meshes[i].vertexOffset, 0);
+  }
+}
+
+// Whether the frame's skinned HLod draws read vertices posed by the skinning pre-pass
+bool skinsInPrePass(const FrameContext &ctx) {
+  return ctx.renderState.computeSkinning && ctx.renderState.useHLodModel &&
+         ctx.hlodModel.hasData() && ctx.renderState.useSkinnedRendering &&
+         ctx.hlodModel.hasSkinning() && ctx.hlodModel.skinningSource();
+}
+
+// Vertex encoding of the mesh set the frame draws (see recordCommandBuffer)
+const gfx::VertexEncoding &drawnEncoding(const FrameContext &ctx) {
+  // The pre-pass writes full-format vertices, already in model space
+  static const gfx::VertexEncoding POSED;
+  if (skinsInPrePass(ctx)) {
+    return POSED;
+  }
+  if (ctx.renderState.useHLodModel && ctx.hlodModel.hasData()) {
+    return ctx.hlodModel.vertexEncoding(ctx.renderState.useSkinnedRendering &&
+                                        ctx.hlodModel.hasSkinning());
+  }
+  return ctx.renderableMesh.vertexEncoding();
+}
+
+} // namespace
+
 void Renderer::init(GLFWwindow *window, VulkanContext &context, ImGuiBackend &imguiBackend,
                     TextureManager &textureManager, BoneMatrixBuffer &boneMatrixBuffer) {
   window_ = window;
@@ -24,38 +96,55 @@ void Renderer::init(GLFWwindow *window, VulkanContext &context, ImGuiBackend &im
   boneMatrixBuffer_ = &boneMatrixBuffer;
 
   // Create pipelines
-  pipeline_.create(context, "shaders/basic.vert.spv", "shaders/basic.frag.spv");
-  skinnedPipeline_.createSkinned(context, "shaders/skinned.vert.spv", "shaders/basic.frag.spv");
-
-  // Create uniform buffers
-  uniformBuffers_.create(context, MAX_FRAMES_IN_FLIGHT);
+  // All sample from the texture manager's bindless table (set 1). The remaining permutations
+  // are created the first time a material (or vertex format) needs them.
+  meshPipelines_.init(context, textureManager.descriptorSetLayout());
+  pipeline_ = &meshPipelines_.get(
+      gfx::VertexFormat::Full,
+      gfx::PipelineKey{false, gfx::PipelineBlend::Opaque, gfx::ShaderFeature::Textured});
+  skinnedPipeline_ = &meshPipelines_.get(
+      gfx::VertexFormat::Full,
+      gfx::PipelineKey{true, gfx::PipelineBlend::Opaque, gfx::ShaderFeature::Textured});
+
+  // Per-frame dynamic data (UBO, bone palette, instance transforms) lives in one persistently
+  // mapped ring buffer
+  frameData_.create(context, FRAME_DATA_SIZE, MAX_FRAMES_IN_FLIGHT,
+                    vk::BufferUsageFlagBits::eUniformBuffer |
+                        vk::BufferUsageFlagBits::eStorageBuffer |
+                        vk::BufferUsageFlagBits::eIndirectBuffer);
 
   // Create descriptor managers
-  descriptorManager_.create(context, pipeline_.descriptorSetLayout(), MAX_FRAMES_IN_FLIGHT);
-  skinnedDescriptorManager_.create(context, skinnedPipeline_.descriptorSetLayout(),
+  descriptorManager_.create(context, pipeline_->descriptorSetLayout(), MAX_FRAMES_IN_FLIGHT);
+  skinnedDescriptorManager_.create(context, skinnedPipeline_->descriptorSetLayout(),
                                    MAX_FRAMES_IN_FLIGHT);
 
-  // Get default texture for descriptor binding
-  const auto &defaultTex = textureManager.texture(0);
-
+  // Descriptors point at the ring buffer; the per-frame location is supplied as a dynamic
+  // offset when binding, so these never need rewriting
   for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    descriptorManager_.updateUniformBuffer(i, uniformBuffers_.buffer(i),
-                                           sizeof(UniformBufferObject));
-    descriptorManager_.updateTexture(i, defaultTex.view, defaultTex.sampler);
+    descriptorManager_.updateUniformBuffer(i, frameData_.buffer(), sizeof(UniformBufferObject));
+    descriptorManager_.updateInstanceBuffer(i, frameData_.buffer(), INSTANCE_DATA_SIZE);
 
     // Initialize skinned descriptor manager
-    skinnedDescriptorManager_.updateUniformBuffer(i, uniformBuffers_.buffer(i),
+    skinnedDescriptorManager_.updateUniformBuffer(i, frameData_.buffer(),
                                                   sizeof(UniformBufferObject));
-    skinnedDescriptorManager_.updateBoneBuffer(i, boneMatrixBuffer.buffer(i),
-                                               sizeof(glm::mat4) * BoneMatrixBuffer::MAX_BONES);
+    skinnedDescriptorManager_.updateBoneBuffer(i, frameData_.buffer(),
+                                               boneMatrixBuffer.paletteSize());
+    skinnedDescriptorManager_.updateInstanceBuffer(i, frameData_.buffer(), INSTANCE_DATA_SIZE);
   }
 
-  // Create default material
-  defaultMaterial_ = createDefaultMaterial();
+  // Frustum culling and the skinning pre-pass read the bone palette from the same ring buffer
+  culler_.create(context, frameData_, boneMatrixBuffer.paletteSize());
+  skinning_.create(context, frameData_, boneMatrixBuffer.paletteSize(), MAX_FRAMES_IN_FLIGHT);
+
+  // GPU picking needs gl_PrimitiveID in fragment shaders; without it hover stays on the CPU
+  if (context.fragmentPrimitiveId()) {
+    pick_.create(context, textureManager.descriptorSetLayout(), MAX_FRAMES_IN_FLIGHT);
+  }
 
   // Create command buffers and sync objects
   createCommandBuffers();
   createSyncObjects();
+  gpuProfiler_.init(context, MAX_FRAMES_IN_FLIGHT, {"Frame", "Mesh", "Skeleton", "ImGui"});
 }
 
 void Renderer::cleanup() {
@@ -67,11 +156,26 @@ void Renderer::cleanup() {
     device.destroyFence(inFlightFences_[i]);
   }
 
+  gpuProfiler_.destroy();
+
+  for (auto &slots : recordSlots_) {
+    for (auto &slot : slots) {
+      device.destroyCommandPool(slot.pool); // Frees its secondary command buffer
+      slot = RecordSlot{};
+    }
+  }
+  recordPool_.resize(0);
+  invalidateDrawCaches();
+
+  culler_.destroy();
+  skinning_.destroy();
+  pick_.destroy();
   skinnedDescriptorManager_.destroy();
   descriptorManager_.destroy();
-  uniformBuffers_.destroy();
-  skinnedPipeline_.destroy();
-  pipeline_.destroy();
+  frameData_.destroy();
+  meshPipelines_.destroy();
+  pipeline_ = nullptr;
+  skinnedPipeline_ = nullptr;
 }
 
 void Renderer::createCommandBuffers() {
@@ -79,6 +183,35 @@ void Renderer::createCommandBuffers() {
                                           MAX_FRAMES_IN_FLIGHT};
 
   commandBuffers_ = context_->device().allocateCommandBuffers(allocInfo);
+
+  // Secondary command buffers for parallel recording. Command pools may only be used by one
+  // thread at a time, so every recording thread gets its own pool per frame slot.
+  auto device = context_->device();
+  for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame) {
+    for (auto &slot : recordSlots_[frame]) {
+      slot.pool = device.createCommandPool(
+          vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlagBits::eTransient,
+                                    context_->graphicsQueueFamily()});
+      slot.cmd = device
+                     .allocateCommandBuffers(vk::CommandBufferAllocateInfo{
+                         slot.pool, vk::CommandBufferLevel::eSecondary, 1})
+                     .front();
+    }
+  }
+
+  // The skeleton and ImGui overlay is recorded on the calling thread, from the shared pool
+  vk::CommandBufferAllocateInfo overlayInfo{context_->commandPool(),
+                                            vk::CommandBufferLevel::eSecondary,
+                                            MAX_FRAMES_IN_FLIGHT};
+  auto overlays = device.allocateCommandBuffers(overlayInfo);
+  std::copy(overlays.begin(), overlays.end(), overlayBuffers_.begin());
+}
+
+void Renderer::beginSecondary(vk::CommandBuffer cmd, vk::Framebuffer framebuffer,
+                              vk::CommandBufferUsageFlags usage) const {
+  vk::CommandBufferInheritanceInfo inheritance{context_->renderPass(), 0, framebuffer};
+  vk::CommandBufferBeginInfo beginInfo{usage, &inheritance};
+  cmd.begin(beginInfo);
 }
 
 void Renderer::createSyncObjects() {
@@ -96,7 +229,23 @@ void Renderer::createSyncObjects() {
   }
 }
 
-void Renderer::updateUniformBuffer(uint32_t frameIndex, const Camera &camera) {
+void Renderer::readFrameTimestamps() {
+  // The slot's fence has signaled, so its queries are available
+  gpuProfiler_.collect(currentFrame_);
+  if (auto frameMs = gpuProfiler_.scopes()[GPU_SCOPE_FRAME].lastMs) {
+    gpuFrameTime_ = frameMs;
+  }
+}
+
+void Renderer::updateFrameData(const FrameContext &ctx) {
+  // Safe to overwrite: the fence for this frame slot has been waited on
+  frameData_.beginFrame(currentFrame_);
+  auto prefix = allocateFramePrefix(frameData_, {sizeof(UniformBufferObject),
+                                                 boneMatrixBuffer_->paletteSize(),
+                                                 INSTANCE_DATA_SIZE});
+
+  const Camera &camera = ctx.camera;
+  const gfx::VertexEncoding &meshEncoding = drawnEncoding(ctx);
   UniformBufferObject ubo{};
 
   // Always use camera-based view
@@ -104,12 +253,62 @@ void Renderer::updateUniformBuffer(uint32_t frameIndex, const Camera &camera) {
   ubo.view = camera.viewMatrix();
 
   auto extent = context_->swapchainExtent();
-  ubo.proj = glm::perspective(glm::radians(45.0f),
+  float fovY = glm::radians(45.0f);
+  ubo.proj = glm::perspective(fovY,
                               static_cast<float>(extent.width) / static_cast<float>(extent.height),
                               0.01f, 10000.0f);
   ubo.proj[1][1] *= -1; // Flip Y for Vulkan
+  ubo.normalMatrix = glm::transpose(glm::inverse(ubo.model));
+
+  // Only one mesh set is drawn per frame, so its dequantization goes in the UBO
+  ubo.positionScale = glm::vec4(meshEncoding.quantization.scale, 0.0f);
+  ubo.positionOffset = glm::vec4(meshEncoding.quantization.offset, 0.0f);
+  meshFormat_ = meshEncoding.format;
+  computeSkinning_ = skinsInPrePass(ctx);
+
+  std::memcpy(prefix.ubo.data, &ubo, sizeof(ubo));
+  uboOffset_ = prefix.ubo.dynamicOffset();
+  viewProj_ = ubo.proj * ubo.view * ubo.model;
+
+  // Bone palette (GPU skinning and skeleton overlay). The whole palette range is reserved
+  // because the descriptor range is fixed; only the live bones are copied.
+  std::memcpy(prefix.palette.data, boneMatrixBuffer_->data(),
+              sizeof(glm::mat4) * boneMatrixBuffer_->boneCount());
+  boneOffset_ = prefix.palette.dynamicOffset();
+
+  // Instance transforms, also over a fixed descriptor range: the identity that single-model
+  // draws read, then the HLod model's instances in view, grouped by LOD level
+  auto *slots = static_cast<glm::mat4 *>(prefix.instances.data);
+  slots[0] = glm::mat4(1.0f);
+  instanceOffset_ = prefix.instances.dynamicOffset();
+
+  drawInstanced_ = ctx.renderState.showMesh && ctx.renderState.useHLodModel &&
+                   ctx.hlodModel.hasData() && !ctx.hlodModel.instances().empty();
+  instanceBuckets_.transforms.clear();
+  instanceBuckets_.offsets.clear();
+  if (drawInstanced_) {
+    InstanceView view;
+    view.frustum = Frustum::fromMatrix(viewProj_);
+    view.cameraPosition = camera.position();
+    view.screenHeight = static_cast<float>(extent.height);
+    view.fovY = fovY;
+    ctx.hlodModel.bucketInstances(view, instanceBuckets_);
+    std::memcpy(slots + InstanceBuckets::FIRST_SLOT, instanceBuckets_.transforms.data(),
+                sizeof(glm::mat4) * instanceBuckets_.transforms.size());
+  }
 
-  uniformBuffers_.update(frameIndex, ubo);
+  // The picking pass draws with the frame's UBO projected onto its target around the cursor.
+  // Its slot is part of every frame's prefix, so picking moves none of the later allocations.
+  pickThisFrame_ = pick_.valid() && ctx.renderState.gpuPicking && pickCursor_.has_value();
+  pickUboOffset_ = prefix.pickUbo.dynamicOffset();
+  if (pickThisFrame_) {
+    UniformBufferObject pickUbo = ubo;
+    glm::vec2 screenSize(static_cast<float>(extent.width), static_cast<float>(extent.height));
+    pickUbo.proj = pickProjection(ubo.proj, *pickCursor_, screenSize,
+                                  static_cast<float>(PickPass::TARGET_SIZE));
+    std::memcpy(prefix.pickUbo.data, &pickUbo, sizeof(pickUbo));
+  }
+  pickCursor_.reset();
 }
 
 void Renderer::recreateSwapchain(int width, int height) {
@@ -123,37 +322,20 @@ void Renderer::recreateSwapchain(int width, int height) {
 
   context_->recreateSwapchain(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
   imguiBackend_->onSwapchainRecreate();
+  invalidateDrawCaches();
   recreatingSwapchain_ = false;
 }
 
-void Renderer::recordCommandBuffer(vk::CommandBuffer cmd, uint32_t imageIndex,
-                                   const FrameContext &ctx) {
-  vk::CommandBufferBeginInfo beginInfo{};
-  cmd.begin(beginInfo);
+void Renderer::setRecordThreads(uint32_t threads) {
+  // The recording thread takes one chunk itself
+  uint32_t workers = threads > 1 ? threads - 1 : 0;
+  if (recordPool_.workerCount() != workers) {
+    recordPool_.resize(workers);
+  }
+}
 
+void Renderer::bindFrameState(vk::CommandBuffer cmd, bool drawSkinned) const {
   auto extent = context_->swapchainExtent();
-
-  // Clear values for color and depth attachments
-  std::array<vk::ClearValue, 2> clearValues{};
-  clearValues[0].color = vk::ClearColorValue{
-      std::array<float, 4>{0.1f, 0.1f, 0.1f, 1.0f}
-  };
-  clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
-
-  // Begin render pass
-  vk::RenderPassBeginInfo renderPassInfo{};
-  renderPassInfo.renderPass = context_->renderPass();
-  renderPassInfo.framebuffer = context_->framebuffer(imageIndex);
-  renderPassInfo.renderArea.offset = vk::Offset2D{0, 0};
-  renderPassInfo.renderArea.extent = extent;
-  renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-  renderPassInfo.pClearValues = clearValues.data();
-
-  cmd.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-
-  // Draw 3D content
-  cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline_.pipeline());
-
   vk::Viewport viewport{
       0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f};
   cmd.setViewport(0, viewport);
@@ -164,152 +346,384 @@ void Renderer::recordCommandBuffer(vk::CommandBuffer cmd, uint32_t imageIndex,
   };
   cmd.setScissor(0, scissor);
 
-  cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline_.layout(), 0,
-                         descriptorManager_.descriptorSet(currentFrame_), {});
-
-  // Draw loaded mesh (either HLod model or simple renderable mesh)
-  if (ctx.renderState.showMesh) {
-    if (ctx.renderState.useHLodModel && ctx.hlodModel.hasData()) {
-      if (ctx.renderState.useSkinnedRendering && ctx.hlodModel.hasSkinning()) {
-        // Draw with skinned pipeline (GPU skinning) with hover support
-        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, skinnedPipeline_.pipeline());
-
-        const glm::vec3 hoverTint(1.5f, 1.5f, 1.3f); // Warm highlight
-        const auto &hover = ctx.hoverDetector.state();
-        int hoverIdx = (hover.type == HoverType::Mesh) ? static_cast<int>(hover.objectIndex) : -1;
-
-        ctx.hlodModel.drawSkinnedWithHover(
-            cmd, hoverIdx, hoverTint,
-            [&](size_t /*meshIndex*/, const std::string &textureName, const glm::vec3 &tint) {
-              MaterialPushConstant materialData{};
-              materialData.diffuseColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-              materialData.emissiveColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-              materialData.specularColor = glm::vec4(0.2f, 0.2f, 0.2f, 32.0f);
-              materialData.hoverTint = tint;
-              materialData.flags = 0;
-              materialData.alphaThreshold = 0.5f;
-
-              // Look up texture by name
-              uint32_t texIdx = 0;
-              if (!textureName.empty()) {
-                texIdx = textureManager_->findTexture(textureName);
-              }
-
-              if (texIdx > 0) {
-                const auto &tex = textureManager_->texture(texIdx);
-                vk::DescriptorSet texDescSet = skinnedDescriptorManager_.getDescriptorSet(
-                    currentFrame_, texIdx, tex.view, tex.sampler,
-                    boneMatrixBuffer_->buffer(currentFrame_),
-                    sizeof(glm::mat4) * BoneMatrixBuffer::MAX_BONES);
-                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, skinnedPipeline_.layout(),
-                                       0, texDescSet, {});
-                materialData.useTexture = 1;
-              } else {
-                const auto &defaultTex = textureManager_->texture(0);
-                vk::DescriptorSet defaultDescSet = skinnedDescriptorManager_.getDescriptorSet(
-                    currentFrame_, 0, defaultTex.view, defaultTex.sampler,
-                    boneMatrixBuffer_->buffer(currentFrame_),
-                    sizeof(glm::mat4) * BoneMatrixBuffer::MAX_BONES);
-                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, skinnedPipeline_.layout(),
-                                       0, defaultDescSet, {});
-                materialData.useTexture = 0;
-              }
-
-              cmd.pushConstants(skinnedPipeline_.layout(), vk::ShaderStageFlagBits::eFragment, 0,
-                                sizeof(MaterialPushConstant), &materialData);
-            });
-
-        // Switch back to regular pipeline for skeleton overlay
-        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline_.pipeline());
+  bindFrameSets(cmd, drawSkinned, uboOffset_);
+}
+
+void Renderer::bindFrameSets(vk::CommandBuffer cmd, bool drawSkinned, uint32_t uboOffset) const {
+  // Dynamic offsets: bindings 0 and 3 (UBO, instances) for the static layout, bindings 0, 2
+  // and 3 (UBO, bones, instances) for the skinned layout
+  const std::array<uint32_t, 2> staticOffsets = {uboOffset, instanceOffset_};
+  const std::array<uint32_t, 3> skinnedOffsets = {uboOffset, boneOffset_, instanceOffset_};
+
+  // Set 0 holds the frame's UBO, bones and instances, set 1 the bindless texture table. Both
+  // are bound once per pipeline; draws pick their texture through the material push constant.
+  if (shaderSkinning(drawSkinned)) {
+    const std::array<vk::DescriptorSet, 2> skinnedSets = {
+        skinnedDescriptorManager_.descriptorSet(currentFrame_), textureManager_->descriptorSet()};
+    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, skinnedPipeline_->layout(), 0,
+                           skinnedSets, skinnedOffsets);
+  } else {
+    const std::array<vk::DescriptorSet, 2> staticSets = {
+        descriptorManager_.descriptorSet(currentFrame_), textureManager_->descriptorSet()};
+    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline_->layout(), 0, staticSets,
+                           staticOffsets);
+  }
+}
+
+void Renderer::recordDraws(vk::CommandBuffer cmd, size_t begin, size_t end,
+                           const FrameContext &ctx, bool drawHLod, bool drawSkinned) const {
+  // Skip binds and pushes that would repeat the bound state. All mesh pipeline layouts are
+  // compatible, so descriptor sets and push constants carry over.
+  BoundState bound;
+  for (size_t i = begin; i < end; ++i) {
+    const RenderItem &item = renderQueue_[i];
+    const gfx::Pipeline &pipeline = meshPipelines_.created(meshFormat_, item.pipeline);
+
+    if (bound.setPipeline(item.pipeline)) {
+      cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+    }
+    if (bound.setVertexBuffer(item.vertexBuffer)) {
+      if (drawHLod) {
+        ctx.hlodModel.bindBuffers(cmd, drawSkinned,
+                                  drawSkinned && computeSkinning_ ? skinning_.output(currentFrame_)
+                                                                  : vk::Buffer{});
       } else {
-        // Draw with regular pipeline (CPU-transformed vertices) with hover support
-        const glm::vec3 hoverTint(1.5f, 1.5f, 1.3f); // Warm highlight
-        const auto &hover = ctx.hoverDetector.state();
-        int hoverIdx = (hover.type == HoverType::Mesh) ? static_cast<int>(hover.objectIndex) : -1;
-
-        ctx.hlodModel.drawWithHover(
-            cmd, hoverIdx, hoverTint,
-            [&](size_t /*meshIndex*/, const std::string &textureName, const glm::vec3 &tint) {
-              MaterialPushConstant materialData{};
-              materialData.diffuseColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-              materialData.emissiveColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-              materialData.specularColor = glm::vec4(0.2f, 0.2f, 0.2f, 32.0f);
-              materialData.hoverTint = tint;
-              materialData.flags = 0;
-              materialData.alphaThreshold = 0.5f;
-
-              // Look up texture by name
-              uint32_t texIdx = 0;
-              if (!textureName.empty()) {
-                texIdx = textureManager_->findTexture(textureName);
-              }
-
-              if (texIdx > 0) {
-                // Get pre-allocated descriptor set for this texture
-                const auto &tex = textureManager_->texture(texIdx);
-                vk::DescriptorSet texDescSet = descriptorManager_.getTextureDescriptorSet(
-                    currentFrame_, texIdx, tex.view, tex.sampler);
-                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline_.layout(), 0,
-                                       texDescSet, {});
-                materialData.useTexture = 1;
-              } else {
-                // Use default texture descriptor set
-                const auto &defaultTex = textureManager_->texture(0);
-                vk::DescriptorSet defaultDescSet = descriptorManager_.getTextureDescriptorSet(
-                    currentFrame_, 0, defaultTex.view, defaultTex.sampler);
-                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline_.layout(), 0,
-                                       defaultDescSet, {});
-                materialData.useTexture = 0;
-              }
-
-              cmd.pushConstants(pipeline_.layout(), vk::ShaderStageFlagBits::eFragment, 0,
-                                sizeof(MaterialPushConstant), &materialData);
-            });
+        ctx.renderableMesh.bindMesh(cmd, item.vertexBuffer);
       }
-    } else if (ctx.renderableMesh.hasData()) {
-      // Simple mesh without textures
-      MaterialPushConstant materialData{};
-      materialData.diffuseColor = glm::vec4(defaultMaterial_.diffuse, defaultMaterial_.opacity);
-      materialData.emissiveColor = glm::vec4(defaultMaterial_.emissive, 1.0f);
-      materialData.specularColor = glm::vec4(defaultMaterial_.specular, defaultMaterial_.shininess);
-      materialData.flags = 0;
-      materialData.alphaThreshold = 0.5f;
-      materialData.useTexture = 0;
-
-      // Use hover detection for simple meshes
-      const glm::vec3 hoverTint(1.5f, 1.5f, 1.3f); // Warm highlight
-      const auto &hover = ctx.hoverDetector.state();
-
-      ctx.renderableMesh.drawWithHover(
-          cmd, hover.type == HoverType::Mesh ? static_cast<int>(hover.objectIndex) : -1, hoverTint,
-          [&](size_t /*meshIndex*/, const glm::vec3 &tint) {
-            materialData.hoverTint = tint;
-            cmd.pushConstants(pipeline_.layout(), vk::ShaderStageFlagBits::eFragment, 0,
-                              sizeof(MaterialPushConstant), &materialData);
-          });
+    }
+    if (bound.setMaterial(*item.material, item.tint)) {
+      pushMaterial(cmd, pipeline.layout(), *item.material, item.tint);
+    }
+
+    if (drawHLod) {
+      culler_.drawBatch(cmd, frameData_.buffer(), item.draw);
+    } else {
+      const IndirectDrawCommand &draw = ctx.renderableMesh.drawPackets()[item.draw].command;
+      cmd.drawIndexed(draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset,
+                      draw.firstInstance);
     }
   }
+}
+
+void Renderer::beginPass(vk::CommandBuffer cmd, GpuScope scope) const {
+  gpuProfiler_.beginScope(cmd, currentFrame_, scope);
+  if (pipelineStatistics_) {
+    gpuProfiler_.beginStatistics(cmd, currentFrame_, scope);
+  }
+}
+
+void Renderer::endPass(vk::CommandBuffer cmd, GpuScope scope) const {
+  if (pipelineStatistics_) {
+    gpuProfiler_.endStatistics(cmd, currentFrame_, scope);
+  }
+  gpuProfiler_.endScope(cmd, currentFrame_, scope);
+}
+
+void Renderer::recordOverlay(vk::CommandBuffer cmd, const FrameContext &ctx) {
+  const auto &hover = ctx.hoverDetector.state();
 
   // Draw skeleton overlay
   if (ctx.renderState.showSkeleton && ctx.skeletonRenderer.hasData()) {
-    // Skeleton uses same descriptor set layout, so we can reuse the bound descriptor
+    // Skeleton layout matches the skinned layout: reuse its UBO + bone matrix descriptor set
+    const std::array<uint32_t, 3> skinnedOffsets = {uboOffset_, boneOffset_, instanceOffset_};
     cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, ctx.skeletonRenderer.pipelineLayout(),
-                           0, descriptorManager_.descriptorSet(currentFrame_), {});
+                           0, skinnedDescriptorManager_.descriptorSet(currentFrame_),
+                           skinnedOffsets);
 
     // Apply hover tint if hovering over skeleton
-    const glm::vec3 hoverTint(1.5f, 1.5f, 1.3f); // Warm highlight
-    const auto &hover = ctx.hoverDetector.state();
     glm::vec3 skeletonTint = (hover.type == HoverType::Bone || hover.type == HoverType::Joint)
-                                 ? hoverTint
+                                 ? HOVER_TINT
                                  : glm::vec3(1.0f);
 
-    ctx.skeletonRenderer.drawWithHover(cmd, currentFrame_, skeletonTint);
+    beginPass(cmd, GPU_SCOPE_SKELETON);
+    ctx.skeletonRenderer.drawWithHover(cmd, skeletonTint);
+    endPass(cmd, GPU_SCOPE_SKELETON);
   }
 
   // Draw ImGui
+  beginPass(cmd, GPU_SCOPE_IMGUI);
   imguiBackend_->render(cmd);
+  endPass(cmd, GPU_SCOPE_IMGUI);
+}
+
+void Renderer::recordPick(vk::CommandBuffer cmd, const FrameContext &ctx, bool drawHLod,
+                          bool drawSkinned) {
+  // The frame's meshes as its render pass drew them, with the frame's descriptor sets (the
+  // pick pipelines' layouts are compatible). An instanced HLod model is not picked: which
+  // instance covered the cursor is not part of the ID.
+  const gfx::Pipeline &pipeline = pick_.pipeline(meshFormat_, shaderSkinning(drawSkinned));
+  vk::PipelineLayout layout = pipeline.layout();
+
+  pick_.begin(cmd, currentFrame_);
+  cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+  bindFrameSets(cmd, drawSkinned, pickUboOffset_);
+
+  PickSet set = PickSet::Meshes;
+  uint64_t revision = ctx.renderableMesh.revision();
+  if (drawHLod) {
+    const HLodModel &model = ctx.hlodModel;
+    set = drawSkinned ? PickSet::HLodSkinnedMeshes : PickSet::HLodMeshes;
+    revision = model.revision();
+    if (!drawInstanced_) {
+      model.bindBuffers(cmd, drawSkinned,
+                        drawSkinned && computeSkinning_ ? skinning_.output(currentFrame_)
+                                                        : vk::Buffer{});
+      if (drawSkinned) {
+        drawPickMeshes(cmd, layout, model.skinnedMeshes(), model.visibleSkinnedMeshIndices(),
+                       [&](size_t i) { return model.isSkinnedMeshHidden(i); });
+      } else {
+        drawPickMeshes(cmd, layout, model.meshes(), model.visibleMeshIndices(),
+                       [&](size_t i) { return model.isMeshHidden(i); });
+      }
+    }
+  } else if (ctx.renderState.showMesh && ctx.renderableMesh.hasData()) {
+    for (const DrawPacket &packet : ctx.renderableMesh.drawPackets()) {
+      if (packet.meshIndex >= PICK_MAX_MESHES) {
+        continue;
+      }
+      const IndirectDrawCommand &draw = packet.command;
+      ctx.renderableMesh.bindMesh(cmd, packet.meshIndex);
+      pushPick(cmd, layout, packet.meshIndex, draw.firstIndex / 3);
+      cmd.drawIndexed(draw.indexCount, 1, draw.firstIndex, draw.vertexOffset, 0);
+    }
+  }
+  pick_.end(cmd, currentFrame_, set, revision);
+}
+
+Renderer::DrawRecordKey Renderer::drawRecordKey(const FrameContext &ctx) const {
+  const auto &hover = ctx.hoverDetector.state();
+
+  DrawRecordKey key;
+  key.viewProj = viewProj_;
+  key.extent = context_->swapchainExtent();
+  key.uboOffset = uboOffset_;
+  key.boneOffset = boneOffset_;
+  key.instanceOffset = instanceOffset_;
+  key.showMesh = ctx.renderState.showMesh;
+  key.useHLodModel = ctx.renderState.useHLodModel;
+  key.useSkinnedRendering = ctx.renderState.useSkinnedRendering;
+  key.computeSkinning = computeSkinning_;
+  key.recordThreads = ctx.renderState.recordThreads;
+  key.pipelineStatistics = pipelineStatistics_;
+  key.animationFrame = ctx.renderState.lastAppliedFrame;
+  key.hoverMesh = (hover.type == HoverType::Mesh) ? static_cast<int64_t>(hover.objectIndex) : -1;
+  key.hlodRevision = ctx.hlodModel.revision();
+  key.meshRevision = ctx.renderableMesh.revision();
+  key.textureCount = textureManager_->textureCount();
+  return key;
+}
+
+void Renderer::buildQueue(vk::CommandBuffer cmd, const FrameContext &ctx, bool drawHLod,
+                          bool drawSkinned) {
+  const auto &hover = ctx.hoverDetector.state();
+  int hoverIdx = (hover.type == HoverType::Mesh) ? static_cast<int>(hover.objectIndex) : -1;
+
+  // Cull the HLod model's draws before the render pass (the compute pass cannot run inside
+  // it); the surviving batches are drawn below. Instanced, each sub-mesh is one draw over
+  // the instances its LOD level was given, however many there are.
+  if (drawHLod) {
+    ctx.hlodModel.buildDrawList(drawSkinned, hoverIdx, HOVER_TINT, drawList_,
+                                drawInstanced_ ? &instanceBuckets_ : nullptr);
+    culler_.cull(cmd, frameData_, drawList_, Frustum::fromMatrix(viewProj_), boneOffset_,
+                 boneMatrixBuffer_->data(), boneMatrixBuffer_->boneCount());
+  }
+
+  // Queue the mesh draws: HLod batches that may have survived culling, or one draw per
+  // RenderableMesh packet. The queue orders them by pipeline, material and buffers, with
+  // translucent draws last and back to front.
+  renderQueue_.clear();
+  if (drawHLod) {
+    uint32_t vertexBuffer = drawSkinned ? 1 : 0;
+    for (uint32_t i = 0; i < drawList_.batches.size(); ++i) {
+      if (!culler_.mayDrawBatch(i)) {
+        continue;
+      }
+      const DrawBatch &batch = drawList_.batches[i];
+      float depth = batchDepth(drawList_, i, viewProj_, boneMatrixBuffer_->data(),
+                               boneMatrixBuffer_->boneCount());
+      uint32_t pipeline = pipelineKey(*batch.material, shaderSkinning(drawSkinned)).id();
+      renderQueue_.submit({pipeline, vertexBuffer, batch.material, batch.tint, depth, i});
+    }
+  } else if (ctx.renderState.showMesh && ctx.renderableMesh.hasData()) {
+    // Packets have no bounds here; they order by buffer, which keeps mesh order
+    const auto &packets = ctx.renderableMesh.drawPackets();
+    for (uint32_t i = 0; i < packets.size(); ++i) {
+      const DrawPacket &packet = packets[i];
+      bool hovered = static_cast<int>(packet.meshIndex) == hoverIdx;
+      renderQueue_.submit({pipelineKey(packet.material, false).id(), packet.meshIndex,
+                           &packet.material, hovered ? HOVER_TINT : glm::vec3(1.0f), 0.0f, i});
+    }
+  }
+  renderQueue_.sort();
+  queueStats_ = renderQueue_.stats();
+
+  // Create any pipeline permutation the frame needs now, so recording only reads them
+  for (size_t i = 0; i < renderQueue_.size(); ++i) {
+    meshPipelines_.get(meshFormat_, renderQueue_[i].pipeline);
+  }
+}
+
+uint32_t Renderer::recordChunks(uint32_t threads, bool reusable, const FrameContext &ctx,
+                                bool drawHLod, bool drawSkinned) {
+  // Split the sorted queue into contiguous chunks, one secondary command buffer each, so
+  // every chunk still records its draws in state order. Reusable buffers may run in any
+  // framebuffer of the render pass, since a frame slot does not keep its swapchain image.
+  setRecordThreads(threads);
+  auto chunks = static_cast<uint32_t>(std::min<size_t>(threads, renderQueue_.size()));
+  recordStats_.threadMs.resize(chunks);
+  recordStats_.threadDraws.resize(chunks);
+
+  vk::CommandBufferUsageFlags usage = vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+  if (!reusable) {
+    usage |= vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  }
+
+  auto &slots = recordSlots_[currentFrame_];
+  recordPool_.parallelFor(chunks, [&](uint32_t chunk) {
+    auto chunkStart = std::chrono::steady_clock::now();
+    size_t begin = renderQueue_.size() * chunk / chunks;
+    size_t end = renderQueue_.size() * (chunk + 1) / chunks;
+
+    // Each chunk has its own pool, so threads never share one
+    context_->device().resetCommandPool(slots[chunk].pool);
+    beginSecondary(slots[chunk].cmd, nullptr, usage);
+    bindFrameState(slots[chunk].cmd, drawSkinned);
+
+    // The mesh pass's timestamps go in its first and last chunk; each chunk counts its own
+    // statistics, since a query cannot span command buffers
+    if (chunk == 0) {
+      gpuProfiler_.beginScope(slots[chunk].cmd, currentFrame_, GPU_SCOPE_MESH);
+    }
+    if (pipelineStatistics_) {
+      gpuProfiler_.beginStatistics(slots[chunk].cmd, currentFrame_, GPU_SCOPE_MESH, chunk);
+    }
+    recordDraws(slots[chunk].cmd, begin, end, ctx, drawHLod, drawSkinned);
+    if (pipelineStatistics_) {
+      gpuProfiler_.endStatistics(slots[chunk].cmd, currentFrame_, GPU_SCOPE_MESH, chunk);
+    }
+    if (chunk == chunks - 1) {
+      gpuProfiler_.endScope(slots[chunk].cmd, currentFrame_, GPU_SCOPE_MESH);
+    }
+    slots[chunk].cmd.end();
+
+    recordStats_.threadMs[chunk] = elapsedMs(chunkStart);
+    recordStats_.threadDraws[chunk] = static_cast<uint32_t>(end - begin);
+  });
+  return chunks;
+}
+
+void Renderer::executeChunks(vk::CommandBuffer cmd, const vk::RenderPassBeginInfo &renderPassInfo,
+                             uint32_t chunks, uint32_t imageIndex, const FrameContext &ctx) {
+  // Skeleton and ImGui go in one more secondary, recorded every frame: a render pass begun
+  // for secondaries cannot take inline commands
+  vk::CommandBuffer overlay = overlayBuffers_[currentFrame_];
+  beginSecondary(overlay, context_->framebuffer(imageIndex),
+                 vk::CommandBufferUsageFlagBits::eRenderPassContinue |
+                     vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+  recordOverlay(overlay, ctx);
+  overlay.end();
+
+  std::array<vk::CommandBuffer, RenderState::MAX_RECORD_THREADS + 1> secondaries{};
+  for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+    secondaries[chunk] = recordSlots_[currentFrame_][chunk].cmd;
+  }
+  secondaries[chunks] = overlay;
 
+  cmd.beginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+  cmd.executeCommands(chunks + 1, secondaries.data());
   cmd.endRenderPass();
+}
+
+void Renderer::recordCommandBuffer(vk::CommandBuffer cmd, uint32_t imageIndex,
+                                   const FrameContext &ctx) {
+  vk::CommandBufferBeginInfo beginInfo{};
+  cmd.begin(beginInfo);
+
+  gpuProfiler_.reset(cmd, currentFrame_);
+  pipelineStatistics_ =
+      ctx.renderState.gpuPipelineStatistics && gpuProfiler_.hasPipelineStatistics();
+  gpuProfiler_.beginScope(cmd, currentFrame_, GPU_SCOPE_FRAME);
+
+  auto extent = context_->swapchainExtent();
+
+  // Clear values for color and depth attachments
+  std::array<vk::ClearValue, 2> clearValues{};
+  clearValues[0].color = vk::ClearColorValue{
+      std::array<float, 4>{0.1f, 0.1f, 0.1f, 1.0f}
+  };
+  clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
+
+  // Begin render pass
+  vk::RenderPassBeginInfo renderPassInfo{};
+  renderPassInfo.renderPass = context_->renderPass();
+  renderPassInfo.framebuffer = context_->framebuffer(imageIndex);
+  renderPassInfo.renderArea.offset = vk::Offset2D{0, 0};
+  renderPassInfo.renderArea.extent = extent;
+  renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+  renderPassInfo.pClearValues = clearValues.data();
+
+  bool drawHLod = ctx.renderState.showMesh && ctx.renderState.useHLodModel &&
+                  ctx.hlodModel.hasData();
+  bool drawSkinned = drawHLod && ctx.renderState.useSkinnedRendering && ctx.hlodModel.hasSkinning();
+
+  uint32_t threads = std::min(ctx.renderState.recordThreads, RenderState::MAX_RECORD_THREADS);
+  bool reuse = ctx.renderState.reuseDrawCommands;
+  recordStats_.threads = threads;
+  recordStats_.reused = false;
+  recordStats_.threadMs.clear();
+  recordStats_.threadDraws.clear();
+  auto recordStart = std::chrono::steady_clock::now();
+
+  DrawCache &cache = drawCaches_[currentFrame_];
+  DrawRecordKey key = drawRecordKey(ctx);
+
+  // Pose the skinned set before the render pass, for every draw of it this frame
+  if (drawSkinned && computeSkinning_ &&
+      skinning_.skin(cmd, currentFrame_, ctx.hlodModel.skinningSource(),
+                     ctx.hlodModel.skinnedVertexCount(), boneOffset_,
+                     static_cast<uint32_t>(boneMatrixBuffer_->boneCount()))) {
+    cache.valid = false; // Recorded against the slot's previous output buffer
+  }
+  if (reuse && cache.valid && cache.key == key) {
+    // Nothing the mesh draws depend on changed since this frame slot last recorded them, so
+    // its culling results in the ring buffer and its secondary command buffers still apply.
+    // Only the UBO, bone palette and instance transforms (rewritten in place), the posed
+    // vertices and the overlay are new.
+    queueStats_ = cache.stats;
+    recordStats_.reused = true;
+    recordStats_.totalMs = elapsedMs(recordStart);
+    executeChunks(cmd, renderPassInfo, cache.chunks, imageIndex, ctx);
+  } else if (threads == 0 && !reuse) {
+    // Everything inline in the primary command buffer
+    cache.valid = false;
+    buildQueue(cmd, ctx, drawHLod, drawSkinned);
+    cmd.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+    bindFrameState(cmd, drawSkinned);
+    if (!renderQueue_.empty()) {
+      beginPass(cmd, GPU_SCOPE_MESH);
+      recordDraws(cmd, 0, renderQueue_.size(), ctx, drawHLod, drawSkinned);
+      endPass(cmd, GPU_SCOPE_MESH);
+    }
+    recordStats_.totalMs = elapsedMs(recordStart);
+    recordOverlay(cmd, ctx);
+    cmd.endRenderPass();
+  } else {
+    // Reuse needs the draws in secondaries even when recording on the calling thread alone
+    buildQueue(cmd, ctx, drawHLod, drawSkinned);
+    uint32_t chunks = recordChunks(std::max(threads, 1u), reuse, ctx, drawHLod, drawSkinned);
+    recordStats_.totalMs = elapsedMs(recordStart);
+    cache.valid = reuse;
+    cache.key = key;
+    cache.chunks = chunks;
+    cache.stats = queueStats_;
+    executeChunks(cmd, renderPassInfo, chunks, imageIndex, ctx);
+  }
+
+  if (pickThisFrame_) {
+    recordPick(cmd, ctx, drawHLod, drawSkinned);
+  }
+
+  gpuProfiler_.endScope(cmd, currentFrame_, GPU_SCOPE_FRAME);
   cmd.end();
 }
 
@@ -323,6 +737,10 @@ void Renderer::waitForCurrentFrame() {
   if (waitResult != vk::Result::eSuccess) {
     throw std::runtime_error("Failed waiting for fence");
   }
+  readFrameTimestamps();
+  if (auto pick = pick_.collect(currentFrame_)) {
+    pickResult_ = pick;
+  }
 
   frameWaited_ = true;
 }
@@ -333,45 +751,71 @@ void Renderer::drawFrame(const FrameContext &ctx) {
   // Wait for previous frame (skipped if waitForCurrentFrame() was already called)
   waitForCurrentFrame();
 
-  // Acquire next image
-  uint32_t imageIndex;
-  auto acquireResult = device.acquireNextImageKHR(
-      context_->swapchain(), UINT64_MAX, imageAvailableSemaphores_[currentFrame_], nullptr);
-
-  if (acquireResult.result == vk::Result::eErrorOutOfDateKHR) {
-    int width, height;
-    glfwGetFramebufferSize(window_, &width, &height);
-    recreateSwapchain(width, height);
-    frameWaited_ = false;
-    return;
-  } else if (acquireResult.result != vk::Result::eSuccess &&
-             acquireResult.result != vk::Result::eSuboptimalKHR) {
-    throw std::runtime_error("Failed to acquire swap chain image");
+  // Acquire next image; headless frames own an offscreen image per frame slot
+  bool headless = context_->headless();
+  uint32_t imageIndex = currentFrame_ % gfx::VulkanContext::OFFSCREEN_IMAGE_COUNT;
+  if (!headless) {
+    auto acquireResult = device.acquireNextImageKHR(
+        context_->swapchain(), UINT64_MAX, imageAvailableSemaphores_[currentFrame_], nullptr);
+
+    if (acquireResult.result == vk::Result::eErrorOutOfDateKHR) {
+      int width, height;
+      glfwGetFramebufferSize(window_, &width, &height);
+      recreateSwapchain(width, height);
+      frameWaited_ = false;
+      return;
+    } else if (acquireResult.result != vk::Result::eSuccess &&
+               acquireResult.result != vk::Result::eSuboptimalKHR) {
+      throw std::runtime_error("Failed to acquire swap chain image");
+    }
+    imageIndex = acquireResult.value;
   }
-  imageIndex = acquireResult.value;
 
   device.resetFences(inFlightFences_[currentFrame_]);
 
-  // Update uniform buffer
-  updateUniformBuffer(currentFrame_, ctx.camera);
+  // Write this frame's UBO, bone palette and instance transforms into the ring buffer
+  updateFrameData(ctx);
 
   // Record command buffer
   commandBuffers_[currentFrame_].reset();
   recordCommandBuffer(commandBuffers_[currentFrame_], imageIndex, ctx);
 
   // Submit
-  vk::PipelineStageFlags waitStages = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+  // Besides the swapchain image, wait for the latest upload batch (already signaled unless a
+  // model was just loaded) so data written on the transfer queue is visible here, to the
+  // skinning pre-pass (which reads the uploaded skinning source) as well as to the draws.
+  // Headless frames have no image to wait for and nothing to present.
+  auto &uploader = context_->uploader();
+  std::array<vk::Semaphore, 2> waitSemaphores = {imageAvailableSemaphores_[currentFrame_],
+                                                 uploader.timelineSemaphore()};
+  std::array<vk::PipelineStageFlags, 2> waitStages = {
+      vk::PipelineStageFlagBits::eColorAttachmentOutput,
+      vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eVertexInput |
+          vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader};
+  std::array<uint64_t, 2> waitValues = {0, uploader.lastSubmittedValue()};
+  uint32_t firstWait = headless ? 1 : 0;
+  vk::TimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()) - firstWait;
+  timelineInfo.pWaitSemaphoreValues = waitValues.data() + firstWait;
 
   vk::SubmitInfo submitInfo{};
-  submitInfo.waitSemaphoreCount = 1;
-  submitInfo.pWaitSemaphores = &imageAvailableSemaphores_[currentFrame_];
-  submitInfo.pWaitDstStageMask = &waitStages;
+  submitInfo.pNext = &timelineInfo;
+  submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()) - firstWait;
+  submitInfo.pWaitSemaphores = waitSemaphores.data() + firstWait;
+  submitInfo.pWaitDstStageMask = waitStages.data() + firstWait;
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &commandBuffers_[currentFrame_];
-  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.signalSemaphoreCount = headless ? 0 : 1;
   submitInfo.pSignalSemaphores = &renderFinishedSemaphores_[currentFrame_];
 
   context_->graphicsQueue().submit(submitInfo, inFlightFences_[currentFrame_]);
+  lastImageIndex_ = imageIndex;
+
+  if (headless) {
+    currentFrame_ = (currentFrame_ + 1) % MAX_FRAMES_IN_FLIGHT;
+    frameWaited_ = false;
+    return;
+  }
 
   // Present
   vk::SwapchainKHR swapchain = context_->swapchain();
@@ -1,25 +1,39 @@
 #pragma once
 
 #include "lib/gfx/buffer.hpp"
+#include "lib/gfx/gpu_profiler.hpp"
 #include "lib/gfx/pipeline.hpp"
+#include "lib/gfx/ring_buffer.hpp"
 #include "lib/gfx/vulkan_context.hpp"
 
 #include <vulkan/vulkan.hpp>
 
 #include <GLFW/glfw3.h>
 
+#include <array>
 #include <cstdint>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "core/render_state.hpp"
+#include "core/thread_pool.hpp"
 #include "lib/formats/w3d/hlod_model.hpp"
 #include "lib/gfx/camera.hpp"
 #include "lib/gfx/texture.hpp"
 #include "render/bone_buffer.hpp"
+#include "render/draw_culler.hpp"
+#include "render/draw_culling.hpp"
+#include "render/draw_packet.hpp"
+#include "render/frame_prefix.hpp"
 #include "render/hover_detector.hpp"
+#include "render/instance_set.hpp"
 #include "render/material.hpp"
+#include "render/pick_pass.hpp"
+#include "render/render_queue.hpp"
 #include "render/renderable_mesh.hpp"
 #include "render/skeleton_renderer.hpp"
+#include "render/skinning_pass.hpp"
 #include "ui/imgui_backend.hpp"
 
 namespace w3d {
@@ -52,6 +66,8 @@ public:
 
   /**
    * Initialize the renderer with Vulkan context and window.
+   * For a headless context the window is null and ImGui is not initialized; frames render
+   * into the context's offscreen images and are not presented.
    */
   void init(GLFWwindow *window, gfx::VulkanContext &context, ImGuiBackend &imguiBackend,
             gfx::TextureManager &textureManager, BoneMatrixBuffer &boneMatrixBuffer);
@@ -68,8 +84,8 @@ public:
 
   /**
    * Wait for the current frame's fence to be signaled.
-   * Call this before updating any per-frame resources (e.g., bone matrices)
-   * to ensure the GPU is done reading from that frame's buffers.
+   * Call this before updating any per-frame GPU resources to ensure the GPU is
+   * done reading from that frame's buffers. Ring buffer data is guarded internally.
    */
   void waitForCurrentFrame();
 
@@ -90,18 +106,130 @@ public:
   uint32_t currentFrame() const { return currentFrame_; }
 
   // Accessors
-  gfx::Pipeline &pipeline() { return pipeline_; }
-  gfx::Pipeline &skinnedPipeline() { return skinnedPipeline_; }
+  const gfx::Pipeline &pipeline() const { return *pipeline_; }
+  const gfx::Pipeline &skinnedPipeline() const { return *skinnedPipeline_; }
   gfx::DescriptorManager &descriptorManager() { return descriptorManager_; }
   gfx::SkinnedDescriptorManager &skinnedDescriptorManager() { return skinnedDescriptorManager_; }
 
+  /**
+   * Pick what is under the cursor (in swapchain pixels) on the GPU, in the next frame drawn
+   * with RenderState::gpuPicking. The result arrives through pickResult() once that frame's
+   * slot has been waited on.
+   */
+  void requestPick(const glm::vec2 &cursor) { pickCursor_ = cursor; }
+
+  /**
+   * Whether the device can pick on the GPU (see PickPass); without it requests are ignored.
+   */
+  bool canPick() const { return pick_.valid(); }
+
+  /**
+   * The latest GPU pick read back. Empty until one has completed.
+   */
+  const std::optional<PickResult> &pickResult() const { return pickResult_; }
+
+  /**
+   * Draw count and bind counts of the last recorded frame, in submission and sorted order.
+   */
+  const RenderQueueStats &queueStats() const { return queueStats_; }
+
+  /**
+   * CPU time spent recording the last frame's mesh draws, in total and per recording thread.
+   */
+  const RecordStats &recordStats() const { return recordStats_; }
+
+  /**
+   * Instances of the HLod model the last frame drew, by LOD level. Empty when the model was
+   * drawn once, without instances.
+   */
+  const InstanceBuckets &instanceBuckets() const { return instanceBuckets_; }
+
+  /**
+   * Vertex format of the mesh set the last frame drew.
+   */
+  gfx::VertexFormat meshFormat() const { return meshFormat_; }
+
+  /**
+   * GPU time in milliseconds of the most recently completed frame, from timestamps around
+   * its command buffer, and clear it. Empty if no frame completed since the last call or if
+   * the device has no timestamps.
+   */
+  std::optional<double> takeGpuFrameTime() { return std::exchange(gpuFrameTime_, std::nullopt); }
+
+  /**
+   * Image the last submitted frame rendered into (an offscreen image index when headless).
+   */
+  uint32_t lastImageIndex() const { return lastImageIndex_; }
+
+  /**
+   * Per-pass GPU times and pipeline statistics, in the order of the GPU_SCOPE_* ids.
+   */
+  const gfx::GpuProfiler &gpuProfiler() const { return gpuProfiler_; }
+
+  // GPU profiler scopes: the whole command buffer and the passes inside the render pass
+  enum GpuScope : uint32_t { GPU_SCOPE_FRAME, GPU_SCOPE_MESH, GPU_SCOPE_SKELETON, GPU_SCOPE_IMGUI };
+
 private:
   static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+  static constexpr vk::DeviceSize FRAME_DATA_SIZE = 4 * 1024 * 1024; // Ring partition per frame
+  // Instance transforms reserved per frame: the identity slot, then up to MAX_INSTANCES
+  static constexpr vk::DeviceSize INSTANCE_DATA_SIZE =
+      sizeof(glm::mat4) * (InstanceBuckets::FIRST_SLOT + MAX_INSTANCES);
+
+  // Everything a frame's mesh draws are recorded from: while it is unchanged, a frame slot
+  // replays its secondaries and the culling results its last recording left in the ring
+  struct DrawRecordKey {
+    glm::mat4 viewProj{1.0f};
+    vk::Extent2D extent;
+    uint32_t uboOffset = 0;
+    uint32_t boneOffset = 0;
+    uint32_t instanceOffset = 0;
+    bool showMesh = false;
+    bool useHLodModel = false;
+    bool useSkinnedRendering = false;
+    bool computeSkinning = false;
+    uint32_t recordThreads = 0;
+    bool pipelineStatistics = false;
+    float animationFrame = 0.0f;
+    int64_t hoverMesh = -1;
+    uint64_t hlodRevision = 0;
+    uint64_t meshRevision = 0;
+    size_t textureCount = 0; // New textures rewrite the bindless table the draws bind
+
+    bool operator==(const DrawRecordKey &) const = default;
+  };
+  struct DrawCache {
+    bool valid = false;
+    DrawRecordKey key;
+    uint32_t chunks = 0;
+    RenderQueueStats stats;
+  };
 
   void createCommandBuffers();
   void createSyncObjects();
-  void updateUniformBuffer(uint32_t frameIndex, const gfx::Camera &camera);
+  void readFrameTimestamps();
+  void updateFrameData(const FrameContext &ctx);
   void recordCommandBuffer(vk::CommandBuffer cmd, uint32_t imageIndex, const FrameContext &ctx);
+  void buildQueue(vk::CommandBuffer cmd, const FrameContext &ctx, bool drawHLod, bool drawSkinned);
+  void setRecordThreads(uint32_t threads);
+  void beginSecondary(vk::CommandBuffer cmd, vk::Framebuffer framebuffer,
+                      vk::CommandBufferUsageFlags usage) const;
+  // Whether drawSkinned draws go through the skinned pipelines (not posed by the pre-pass)
+  bool shaderSkinning(bool drawSkinned) const { return drawSkinned && !computeSkinning_; }
+  void bindFrameState(vk::CommandBuffer cmd, bool drawSkinned) const;
+  void bindFrameSets(vk::CommandBuffer cmd, bool drawSkinned, uint32_t uboOffset) const;
+  void recordDraws(vk::CommandBuffer cmd, size_t begin, size_t end, const FrameContext &ctx,
+                   bool drawHLod, bool drawSkinned) const;
+  uint32_t recordChunks(uint32_t threads, bool reusable, const FrameContext &ctx, bool drawHLod,
+                        bool drawSkinned);
+  void recordOverlay(vk::CommandBuffer cmd, const FrameContext &ctx);
+  void recordPick(vk::CommandBuffer cmd, const FrameContext &ctx, bool drawHLod, bool drawSkinned);
+  void beginPass(vk::CommandBuffer cmd, GpuScope scope) const;
+  void endPass(vk::CommandBuffer cmd, GpuScope scope) const;
+  void executeChunks(vk::CommandBuffer cmd, const vk::RenderPassBeginInfo &renderPassInfo,
+                     uint32_t chunks, uint32_t imageIndex, const FrameContext &ctx);
+  DrawRecordKey drawRecordKey(const FrameContext &ctx) const;
+  void invalidateDrawCaches() { drawCaches_.fill(DrawCache{}); }
 
   // External resources (not owned)
   GLFWwindow *window_ = nullptr;
@@ -110,12 +238,46 @@ private:
   gfx::TextureManager *textureManager_ = nullptr;
   BoneMatrixBuffer *boneMatrixBuffer_ = nullptr;
 
-  // Pipelines and descriptors
-  gfx::Pipeline pipeline_;
-  gfx::Pipeline skinnedPipeline_;
+  // Pipelines and descriptors. Mesh pipelines are created per material permutation on first
+  // use; the opaque textured ones are created up front and supply the shared layouts.
+  gfx::PipelinePermutations meshPipelines_;
+  const gfx::Pipeline *pipeline_ = nullptr;
+  const gfx::Pipeline *skinnedPipeline_ = nullptr;
   gfx::DescriptorManager descriptorManager_;
   gfx::SkinnedDescriptorManager skinnedDescriptorManager_;
-  gfx::UniformBuffer<gfx::UniformBufferObject> uniformBuffers_;
+  gfx::FrameRingBuffer frameData_;
+
+  // HLod draws of the frame being recorded, frustum-culled before the render pass
+  DrawList drawList_;
+  DrawCuller culler_;
+
+  // Poses the HLod model's skinned set before the render pass when the frame draws it with
+  // computeSkinning; its draws then use the static pipelines
+  SkinningPass skinning_;
+  bool computeSkinning_ = false;
+
+  // Picking pass after the render pass, in frames drawn after requestPick(); read back a
+  // frame slot later
+  PickPass pick_;
+  std::optional<glm::vec2> pickCursor_; // Requested for the next frame
+  bool pickThisFrame_ = false;
+  uint32_t pickUboOffset_ = 0; // The frame's UBO with the pick projection
+  std::optional<PickResult> pickResult_;
+
+  // The HLod model's instances in view, by LOD level, when the frame draws it instanced
+  InstanceBuckets instanceBuckets_;
+  bool drawInstanced_ = false;
+
+  // Mesh draws of the frame being recorded, in state order
+  RenderQueue renderQueue_;
+  RenderQueueStats queueStats_;
+
+  // Dynamic offsets into frameData_ for the frame being recorded
+  uint32_t uboOffset_ = 0;
+  uint32_t boneOffset_ = 0;
+  uint32_t instanceOffset_ = 0;
+  glm::mat4 viewProj_{1.0f}; // proj * view * model of the frame, for culling
+  gfx::VertexFormat meshFormat_ = gfx::VertexFormat::Full; // Of the mesh set drawn
 
   // Command buffers and synchronization
   std::vector<vk::CommandBuffer> commandBuffers_;
@@ -123,13 +285,33 @@ private:
   std::vector<vk::Semaphore> renderFinishedSemaphores_;
   std::vector<vk::Fence> inFlightFences_;
 
+  // Parallel recording: per frame slot, one pool and secondary command buffer per chunk of
+  // the queue, plus the overlay's secondary. The calling thread records one chunk itself.
+  struct RecordSlot {
+    vk::CommandPool pool;
+    vk::CommandBuffer cmd;
+  };
+  using RecordSlots = std::array<RecordSlot, RenderState::MAX_RECORD_THREADS>;
+  std::array<RecordSlots, MAX_FRAMES_IN_FLIGHT> recordSlots_{};
+  std::array<vk::CommandBuffer, MAX_FRAMES_IN_FLIGHT> overlayBuffers_{};
+  ThreadPool recordPool_;
+  RecordStats recordStats_;
+
+  // Mesh draws each frame slot last recorded for reuse, with the key they were recorded from
+  std::array<DrawCache, MAX_FRAMES_IN_FLIGHT> drawCaches_{};
+
+  // GPU time of the frame and its passes, read back a frame slot later
+  gfx::GpuProfiler gpuProfiler_;
+  bool pipelineStatistics_ = false; // Statistics queries recorded in the current frame
+  std::optional<double> gpuFrameTime_;
+  static_assert(gfx::GpuProfiler::MAX_PARTS >= RenderState::MAX_RECORD_THREADS,
+                "Every recording chunk needs its own statistics query");
+  uint32_t lastImageIndex_ = 0;
+
   uint32_t currentFrame_ = 0;
   bool framebufferResized_ = false;
   bool frameWaited_ = false;         // Track if waitForCurrentFrame() was called this frame
   bool recreatingSwapchain_ = false; // Prevent concurrent swapchain recreation
-
-  // Default material
-  Material defaultMaterial_;
 };
 
 } // namespace w3d
@@ -67,6 +67,17 @@ Settings Settings::load(const std::filesystem::path &path) {
         settings.showSkeleton = display["show_skeleton"].get<bool>();
       }
     }
+
+    // Parse rendering section
+    if (json.contains("rendering")) {
+      auto &rendering = json["rendering"];
+      if (rendering.contains("record_threads")) {
+        settings.recordThreads = rendering["record_threads"].get<int>();
+      }
+      if (rendering.contains("vertex_format")) {
+        settings.vertexFormat = rendering["vertex_format"].get<std::string>();
+      }
+    }
   } catch (const nlohmann::json::exception &e) {
     std::cerr << "Warning: Error parsing settings file: " << e.what() << "\n";
     // Return partially loaded settings or defaults
@@ -119,6 +130,10 @@ bool Settings::save(const std::filesystem::path &path) const {
     json["display"]["show_mesh"] = showMesh;
     json["display"]["show_skeleton"] = showSkeleton;
 
+    // Rendering section
+    json["rendering"]["record_threads"] = recordThreads;
+    json["rendering"]["vertex_format"] = vertexFormat;
+
     file << json.dump(2); // Pretty print with 2-space indent
   } catch (const nlohmann::json::exception &e) {
     std::cerr << "Warning: Error serializing settings: " << e.what() << "\n";
@@ -33,6 +33,12 @@ struct Settings {
   /// Show skeleton by default
   bool showSkeleton = true;
 
+  // === Rendering Settings ===
+  /// Threads recording draw commands (0 = record inline on the main thread)
+  int recordThreads = 0;
+  /// Vertex format of uploaded meshes: "full", "compact" or "quantized"
+  std::string vertexFormat = "quantized";
+
   // === Serialization ===
 
   /// Load settings from a file.
@@ -0,0 +1,112 @@
+#include "thread_pool.hpp"
+
+#include <utility>
+
+namespace w3d {
+
+ThreadPool::ThreadPool(uint32_t workers) {
+  start(workers);
+}
+
+ThreadPool::~ThreadPool() {
+  stop();
+}
+
+void ThreadPool::resize(uint32_t workers) {
+  std::lock_guard<std::mutex> job(jobMutex_);
+  if (workers == workerCount()) {
+    return;
+  }
+  stop();
+  start(workers);
+}
+
+void ThreadPool::start(uint32_t workers) {
+  // New workers start from the current generation: the last finished job is not theirs
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    generation = generation_;
+  }
+  workers_.reserve(workers);
+  for (uint32_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this, generation] { workerLoop(generation); });
+  }
+}
+
+void ThreadPool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  jobReady_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)> &task) {
+  if (count == 0) {
+    return;
+  }
+
+  // The job state below is shared: a second caller waits for the current job to finish
+  std::lock_guard<std::mutex> job(jobMutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_.store(0);
+    busyWorkers_ = workerCount();
+    error_ = nullptr;
+    ++generation_;
+  }
+  jobReady_.notify_all();
+
+  runTasks();
+
+  // Every worker checks in, so none is still looking at this job when the next one starts
+  std::unique_lock<std::mutex> lock(mutex_);
+  jobDone_.wait(lock, [this] { return busyWorkers_ == 0; });
+  task_ = nullptr;
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+void ThreadPool::workerLoop(uint64_t seen) {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobReady_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+      if (stopping_) {
+        return;
+      }
+      seen = generation_;
+    }
+
+    runTasks();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busyWorkers_ == 0) {
+      jobDone_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::runTasks() {
+  for (uint32_t i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+    try {
+      (*task_)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+} // namespace w3d
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace w3d {
+
+/**
+ * Fixed set of worker threads that run indexed tasks in parallel.
+ * The calling thread takes part in every job, so a pool with N workers runs up to N + 1
+ * tasks at once and a pool without workers runs them inline.
+ */
+class ThreadPool {
+public:
+  explicit ThreadPool(uint32_t workers = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * Stop the current workers and start a new set. Waits for a running job to finish.
+   */
+  void resize(uint32_t workers);
+
+  uint32_t workerCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+  /**
+   * Run task(i) once for every i in [0, count) and return when all have finished.
+   * Tasks are claimed in index order by whichever thread is free. Calls from several threads
+   * are serialized: each job runs alone, after the one before it has finished. A task must not
+   * call parallelFor() on the pool running it.
+   * @throws the first exception thrown by a task, after all tasks have finished
+   */
+  void parallelFor(uint32_t count, const std::function<void(uint32_t)> &task);
+
+private:
+  void start(uint32_t workers);
+  void stop();
+  void workerLoop(uint64_t seen);
+  void runTasks();
+
+  std::vector<std::thread> workers_;
+  std::mutex jobMutex_; // Held by the caller for a whole job, and by resize()
+  std::mutex mutex_;
+  std::condition_variable jobReady_;
+  std::condition_variable jobDone_;
+
+  // Current job, published under mutex_ by bumping generation_
+  const std::function<void(uint32_t)> *task_ = nullptr;
+  uint32_t count_ = 0;
+  std::atomic<uint32_t> next_{0};
+  uint32_t busyWorkers_ = 0;
+  uint64_t generation_ = 0;
+  std::exception_ptr error_;
+  bool stopping_ = false;
+};
+
+} // namespace w3d
@@ -5,35 +5,160 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 #include "render/mesh_converter.hpp"
+#include "render/mesh_simplifier.hpp"
+#include "render/skinning.hpp"
 
 namespace w3d {
 
+namespace {
+
+// Pack every sub-mesh into one vertex and one index buffer, recording each mesh's range.
+// Indices stay mesh-local; the draw's vertexOffset rebases them. Vertices are encoded in
+// format, quantized against the bounds of the whole set.
+template <typename MeshT>
+void uploadSharedBuffers(gfx::VulkanContext &context, std::vector<MeshT> &meshes,
+                         gfx::VertexFormat format, gfx::EncodedVertexBuffer &vertexBuffer,
+                         gfx::IndexBuffer &indexBuffer) {
+  using VertexT = typename decltype(MeshT::cpuVertices)::value_type;
+
+  size_t vertexCount = 0;
+  size_t indexCount = 0;
+  for (const auto &mesh : meshes) {
+    vertexCount += mesh.cpuVertices.size();
+    indexCount += mesh.cpuIndices.size();
+  }
+
+  if (vertexCount == 0 || indexCount == 0) {
+    return;
+  }
+
+  std::vector<VertexT> vertices;
+  std::vector<uint32_t> indices;
+  vertices.reserve(vertexCount);
+  indices.reserve(indexCount);
+  gfx::BoundingBox bounds;
+
+  for (auto &mesh : meshes) {
+    mesh.vertexOffset = static_cast<int32_t>(vertices.size());
+    mesh.firstIndex = static_cast<uint32_t>(indices.size());
+    mesh.indexCount = static_cast<uint32_t>(mesh.cpuIndices.size());
+
+    vertices.insert(vertices.end(), mesh.cpuVertices.begin(), mesh.cpuVertices.end());
+    indices.insert(indices.end(), mesh.cpuIndices.begin(), mesh.cpuIndices.end());
+  }
+  for (const auto &vertex : vertices) {
+    bounds.expand(vertex.position);
+  }
+
+  vertexBuffer.create(context, MeshConverter::encodeVertices(vertices, format, bounds));
+  indexBuffer.create(context, indices);
+}
+
+// The skinned set in the full format, vertex for vertex as uploadSharedBuffers() laid it
+// out, so the meshes' vertexOffsets also address the posed copy the skinning pre-pass writes
+void uploadSkinningSource(gfx::VulkanContext &context,
+                          const std::vector<w3d_types::HLodSkinnedMeshGPU> &meshes,
+                          gfx::StagedBuffer &source) {
+  std::vector<gfx::SkinnedVertex> vertices;
+  for (const auto &mesh : meshes) {
+    vertices.insert(vertices.end(), mesh.cpuVertices.begin(), mesh.cpuVertices.end());
+  }
+  if (vertices.empty()) {
+    return;
+  }
+  source.create(context, vertices.data(), sizeof(gfx::SkinnedVertex) * vertices.size(),
+                vk::BufferUsageFlagBits::eStorageBuffer);
+}
+
+// Picking trees over the static set's CPU copies, generated LOD levels included. Skinned
+// meshes are posed every frame, so their hover test stays per triangle.
+void buildPickingTrees(std::vector<w3d_types::HLodMeshGPU> &meshes) {
+  for (auto &mesh : meshes) {
+    mesh.bvh.build(mesh.cpuVertices, mesh.cpuIndices);
+  }
+}
+
+// One packet per mesh, texture resolved through textures, sorted by material.
+// placeDraw(mesh, packet) fills in sphere and bone.
+template <typename MeshT, typename PlaceDrawFunc>
+void compilePackets(const std::vector<MeshT> &meshes, const gfx::TextureManager &textures,
+                    std::vector<DrawPacket> &out, PlaceDrawFunc placeDraw) {
+  out.clear();
+  out.reserve(meshes.size());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    const auto &mesh = meshes[i];
+
+    DrawPacket packet{};
+    uint32_t texIdx = mesh.textureName.empty() ? 0 : textures.findTexture(mesh.textureName);
+    packet.material = packetMaterial(texIdx, mesh.blendMode);
+    packet.command = {mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, 0};
+    packet.boneIndex = CullInput::NO_BONE;
+    packet.lodMask = mesh.isAggregate ? DrawPacket::ALL_LODS : lodBit(mesh.lodLevel);
+    packet.meshIndex = static_cast<uint32_t>(i);
+    placeDraw(mesh, packet);
+    out.push_back(packet);
+  }
+  sortDrawPackets(out);
+}
+
+// Simplify a sub-mesh to about ratio of its triangles, keeping vertices of different bones
+// apart, then reorder and compact it as MeshConverter::optimize() does. Returns the error.
+template <typename VertexT>
+float simplifySubMesh(std::vector<VertexT> &vertices, std::vector<uint32_t> &indices,
+                      BlendMode blendMode, float ratio) {
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> bones;
+  positions.reserve(vertices.size());
+  for (const auto &v : vertices) {
+    positions.push_back(v.position);
+    if constexpr (std::is_same_v<VertexT, gfx::SkinnedVertex>) {
+      bones.push_back(v.boneIndex);
+    }
+  }
+
+  size_t target = static_cast<size_t>(static_cast<float>(indices.size() / 3) * ratio) * 3;
+  auto simplified = simplifyMesh(indices, positions, target, bones.empty() ? nullptr : &bones);
+  indices = blendMode == BlendMode::AlphaBlend
+                ? std::move(simplified.indices)
+                : optimizeVertexCache(simplified.indices, vertices.size());
+  remapVertices(vertices, optimizeVertexFetch(indices, vertices.size()));
+  return simplified.error;
+}
+
+} // namespace
+
 HLodModel::~HLodModel() {
   destroy();
 }
 
 void HLodModel::destroy() {
-  for (auto &mesh : meshGPU_) {
-    mesh.vertexBuffer.destroy();
-    mesh.indexBuffer.destroy();
-  }
+  vertexBuffer_.destroy();
+  indexBuffer_.destroy();
   meshGPU_.clear();
 
-  for (auto &mesh : skinnedMeshGPU_) {
-    mesh.vertexBuffer.destroy();
-    mesh.indexBuffer.destroy();
-  }
+  skinnedVertexBuffer_.destroy();
+  skinnedIndexBuffer_.destroy();
+  skinningSource_.destroy();
   skinnedMeshGPU_.clear();
 
+  packets_.clear();
+  skinnedPackets_.clear();
   lodLevels_.clear();
   aggregateCount_ = 0;
   skinnedAggregateCount_ = 0;
   currentLOD_ = 0;
   combinedBounds_ = gfx::BoundingBox{};
+  instances_.clear();
+  vertexCacheStats_ = {};
   name_.clear();
   hierarchyName_.clear();
+  ++revision_;
 }
 
 std::unordered_map<std::string, size_t> HLodModel::buildMeshNameMap(const W3DFile &file) {
@@ -70,6 +195,38 @@ HLodModel::findMeshIndex(const std::unordered_map<std::string, size_t> &nameMap,
   return std::nullopt;
 }
 
+std::vector<w3d_types::HLodMeshInfo>
+HLodModel::findAggregates(const std::unordered_map<std::string, size_t> &nameMap,
+                          const W3DFile &file, const HLod &hlod) {
+  std::vector<w3d_types::HLodMeshInfo> aggregates;
+  for (const auto &subObj : hlod.aggregates) {
+    auto meshIdx = findMeshIndex(nameMap, file, subObj.name);
+    if (meshIdx.has_value()) {
+      aggregates.push_back({meshIdx.value(), subObj.boneIndex, subObj.name});
+    }
+  }
+  return aggregates;
+}
+
+std::vector<MeshConversionJob>
+HLodModel::conversionJobs(const W3DFile &file,
+                          const std::vector<w3d_types::HLodMeshInfo> &aggregates,
+                          const std::vector<w3d_types::HLodLevelInfo> &levels) {
+  std::vector<MeshConversionJob> jobs;
+  auto addJob = [&](const w3d_types::HLodMeshInfo &info) {
+    jobs.push_back({&file.meshes[info.meshIndex], static_cast<int32_t>(info.boneIndex)});
+  };
+  for (const auto &info : aggregates) {
+    addJob(info);
+  }
+  for (const auto &level : levels) {
+    for (const auto &info : level.meshes) {
+      addJob(info);
+    }
+  }
+  return jobs;
+}
+
 void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const SkeletonPose *pose) {
   destroy();
 
@@ -89,8 +246,15 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
 
     lodLevels_.push_back(level0);
 
-    for (size_t i = 0; i < file.meshes.size(); ++i) {
-      auto converted = MeshConverter::convert(file.meshes[i]);
+    std::vector<MeshConversionJob> jobs;
+    jobs.reserve(file.meshes.size());
+    for (const auto &mesh : file.meshes) {
+      jobs.push_back({&mesh, -1});
+    }
+    auto convertedMeshes = MeshConverter::convertMany(jobs);
+    vertexCacheStats_.add(MeshConverter::optimizeAll(convertedMeshes));
+
+    for (const auto &converted : convertedMeshes) {
       if (converted.subMeshes.empty()) {
         continue;
       }
@@ -110,15 +274,14 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
         gpuMesh.subMeshIndex = subIdx;
         gpuMesh.subMeshTotal = converted.subMeshes.size();
         gpuMesh.textureName = subMesh.textureName;
+        gpuMesh.blendMode = subMesh.blendMode;
         gpuMesh.boneIndex = -1;
         gpuMesh.lodLevel = 0;
         gpuMesh.isAggregate = false;
 
         gpuMesh.cpuVertices = subMesh.vertices;
         gpuMesh.cpuIndices = subMesh.indices;
-
-        gpuMesh.vertexBuffer.create(context, subMesh.vertices);
-        gpuMesh.indexBuffer.create(context, subMesh.indices);
+        gpuMesh.boundingSphere = glm::vec4(subMesh.bounds.center(), subMesh.bounds.radius());
 
         combinedBounds_.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
         lodLevels_[0].bounds.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
@@ -127,6 +290,9 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
       }
     }
 
+    generateLODs(meshGPU_);
+    buildPickingTrees(meshGPU_);
+    uploadSharedBuffers(context, meshGPU_, vertexFormat_, vertexBuffer_, indexBuffer_);
     return;
   }
 
@@ -157,15 +323,15 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
     }
   }
 
-  std::unordered_map<size_t, size_t> uploadedMeshes;
-
-  for (const auto &subObj : hlod.aggregates) {
-    auto meshIdx = findMeshIndex(meshNameMap, file, subObj.name);
-    if (!meshIdx.has_value()) {
-      continue;
-    }
+  // Every mesh reference (aggregates, then each LOD's meshes) is converted in one batch
+  auto aggregates = findAggregates(meshNameMap, file, hlod);
+  auto jobs = conversionJobs(file, aggregates, lodLevels_);
+  auto convertedMeshes = MeshConverter::convertMany(jobs);
+  vertexCacheStats_.add(MeshConverter::optimizeAll(convertedMeshes));
+  size_t nextConverted = 0;
 
-    auto converted = MeshConverter::convert(file.meshes[meshIdx.value()]);
+  for (const auto &subObj : aggregates) {
+    auto &converted = convertedMeshes[nextConverted++];
     if (converted.subMeshes.empty()) {
       continue;
     }
@@ -190,22 +356,19 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
       gpuMesh.subMeshIndex = subIdx;
       gpuMesh.subMeshTotal = converted.subMeshes.size();
       gpuMesh.textureName = subMesh.textureName;
+      gpuMesh.blendMode = subMesh.blendMode;
       gpuMesh.boneIndex = static_cast<int32_t>(subObj.boneIndex);
       gpuMesh.lodLevel = 0;
       gpuMesh.isAggregate = true;
 
       gpuMesh.cpuVertices = subMesh.vertices;
       gpuMesh.cpuIndices = subMesh.indices;
-
-      gpuMesh.vertexBuffer.create(context, subMesh.vertices);
-      gpuMesh.indexBuffer.create(context, subMesh.indices);
+      gpuMesh.boundingSphere = glm::vec4(subMesh.bounds.center(), subMesh.bounds.radius());
 
       combinedBounds_.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
 
       meshGPU_.push_back(std::move(gpuMesh));
     }
-
-    uploadedMeshes[meshIdx.value()] = meshGPU_.size();
   }
 
   aggregateCount_ = meshGPU_.size();
@@ -214,10 +377,7 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
     auto &levelInfo = lodLevels_[lodIdx];
 
     for (const auto &meshInfo : levelInfo.meshes) {
-      auto it = uploadedMeshes.find(meshInfo.meshIndex);
-      if (it != uploadedMeshes.end()) {}
-
-      auto converted = MeshConverter::convert(file.meshes[meshInfo.meshIndex]);
+      auto &converted = convertedMeshes[nextConverted++];
       if (converted.subMeshes.empty()) {
         continue;
       }
@@ -242,15 +402,14 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
         gpuMesh.subMeshIndex = subIdx;
         gpuMesh.subMeshTotal = converted.subMeshes.size();
         gpuMesh.textureName = subMesh.textureName;
+        gpuMesh.blendMode = subMesh.blendMode;
         gpuMesh.boneIndex = static_cast<int32_t>(meshInfo.boneIndex);
         gpuMesh.lodLevel = lodIdx;
         gpuMesh.isAggregate = false;
 
         gpuMesh.cpuVertices = subMesh.vertices;
         gpuMesh.cpuIndices = subMesh.indices;
-
-        gpuMesh.vertexBuffer.create(context, subMesh.vertices);
-        gpuMesh.indexBuffer.create(context, subMesh.indices);
+        gpuMesh.boundingSphere = glm::vec4(subMesh.bounds.center(), subMesh.bounds.radius());
 
         combinedBounds_.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
         lodLevels_[0].bounds.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
@@ -262,6 +421,10 @@ void HLodModel::load(gfx::VulkanContext &context, const W3DFile &file, const Ske
 
   currentLOD_ = 0;
 
+  generateLODs(meshGPU_);
+  buildPickingTrees(meshGPU_);
+  uploadSharedBuffers(context, meshGPU_, vertexFormat_, vertexBuffer_, indexBuffer_);
+
   // Initialize all meshes as visible
   meshVisibility_.resize(meshGPU_.size(), true);
 }
@@ -284,6 +447,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
     lodLevels_.push_back(level0);
 
     auto skinnedMeshes = MeshConverter::convertAllSkinned(file);
+    vertexCacheStats_.add(MeshConverter::optimizeAll(skinnedMeshes));
     for (auto &converted : skinnedMeshes) {
       for (size_t subIdx = 0; subIdx < converted.subMeshes.size(); ++subIdx) {
         auto &subMesh = converted.subMeshes[subIdx];
@@ -300,6 +464,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
         gpuMesh.subMeshIndex = subIdx;
         gpuMesh.subMeshTotal = converted.subMeshes.size();
         gpuMesh.textureName = subMesh.textureName;
+        gpuMesh.blendMode = subMesh.blendMode;
         gpuMesh.fallbackBoneIndex = converted.fallbackBoneIndex;
         gpuMesh.lodLevel = 0;
         gpuMesh.isAggregate = false;
@@ -307,9 +472,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
 
         gpuMesh.cpuVertices = subMesh.vertices;
         gpuMesh.cpuIndices = subMesh.indices;
-
-        gpuMesh.vertexBuffer.create(context, subMesh.vertices);
-        gpuMesh.indexBuffer.create(context, subMesh.indices);
+        gpuMesh.boundingSphere = glm::vec4(subMesh.bounds.center(), subMesh.bounds.radius());
 
         combinedBounds_.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
         lodLevels_[0].bounds.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
@@ -318,6 +481,11 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
       }
     }
 
+    generateLODs(skinnedMeshGPU_);
+    uploadSharedBuffers(context, skinnedMeshGPU_, vertexFormat_, skinnedVertexBuffer_,
+                        skinnedIndexBuffer_);
+    uploadSkinningSource(context, skinnedMeshGPU_, skinningSource_);
+
     // Initialize all skinned meshes as visible
     skinnedMeshVisibility_.resize(skinnedMeshGPU_.size(), true);
 
@@ -351,14 +519,14 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
     }
   }
 
-  for (const auto &subObj : hlod.aggregates) {
-    auto meshIdx = findMeshIndex(meshNameMap, file, subObj.name);
-    if (!meshIdx.has_value()) {
-      continue;
-    }
+  auto aggregates = findAggregates(meshNameMap, file, hlod);
+  auto jobs = conversionJobs(file, aggregates, lodLevels_);
+  auto convertedMeshes = MeshConverter::convertManySkinned(jobs);
+  vertexCacheStats_.add(MeshConverter::optimizeAll(convertedMeshes));
+  size_t nextConverted = 0;
 
-    auto converted = MeshConverter::convertSkinned(file.meshes[meshIdx.value()],
-                                                   static_cast<int32_t>(subObj.boneIndex));
+  for (const auto &subObj : aggregates) {
+    auto &converted = convertedMeshes[nextConverted++];
     if (converted.subMeshes.empty()) {
       continue;
     }
@@ -378,6 +546,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
       gpuMesh.subMeshIndex = subIdx;
       gpuMesh.subMeshTotal = converted.subMeshes.size();
       gpuMesh.textureName = subMesh.textureName;
+      gpuMesh.blendMode = subMesh.blendMode;
       gpuMesh.fallbackBoneIndex = static_cast<int32_t>(subObj.boneIndex);
       gpuMesh.lodLevel = 0;
       gpuMesh.isAggregate = true;
@@ -385,9 +554,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
 
       gpuMesh.cpuVertices = subMesh.vertices;
       gpuMesh.cpuIndices = subMesh.indices;
-
-      gpuMesh.vertexBuffer.create(context, subMesh.vertices);
-      gpuMesh.indexBuffer.create(context, subMesh.indices);
+      gpuMesh.boundingSphere = glm::vec4(subMesh.bounds.center(), subMesh.bounds.radius());
 
       combinedBounds_.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
 
@@ -401,8 +568,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
     auto &levelInfo = lodLevels_[lodIdx];
 
     for (const auto &meshInfo : levelInfo.meshes) {
-      auto converted = MeshConverter::convertSkinned(file.meshes[meshInfo.meshIndex],
-                                                     static_cast<int32_t>(meshInfo.boneIndex));
+      auto &converted = convertedMeshes[nextConverted++];
       if (converted.subMeshes.empty()) {
         continue;
       }
@@ -422,6 +588,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
         gpuMesh.subMeshIndex = subIdx;
         gpuMesh.subMeshTotal = converted.subMeshes.size();
         gpuMesh.textureName = subMesh.textureName;
+        gpuMesh.blendMode = subMesh.blendMode;
         gpuMesh.fallbackBoneIndex = static_cast<int32_t>(meshInfo.boneIndex);
         gpuMesh.lodLevel = lodIdx;
         gpuMesh.isAggregate = false;
@@ -429,9 +596,7 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
 
         gpuMesh.cpuVertices = subMesh.vertices;
         gpuMesh.cpuIndices = subMesh.indices;
-
-        gpuMesh.vertexBuffer.create(context, subMesh.vertices);
-        gpuMesh.indexBuffer.create(context, subMesh.indices);
+        gpuMesh.boundingSphere = glm::vec4(subMesh.bounds.center(), subMesh.bounds.radius());
 
         combinedBounds_.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
         levelInfo.bounds.expand(gfx::BoundingBox{subMesh.bounds.min, subMesh.bounds.max});
@@ -443,13 +608,77 @@ void HLodModel::loadSkinned(gfx::VulkanContext &context, const W3DFile &file) {
 
   currentLOD_ = 0;
 
+  generateLODs(skinnedMeshGPU_);
+  uploadSharedBuffers(context, skinnedMeshGPU_, vertexFormat_, skinnedVertexBuffer_,
+                        skinnedIndexBuffer_);
+  uploadSkinningSource(context, skinnedMeshGPU_, skinningSource_);
+
   // Initialize all skinned meshes as visible
   skinnedMeshVisibility_.resize(skinnedMeshGPU_.size(), true);
 }
 
+template <typename MeshT>
+void HLodModel::generateLODs(std::vector<MeshT> &meshes) {
+  if (generatedLODRatios_.empty() || lodLevels_.size() != 1) {
+    return;
+  }
+
+  size_t baseCount = meshes.size();
+  size_t previousTriangles = 0;
+  for (const auto &mesh : meshes) {
+    previousTriangles += mesh.isAggregate ? 0 : mesh.cpuIndices.size() / 3;
+  }
+  float previousMaxScreenSize = std::numeric_limits<float>::max();
+  float radius = combinedBounds_.radius();
+
+  for (float ratio : generatedLODRatios_) {
+    size_t level = lodLevels_.size();
+    std::vector<MeshT> generated;
+    size_t triangles = 0;
+    float error = 0.0f;
+
+    for (size_t i = 0; i < baseCount; ++i) {
+      if (meshes[i].isAggregate || meshes[i].lodLevel != 0) {
+        continue;
+      }
+      MeshT mesh = meshes[i];
+      error = std::max(error, simplifySubMesh(mesh.cpuVertices, mesh.cpuIndices,
+                                              mesh.blendMode, ratio));
+      mesh.lodLevel = level;
+      triangles += mesh.cpuIndices.size() / 3;
+      if (!mesh.cpuIndices.empty()) {
+        generated.push_back(std::move(mesh));
+      }
+    }
+
+    if (triangles >= previousTriangles) {
+      break;
+    }
+
+    w3d_types::HLodLevelInfo levelInfo;
+    levelInfo.maxScreenSize = std::min(previousMaxScreenSize, lodMaxScreenSize(error, radius));
+    levelInfo.meshes = lodLevels_[0].meshes;
+    levelInfo.bounds = lodLevels_[0].bounds;
+    lodLevels_.push_back(std::move(levelInfo));
+
+    previousTriangles = triangles;
+    previousMaxScreenSize = lodLevels_.back().maxScreenSize;
+    meshes.insert(meshes.end(), std::make_move_iterator(generated.begin()),
+                  std::make_move_iterator(generated.end()));
+  }
+}
+
+void HLodModel::setSelectionMode(w3d_types::LODSelectionMode mode) {
+  if (mode != selectionMode_) {
+    selectionMode_ = mode;
+    ++revision_;
+  }
+}
+
 void HLodModel::setCurrentLOD(size_t level) {
-  if (level < lodLevels_.size()) {
+  if (level < lodLevels_.size() && level != currentLOD_) {
     currentLOD_ = level;
+    ++revision_;
   }
 }
 
@@ -474,13 +703,16 @@ void HLodModel::updateLOD(float screenHeight, float fovY, float cameraDistance)
   float radius = combinedBounds_.radius();
   currentScreenSize_ = calculateScreenSize(radius, cameraDistance, screenHeight, fovY);
 
-  currentLOD_ = 0;
-
+  size_t level = 0;
   for (size_t i = 0; i < lodLevels_.size(); ++i) {
     if (lodLevels_[i].maxScreenSize > 0.0f && currentScreenSize_ < lodLevels_[i].maxScreenSize) {
-      currentLOD_ = i;
+      level = i;
     }
   }
+  if (level != currentLOD_) {
+    currentLOD_ = level;
+    ++revision_;
+  }
 }
 
 size_t HLodModel::triangleCount(size_t meshIndex) const {
@@ -555,6 +787,36 @@ bool HLodModel::getSkinnedTriangle(size_t meshIndex, size_t triangleIndex, glm::
   return true;
 }
 
+bool HLodModel::getPosedSkinnedTriangle(size_t meshIndex, size_t triangleIndex,
+                                        const glm::mat4 *bones, size_t boneCount, glm::vec3 &v0,
+                                        glm::vec3 &v1, glm::vec3 &v2) const {
+  if (meshIndex >= skinnedMeshGPU_.size()) {
+    return false;
+  }
+
+  const auto &mesh = skinnedMeshGPU_[meshIndex];
+  size_t baseIdx = triangleIndex * 3;
+
+  if (baseIdx + 2 >= mesh.cpuIndices.size()) {
+    return false;
+  }
+
+  uint32_t i0 = mesh.cpuIndices[baseIdx];
+  uint32_t i1 = mesh.cpuIndices[baseIdx + 1];
+  uint32_t i2 = mesh.cpuIndices[baseIdx + 2];
+
+  if (i0 >= mesh.cpuVertices.size() || i1 >= mesh.cpuVertices.size() ||
+      i2 >= mesh.cpuVertices.size()) {
+    return false;
+  }
+
+  v0 = skinPosition(mesh.cpuVertices[i0], bones, boneCount);
+  v1 = skinPosition(mesh.cpuVertices[i1], bones, boneCount);
+  v2 = skinPosition(mesh.cpuVertices[i2], bones, boneCount);
+
+  return true;
+}
+
 const std::string &HLodModel::meshName(size_t index) const {
   static const std::string empty;
   if (index >= meshGPU_.size()) {
@@ -625,10 +887,12 @@ void HLodModel::setMeshHidden(size_t index, bool hidden) {
     meshVisibility_.resize(index + 1, true);
   }
   meshVisibility_[index] = !hidden;
+  ++revision_;
 }
 
 void HLodModel::setAllMeshesHidden(bool hidden) {
   meshVisibility_.resize(meshGPU_.size(), !hidden);
+  ++revision_;
 }
 
 bool HLodModel::isSkinnedMeshHidden(size_t index) const {
@@ -643,29 +907,97 @@ void HLodModel::setSkinnedMeshHidden(size_t index, bool hidden) {
     skinnedMeshVisibility_.resize(index + 1, true);
   }
   skinnedMeshVisibility_[index] = !hidden;
+  ++revision_;
 }
 
 void HLodModel::setAllSkinnedMeshesHidden(bool hidden) {
   skinnedMeshVisibility_.resize(skinnedMeshGPU_.size(), !hidden);
+  ++revision_;
 }
 
-void HLodModel::draw(vk::CommandBuffer cmd) {
-  for (size_t i = 0; i < aggregateCount_; ++i) {
-    // Skip if user has hidden this mesh
-    if (i < meshVisibility_.size() && !meshVisibility_[i]) {
-      continue;
+void HLodModel::bindBuffers(vk::CommandBuffer cmd, bool skinned,
+                            vk::Buffer vertexBuffer) const {
+  if (!vertexBuffer) {
+    vertexBuffer = skinned ? skinnedVertexBuffer_.buffer() : vertexBuffer_.buffer();
+  }
+  const gfx::IndexBuffer &indices = skinned ? skinnedIndexBuffer_ : indexBuffer_;
+
+  vk::DeviceSize offset = 0;
+  cmd.bindVertexBuffers(0, 1, &vertexBuffer, &offset);
+  cmd.bindIndexBuffer(indices.buffer(), 0, indices.indexType());
+}
+
+void HLodModel::compileDrawPackets(const gfx::TextureManager &textures) {
+  ++revision_;
+
+  // Static vertices are already in model space
+  auto placeStatic = [](const w3d_types::HLodMeshGPU &mesh, DrawPacket &packet) {
+    packet.sphere = mesh.boundingSphere;
+  };
+  compilePackets(meshGPU_, textures, packets_, placeStatic);
+
+  auto placeSkinned = [](const w3d_types::HLodSkinnedMeshGPU &mesh, DrawPacket &packet) {
+    if (mesh.hasSkinning) {
+      // Vertices follow their own bones; no single sphere bounds the pose
+      packet.sphere = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+      return;
     }
+    // Rigid mesh: every vertex uses the fallback bone (0 if unset)
+    packet.sphere = mesh.boundingSphere;
+    packet.boneIndex = static_cast<uint32_t>(std::max(mesh.fallbackBoneIndex, 0));
+  };
+  compilePackets(skinnedMeshGPU_, textures, skinnedPackets_, placeSkinned);
+}
 
-    const auto &mesh = meshGPU_[i];
+void HLodModel::buildDrawList(bool skinned, int hoverMeshIndex, const glm::vec3 &tintColor,
+                              DrawList &out, const InstanceBuckets *instances) const {
+  uint32_t lodMask = lodBit(currentLOD_);
+  if (instances) {
+    lodMask = 0;
+    for (size_t level = 0; level < instances->levelCount(); ++level) {
+      if (instances->count(level) > 0) {
+        lodMask |= lodBit(level);
+      }
+    }
+  }
+  w3d::buildDrawList(skinned ? skinnedPackets_ : packets_, lodMask,
+                     skinned ? skinnedMeshVisibility_ : meshVisibility_, hoverMeshIndex,
+                     tintColor, out, instances);
+}
 
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
+void HLodModel::setInstances(std::vector<glm::mat4> transforms) {
+  glm::vec4 sphere(0.0f);
+  if (combinedBounds_.valid()) {
+    sphere = glm::vec4(combinedBounds_.center(), combinedBounds_.radius());
   }
+  instances_.assign(std::move(transforms), sphere);
+  ++revision_;
+}
 
-  for (size_t i = aggregateCount_; i < meshGPU_.size(); ++i) {
+void HLodModel::clearInstances() {
+  if (!instances_.empty()) {
+    instances_.clear();
+    ++revision_;
+  }
+}
+
+void HLodModel::bucketInstances(const InstanceView &view, InstanceBuckets &out) const {
+  std::vector<float> maxScreenSizes(lodLevels_.size(), 0.0f);
+  if (selectionMode_ == w3d_types::LODSelectionMode::Auto) {
+    for (size_t i = 0; i < lodLevels_.size(); ++i) {
+      maxScreenSizes[i] = lodLevels_[i].maxScreenSize;
+    }
+  } else if (currentLOD_ < maxScreenSizes.size()) {
+    // Only the current level has a maximum, and every instance is below it
+    maxScreenSizes[currentLOD_] = std::numeric_limits<float>::max();
+  }
+  instances_.bucket(view, maxScreenSizes, out);
+}
+
+void HLodModel::draw(vk::CommandBuffer cmd) {
+  bindBuffers(cmd, false);
+
+  for (size_t i = 0; i < meshGPU_.size(); ++i) {
     // Skip if user has hidden this mesh
     if (i < meshVisibility_.size() && !meshVisibility_[i]) {
       continue;
@@ -673,15 +1005,11 @@ void HLodModel::draw(vk::CommandBuffer cmd) {
 
     const auto &mesh = meshGPU_[i];
 
-    if (mesh.lodLevel != currentLOD_) {
+    if (!mesh.isAggregate && mesh.lodLevel != currentLOD_) {
       continue;
     }
 
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
+    cmd.drawIndexed(mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, 0);
   }
 }
 
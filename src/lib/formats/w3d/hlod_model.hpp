@@ -6,17 +6,28 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "lib/gfx/bounding_box.hpp"
 #include "lib/gfx/renderable.hpp"
+#include "lib/gfx/texture.hpp"
+#include "render/draw_culling.hpp"
+#include "render/draw_packet.hpp"
+#include "render/instance_set.hpp"
+#include "render/mesh_bvh.hpp"
+#include "render/mesh_optimizer.hpp"
 #include "render/skeleton.hpp"
 
 namespace w3d {
 
 struct W3DFile;
+struct HLod;
+struct MeshConversionJob;
 
 namespace w3d_types {
 
@@ -32,17 +43,22 @@ struct HLodLevelInfo {
   gfx::BoundingBox bounds;
 };
 
+// Sub-meshes live in the model's shared vertex/index buffers; these are their ranges
 struct HLodMeshGPU {
-  gfx::VertexBuffer<gfx::Vertex> vertexBuffer;
-  gfx::IndexBuffer indexBuffer;
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
+  int32_t vertexOffset = 0;
   std::string name;
   std::string textureName;
+  BlendMode blendMode = BlendMode::Opaque;
   int32_t boneIndex = -1;
+  glm::vec4 boundingSphere{0.0f}; // Center and radius in vertex space
   size_t lodLevel = 0;
   bool isAggregate = false;
 
   std::vector<gfx::Vertex> cpuVertices;
   std::vector<uint32_t> cpuIndices;
+  MeshBVH bvh; // Over the CPU copies, for hover picking
 
   std::string baseName;
   size_t subMeshIndex = 0;
@@ -50,11 +66,14 @@ struct HLodMeshGPU {
 };
 
 struct HLodSkinnedMeshGPU {
-  gfx::VertexBuffer<gfx::SkinnedVertex> vertexBuffer;
-  gfx::IndexBuffer indexBuffer;
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
+  int32_t vertexOffset = 0;
   std::string name;
   std::string textureName;
+  BlendMode blendMode = BlendMode::Opaque;
   int32_t fallbackBoneIndex = -1;
+  glm::vec4 boundingSphere{0.0f}; // Center and radius in vertex space
   size_t lodLevel = 0;
   bool isAggregate = false;
   bool hasSkinning = false;
@@ -100,7 +119,8 @@ public:
   const w3d_types::HLodLevelInfo &lodLevel(size_t index) const { return lodLevels_[index]; }
 
   w3d_types::LODSelectionMode selectionMode() const { return selectionMode_; }
-  void setSelectionMode(w3d_types::LODSelectionMode mode) { selectionMode_ = mode; }
+  // Changes the revision: bucketInstances() sorts instances by the mode
+  void setSelectionMode(w3d_types::LODSelectionMode mode);
 
   size_t currentLOD() const { return currentLOD_; }
   void setCurrentLOD(size_t level);
@@ -118,9 +138,68 @@ public:
   template <typename BindTextureFunc>
   void drawWithTextures(vk::CommandBuffer cmd, BindTextureFunc bindTexture) const;
 
-  template <typename BeforeDrawFunc>
-  void drawWithHover(vk::CommandBuffer cmd, int hoverMeshIndex, const glm::vec3 &tintColor,
-                     BeforeDrawFunc beforeDraw) const;
+  // Resolve each mesh's texture, material, range, bounding sphere, bone and LOD into a
+  // DrawPacket. Call after load()/loadSkinned() once the model's textures are loaded.
+  void compileDrawPackets(const gfx::TextureManager &textures);
+
+  // Collect the visible packets of the static (or skinned) set as cullable indirect draws,
+  // grouped into one batch per material. The hovered mesh gets a batch of its own with
+  // tintColor. Skinned meshes deformed by several bones are never culled. With instances
+  // (from bucketInstances()), every level that has instances is drawn instanced instead of
+  // the current one.
+  void buildDrawList(bool skinned, int hoverMeshIndex, const glm::vec3 &tintColor,
+                     DrawList &out, const InstanceBuckets *instances = nullptr) const;
+
+  // Copies of the model drawn in its place, each placed by a transform of rotation,
+  // translation and uniform scale. Empty (the default) draws the model once, where it is.
+  // Cleared by destroy().
+  const InstanceSet &instances() const { return instances_; }
+  void setInstances(std::vector<glm::mat4> transforms);
+  void clearInstances();
+
+  // Cull the instances against the view and sort them into LOD levels: per instance as
+  // updateLOD() selects for the model in Auto mode, all at the current level in Manual mode
+  void bucketInstances(const InstanceView &view, InstanceBuckets &out) const;
+
+  // Bind the shared vertex/index buffers of the static or skinned mesh set. A vertexBuffer
+  // replaces the set's own, e.g. the posed vertices of the skinning pre-pass.
+  void bindBuffers(vk::CommandBuffer cmd, bool skinned, vk::Buffer vertexBuffer = {}) const;
+
+  // The skinned set's vertices in the full format (gfx::SkinnedVertex) as a storage buffer,
+  // in the order of the shared vertex buffer, for the skinning pre-pass to pose
+  vk::Buffer skinningSource() const { return skinningSource_.buffer(); }
+  uint32_t skinnedVertexCount() const { return skinnedVertexBuffer_.vertexCount(); }
+
+  // Vertex format of the shared buffers created by the next load; the CPU copies used for
+  // picking always stay in the full format
+  gfx::VertexFormat vertexFormat() const { return vertexFormat_; }
+  void setVertexFormat(gfx::VertexFormat format) { vertexFormat_ = format; }
+
+  // Triangle ratios (0-1) of the LOD levels the next load generates for a model with a
+  // single level, one simplified level per ratio from the most detailed down. Empty (the
+  // default) generates none.
+  const std::vector<float> &generatedLODRatios() const { return generatedLODRatios_; }
+  void setGeneratedLODRatios(std::vector<float> ratios) {
+    generatedLODRatios_ = std::move(ratios);
+  }
+
+  // How the static or skinned set was uploaded. A skinned set referencing bones the compact
+  // formats cannot hold is kept in the full format.
+  const gfx::VertexEncoding &vertexEncoding(bool skinned) const {
+    return skinned ? skinnedVertexBuffer_.encoding() : vertexBuffer_.encoding();
+  }
+
+  // GPU memory of both shared vertex buffers
+  vk::DeviceSize vertexBytes() const {
+    return vertexBuffer_.size() + skinnedVertexBuffer_.size();
+  }
+
+  // GPU memory of both shared index buffers, 16-bit when every sub-mesh has fewer than
+  // 65,536 vertices
+  vk::DeviceSize indexBytes() const { return indexBuffer_.size() + skinnedIndexBuffer_.size(); }
+
+  // Post-transform cache efficiency of all loaded sub-meshes before and after optimization
+  const VertexCacheStats &vertexCacheStats() const { return vertexCacheStats_; }
 
   const std::vector<w3d_types::HLodMeshGPU> &meshes() const { return meshGPU_; }
 
@@ -132,6 +211,11 @@ public:
   bool getSkinnedTriangle(size_t meshIndex, size_t triangleIndex, glm::vec3 &v0, glm::vec3 &v1,
                           glm::vec3 &v2) const;
 
+  // The triangle posed by the bone palette as the shaders pose it (see skinVertices)
+  bool getPosedSkinnedTriangle(size_t meshIndex, size_t triangleIndex, const glm::mat4 *bones,
+                               size_t boneCount, glm::vec3 &v0, glm::vec3 &v1,
+                               glm::vec3 &v2) const;
+
   const std::string &meshName(size_t index) const;
   const std::string &skinnedMeshName(size_t index) const;
 
@@ -151,6 +235,11 @@ public:
   std::vector<size_t> visibleMeshIndices() const;
   std::vector<size_t> visibleSkinnedMeshIndices() const;
 
+  // Incremented whenever the draws the model produces may change: loading, packet
+  // compilation, LOD selection, mesh hiding and instancing. Renderers compare it to reuse
+  // recorded draws.
+  uint64_t revision() const { return revision_; }
+
   template <typename UpdateModelMatrixFunc>
   void drawWithBoneTransforms(vk::CommandBuffer cmd, const SkeletonPose *pose,
                               UpdateModelMatrixFunc updateModelMatrix) const;
@@ -158,10 +247,6 @@ public:
   template <typename BindTextureFunc>
   void drawSkinnedWithTextures(vk::CommandBuffer cmd, BindTextureFunc bindTexture) const;
 
-  template <typename BeforeDrawFunc>
-  void drawSkinnedWithHover(vk::CommandBuffer cmd, int hoverMeshIndex, const glm::vec3 &tintColor,
-                            BeforeDrawFunc beforeDraw) const;
-
   const std::vector<w3d_types::HLodSkinnedMeshGPU> &skinnedMeshes() const {
     return skinnedMeshGPU_;
   }
@@ -178,6 +263,23 @@ private:
   std::optional<size_t> findMeshIndex(const std::unordered_map<std::string, size_t> &nameMap,
                                       const W3DFile &file, const std::string &name);
 
+  // The HLod's aggregates that name a mesh of the file
+  std::vector<w3d_types::HLodMeshInfo>
+  findAggregates(const std::unordered_map<std::string, size_t> &nameMap, const W3DFile &file,
+                 const HLod &hlod);
+
+  // One conversion per mesh reference: the aggregates, then every LOD level's meshes, in the
+  // order load()/loadSkinned() consume them. Each job carries the reference's bone.
+  static std::vector<MeshConversionJob>
+  conversionJobs(const W3DFile &file, const std::vector<w3d_types::HLodMeshInfo> &aggregates,
+                 const std::vector<w3d_types::HLodLevelInfo> &levels);
+
+  // Append simplified copies of level 0's meshes as levels 1..N, with the screen size at
+  // which each level's error stays within LOD_PIXEL_ERROR. Only for a model loaded with a
+  // single level; stops at the first ratio that removes no further triangles.
+  template <typename MeshT>
+  void generateLODs(std::vector<MeshT> &meshes);
+
   float calculateScreenSize(float radius, float distance, float screenHeight, float fovY) const;
 
   template <typename MeshT, typename BeforeDrawFunc>
@@ -190,6 +292,20 @@ private:
   std::vector<w3d_types::HLodLevelInfo> lodLevels_;
   std::vector<w3d_types::HLodMeshGPU> meshGPU_;
   std::vector<w3d_types::HLodSkinnedMeshGPU> skinnedMeshGPU_;
+
+  // Compiled by compileDrawPackets(), sorted by material
+  std::vector<DrawPacket> packets_;
+  std::vector<DrawPacket> skinnedPackets_;
+
+  // All sub-meshes of a set share one vertex and one index buffer
+  gfx::VertexFormat vertexFormat_ = gfx::VertexFormat::Full;
+  std::vector<float> generatedLODRatios_;
+  gfx::EncodedVertexBuffer vertexBuffer_;
+  gfx::IndexBuffer indexBuffer_;
+  gfx::EncodedVertexBuffer skinnedVertexBuffer_;
+  gfx::IndexBuffer skinnedIndexBuffer_;
+  gfx::StagedBuffer skinningSource_;
+
   size_t aggregateCount_ = 0;
   size_t skinnedAggregateCount_ = 0;
 
@@ -202,36 +318,25 @@ private:
   float currentScreenSize_ = 0.0f;
 
   gfx::BoundingBox combinedBounds_;
+  InstanceSet instances_;
+  VertexCacheStats vertexCacheStats_;
+  uint64_t revision_ = 0;
 };
 
 template <typename MeshT, typename BeforeDrawFunc>
 void HLodModel::drawMeshesImpl(vk::CommandBuffer cmd, const std::vector<MeshT> &meshes,
                                size_t aggregateCount, BeforeDrawFunc beforeDraw) const {
-  for (size_t i = 0; i < aggregateCount; ++i) {
-    const auto &mesh = meshes[i];
-    beforeDraw(mesh);
+  bindBuffers(cmd, std::is_same_v<MeshT, w3d_types::HLodSkinnedMeshGPU>);
 
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
-  }
-
-  for (size_t i = aggregateCount; i < meshes.size(); ++i) {
+  for (size_t i = 0; i < meshes.size(); ++i) {
     const auto &mesh = meshes[i];
 
-    if (mesh.lodLevel != currentLOD_) {
+    if (i >= aggregateCount && mesh.lodLevel != currentLOD_) {
       continue;
     }
 
     beforeDraw(mesh);
-
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
+    cmd.drawIndexed(mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, 0);
   }
 }
 
@@ -241,49 +346,6 @@ void HLodModel::drawWithTextures(vk::CommandBuffer cmd, BindTextureFunc bindText
                  [&](const w3d_types::HLodMeshGPU &mesh) { bindTexture(mesh.textureName); });
 }
 
-template <typename BeforeDrawFunc>
-void HLodModel::drawWithHover(vk::CommandBuffer cmd, int hoverMeshIndex, const glm::vec3 &tintColor,
-                              BeforeDrawFunc beforeDraw) const {
-  for (size_t i = 0; i < aggregateCount_; ++i) {
-    // Skip if user has hidden this mesh
-    if (i < meshVisibility_.size() && !meshVisibility_[i]) {
-      continue;
-    }
-
-    const auto &mesh = meshGPU_[i];
-    glm::vec3 tint = (static_cast<int>(i) == hoverMeshIndex) ? tintColor : glm::vec3(1.0f);
-    beforeDraw(i, mesh.textureName, tint);
-
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
-  }
-
-  for (size_t i = aggregateCount_; i < meshGPU_.size(); ++i) {
-    // Skip if user has hidden this mesh
-    if (i < meshVisibility_.size() && !meshVisibility_[i]) {
-      continue;
-    }
-
-    const auto &mesh = meshGPU_[i];
-
-    if (mesh.lodLevel != currentLOD_) {
-      continue;
-    }
-
-    glm::vec3 tint = (static_cast<int>(i) == hoverMeshIndex) ? tintColor : glm::vec3(1.0f);
-    beforeDraw(i, mesh.textureName, tint);
-
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
-  }
-}
-
 template <typename UpdateModelMatrixFunc>
 void HLodModel::drawWithBoneTransforms(vk::CommandBuffer cmd, const SkeletonPose *pose,
                                        UpdateModelMatrixFunc updateModelMatrix) const {
@@ -302,47 +364,4 @@ void HLodModel::drawSkinnedWithTextures(vk::CommandBuffer cmd, BindTextureFunc b
                  [&](const w3d_types::HLodSkinnedMeshGPU &mesh) { bindTexture(mesh.textureName); });
 }
 
-template <typename BeforeDrawFunc>
-void HLodModel::drawSkinnedWithHover(vk::CommandBuffer cmd, int hoverMeshIndex,
-                                     const glm::vec3 &tintColor, BeforeDrawFunc beforeDraw) const {
-  for (size_t i = 0; i < skinnedAggregateCount_; ++i) {
-    // Skip if user has hidden this mesh
-    if (i < skinnedMeshVisibility_.size() && !skinnedMeshVisibility_[i]) {
-      continue;
-    }
-
-    const auto &mesh = skinnedMeshGPU_[i];
-    glm::vec3 tint = (static_cast<int>(i) == hoverMeshIndex) ? tintColor : glm::vec3(1.0f);
-    beforeDraw(i, mesh.textureName, tint);
-
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
-  }
-
-  for (size_t i = skinnedAggregateCount_; i < skinnedMeshGPU_.size(); ++i) {
-    // Skip if user has hidden this mesh
-    if (i < skinnedMeshVisibility_.size() && !skinnedMeshVisibility_[i]) {
-      continue;
-    }
-
-    const auto &mesh = skinnedMeshGPU_[i];
-
-    if (mesh.lodLevel != currentLOD_) {
-      continue;
-    }
-
-    glm::vec3 tint = (static_cast<int>(i) == hoverMeshIndex) ? tintColor : glm::vec3(1.0f);
-    beforeDraw(i, mesh.textureName, tint);
-
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
-  }
-}
-
 } // namespace w3d
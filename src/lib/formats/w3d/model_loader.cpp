@@ -132,25 +132,27 @@ ModelLoadResult ModelLoader::load(const std::filesystem::path &path, VulkanConte
 
   // Compute skeleton pose first (needed for mesh positioning)
   context.device().waitIdle();
+
+  // Collect every buffer and texture upload of this model into one transfer submission
+  // A load that throws cancels the batch instead of leaving it open for every later load
+  gfx::UploadBatcher::Scope uploads(context.uploader());
+
   if (!loadedFile_->hierarchies.empty()) {
     skeletonPose.computeRestPose(loadedFile_->hierarchies[0]);
 
-    // Initialize skeleton renderer for all frames with rest pose
-    for (uint32_t i = 0; i < SkeletonRenderer::FRAME_COUNT; ++i) {
-      skeletonRenderer.updateFromPose(context, i, skeletonPose);
-    }
+    // Build the static skeleton overlay geometry (positions come from the bone buffer)
+    skeletonRenderer.load(context, skeletonPose);
 
-    // Initialize bone matrix buffer with rest pose transforms (all frames)
+    // Initialize bone matrix palette with rest pose transforms
     if (skeletonPose.isValid()) {
-      auto skinningMatrices = skeletonPose.getSkinningMatrices();
-      for (uint32_t i = 0; i < BoneMatrixBuffer::FRAME_COUNT; ++i) {
-        boneMatrixBuffer.update(i, skinningMatrices);
-      }
+      boneMatrixBuffer.update(skeletonPose.getSkinningMatrices());
     }
 
     if (logCallback) {
       logCallback("Loaded skeleton with " + std::to_string(skeletonPose.boneCount()) + " bones");
     }
+  } else {
+    skeletonRenderer.clear();
   }
 
   // Load animations if present
@@ -187,6 +189,9 @@ ModelLoadResult ModelLoader::load(const std::filesystem::path &path, VulkanConte
       }
     }
 
+    // Textures are loaded above; resolve them into draw packets once per model
+    hlodModel.compileDrawPackets(textureManager);
+
     const auto &hlod = loadedFile_->hlods[0];
     if (logCallback) {
       logCallback("Loaded HLod: " + hlod.name);
@@ -200,9 +205,13 @@ ModelLoadResult ModelLoader::load(const std::filesystem::path &path, VulkanConte
       // Log LOD level details
       for (size_t i = 0; i < hlodModel.lodCount(); ++i) {
         const auto &level = hlodModel.lodLevel(i);
-        std::string lodInfo =
-            "  LOD " + std::to_string(i) + ": " + std::to_string(level.meshes.size()) +
-            " meshes, maxScreenSize=" + std::to_string(static_cast<int>(level.maxScreenSize));
+        // W3D marks the most detailed level with FLT_MAX, which does not fit an int
+        std::string maxScreenSize = level.maxScreenSize < 1e9f
+                                        ? std::to_string(static_cast<int>(level.maxScreenSize))
+                                        : "unlimited";
+        std::string lodInfo = "  LOD " + std::to_string(i) + ": " +
+                              std::to_string(level.meshes.size()) +
+                              " meshes, maxScreenSize=" + maxScreenSize;
         logCallback(lodInfo);
       }
     }
@@ -228,6 +237,8 @@ ModelLoadResult ModelLoader::load(const std::filesystem::path &path, VulkanConte
     }
   }
 
+  uploads.flush();
+
   // Center on skeleton if no mesh data
   bool hasMeshData = (result.useHLodModel && hlodModel.hasData()) ||
                      (!result.useHLodModel && renderableMesh.hasData());
@@ -243,6 +254,17 @@ ModelLoadResult ModelLoader::load(const std::filesystem::path &path, VulkanConte
     camera.setTarget(center, maxDist * 2.5f);
   }
 
+  if (logCallback) {
+    const auto stats = context.allocator().stats();
+    logCallback("GPU memory: " + std::to_string(stats.bytesUsed / 1024) + " KiB used in " +
+                std::to_string(stats.allocationCount) + " allocations, " +
+                std::to_string(stats.blockCount) + " blocks + " +
+                std::to_string(stats.dedicatedCount) + " dedicated (" +
+                std::to_string(stats.bytesReserved / (1024 * 1024)) + " MiB reserved, " +
+                std::to_string(static_cast<int>(stats.fragmentation * 100.0f)) +
+                "% fragmented)");
+  }
+
   result.success = true;
   return result;
 }
@@ -0,0 +1,153 @@
+#include "lib/gfx/block_allocator.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace w3d::gfx {
+
+namespace {
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+  return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+} // namespace
+
+BlockAllocator::BlockAllocator(uint64_t size, uint64_t granularity)
+    : size_(size), granularity_(std::max<uint64_t>(granularity, 1)) {
+  regions_.push_back({0, size, false, AllocationKind::Linear});
+}
+
+bool BlockAllocator::onSamePage(uint64_t endOffset, uint64_t startOffset) const {
+  // endOffset is one past the last byte of the earlier resource
+  return (endOffset - 1) / granularity_ == startOffset / granularity_;
+}
+
+std::optional<uint64_t> BlockAllocator::allocate(uint64_t size, uint64_t alignment,
+                                                 AllocationKind kind) {
+  if (size == 0) {
+    return std::nullopt;
+  }
+
+  size_t bestIndex = regions_.size();
+  uint64_t bestOffset = 0;
+  uint64_t bestWaste = std::numeric_limits<uint64_t>::max();
+
+  for (size_t i = 0; i < regions_.size(); ++i) {
+    const Region &region = regions_[i];
+    if (region.allocated || region.size < size) {
+      continue;
+    }
+
+    uint64_t offset = alignUp(region.offset, alignment);
+
+    // Keep off the previous resource's page if it is of the other kind
+    if (i > 0 && regions_[i - 1].allocated && regions_[i - 1].kind != kind &&
+        onSamePage(region.offset, offset)) {
+      offset = alignUp(offset, granularity_);
+    }
+
+    uint64_t end = offset + size;
+    uint64_t regionEnd = region.offset + region.size;
+
+    // Likewise the next resource must not start on the page this one ends on
+    uint64_t requiredEnd = end;
+    if (i + 1 < regions_.size() && regions_[i + 1].allocated && regions_[i + 1].kind != kind &&
+        onSamePage(end, regionEnd)) {
+      requiredEnd = alignUp(end, granularity_);
+    }
+
+    if (requiredEnd > regionEnd) {
+      continue;
+    }
+
+    uint64_t waste = region.size - size;
+    if (waste < bestWaste) {
+      bestWaste = waste;
+      bestIndex = i;
+      bestOffset = offset;
+      if (waste == 0) {
+        break;
+      }
+    }
+  }
+
+  if (bestIndex == regions_.size()) {
+    return std::nullopt;
+  }
+
+  Region region = regions_[bestIndex];
+  uint64_t end = bestOffset + size;
+  uint64_t regionEnd = region.offset + region.size;
+
+  // Split into [padding][allocation][tail], dropping empty pieces
+  std::vector<Region> pieces;
+  if (bestOffset > region.offset) {
+    pieces.push_back({region.offset, bestOffset - region.offset, false, AllocationKind::Linear});
+  }
+  pieces.push_back({bestOffset, size, true, kind});
+  if (regionEnd > end) {
+    pieces.push_back({end, regionEnd - end, false, AllocationKind::Linear});
+  }
+
+  regions_.erase(regions_.begin() + static_cast<std::ptrdiff_t>(bestIndex));
+  regions_.insert(regions_.begin() + static_cast<std::ptrdiff_t>(bestIndex), pieces.begin(),
+                  pieces.end());
+
+  bytesUsed_ += size;
+  ++allocationCount_;
+  return bestOffset;
+}
+
+void BlockAllocator::free(uint64_t offset) {
+  auto it = std::lower_bound(regions_.begin(), regions_.end(), offset,
+                             [](const Region &r, uint64_t value) { return r.offset < value; });
+  if (it == regions_.end() || it->offset != offset || !it->allocated) {
+    return;
+  }
+
+  bytesUsed_ -= it->size;
+  --allocationCount_;
+  it->allocated = false;
+
+  // Merge with the following free region
+  auto next = it + 1;
+  if (next != regions_.end() && !next->allocated) {
+    it->size += next->size;
+    regions_.erase(next);
+  }
+
+  // Merge with the preceding free region
+  if (it != regions_.begin()) {
+    auto prev = it - 1;
+    if (!prev->allocated) {
+      prev->size += it->size;
+      regions_.erase(it);
+    }
+  }
+}
+
+uint64_t BlockAllocator::largestFreeRegion() const {
+  uint64_t largest = 0;
+  for (const auto &region : regions_) {
+    if (!region.allocated) {
+      largest = std::max(largest, region.size);
+    }
+  }
+  return largest;
+}
+
+size_t BlockAllocator::freeRegionCount() const {
+  return static_cast<size_t>(std::count_if(regions_.begin(), regions_.end(),
+                                           [](const Region &r) { return !r.allocated; }));
+}
+
+float BlockAllocator::fragmentation() const {
+  uint64_t freeBytes = bytesFree();
+  if (freeBytes == 0) {
+    return 0.0f;
+  }
+  return 1.0f - static_cast<float>(largestFreeRegion()) / static_cast<float>(freeBytes);
+}
+
+} // namespace w3d::gfx
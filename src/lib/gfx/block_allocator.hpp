@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace w3d::gfx {
+
+// Resource class of a sub-allocation, used to honor bufferImageGranularity.
+// Linear resources (buffers, linear images) and optimal-tiling images may not share a
+// granularity-sized page of the same memory block.
+enum class AllocationKind : uint8_t { Linear, Optimal };
+
+// Placement logic for one device memory block, independent of Vulkan so it can be unit tested.
+// The block is tracked as an offset-sorted list of regions (allocated or free) that always
+// covers the whole block; adjacent free regions are merged on release. Placement is best-fit.
+class BlockAllocator {
+public:
+  BlockAllocator(uint64_t size, uint64_t granularity = 1);
+
+  // Returns the offset of the new allocation, or nullopt if it doesn't fit
+  std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment, AllocationKind kind);
+
+  // Release the allocation starting at offset (no-op for unknown offsets)
+  void free(uint64_t offset);
+
+  uint64_t size() const { return size_; }
+  uint64_t granularity() const { return granularity_; }
+  uint64_t bytesUsed() const { return bytesUsed_; }
+  uint64_t bytesFree() const { return size_ - bytesUsed_; }
+  uint64_t largestFreeRegion() const;
+  size_t allocationCount() const { return allocationCount_; }
+  size_t freeRegionCount() const;
+  bool empty() const { return allocationCount_ == 0; }
+
+  // 0 when all free space is contiguous, approaching 1 as it splinters
+  float fragmentation() const;
+
+private:
+  struct Region {
+    uint64_t offset;
+    uint64_t size;
+    bool allocated;
+    AllocationKind kind;
+  };
+
+  // Page-sharing check between a resource ending at endOffset and one starting at startOffset
+  bool onSamePage(uint64_t endOffset, uint64_t startOffset) const;
+
+  uint64_t size_;
+  uint64_t granularity_;
+  uint64_t bytesUsed_ = 0;
+  size_t allocationCount_ = 0;
+  std::vector<Region> regions_;
+};
+
+} // namespace w3d::gfx
@@ -1,6 +1,9 @@
 #include "lib/gfx/buffer.hpp"
 #include "lib/gfx/vulkan_context.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 namespace w3d::gfx {
 
@@ -9,28 +12,28 @@ Buffer::~Buffer() {
 }
 
 Buffer::Buffer(Buffer &&other) noexcept
-    : device_(other.device_), buffer_(other.buffer_), memory_(other.memory_), size_(other.size_),
-      mappedData_(other.mappedData_) {
+    : device_(other.device_), allocator_(other.allocator_), buffer_(other.buffer_),
+      allocation_(other.allocation_), size_(other.size_) {
   other.device_ = nullptr;
+  other.allocator_ = nullptr;
   other.buffer_ = nullptr;
-  other.memory_ = nullptr;
+  other.allocation_ = {};
   other.size_ = 0;
-  other.mappedData_ = nullptr;
 }
 
 Buffer &Buffer::operator=(Buffer &&other) noexcept {
   if (this != &other) {
     destroy();
     device_ = other.device_;
+    allocator_ = other.allocator_;
     buffer_ = other.buffer_;
-    memory_ = other.memory_;
+    allocation_ = other.allocation_;
     size_ = other.size_;
-    mappedData_ = other.mappedData_;
     other.device_ = nullptr;
+    other.allocator_ = nullptr;
     other.buffer_ = nullptr;
-    other.memory_ = nullptr;
+    other.allocation_ = {};
     other.size_ = 0;
-    other.mappedData_ = nullptr;
   }
   return *this;
 }
@@ -38,76 +41,54 @@ Buffer &Buffer::operator=(Buffer &&other) noexcept {
 void Buffer::create(VulkanContext &context, vk::DeviceSize size, vk::BufferUsageFlags usage,
                     vk::MemoryPropertyFlags properties) {
   device_ = context.device();
+  allocator_ = &context.allocator();
   size_ = size;
 
   vk::BufferCreateInfo bufferInfo{{}, size, usage, vk::SharingMode::eExclusive};
 
-  buffer_ = device_.createBuffer(bufferInfo);
-
-  auto memRequirements = device_.getBufferMemoryRequirements(buffer_);
-
-  vk::MemoryAllocateInfo allocInfo{
-      memRequirements.size, context.findMemoryType(memRequirements.memoryTypeBits, properties)};
+  // Upload targets are written on the transfer queue and read on the graphics queue
+  const auto &sharingFamilies = context.uploadSharingFamilies();
+  if ((usage & vk::BufferUsageFlagBits::eTransferDst) && !sharingFamilies.empty()) {
+    bufferInfo.sharingMode = vk::SharingMode::eConcurrent;
+    bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingFamilies.size());
+    bufferInfo.pQueueFamilyIndices = sharingFamilies.data();
+  }
 
-  memory_ = device_.allocateMemory(allocInfo);
-  device_.bindBufferMemory(buffer_, memory_, 0);
+  buffer_ = device_.createBuffer(bufferInfo);
+  allocation_ = allocator_->allocateForBuffer(buffer_, properties);
 }
 
 void Buffer::destroy() {
   if (device_) {
-    if (mappedData_) {
-      unmap();
-    }
     if (buffer_) {
       device_.destroyBuffer(buffer_);
       buffer_ = nullptr;
     }
-    if (memory_) {
-      device_.freeMemory(memory_);
-      memory_ = nullptr;
-    }
+    allocator_->free(allocation_);
+    allocator_ = nullptr;
     device_ = nullptr;
+    size_ = 0;
   }
 }
 
 void *Buffer::map() {
-  if (!mappedData_) {
-    mappedData_ = device_.mapMemory(memory_, 0, size_);
-  }
-  return mappedData_;
-}
-
-void Buffer::unmap() {
-  if (mappedData_) {
-    device_.unmapMemory(memory_);
-    mappedData_ = nullptr;
+  if (!allocation_.mapped) {
+    throw std::runtime_error("Buffer memory is not host visible");
   }
+  return allocation_.mapped;
 }
 
 void Buffer::upload(const void *data, vk::DeviceSize size) {
-  void *mapped = map();
-  std::memcpy(mapped, data, static_cast<size_t>(size));
-  unmap();
+  std::memcpy(map(), data, static_cast<size_t>(size));
 }
 
 void StagedBuffer::create(VulkanContext &context, const void *data, vk::DeviceSize size,
                           vk::BufferUsageFlags usage) {
-  Buffer stagingBuffer;
-  stagingBuffer.create(context, size, vk::BufferUsageFlagBits::eTransferSrc,
-                       vk::MemoryPropertyFlagBits::eHostVisible |
-                           vk::MemoryPropertyFlagBits::eHostCoherent);
-
-  stagingBuffer.upload(data, size);
-
   buffer_.create(context, size, usage | vk::BufferUsageFlagBits::eTransferDst,
                  vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-  auto cmd = context.beginSingleTimeCommands();
-
-  vk::BufferCopy copyRegion{0, 0, size};
-  cmd.copyBuffer(stagingBuffer.buffer(), buffer_.buffer(), copyRegion);
-
-  context.endSingleTimeCommands(cmd);
+  // Joins the current upload batch, or submits right away outside of one
+  context.uploader().uploadBuffer(buffer_.buffer(), data, size);
 }
 
 void StagedBuffer::destroy() {
@@ -115,8 +96,17 @@ void StagedBuffer::destroy() {
 }
 
 void IndexBuffer::create(VulkanContext &context, const std::vector<uint32_t> &indices) {
-  stagedBuffer_.create(context, indices.data(), sizeof(uint32_t) * indices.size(),
-                       vk::BufferUsageFlagBits::eIndexBuffer);
+  uint32_t maxIndex = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+  if (maxIndex <= std::numeric_limits<uint16_t>::max()) {
+    std::vector<uint16_t> narrow(indices.begin(), indices.end());
+    stagedBuffer_.create(context, narrow.data(), sizeof(uint16_t) * narrow.size(),
+                         vk::BufferUsageFlagBits::eIndexBuffer);
+    indexType_ = vk::IndexType::eUint16;
+  } else {
+    stagedBuffer_.create(context, indices.data(), sizeof(uint32_t) * indices.size(),
+                         vk::BufferUsageFlagBits::eIndexBuffer);
+    indexType_ = vk::IndexType::eUint32;
+  }
   indexCount_ = static_cast<uint32_t>(indices.size());
 }
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "lib/gfx/memory_allocator.hpp"
+#include "lib/gfx/vertex_format.hpp"
+
 #include <vulkan/vulkan.hpp>
 
 #include <GLFW/glfw3.h>
@@ -28,20 +31,20 @@ public:
 
   void destroy();
 
+  // Host-visible memory is persistently mapped by the allocator; map() returns that pointer
   void *map();
-  void unmap();
   void upload(const void *data, vk::DeviceSize size);
 
   vk::Buffer buffer() const { return buffer_; }
-  vk::DeviceMemory memory() const { return memory_; }
+  const MemoryAllocation &allocation() const { return allocation_; }
   vk::DeviceSize size() const { return size_; }
 
 private:
   vk::Device device_;
+  DeviceMemoryAllocator *allocator_ = nullptr;
   vk::Buffer buffer_;
-  vk::DeviceMemory memory_;
+  MemoryAllocation allocation_;
   vk::DeviceSize size_ = 0;
-  void *mappedData_ = nullptr;
 };
 
 class StagedBuffer {
@@ -79,46 +82,53 @@ private:
   uint32_t vertexCount_ = 0;
 };
 
-class IndexBuffer {
+// Vertices uploaded in the byte layout of a VertexFormat (see MeshConverter::encodeVertices)
+class EncodedVertexBuffer {
 public:
-  void create(VulkanContext &context, const std::vector<uint32_t> &indices);
-  void destroy() { stagedBuffer_.destroy(); }
+  void create(VulkanContext &context, const EncodedVertices &vertices) {
+    stagedBuffer_.create(context, vertices.data.data(), vertices.data.size(),
+                         vk::BufferUsageFlagBits::eVertexBuffer);
+    vertexCount_ = vertices.count;
+    encoding_ = vertices.encoding;
+  }
+
+  void destroy() {
+    stagedBuffer_.destroy();
+    vertexCount_ = 0;
+    encoding_ = {};
+  }
 
   vk::Buffer buffer() const { return stagedBuffer_.buffer(); }
-  uint32_t indexCount() const { return indexCount_; }
+  vk::DeviceSize size() const { return stagedBuffer_.size(); }
+  uint32_t vertexCount() const { return vertexCount_; }
+  const VertexEncoding &encoding() const { return encoding_; }
 
 private:
   StagedBuffer stagedBuffer_;
-  uint32_t indexCount_ = 0;
+  uint32_t vertexCount_ = 0;
+  VertexEncoding encoding_;
 };
 
-template <typename T>
-class UniformBuffer {
+// Indices are uploaded as 16-bit when every one of them fits, halving the buffer and the
+// index fetch bandwidth. Bind with indexType().
+class IndexBuffer {
 public:
-  void create(VulkanContext &context, uint32_t frameCount) {
-    buffers_.resize(frameCount);
-    for (auto &buffer : buffers_) {
-      buffer.create(context, sizeof(T), vk::BufferUsageFlagBits::eUniformBuffer,
-                    vk::MemoryPropertyFlagBits::eHostVisible |
-                        vk::MemoryPropertyFlagBits::eHostCoherent);
-    }
-  }
-
+  void create(VulkanContext &context, const std::vector<uint32_t> &indices);
   void destroy() {
-    for (auto &buffer : buffers_) {
-      buffer.destroy();
-    }
-    buffers_.clear();
+    stagedBuffer_.destroy();
+    indexCount_ = 0;
+    indexType_ = vk::IndexType::eUint32;
   }
 
-  void update(uint32_t frameIndex, const T &data) { buffers_[frameIndex].upload(&data, sizeof(T)); }
-
-  vk::Buffer buffer(uint32_t frameIndex) const { return buffers_[frameIndex].buffer(); }
-
-  size_t frameCount() const { return buffers_.size(); }
+  vk::Buffer buffer() const { return stagedBuffer_.buffer(); }
+  vk::DeviceSize size() const { return stagedBuffer_.size(); }
+  uint32_t indexCount() const { return indexCount_; }
+  vk::IndexType indexType() const { return indexType_; }
 
 private:
-  std::vector<Buffer> buffers_;
+  StagedBuffer stagedBuffer_;
+  uint32_t indexCount_ = 0;
+  vk::IndexType indexType_ = vk::IndexType::eUint32;
 };
 
 } // namespace w3d::gfx
@@ -0,0 +1,163 @@
+#include "lib/gfx/gpu_profiler.hpp"
+
+#include "lib/gfx/vulkan_context.hpp"
+
+namespace w3d::gfx {
+
+namespace {
+
+constexpr vk::QueryPipelineStatisticFlags STATISTICS =
+    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+
+} // namespace
+
+GpuProfiler::~GpuProfiler() {
+  destroy();
+}
+
+void GpuProfiler::init(VulkanContext &context, uint32_t framesInFlight,
+                       const std::vector<std::string> &scopeNames) {
+  destroy();
+  device_ = context.device();
+  timestampPeriod_ = context.timestampPeriod();
+  timestampValidBits_ = context.timestampValidBits();
+
+  scopes_.clear();
+  for (const auto &name : scopeNames) {
+    scopes_.push_back(Scope{name, std::nullopt, RollingTiming{}, PipelineCounts{}});
+  }
+  pending_.assign(framesInFlight, false);
+
+  auto scopeCount = static_cast<uint32_t>(scopes_.size());
+  if (timestampPeriod_ <= 0.0f || scopeCount == 0) {
+    return;
+  }
+
+  vk::QueryPoolCreateInfo timestampInfo{{}, vk::QueryType::eTimestamp,
+                                        framesInFlight * scopeCount * 2};
+  timestampPool_ = device_.createQueryPool(timestampInfo);
+
+  if (context.pipelineStatisticsQuery()) {
+    vk::QueryPoolCreateInfo statisticsInfo{{}, vk::QueryType::ePipelineStatistics,
+                                           framesInFlight * scopeCount * MAX_PARTS, STATISTICS};
+    statisticsPool_ = device_.createQueryPool(statisticsInfo);
+  }
+}
+
+void GpuProfiler::destroy() {
+  if (timestampPool_) {
+    device_.destroyQueryPool(timestampPool_);
+    timestampPool_ = nullptr;
+  }
+  if (statisticsPool_) {
+    device_.destroyQueryPool(statisticsPool_);
+    statisticsPool_ = nullptr;
+  }
+  pending_.assign(pending_.size(), false);
+}
+
+uint32_t GpuProfiler::timestampQuery(uint32_t frame, uint32_t scope) const {
+  return (frame * static_cast<uint32_t>(scopes_.size()) + scope) * 2;
+}
+
+uint32_t GpuProfiler::statisticsQuery(uint32_t frame, uint32_t scope, uint32_t part) const {
+  return (frame * static_cast<uint32_t>(scopes_.size()) + scope) * MAX_PARTS + part;
+}
+
+void GpuProfiler::collect(uint32_t frame) {
+  for (auto &scope : scopes_) {
+    scope.lastMs.reset();
+  }
+  if (!timestampPool_ || !pending_[frame]) {
+    return;
+  }
+  pending_[frame] = false;
+  auto scopeCount = static_cast<uint32_t>(scopes_.size());
+
+  // Scopes the frame did not record stay unavailable; with availability words the others are
+  // still returned (eNotReady rather than an error)
+  constexpr vk::QueryResultFlags flags =
+      vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability;
+  auto timestamps = device_.getQueryPoolResults<uint64_t>(
+      timestampPool_, timestampQuery(frame, 0), scopeCount * 2,
+      scopeCount * 2 * 2 * sizeof(uint64_t), 2 * sizeof(uint64_t), flags);
+  for (uint32_t i = 0; i < scopeCount; ++i) {
+    const uint64_t *begin = &timestamps.value[i * 4];
+    const uint64_t *end = begin + 2;
+    if (begin[1] == 0 || end[1] == 0) {
+      continue;
+    }
+    double ms = timestampDeltaMs(begin[0], end[0], timestampValidBits_, timestampPeriod_);
+    scopes_[i].lastMs = ms;
+    scopes_[i].history.push(static_cast<float>(ms));
+  }
+
+  if (!statisticsPool_) {
+    return;
+  }
+
+  // Vertex invocations, fragment invocations, availability per query
+  constexpr size_t STRIDE = 3;
+  auto statistics = device_.getQueryPoolResults<uint64_t>(
+      statisticsPool_, statisticsQuery(frame, 0, 0), scopeCount * MAX_PARTS,
+      scopeCount * MAX_PARTS * STRIDE * sizeof(uint64_t), STRIDE * sizeof(uint64_t), flags);
+  for (uint32_t i = 0; i < scopeCount; ++i) {
+    PipelineCounts counts;
+    bool any = false;
+    for (uint32_t part = 0; part < MAX_PARTS; ++part) {
+      const uint64_t *result = &statistics.value[(i * MAX_PARTS + part) * STRIDE];
+      if (result[2] == 0) {
+        continue;
+      }
+      counts.vertexInvocations += result[0];
+      counts.fragmentInvocations += result[1];
+      any = true;
+    }
+    if (any) {
+      scopes_[i].counts = counts;
+    }
+  }
+}
+
+void GpuProfiler::reset(vk::CommandBuffer cmd, uint32_t frame) {
+  if (!timestampPool_) {
+    return;
+  }
+  auto scopeCount = static_cast<uint32_t>(scopes_.size());
+  cmd.resetQueryPool(timestampPool_, timestampQuery(frame, 0), scopeCount * 2);
+  if (statisticsPool_) {
+    cmd.resetQueryPool(statisticsPool_, statisticsQuery(frame, 0, 0), scopeCount * MAX_PARTS);
+  }
+  pending_[frame] = true;
+}
+
+void GpuProfiler::beginScope(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope) const {
+  if (timestampPool_) {
+    cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, timestampPool_,
+                       timestampQuery(frame, scope));
+  }
+}
+
+void GpuProfiler::endScope(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope) const {
+  if (timestampPool_) {
+    cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, timestampPool_,
+                       timestampQuery(frame, scope) + 1);
+  }
+}
+
+void GpuProfiler::beginStatistics(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope,
+                                  uint32_t part) const {
+  if (statisticsPool_ && part < MAX_PARTS) {
+    cmd.beginQuery(statisticsPool_, statisticsQuery(frame, scope, part), {});
+  }
+}
+
+void GpuProfiler::endStatistics(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope,
+                                uint32_t part) const {
+  if (statisticsPool_ && part < MAX_PARTS) {
+    cmd.endQuery(statisticsPool_, statisticsQuery(frame, scope, part));
+  }
+}
+
+} // namespace w3d::gfx
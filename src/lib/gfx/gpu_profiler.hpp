@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "lib/gfx/gpu_timing.hpp"
+
+namespace w3d::gfx {
+
+class VulkanContext;
+
+// Shader invocations counted by a pipeline statistics query
+struct PipelineCounts {
+  uint64_t vertexInvocations = 0;
+  uint64_t fragmentInvocations = 0;
+};
+
+// GPU time of named scopes (passes) of each frame, from a pair of timestamps per scope, with
+// optional pipeline statistics. Every frame in flight has its own queries. A slot's results
+// are read when the slot comes round again, after its fence has signaled, so reading never
+// waits on the GPU.
+//
+// A scope's statistics may be split into up to MAX_PARTS queries (one per secondary command
+// buffer the pass is recorded into, since a query cannot span command buffers); the parts
+// are summed.
+class GpuProfiler {
+public:
+  static constexpr uint32_t MAX_PARTS = 8;
+
+  struct Scope {
+    std::string name;
+    std::optional<double> lastMs; // Of the frame read by the latest collect(), if recorded
+    RollingTiming history;        // Recent frames that recorded the scope
+    PipelineCounts counts;        // Of the latest frame with statistics for the scope
+  };
+
+  GpuProfiler() = default;
+  ~GpuProfiler();
+
+  GpuProfiler(const GpuProfiler &) = delete;
+  GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+  // No queries are created when the device has no graphics timestamps; statistics queries
+  // only when the device supports them
+  void init(VulkanContext &context, uint32_t framesInFlight,
+            const std::vector<std::string> &scopeNames);
+  void destroy();
+
+  bool hasTimestamps() const { return static_cast<bool>(timestampPool_); }
+  bool hasPipelineStatistics() const { return static_cast<bool>(statisticsPool_); }
+
+  // Read the results the frame slot's queries received when it last ran. Call once the
+  // slot's fence has signaled.
+  void collect(uint32_t frame);
+
+  // Reset the frame slot's queries before any scope of the frame is recorded. Must be
+  // recorded outside a render pass.
+  void reset(vk::CommandBuffer cmd, uint32_t frame);
+
+  void beginScope(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope) const;
+  void endScope(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope) const;
+
+  // Count the scope's vertex and fragment invocations between the two calls, which must be in
+  // the same command buffer. No-op without statistics.
+  void beginStatistics(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope,
+                       uint32_t part = 0) const;
+  void endStatistics(vk::CommandBuffer cmd, uint32_t frame, uint32_t scope,
+                     uint32_t part = 0) const;
+
+  const std::vector<Scope> &scopes() const { return scopes_; }
+
+private:
+  uint32_t timestampQuery(uint32_t frame, uint32_t scope) const;
+  uint32_t statisticsQuery(uint32_t frame, uint32_t scope, uint32_t part) const;
+
+  vk::Device device_;
+  float timestampPeriod_ = 0.0f;
+  uint32_t timestampValidBits_ = 64;
+  vk::QueryPool timestampPool_;  // Two per scope and frame
+  vk::QueryPool statisticsPool_; // MAX_PARTS per scope and frame
+  std::vector<Scope> scopes_;
+  std::vector<bool> pending_; // Slot reset and submitted, results not read yet
+};
+
+} // namespace w3d::gfx
@@ -0,0 +1,57 @@
+#include "lib/gfx/gpu_timing.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace w3d::gfx {
+
+double timestampDeltaMs(uint64_t begin, uint64_t end, uint32_t validBits, float periodNs) {
+  uint64_t mask = validBits >= 64 ? ~uint64_t{0} : (uint64_t{1} << validBits) - 1;
+  uint64_t ticks = ((end & mask) - (begin & mask)) & mask;
+  return static_cast<double>(ticks) * static_cast<double>(periodNs) * 1e-6;
+}
+
+RollingTiming::RollingTiming(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+  samples_.reserve(capacity_);
+}
+
+void RollingTiming::push(float ms) {
+  if (samples_.size() < capacity_) {
+    samples_.push_back(ms);
+    return;
+  }
+  samples_[next_] = ms;
+  next_ = (next_ + 1) % capacity_;
+}
+
+void RollingTiming::clear() {
+  samples_.clear();
+  next_ = 0;
+}
+
+float RollingTiming::latest() const {
+  if (samples_.empty()) {
+    return 0.0f;
+  }
+  if (samples_.size() < capacity_) {
+    return samples_.back();
+  }
+  return samples_[(next_ + capacity_ - 1) % capacity_];
+}
+
+float RollingTiming::mean() const {
+  if (samples_.empty()) {
+    return 0.0f;
+  }
+  return std::accumulate(samples_.begin(), samples_.end(), 0.0f) /
+         static_cast<float>(samples_.size());
+}
+
+float RollingTiming::max() const {
+  if (samples_.empty()) {
+    return 0.0f;
+  }
+  return *std::max_element(samples_.begin(), samples_.end());
+}
+
+} // namespace w3d::gfx
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace w3d::gfx {
+
+// Milliseconds from one GPU timestamp to a later one. Only the low validBits bits of a
+// timestamp count and the counter wraps above them, so an end below its begin is a wrap.
+double timestampDeltaMs(uint64_t begin, uint64_t end, uint32_t validBits, float periodNs);
+
+// The most recent samples of a GPU time (ms), oldest overwritten first
+class RollingTiming {
+public:
+  explicit RollingTiming(size_t capacity = 120);
+
+  void push(float ms);
+  void clear();
+
+  size_t size() const { return samples_.size(); }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return samples_.empty(); }
+
+  float latest() const;
+  float mean() const;
+  float max() const;
+
+  // Samples in storage order and the index of the oldest, as ImGui::PlotLines takes them
+  const float *data() const { return samples_.data(); }
+  size_t offset() const { return samples_.size() < capacity_ ? 0 : next_; }
+
+private:
+  size_t capacity_;
+  size_t next_ = 0; // Slot the next sample goes to once the window is full
+  std::vector<float> samples_;
+};
+
+} // namespace w3d::gfx
@@ -0,0 +1,201 @@
+#include "lib/gfx/memory_allocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace w3d::gfx {
+
+struct MemoryBlock {
+  MemoryBlock(vk::DeviceMemory mem, uint32_t type, void *ptr, vk::DeviceSize size,
+              vk::DeviceSize granularity)
+      : memory(mem), memoryType(type), mapped(ptr), allocator(size, granularity) {}
+
+  vk::DeviceMemory memory;
+  uint32_t memoryType;
+  void *mapped;
+  BlockAllocator allocator;
+};
+
+namespace {
+
+constexpr vk::DeviceSize SMALL_HEAP_THRESHOLD = 1024ull * 1024 * 1024;
+
+void *offsetPointer(void *base, vk::DeviceSize offset) {
+  return base ? static_cast<uint8_t *>(base) + offset : nullptr;
+}
+
+} // namespace
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator() {
+  destroy();
+}
+
+void DeviceMemoryAllocator::init(vk::PhysicalDevice physicalDevice, vk::Device device) {
+  device_ = device;
+  memoryProperties_ = physicalDevice.getMemoryProperties();
+  granularity_ = physicalDevice.getProperties().limits.bufferImageGranularity;
+}
+
+void DeviceMemoryAllocator::destroy() {
+  if (device_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &block : blocks_) {
+      device_.freeMemory(block->memory);
+    }
+    blocks_.clear();
+    dedicatedCount_ = 0;
+    dedicatedBytes_ = 0;
+    device_ = nullptr;
+  }
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocateForBuffer(vk::Buffer buffer,
+                                                          vk::MemoryPropertyFlags properties) {
+  auto requirements = device_.getBufferMemoryRequirements(buffer);
+  MemoryAllocation allocation = allocate(requirements, properties, AllocationKind::Linear);
+  device_.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+  return allocation;
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocateForImage(vk::Image image,
+                                                         vk::MemoryPropertyFlags properties) {
+  // All images in the viewer use optimal tiling
+  auto requirements = device_.getImageMemoryRequirements(image);
+  MemoryAllocation allocation = allocate(requirements, properties, AllocationKind::Optimal);
+  device_.bindImageMemory(image, allocation.memory, allocation.offset);
+  return allocation;
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocate(const vk::MemoryRequirements &requirements,
+                                                 vk::MemoryPropertyFlags properties,
+                                                 AllocationKind kind) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+  vk::DeviceSize blockSize = blockSizeFor(memoryType);
+
+  if (requirements.size > blockSize / 2) {
+    return allocateDedicated(requirements.size, memoryType);
+  }
+
+  auto place = [&](MemoryBlock &block) -> MemoryAllocation {
+    auto offset = block.allocator.allocate(requirements.size, requirements.alignment, kind);
+    if (!offset) {
+      return {};
+    }
+    return {block.memory, *offset, requirements.size, offsetPointer(block.mapped, *offset),
+            &block};
+  };
+
+  for (auto &block : blocks_) {
+    if (block->memoryType == memoryType) {
+      if (MemoryAllocation allocation = place(*block)) {
+        return allocation;
+      }
+    }
+  }
+
+  // No room in existing blocks: grow the pool
+  vk::MemoryAllocateInfo allocInfo{blockSize, memoryType};
+  vk::DeviceMemory memory = device_.allocateMemory(allocInfo);
+  void *mapped = isHostVisible(memoryType) ? device_.mapMemory(memory, 0, blockSize) : nullptr;
+
+  blocks_.push_back(
+      std::make_unique<MemoryBlock>(memory, memoryType, mapped, blockSize, granularity_));
+  return place(*blocks_.back());
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocateDedicated(vk::DeviceSize size,
+                                                          uint32_t memoryType) {
+  vk::MemoryAllocateInfo allocInfo{size, memoryType};
+  vk::DeviceMemory memory = device_.allocateMemory(allocInfo);
+  void *mapped = isHostVisible(memoryType) ? device_.mapMemory(memory, 0, size) : nullptr;
+
+  ++dedicatedCount_;
+  dedicatedBytes_ += size;
+  return {memory, 0, size, mapped, nullptr};
+}
+
+void DeviceMemoryAllocator::free(MemoryAllocation &allocation) {
+  if (!allocation || !device_) {
+    allocation = {};
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!allocation.block) {
+    device_.freeMemory(allocation.memory);
+    --dedicatedCount_;
+    dedicatedBytes_ -= allocation.size;
+    allocation = {};
+    return;
+  }
+
+  MemoryBlock *block = allocation.block;
+  block->allocator.free(allocation.offset);
+  allocation = {};
+
+  if (!block->allocator.empty()) {
+    return;
+  }
+
+  // Keep one empty block per memory type around so load/unload cycles don't thrash the driver
+  bool hasSibling = std::any_of(blocks_.begin(), blocks_.end(), [&](const auto &other) {
+    return other.get() != block && other->memoryType == block->memoryType;
+  });
+  if (hasSibling) {
+    device_.freeMemory(block->memory);
+    blocks_.erase(std::find_if(blocks_.begin(), blocks_.end(),
+                               [&](const auto &other) { return other.get() == block; }));
+  }
+}
+
+MemoryStats DeviceMemoryAllocator::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  MemoryStats result;
+  result.blockCount = blocks_.size();
+  result.dedicatedCount = dedicatedCount_;
+  result.allocationCount = dedicatedCount_;
+  result.bytesReserved = dedicatedBytes_;
+  result.bytesUsed = dedicatedBytes_;
+
+  for (const auto &block : blocks_) {
+    result.allocationCount += block->allocator.allocationCount();
+    result.bytesReserved += block->allocator.size();
+    result.bytesUsed += block->allocator.bytesUsed();
+    result.fragmentation = std::max(result.fragmentation, block->allocator.fragmentation());
+  }
+  return result;
+}
+
+uint32_t DeviceMemoryAllocator::findMemoryType(uint32_t typeFilter,
+                                               vk::MemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < memoryProperties_.memoryTypeCount; i++) {
+    if ((typeFilter & (1 << i)) &&
+        (memoryProperties_.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+  throw std::runtime_error("Failed to find suitable memory type");
+}
+
+vk::DeviceSize DeviceMemoryAllocator::blockSizeFor(uint32_t memoryType) const {
+  uint32_t heapIndex = memoryProperties_.memoryTypes[memoryType].heapIndex;
+  vk::DeviceSize heapSize = memoryProperties_.memoryHeaps[heapIndex].size;
+
+  // Small heaps (e.g. the 256 MiB host-visible device-local window) get proportionally
+  // smaller blocks so a single block can't claim most of the heap
+  if (heapSize <= SMALL_HEAP_THRESHOLD) {
+    return std::min(DEFAULT_BLOCK_SIZE, heapSize / 8);
+  }
+  return DEFAULT_BLOCK_SIZE;
+}
+
+bool DeviceMemoryAllocator::isHostVisible(uint32_t memoryType) const {
+  return static_cast<bool>(memoryProperties_.memoryTypes[memoryType].propertyFlags &
+                           vk::MemoryPropertyFlagBits::eHostVisible);
+}
+
+} // namespace w3d::gfx
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "lib/gfx/block_allocator.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace w3d::gfx {
+
+struct MemoryBlock;
+
+// A range of device memory handed out by DeviceMemoryAllocator.
+// Host-visible allocations are persistently mapped; mapped points at offset within the block.
+struct MemoryAllocation {
+  vk::DeviceMemory memory;
+  vk::DeviceSize offset = 0;
+  vk::DeviceSize size = 0;
+  void *mapped = nullptr;
+  MemoryBlock *block = nullptr; // nullptr for dedicated allocations
+
+  explicit operator bool() const { return static_cast<bool>(memory); }
+};
+
+// Snapshot of allocator usage, summed over all memory types
+struct MemoryStats {
+  size_t blockCount = 0;            // Pooled blocks currently held
+  size_t dedicatedCount = 0;        // Allocations that got their own vkDeviceMemory
+  size_t allocationCount = 0;       // Live sub-allocations plus dedicated allocations
+  vk::DeviceSize bytesReserved = 0; // Device memory obtained from the driver
+  vk::DeviceSize bytesUsed = 0;     // Bytes handed out to resources
+  float fragmentation = 0.0f;       // Worst block fragmentation (see BlockAllocator)
+};
+
+// Pooled device memory sub-allocator.
+// Each memory type gets a list of large blocks that resources are placed into with
+// BlockAllocator, so loading a model costs a handful of vkAllocateMemory calls instead of one
+// per buffer and texture. Requests larger than half a block get a dedicated allocation.
+class DeviceMemoryAllocator {
+public:
+  static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+  DeviceMemoryAllocator() = default;
+  ~DeviceMemoryAllocator();
+
+  DeviceMemoryAllocator(const DeviceMemoryAllocator &) = delete;
+  DeviceMemoryAllocator &operator=(const DeviceMemoryAllocator &) = delete;
+
+  void init(vk::PhysicalDevice physicalDevice, vk::Device device);
+  void destroy();
+
+  // Allocate memory for a resource and bind it
+  MemoryAllocation allocateForBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties);
+  MemoryAllocation allocateForImage(vk::Image image, vk::MemoryPropertyFlags properties);
+
+  // Return memory to its block (or the driver for dedicated allocations) and reset allocation
+  void free(MemoryAllocation &allocation);
+
+  MemoryStats stats() const;
+
+private:
+  MemoryAllocation allocate(const vk::MemoryRequirements &requirements,
+                            vk::MemoryPropertyFlags properties, AllocationKind kind);
+  MemoryAllocation allocateDedicated(vk::DeviceSize size, uint32_t memoryType);
+  uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const;
+  vk::DeviceSize blockSizeFor(uint32_t memoryType) const;
+  bool isHostVisible(uint32_t memoryType) const;
+
+  vk::Device device_;
+  vk::PhysicalDeviceMemoryProperties memoryProperties_;
+  vk::DeviceSize granularity_ = 1;
+
+  std::vector<std::unique_ptr<MemoryBlock>> blocks_;
+  size_t dedicatedCount_ = 0;
+  vk::DeviceSize dedicatedBytes_ = 0;
+
+  mutable std::mutex mutex_;
+};
+
+} // namespace w3d::gfx
@@ -2,149 +2,88 @@
 
 #include "lib/gfx/vulkan_context.hpp"
 
+#include <cstddef>
 #include <filesystem>
 #include <stdexcept>
+#include <string>
 
 #include "core/shader_loader.hpp"
 
 namespace w3d::gfx {
 
-Pipeline::~Pipeline() {
-  destroy();
-}
-
-void Pipeline::create(VulkanContext &context, const std::string &vertShaderPath,
-                      const std::string &fragShaderPath) {
-  createWithTexture(context, vertShaderPath, fragShaderPath, {});
+namespace {
+
+// Vertex input of a mesh format. The compact formats bind their packed attributes with
+// formats the input assembler expands, so the shaders see the same types as for Full: only
+// the normal (octahedral) and the position of Quantized need decoding in the shader.
+struct VertexInput {
+  vk::VertexInputBindingDescription binding;
+  std::vector<vk::VertexInputAttributeDescription> attributes;
+};
+
+template <typename PackedT>
+VertexInput packedVertexInput(vk::Format positionFormat, bool skinned) {
+  VertexInput input{
+      {0, sizeof(PackedT), vk::VertexInputRate::eVertex},
+      {{0, 0, positionFormat, offsetof(PackedT, position)},
+       {1, 0, vk::Format::eR16G16Snorm, offsetof(PackedT, normal)},
+       {2, 0, vk::Format::eR16G16Sfloat, offsetof(PackedT, texCoord)},
+       {3, 0, vk::Format::eR8G8B8A8Unorm, offsetof(PackedT, color)}}
+  };
+  if (skinned) {
+    // The bone index is the color's alpha byte
+    input.attributes.push_back({4, 0, vk::Format::eR8Uint, offsetof(PackedT, color) + 3});
+  }
+  return input;
 }
 
-void Pipeline::createWithTexture(VulkanContext &context, const std::string &vertShaderPath,
-                                 const std::string &fragShaderPath, const PipelineConfig &config) {
-  device_ = context.device();
-
-  auto vertShaderCode = readFile(vertShaderPath);
-  auto fragShaderCode = readFile(fragShaderPath);
-
-  auto vertShaderModule = createShaderModule(vertShaderCode);
-  auto fragShaderModule = createShaderModule(fragShaderCode);
-
-  vk::PipelineShaderStageCreateInfo vertShaderStageInfo{
-      {}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main"};
-
-  vk::PipelineShaderStageCreateInfo fragShaderStageInfo{
-      {}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main"};
-
-  std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo,
-                                                                   fragShaderStageInfo};
-
-  auto bindingDescription = Vertex::getBindingDescription();
-  auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
-  vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
-      {}, bindingDescription, attributeDescriptions};
-
-  vk::PipelineInputAssemblyStateCreateInfo inputAssembly{
-      {}, vk::PrimitiveTopology::eTriangleList, VK_FALSE};
-
-  std::array<vk::DynamicState, 2> dynamicStates = {vk::DynamicState::eViewport,
-                                                   vk::DynamicState::eScissor};
-
-  vk::PipelineDynamicStateCreateInfo dynamicState{{}, dynamicStates};
-
-  vk::PipelineViewportStateCreateInfo viewportState{{}, 1, nullptr, 1, nullptr};
-
-  vk::PipelineRasterizationStateCreateInfo rasterizer{{},
-                                                      VK_FALSE,
-                                                      VK_FALSE,
-                                                      vk::PolygonMode::eFill,
-                                                      config.twoSided ? vk::CullModeFlagBits::eNone
-                                                                      : vk::CullModeFlagBits::eBack,
-                                                      vk::FrontFace::eCounterClockwise,
-                                                      VK_FALSE,
-                                                      0.0f,
-                                                      0.0f,
-                                                      0.0f,
-                                                      1.0f};
-
-  vk::PipelineMultisampleStateCreateInfo multisampling{{}, vk::SampleCountFlagBits::e1, VK_FALSE};
-
-  vk::PipelineDepthStencilStateCreateInfo depthStencil{
-      {},       VK_TRUE, config.depthWrite ? VK_TRUE : VK_FALSE, vk::CompareOp::eLess,
-      VK_FALSE, VK_FALSE};
-
-  vk::PipelineColorBlendAttachmentState colorBlendAttachment;
-  if (config.enableBlending) {
-    colorBlendAttachment = vk::PipelineColorBlendAttachmentState{
-        VK_TRUE,
-        config.alphaBlend ? vk::BlendFactor::eSrcAlpha : vk::BlendFactor::eOne,
-        config.alphaBlend ? vk::BlendFactor::eOneMinusSrcAlpha : vk::BlendFactor::eOne,
-        vk::BlendOp::eAdd,
-        vk::BlendFactor::eOne,
-        vk::BlendFactor::eZero,
-        vk::BlendOp::eAdd,
-        vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
-            vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
-  } else {
-    colorBlendAttachment = vk::PipelineColorBlendAttachmentState{
-        VK_FALSE,
-        vk::BlendFactor::eOne,
-        vk::BlendFactor::eZero,
-        vk::BlendOp::eAdd,
-        vk::BlendFactor::eOne,
-        vk::BlendFactor::eZero,
-        vk::BlendOp::eAdd,
-        vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
-            vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
+VertexInput vertexInput(VertexFormat format, bool skinned) {
+  switch (format) {
+  case VertexFormat::Compact:
+    return packedVertexInput<CompactVertex>(vk::Format::eR32G32B32Sfloat, skinned);
+  case VertexFormat::Quantized:
+    return packedVertexInput<QuantizedVertex>(vk::Format::eR16G16B16A16Unorm, skinned);
+  default:
+    break;
   }
 
-  vk::PipelineColorBlendStateCreateInfo colorBlending{
-      {}, VK_FALSE, vk::LogicOp::eCopy, colorBlendAttachment};
-
-  std::array<vk::DescriptorSetLayoutBinding, 2> bindings = {
-      vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBuffer,        1,
-                                     vk::ShaderStageFlagBits::eVertex  },
-      vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eCombinedImageSampler, 1,
-                                     vk::ShaderStageFlagBits::eFragment}
-  };
-
-  vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, bindings};
-
-  descriptorSetLayout_ = device_.createDescriptorSetLayout(layoutInfo);
-
-  vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eFragment, 0,
-                                          sizeof(MaterialPushConstant)};
-
-  vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, descriptorSetLayout_, pushConstantRange};
+  if (skinned) {
+    auto attributes = SkinnedVertex::getAttributeDescriptions();
+    return {SkinnedVertex::getBindingDescription(), {attributes.begin(), attributes.end()}};
+  }
+  auto attributes = Vertex::getAttributeDescriptions();
+  return {Vertex::getBindingDescription(), {attributes.begin(), attributes.end()}};
+}
 
-  pipelineLayout_ = device_.createPipelineLayout(pipelineLayoutInfo);
+} // namespace
 
-  vk::GraphicsPipelineCreateInfo pipelineInfo{{},
-                                              shaderStages,
-                                              &vertexInputInfo,
-                                              &inputAssembly,
-                                              nullptr,
-                                              &viewportState,
-                                              &rasterizer,
-                                              &multisampling,
-                                              &depthStencil,
-                                              &colorBlending,
-                                              &dynamicState,
-                                              pipelineLayout_,
-                                              context.renderPass(),
-                                              0};
+Pipeline::~Pipeline() {
+  destroy();
+}
 
-  auto result = device_.createGraphicsPipeline(nullptr, pipelineInfo);
-  if (result.result != vk::Result::eSuccess) {
-    throw std::runtime_error("Failed to create graphics pipeline");
-  }
-  pipeline_ = result.value;
+void Pipeline::create(VulkanContext &context, const std::string &vertShaderPath,
+                      const std::string &fragShaderPath, vk::DescriptorSetLayout textureSetLayout) {
+  createWithTexture(context, vertShaderPath, fragShaderPath, textureSetLayout, {});
+}
 
-  device_.destroyShaderModule(vertShaderModule);
-  device_.destroyShaderModule(fragShaderModule);
+void Pipeline::createWithTexture(VulkanContext &context, const std::string &vertShaderPath,
+                                 const std::string &fragShaderPath,
+                                 vk::DescriptorSetLayout textureSetLayout,
+                                 const PipelineConfig &config) {
+  createMesh(context, vertShaderPath, fragShaderPath, textureSetLayout, config, false);
 }
 
 void Pipeline::createSkinned(VulkanContext &context, const std::string &vertShaderPath,
-                             const std::string &fragShaderPath, const PipelineConfig &config) {
+                             const std::string &fragShaderPath,
+                             vk::DescriptorSetLayout textureSetLayout,
+                             const PipelineConfig &config) {
+  createMesh(context, vertShaderPath, fragShaderPath, textureSetLayout, config, true);
+}
+
+void Pipeline::createMesh(VulkanContext &context, const std::string &vertShaderPath,
+                          const std::string &fragShaderPath,
+                          vk::DescriptorSetLayout textureSetLayout, const PipelineConfig &config,
+                          bool skinned) {
   device_ = context.device();
 
   auto vertShaderCode = readFile(vertShaderPath);
@@ -153,20 +92,35 @@ void Pipeline::createSkinned(VulkanContext &context, const std::string &vertShad
   auto vertShaderModule = createShaderModule(vertShaderCode);
   auto fragShaderModule = createShaderModule(fragShaderCode);
 
+  // One boolean specialization constant per shader feature, constant_id = feature bit
+  std::array<vk::Bool32, ShaderFeature::COUNT> featureValues;
+  std::array<vk::SpecializationMapEntry, ShaderFeature::COUNT> featureEntries;
+  for (uint32_t i = 0; i < ShaderFeature::COUNT; ++i) {
+    featureValues[i] = (config.shaderFeatures & (1u << i)) ? VK_TRUE : VK_FALSE;
+    featureEntries[i] = vk::SpecializationMapEntry{
+        i, static_cast<uint32_t>(i * sizeof(vk::Bool32)), sizeof(vk::Bool32)};
+  }
+  vk::SpecializationInfo specialization{static_cast<uint32_t>(featureEntries.size()),
+                                        featureEntries.data(), sizeof(featureValues),
+                                        featureValues.data()};
+
+  // Vertex stage: constant_id 0 selects octahedral normal decoding (the compact formats)
+  vk::Bool32 octNormals = config.vertexFormat != VertexFormat::Full ? VK_TRUE : VK_FALSE;
+  vk::SpecializationMapEntry octNormalsEntry{0, 0, sizeof(vk::Bool32)};
+  vk::SpecializationInfo vertexSpecialization{1, &octNormalsEntry, sizeof(octNormals),
+                                              &octNormals};
+
   vk::PipelineShaderStageCreateInfo vertShaderStageInfo{
-      {}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main"};
+      {}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main", &vertexSpecialization};
 
   vk::PipelineShaderStageCreateInfo fragShaderStageInfo{
-      {}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main"};
+      {}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main", &specialization};
 
   std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo,
                                                                    fragShaderStageInfo};
 
-  auto bindingDescription = SkinnedVertex::getBindingDescription();
-  auto attributeDescriptions = SkinnedVertex::getAttributeDescriptions();
-
-  vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
-      {}, bindingDescription, attributeDescriptions};
+  VertexInput input = vertexInput(config.vertexFormat, skinned);
+  vk::PipelineVertexInputStateCreateInfo vertexInputInfo{{}, input.binding, input.attributes};
 
   vk::PipelineInputAssemblyStateCreateInfo inputAssembly{
       {}, vk::PrimitiveTopology::eTriangleList, VK_FALSE};
@@ -225,14 +179,19 @@ void Pipeline::createSkinned(VulkanContext &context, const std::string &vertShad
   vk::PipelineColorBlendStateCreateInfo colorBlending{
       {}, VK_FALSE, vk::LogicOp::eCopy, colorBlendAttachment};
 
-  std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {
-      vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBuffer,        1,
-                                     vk::ShaderStageFlagBits::eVertex  },
-      vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eCombinedImageSampler, 1,
-                                     vk::ShaderStageFlagBits::eFragment},
-      vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageBuffer,        1,
-                                     vk::ShaderStageFlagBits::eVertex  }
+  // Set 0: per-frame UBO, the bone palette (binding 2, as in the skeleton overlay layout) for
+  // skinned meshes, and the instance transforms (binding 3). Textures come from the bindless
+  // table in set 1.
+  std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+      vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBufferDynamic, 1,
+                                     vk::ShaderStageFlagBits::eVertex}
   };
+  if (skinned) {
+    bindings.push_back(vk::DescriptorSetLayoutBinding{
+        2, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex});
+  }
+  bindings.push_back(vk::DescriptorSetLayoutBinding{
+      3, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex});
 
   vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, bindings};
 
@@ -241,7 +200,8 @@ void Pipeline::createSkinned(VulkanContext &context, const std::string &vertShad
   vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eFragment, 0,
                                           sizeof(MaterialPushConstant)};
 
-  vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, descriptorSetLayout_, pushConstantRange};
+  std::array<vk::DescriptorSetLayout, 2> setLayouts = {descriptorSetLayout_, textureSetLayout};
+  vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, setLayouts, pushConstantRange};
 
   pipelineLayout_ = device_.createPipelineLayout(pipelineLayoutInfo);
 
@@ -257,12 +217,14 @@ void Pipeline::createSkinned(VulkanContext &context, const std::string &vertShad
                                               &colorBlending,
                                               &dynamicState,
                                               pipelineLayout_,
-                                              context.renderPass(),
+                                              config.renderPass ? config.renderPass
+                                                                : context.renderPass(),
                                               0};
 
-  auto result = device_.createGraphicsPipeline(nullptr, pipelineInfo);
+  auto result = device_.createGraphicsPipeline(context.pipelineCache(), pipelineInfo);
   if (result.result != vk::Result::eSuccess) {
-    throw std::runtime_error("Failed to create skinned graphics pipeline");
+    throw std::runtime_error(skinned ? "Failed to create skinned graphics pipeline"
+                                     : "Failed to create graphics pipeline");
   }
   pipeline_ = result.value;
 
@@ -302,30 +264,95 @@ vk::ShaderModule Pipeline::createShaderModule(const std::vector<char> &code) {
   return device_.createShaderModule(createInfo);
 }
 
+PipelinePermutations::~PipelinePermutations() {
+  destroy();
+}
+
+void PipelinePermutations::init(VulkanContext &context, vk::DescriptorSetLayout textureSetLayout) {
+  context_ = &context;
+  textureSetLayout_ = textureSetLayout;
+}
+
+void PipelinePermutations::destroy() {
+  for (auto &formatPipelines : pipelines_) {
+    for (auto &pipeline : formatPipelines) {
+      pipeline.reset();
+    }
+  }
+  context_ = nullptr;
+}
+
+const Pipeline &PipelinePermutations::get(VertexFormat format, uint32_t id) {
+  auto formatIndex = static_cast<uint32_t>(format);
+  if (id >= PipelineKey::COUNT || formatIndex >= VERTEX_FORMAT_COUNT) {
+    throw std::runtime_error("Invalid pipeline permutation: " + std::to_string(id) + " (" +
+                             vertexFormatName(format) + ")");
+  }
+
+  auto &pipeline = pipelines_[formatIndex][id];
+  if (!pipeline) {
+    PipelineKey key = PipelineKey::fromId(id);
+    pipeline = std::make_unique<Pipeline>();
+    if (key.skinned) {
+      pipeline->createSkinned(*context_, "shaders/skinned.vert.spv", "shaders/basic.frag.spv",
+                              textureSetLayout_, config(key, format));
+    } else {
+      pipeline->createWithTexture(*context_, "shaders/basic.vert.spv", "shaders/basic.frag.spv",
+                                  textureSetLayout_, config(key, format));
+    }
+  }
+  return *pipeline;
+}
+
+const Pipeline &PipelinePermutations::created(VertexFormat format, uint32_t id) const {
+  auto formatIndex = static_cast<uint32_t>(format);
+  if (id >= PipelineKey::COUNT || formatIndex >= VERTEX_FORMAT_COUNT ||
+      !pipelines_[formatIndex][id]) {
+    throw std::runtime_error("Pipeline permutation not created: " + std::to_string(id) + " (" +
+                             vertexFormatName(format) + ")");
+  }
+  return *pipelines_[formatIndex][id];
+}
+
+uint32_t PipelinePermutations::createdCount() const {
+  uint32_t count = 0;
+  for (const auto &formatPipelines : pipelines_) {
+    for (const auto &pipeline : formatPipelines) {
+      count += pipeline ? 1 : 0;
+    }
+  }
+  return count;
+}
+
+PipelineConfig PipelinePermutations::config(const PipelineKey &key, VertexFormat format) {
+  // Translucent variants: blended, depth tested but not written
+  PipelineConfig config;
+  if (key.blend != PipelineBlend::Opaque) {
+    config.enableBlending = true;
+    config.alphaBlend = key.blend == PipelineBlend::AlphaBlend;
+    config.depthWrite = false;
+  }
+  config.shaderFeatures = key.shaderFeatures;
+  config.vertexFormat = format;
+  return config;
+}
+
 DescriptorManager::~DescriptorManager() {
   destroy();
 }
 
 void DescriptorManager::create(VulkanContext &context, vk::DescriptorSetLayout layout,
                                uint32_t frameCount) {
-  createWithTexture(context, layout, frameCount);
-}
-
-void DescriptorManager::createWithTexture(VulkanContext &context, vk::DescriptorSetLayout layout,
-                                          uint32_t frameCount, uint32_t maxTextures) {
   device_ = context.device();
   layout_ = layout;
   frameCount_ = frameCount;
-  maxTextures_ = maxTextures;
-
-  uint32_t totalSets = frameCount + frameCount * maxTextures;
 
   std::array<vk::DescriptorPoolSize, 2> poolSizes = {
-      vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer,        totalSets},
-      vk::DescriptorPoolSize{vk::DescriptorType::eCombinedImageSampler, totalSets}
+      vk::DescriptorPoolSize{vk::DescriptorType::eUniformBufferDynamic, frameCount},
+      vk::DescriptorPoolSize{vk::DescriptorType::eStorageBufferDynamic, frameCount}
   };
 
-  vk::DescriptorPoolCreateInfo poolInfo{{}, totalSets, poolSizes};
+  vk::DescriptorPoolCreateInfo poolInfo{{}, frameCount, poolSizes};
 
   descriptorPool_ = device_.createDescriptorPool(poolInfo);
 
@@ -334,12 +361,6 @@ void DescriptorManager::createWithTexture(VulkanContext &context, vk::Descriptor
   vk::DescriptorSetAllocateInfo allocInfo{descriptorPool_, layouts};
 
   descriptorSets_ = device_.allocateDescriptorSets(allocInfo);
-
-  uint32_t textureSetsCount = frameCount * maxTextures;
-  std::vector<vk::DescriptorSetLayout> textureLayouts(textureSetsCount, layout);
-  vk::DescriptorSetAllocateInfo textureAllocInfo{descriptorPool_, textureLayouts};
-  textureDescriptorSets_ = device_.allocateDescriptorSets(textureAllocInfo);
-  textureDescriptorSetInitialized_.resize(textureSetsCount, false);
 }
 
 void DescriptorManager::destroy() {
@@ -349,11 +370,8 @@ void DescriptorManager::destroy() {
       descriptorPool_ = nullptr;
     }
     descriptorSets_.clear();
-    textureDescriptorSets_.clear();
-    textureDescriptorSetInitialized_.clear();
     layout_ = nullptr;
     frameCount_ = 0;
-    maxTextures_ = 0;
     device_ = nullptr;
   }
 }
@@ -362,79 +380,46 @@ void DescriptorManager::updateUniformBuffer(uint32_t frameIndex, vk::Buffer buff
                                             vk::DeviceSize size) {
   vk::DescriptorBufferInfo bufferInfo{buffer, 0, size};
 
-  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex],        0,  0,
-                                         vk::DescriptorType::eUniformBuffer, {}, bufferInfo};
+  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex], 0, 0,
+                                         vk::DescriptorType::eUniformBufferDynamic, {},
+                                         bufferInfo};
 
   device_.updateDescriptorSets(descriptorWrite, {});
 }
 
-void DescriptorManager::updateTexture(uint32_t frameIndex, vk::ImageView imageView,
-                                      vk::Sampler sampler) {
-  vk::DescriptorImageInfo imageInfo{sampler, imageView, vk::ImageLayout::eShaderReadOnlyOptimal};
+void DescriptorManager::updateInstanceBuffer(uint32_t frameIndex, vk::Buffer buffer,
+                                             vk::DeviceSize size) {
+  vk::DescriptorBufferInfo bufferInfo{buffer, 0, size};
 
-  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex], 1, 0,
-                                         vk::DescriptorType::eCombinedImageSampler, imageInfo};
+  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex], 3, 0,
+                                         vk::DescriptorType::eStorageBufferDynamic, {},
+                                         bufferInfo};
 
   device_.updateDescriptorSets(descriptorWrite, {});
 }
 
-vk::DescriptorSet DescriptorManager::getTextureDescriptorSet(uint32_t frameIndex,
-                                                             uint32_t textureIndex,
-                                                             vk::ImageView imageView,
-                                                             vk::Sampler sampler) {
-  if (textureIndex >= maxTextures_ || frameIndex >= frameCount_) {
-    return descriptorSets_[frameIndex];
-  }
-
-  uint32_t setIndex = frameIndex * maxTextures_ + textureIndex;
-  vk::DescriptorSet set = textureDescriptorSets_[setIndex];
-
-  if (!textureDescriptorSetInitialized_[setIndex]) {
-    vk::CopyDescriptorSet copyUbo{descriptorSets_[frameIndex], 0, 0, set, 0, 0, 1};
-
-    vk::DescriptorImageInfo imageInfo{sampler, imageView, vk::ImageLayout::eShaderReadOnlyOptimal};
-    vk::WriteDescriptorSet writeTexture{set, 1, 0, vk::DescriptorType::eCombinedImageSampler,
-                                        imageInfo};
-
-    device_.updateDescriptorSets(writeTexture, copyUbo);
-    textureDescriptorSetInitialized_[setIndex] = true;
-  }
-
-  return set;
-}
-
 SkinnedDescriptorManager::~SkinnedDescriptorManager() {
   destroy();
 }
 
 void SkinnedDescriptorManager::create(VulkanContext &context, vk::DescriptorSetLayout layout,
-                                      uint32_t frameCount, uint32_t maxTextures) {
+                                      uint32_t frameCount) {
   device_ = context.device();
   layout_ = layout;
   frameCount_ = frameCount;
-  maxTextures_ = maxTextures;
-
-  uint32_t totalSets = frameCount + frameCount * maxTextures;
 
-  std::array<vk::DescriptorPoolSize, 3> poolSizes = {
-      vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer,        totalSets},
-      vk::DescriptorPoolSize{vk::DescriptorType::eCombinedImageSampler, totalSets},
-      vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer,        totalSets}
+  std::array<vk::DescriptorPoolSize, 2> poolSizes = {
+      vk::DescriptorPoolSize{vk::DescriptorType::eUniformBufferDynamic, frameCount},
+      vk::DescriptorPoolSize{vk::DescriptorType::eStorageBufferDynamic, 2 * frameCount}
   };
 
-  vk::DescriptorPoolCreateInfo poolInfo{{}, totalSets, poolSizes};
+  vk::DescriptorPoolCreateInfo poolInfo{{}, frameCount, poolSizes};
 
   descriptorPool_ = device_.createDescriptorPool(poolInfo);
 
   std::vector<vk::DescriptorSetLayout> layouts(frameCount, layout);
   vk::DescriptorSetAllocateInfo allocInfo{descriptorPool_, layouts};
   descriptorSets_ = device_.allocateDescriptorSets(allocInfo);
-
-  uint32_t textureSetsCount = frameCount * maxTextures;
-  std::vector<vk::DescriptorSetLayout> textureLayouts(textureSetsCount, layout);
-  vk::DescriptorSetAllocateInfo textureAllocInfo{descriptorPool_, textureLayouts};
-  textureDescriptorSets_ = device_.allocateDescriptorSets(textureAllocInfo);
-  textureDescriptorSetInitialized_.resize(textureSetsCount, false);
 }
 
 void SkinnedDescriptorManager::destroy() {
@@ -444,11 +429,8 @@ void SkinnedDescriptorManager::destroy() {
       descriptorPool_ = nullptr;
     }
     descriptorSets_.clear();
-    textureDescriptorSets_.clear();
-    textureDescriptorSetInitialized_.clear();
     layout_ = nullptr;
     frameCount_ = 0;
-    maxTextures_ = 0;
     device_ = nullptr;
   }
 }
@@ -456,46 +438,28 @@ void SkinnedDescriptorManager::destroy() {
 void SkinnedDescriptorManager::updateUniformBuffer(uint32_t frameIndex, vk::Buffer buffer,
                                                    vk::DeviceSize size) {
   vk::DescriptorBufferInfo bufferInfo{buffer, 0, size};
-  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex],        0,  0,
-                                         vk::DescriptorType::eUniformBuffer, {}, bufferInfo};
+  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex], 0, 0,
+                                         vk::DescriptorType::eUniformBufferDynamic, {},
+                                         bufferInfo};
   device_.updateDescriptorSets(descriptorWrite, {});
 }
 
 void SkinnedDescriptorManager::updateBoneBuffer(uint32_t frameIndex, vk::Buffer buffer,
                                                 vk::DeviceSize size) {
   vk::DescriptorBufferInfo bufferInfo{buffer, 0, size};
-  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex],        2,  0,
-                                         vk::DescriptorType::eStorageBuffer, {}, bufferInfo};
+  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex], 2, 0,
+                                         vk::DescriptorType::eStorageBufferDynamic, {},
+                                         bufferInfo};
   device_.updateDescriptorSets(descriptorWrite, {});
 }
 
-vk::DescriptorSet
-SkinnedDescriptorManager::getDescriptorSet(uint32_t frameIndex, uint32_t textureIndex,
-                                           vk::ImageView imageView, vk::Sampler sampler,
-                                           vk::Buffer boneBuffer, vk::DeviceSize boneBufferSize) {
-  if (textureIndex >= maxTextures_ || frameIndex >= frameCount_) {
-    return descriptorSets_[frameIndex];
-  }
-
-  uint32_t setIndex = frameIndex * maxTextures_ + textureIndex;
-  vk::DescriptorSet set = textureDescriptorSets_[setIndex];
-
-  if (!textureDescriptorSetInitialized_[setIndex]) {
-    vk::CopyDescriptorSet copyUbo{descriptorSets_[frameIndex], 0, 0, set, 0, 0, 1};
-
-    vk::DescriptorImageInfo imageInfo{sampler, imageView, vk::ImageLayout::eShaderReadOnlyOptimal};
-    vk::WriteDescriptorSet writeTexture{set, 1, 0, vk::DescriptorType::eCombinedImageSampler,
-                                        imageInfo};
-
-    vk::DescriptorBufferInfo boneInfo{boneBuffer, 0, boneBufferSize};
-    vk::WriteDescriptorSet writeBones{set, 2, 0, vk::DescriptorType::eStorageBuffer, {}, boneInfo};
-
-    std::array<vk::WriteDescriptorSet, 2> writes = {writeTexture, writeBones};
-    device_.updateDescriptorSets(writes, copyUbo);
-    textureDescriptorSetInitialized_[setIndex] = true;
-  }
-
-  return set;
+void SkinnedDescriptorManager::updateInstanceBuffer(uint32_t frameIndex, vk::Buffer buffer,
+                                                    vk::DeviceSize size) {
+  vk::DescriptorBufferInfo bufferInfo{buffer, 0, size};
+  vk::WriteDescriptorSet descriptorWrite{descriptorSets_[frameIndex], 3, 0,
+                                         vk::DescriptorType::eStorageBufferDynamic, {},
+                                         bufferInfo};
+  device_.updateDescriptorSets(descriptorWrite, {});
 }
 
 } // namespace w3d::gfx
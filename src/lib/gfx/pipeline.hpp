@@ -7,9 +7,13 @@
 #include <glm/glm.hpp>
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "lib/gfx/pipeline_key.hpp"
+#include "lib/gfx/vertex_format.hpp"
+
 namespace w3d::gfx {
 
 class VulkanContext;
@@ -61,6 +65,10 @@ struct UniformBufferObject {
   alignas(16) glm::mat4 model;
   alignas(16) glm::mat4 view;
   alignas(16) glm::mat4 proj;
+  alignas(16) glm::mat4 normalMatrix; // transpose(inverse(model)), so shaders need not invert
+  // PositionQuantization of the drawn vertex set (xyz); identity for float positions
+  alignas(16) glm::vec4 positionScale;
+  alignas(16) glm::vec4 positionOffset;
 };
 
 struct MaterialPushConstant {
@@ -68,9 +76,8 @@ struct MaterialPushConstant {
   alignas(16) glm::vec4 emissiveColor;
   alignas(16) glm::vec4 specularColor;
   alignas(16) glm::vec3 hoverTint;
-  alignas(4) uint32_t flags;
-  alignas(4) float alphaThreshold;
-  alignas(4) uint32_t useTexture;
+  alignas(4) float alphaThreshold;  // Read by AlphaTest permutations
+  alignas(4) uint32_t textureIndex; // Slot in the TextureManager's bindless table (set 1)
 };
 
 struct PipelineConfig {
@@ -78,6 +85,9 @@ struct PipelineConfig {
   bool alphaBlend = false;
   bool depthWrite = true;
   bool twoSided = false;
+  uint32_t shaderFeatures = ShaderFeature::Textured; // Specialization of the fragment shader
+  VertexFormat vertexFormat = VertexFormat::Full;     // Vertex input layout and decoding
+  vk::RenderPass renderPass;                          // Null: the context's render pass
 };
 
 class Pipeline {
@@ -88,14 +98,19 @@ public:
   Pipeline(const Pipeline &) = delete;
   Pipeline &operator=(const Pipeline &) = delete;
 
+  // Mesh pipelines use two descriptor sets: set 0 holds the per-frame data (UBO, bones) and
+  // set 1 is the bindless texture table described by textureSetLayout
   void create(VulkanContext &context, const std::string &vertShaderPath,
-              const std::string &fragShaderPath);
+              const std::string &fragShaderPath, vk::DescriptorSetLayout textureSetLayout);
 
   void createWithTexture(VulkanContext &context, const std::string &vertShaderPath,
-                         const std::string &fragShaderPath, const PipelineConfig &config = {});
+                         const std::string &fragShaderPath,
+                         vk::DescriptorSetLayout textureSetLayout,
+                         const PipelineConfig &config = {});
 
   void createSkinned(VulkanContext &context, const std::string &vertShaderPath,
-                     const std::string &fragShaderPath, const PipelineConfig &config = {});
+                     const std::string &fragShaderPath, vk::DescriptorSetLayout textureSetLayout,
+                     const PipelineConfig &config = {});
 
   void destroy();
 
@@ -104,6 +119,9 @@ public:
   vk::DescriptorSetLayout descriptorSetLayout() const { return descriptorSetLayout_; }
 
 private:
+  void createMesh(VulkanContext &context, const std::string &vertShaderPath,
+                  const std::string &fragShaderPath, vk::DescriptorSetLayout textureSetLayout,
+                  const PipelineConfig &config, bool skinned);
   std::vector<char> readFile(const std::string &filename);
   vk::ShaderModule createShaderModule(const std::vector<char> &code);
 
@@ -113,6 +131,44 @@ private:
   vk::DescriptorSetLayout descriptorSetLayout_;
 };
 
+// Mesh pipelines for every PipelineKey and vertex format, each created the first time it is
+// requested. All of them have compatible layouts, so descriptor sets and push constants bound
+// through one carry over to the others.
+class PipelinePermutations {
+public:
+  PipelinePermutations() = default;
+  ~PipelinePermutations();
+
+  PipelinePermutations(const PipelinePermutations &) = delete;
+  PipelinePermutations &operator=(const PipelinePermutations &) = delete;
+
+  void init(VulkanContext &context, vk::DescriptorSetLayout textureSetLayout);
+  void destroy();
+
+  // Pipeline for a key id (PipelineKey::id()) reading vertices in the given format, created on
+  // first use
+  const Pipeline &get(VertexFormat format, uint32_t id);
+  const Pipeline &get(VertexFormat format, const PipelineKey &key) {
+    return get(format, key.id());
+  }
+
+  // Pipeline get() has already created. Never creates one, so threads may call it
+  // concurrently while recording.
+  const Pipeline &created(VertexFormat format, uint32_t id) const;
+
+  // Number of permutations created so far
+  uint32_t createdCount() const;
+
+  static PipelineConfig config(const PipelineKey &key, VertexFormat format);
+
+private:
+  using FormatPipelines = std::array<std::unique_ptr<Pipeline>, PipelineKey::COUNT>;
+
+  VulkanContext *context_ = nullptr;
+  vk::DescriptorSetLayout textureSetLayout_;
+  std::array<FormatPipelines, VERTEX_FORMAT_COUNT> pipelines_;
+};
+
 class DescriptorManager {
 public:
   DescriptorManager() = default;
@@ -120,16 +176,11 @@ public:
 
   void create(VulkanContext &context, vk::DescriptorSetLayout layout, uint32_t frameCount);
 
-  void createWithTexture(VulkanContext &context, vk::DescriptorSetLayout layout,
-                         uint32_t frameCount, uint32_t maxTextures = 64);
   void destroy();
 
   void updateUniformBuffer(uint32_t frameIndex, vk::Buffer buffer, vk::DeviceSize size);
 
-  void updateTexture(uint32_t frameIndex, vk::ImageView imageView, vk::Sampler sampler);
-
-  vk::DescriptorSet getTextureDescriptorSet(uint32_t frameIndex, uint32_t textureIndex,
-                                            vk::ImageView imageView, vk::Sampler sampler);
+  void updateInstanceBuffer(uint32_t frameIndex, vk::Buffer buffer, vk::DeviceSize size);
 
   vk::DescriptorSet descriptorSet(uint32_t frameIndex) const { return descriptorSets_[frameIndex]; }
 
@@ -139,10 +190,6 @@ private:
   std::vector<vk::DescriptorSet> descriptorSets_;
   vk::DescriptorSetLayout layout_;
   uint32_t frameCount_ = 0;
-
-  std::vector<vk::DescriptorSet> textureDescriptorSets_;
-  std::vector<bool> textureDescriptorSetInitialized_;
-  uint32_t maxTextures_ = 0;
 };
 
 class SkinnedDescriptorManager {
@@ -150,17 +197,15 @@ public:
   SkinnedDescriptorManager() = default;
   ~SkinnedDescriptorManager();
 
-  void create(VulkanContext &context, vk::DescriptorSetLayout layout, uint32_t frameCount,
-              uint32_t maxTextures = 64);
+  void create(VulkanContext &context, vk::DescriptorSetLayout layout, uint32_t frameCount);
+
   void destroy();
 
   void updateUniformBuffer(uint32_t frameIndex, vk::Buffer buffer, vk::DeviceSize size);
 
   void updateBoneBuffer(uint32_t frameIndex, vk::Buffer buffer, vk::DeviceSize size);
 
-  vk::DescriptorSet getDescriptorSet(uint32_t frameIndex, uint32_t textureIndex,
-                                     vk::ImageView imageView, vk::Sampler sampler,
-                                     vk::Buffer boneBuffer, vk::DeviceSize boneBufferSize);
+  void updateInstanceBuffer(uint32_t frameIndex, vk::Buffer buffer, vk::DeviceSize size);
 
   vk::DescriptorSet descriptorSet(uint32_t frameIndex) const { return descriptorSets_[frameIndex]; }
 
@@ -170,10 +215,6 @@ private:
   std::vector<vk::DescriptorSet> descriptorSets_;
   vk::DescriptorSetLayout layout_;
   uint32_t frameCount_ = 0;
-
-  std::vector<vk::DescriptorSet> textureDescriptorSets_;
-  std::vector<bool> textureDescriptorSetInitialized_;
-  uint32_t maxTextures_ = 0;
 };
 
 } // namespace w3d::gfx
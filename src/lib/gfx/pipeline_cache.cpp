@@ -0,0 +1,89 @@
+#include "lib/gfx/pipeline_cache.hpp"
+
+#include "lib/gfx/pipeline_cache_file.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace w3d::gfx {
+
+namespace {
+
+PipelineCacheIdentity identityOf(vk::PhysicalDevice physicalDevice) {
+  auto properties = physicalDevice.getProperties();
+
+  PipelineCacheIdentity identity;
+  identity.vendorID = properties.vendorID;
+  identity.deviceID = properties.deviceID;
+  identity.driverVersion = properties.driverVersion;
+  std::copy(properties.pipelineCacheUUID.begin(), properties.pipelineCacheUUID.end(),
+            identity.pipelineCacheUUID.begin());
+  return identity;
+}
+
+} // namespace
+
+PipelineCache::~PipelineCache() {
+  destroy();
+}
+
+void PipelineCache::init(vk::PhysicalDevice physicalDevice, vk::Device device,
+                         const std::filesystem::path &file) {
+  physicalDevice_ = physicalDevice;
+  device_ = device;
+  file_ = file;
+  loadedSize_ = 0;
+
+  std::vector<uint8_t> blob;
+  if (!file_.empty()) {
+    if (auto data = readBinaryFile(file_)) {
+      if (auto unpacked = unpackPipelineCache(*data, identityOf(physicalDevice_))) {
+        blob = std::move(*unpacked);
+      } else {
+        std::cerr << "Ignoring stale or corrupt pipeline cache: " << file_.string() << "\n";
+      }
+    }
+  }
+
+  vk::PipelineCacheCreateInfo createInfo{};
+  createInfo.initialDataSize = blob.size();
+  createInfo.pInitialData = blob.data();
+
+  try {
+    cache_ = device_.createPipelineCache(createInfo);
+    loadedSize_ = blob.size();
+  } catch (const vk::SystemError &) {
+    if (blob.empty()) {
+      throw;
+    }
+    // The driver rejected data that passed our checks; start over with an empty cache
+    cache_ = device_.createPipelineCache(vk::PipelineCacheCreateInfo{});
+  }
+}
+
+void PipelineCache::destroy() {
+  if (!cache_) {
+    return;
+  }
+
+  if (!file_.empty() && !save()) {
+    std::cerr << "Failed to save pipeline cache: " << file_.string() << "\n";
+  }
+
+  device_.destroyPipelineCache(cache_);
+  cache_ = nullptr;
+}
+
+bool PipelineCache::save() {
+  if (!cache_ || file_.empty()) {
+    return false;
+  }
+
+  std::vector<uint8_t> blob = device_.getPipelineCacheData(cache_);
+  if (blob.empty()) {
+    return false;
+  }
+  return writeFileAtomically(file_, packPipelineCache(blob, identityOf(physicalDevice_)));
+}
+
+} // namespace w3d::gfx
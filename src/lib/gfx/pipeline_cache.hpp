@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstddef>
+#include <filesystem>
+
+namespace w3d::gfx {
+
+// The one vk::PipelineCache every pipeline is created through.
+// When given a file, the cache is seeded from it at init (if it was written by the same
+// device and driver) and written back at destroy, so later launches skip shader compilation.
+class PipelineCache {
+public:
+  PipelineCache() = default;
+  ~PipelineCache();
+
+  PipelineCache(const PipelineCache &) = delete;
+  PipelineCache &operator=(const PipelineCache &) = delete;
+
+  // An empty file keeps the cache in memory only
+  void init(vk::PhysicalDevice physicalDevice, vk::Device device,
+            const std::filesystem::path &file = {});
+  // Saves to the file (if any) before destroying the cache
+  void destroy();
+
+  // Write the current contents to the file; false if there is no file or the write failed
+  bool save();
+
+  vk::PipelineCache handle() const { return cache_; }
+  // Size of the blob the cache was seeded with (0 when it started empty)
+  size_t loadedSize() const { return loadedSize_; }
+
+private:
+  vk::PhysicalDevice physicalDevice_;
+  vk::Device device_;
+  vk::PipelineCache cache_;
+  std::filesystem::path file_;
+  size_t loadedSize_ = 0;
+};
+
+} // namespace w3d::gfx
@@ -0,0 +1,147 @@
+#include "lib/gfx/pipeline_cache_file.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+
+namespace w3d::gfx {
+
+namespace {
+
+constexpr std::array<char, 4> MAGIC = {'W', '3', 'P', 'C'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+// Magic, then format version, vendor, device, driver version, cache UUID, blob size and blob
+// checksum, all little-endian
+constexpr size_t HEADER_SIZE = MAGIC.size() + 4 * 4 + PipelineCacheIdentity::UUID_SIZE + 2 * 8;
+
+// VkPipelineCacheHeaderVersionOne: headerSize, headerVersion, vendorID, deviceID, UUID
+constexpr size_t VK_HEADER_SIZE = 4 * 4 + PipelineCacheIdentity::UUID_SIZE;
+constexpr uint32_t VK_HEADER_VERSION_ONE = 1;
+
+// 64-bit FNV-1a
+uint64_t checksum(const uint8_t *data, size_t size) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+template <typename T>
+void put(std::vector<uint8_t> &out, T value) {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+template <typename T>
+T get(const uint8_t *data) {
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+bool sameDevice(const PipelineCacheIdentity &a, uint32_t vendorID, uint32_t deviceID,
+                const uint8_t *uuid) {
+  return a.vendorID == vendorID && a.deviceID == deviceID &&
+         std::equal(a.pipelineCacheUUID.begin(), a.pipelineCacheUUID.end(), uuid);
+}
+
+} // namespace
+
+std::vector<uint8_t> packPipelineCache(const std::vector<uint8_t> &blob,
+                                       const PipelineCacheIdentity &identity) {
+  std::vector<uint8_t> file;
+  file.reserve(HEADER_SIZE + blob.size());
+  file.insert(file.end(), MAGIC.begin(), MAGIC.end());
+  put(file, FORMAT_VERSION);
+  put(file, identity.vendorID);
+  put(file, identity.deviceID);
+  put(file, identity.driverVersion);
+  file.insert(file.end(), identity.pipelineCacheUUID.begin(), identity.pipelineCacheUUID.end());
+  put(file, static_cast<uint64_t>(blob.size()));
+  put(file, checksum(blob.data(), blob.size()));
+  file.insert(file.end(), blob.begin(), blob.end());
+  return file;
+}
+
+std::optional<std::vector<uint8_t>> unpackPipelineCache(const std::vector<uint8_t> &file,
+                                                        const PipelineCacheIdentity &identity) {
+  if (file.size() < HEADER_SIZE || !std::equal(MAGIC.begin(), MAGIC.end(), file.begin())) {
+    return std::nullopt;
+  }
+
+  const uint8_t *header = file.data() + MAGIC.size();
+  const uint8_t *uuid = header + 16;
+  const uint8_t *sizes = uuid + PipelineCacheIdentity::UUID_SIZE;
+  uint64_t blobSize = get<uint64_t>(sizes);
+
+  if (get<uint32_t>(header) != FORMAT_VERSION ||
+      get<uint32_t>(header + 12) != identity.driverVersion ||
+      !sameDevice(identity, get<uint32_t>(header + 4), get<uint32_t>(header + 8), uuid) ||
+      blobSize != file.size() - HEADER_SIZE) {
+    return std::nullopt;
+  }
+
+  const uint8_t *blob = file.data() + HEADER_SIZE;
+  if (checksum(blob, blobSize) != get<uint64_t>(sizes + 8)) {
+    return std::nullopt;
+  }
+
+  // The driver's own header must agree too; some drivers do not validate it themselves
+  if (blobSize < VK_HEADER_SIZE || get<uint32_t>(blob) < VK_HEADER_SIZE ||
+      get<uint32_t>(blob + 4) != VK_HEADER_VERSION_ONE ||
+      !sameDevice(identity, get<uint32_t>(blob + 8), get<uint32_t>(blob + 12), blob + 16)) {
+    return std::nullopt;
+  }
+
+  return std::vector<uint8_t>(blob, blob + blobSize);
+}
+
+std::optional<std::vector<uint8_t>> readBinaryFile(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  auto size = static_cast<size_t>(file.tellg());
+  std::vector<uint8_t> data(size);
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(size))) {
+    return std::nullopt;
+  }
+  return data;
+}
+
+bool writeFileAtomically(const std::filesystem::path &path, const std::vector<uint8_t> &data) {
+  std::error_code ec;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), ec);
+  }
+
+  std::filesystem::path temp = path;
+  temp += ".tmp";
+  {
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+    if (!file ||
+        !file.write(reinterpret_cast<const char *>(data.data()),
+                    static_cast<std::streamsize>(data.size())) ||
+        !file.flush()) {
+      file.close();
+      std::filesystem::remove(temp, ec);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp, ec);
+    return false;
+  }
+  return true;
+}
+
+} // namespace w3d::gfx
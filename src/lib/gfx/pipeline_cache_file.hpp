@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace w3d::gfx {
+
+// Device and driver a pipeline cache blob was produced by. Blobs from any other device or
+// driver build are discarded rather than handed to the driver.
+struct PipelineCacheIdentity {
+  static constexpr size_t UUID_SIZE = 16; // VK_UUID_SIZE
+
+  uint32_t vendorID = 0;
+  uint32_t deviceID = 0;
+  uint32_t driverVersion = 0;
+  std::array<uint8_t, UUID_SIZE> pipelineCacheUUID{};
+};
+
+// On-disk pipeline cache: a small header (magic, format version, identity, blob size and
+// checksum) followed by the blob from vkGetPipelineCacheData.
+std::vector<uint8_t> packPipelineCache(const std::vector<uint8_t> &blob,
+                                       const PipelineCacheIdentity &identity);
+
+// Blob stored in a cache file, or nullopt if the file is truncated, corrupt, from another
+// format version, or was written for a different device or driver. Also checks the Vulkan
+// header at the start of the blob against the identity.
+std::optional<std::vector<uint8_t>> unpackPipelineCache(const std::vector<uint8_t> &file,
+                                                        const PipelineCacheIdentity &identity);
+
+// Whole file contents, or nullopt if it cannot be read
+std::optional<std::vector<uint8_t>> readBinaryFile(const std::filesystem::path &path);
+
+// Write to a temporary file next to path, then rename it over path, so readers never see a
+// partially written file. Creates missing parent directories. Returns false on failure.
+bool writeFileAtomically(const std::filesystem::path &path, const std::vector<uint8_t> &data);
+
+} // namespace w3d::gfx
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace w3d::gfx {
+
+// Fragment shader features, baked into each mesh pipeline through specialization constants.
+// Bit i is constant_id i in basic.frag.
+namespace ShaderFeature {
+constexpr uint32_t Textured = 1 << 0;  // Sample the bindless table instead of vertex color
+constexpr uint32_t AlphaTest = 1 << 1; // Discard below the material's alpha threshold
+constexpr uint32_t Unlit = 1 << 2;     // Skip lighting
+constexpr uint32_t COUNT = 3;
+} // namespace ShaderFeature
+
+// Fixed-function blend state of a mesh pipeline
+enum class PipelineBlend : uint32_t {
+  Opaque = 0,     // Depth written, no blending
+  AlphaBlend = 1, // (src_alpha, 1-src_alpha), depth tested only
+  Additive = 2    // (one, one), depth tested only
+};
+
+// One mesh pipeline permutation: vertex layout, blend state and shader features
+struct PipelineKey {
+  static constexpr uint32_t BLEND_COUNT = 3;
+  static constexpr uint32_t FEATURE_COMBINATIONS = 1 << ShaderFeature::COUNT;
+  // Number of distinct ids
+  static constexpr uint32_t COUNT = 2 * BLEND_COUNT * FEATURE_COMBINATIONS;
+
+  bool skinned = false;
+  PipelineBlend blend = PipelineBlend::Opaque;
+  uint32_t shaderFeatures = 0;
+
+  // Dense id below COUNT. Permutations sharing a vertex layout, then a blend state, are
+  // adjacent, so sorting draws by id groups them by the most expensive state first.
+  uint32_t id() const {
+    uint32_t layout = skinned ? 1 : 0;
+    return (layout * BLEND_COUNT + static_cast<uint32_t>(blend)) * FEATURE_COMBINATIONS +
+           (shaderFeatures & (FEATURE_COMBINATIONS - 1));
+  }
+
+  static PipelineKey fromId(uint32_t id) {
+    PipelineKey key;
+    key.shaderFeatures = id % FEATURE_COMBINATIONS;
+    key.blend = static_cast<PipelineBlend>(id / FEATURE_COMBINATIONS % BLEND_COUNT);
+    key.skinned = id / (FEATURE_COMBINATIONS * BLEND_COUNT) != 0;
+    return key;
+  }
+
+  bool operator==(const PipelineKey &) const = default;
+};
+
+} // namespace w3d::gfx
@@ -0,0 +1,24 @@
+#include "lib/gfx/ring_allocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace w3d::gfx {
+
+RingAllocator::RingAllocator(uint64_t capacity, uint64_t alignment)
+    : capacity_(capacity), alignment_(std::max<uint64_t>(alignment, 1)) {}
+
+uint64_t RingAllocator::allocate(uint64_t size) {
+  uint64_t offset = (head_ + alignment_ - 1) / alignment_ * alignment_;
+  if (offset + size > capacity_) {
+    throw std::runtime_error("Frame ring buffer exhausted (" + std::to_string(offset + size) +
+                             " of " + std::to_string(capacity_) + " bytes)");
+  }
+
+  head_ = offset + size;
+  peakBytesUsed_ = std::max(peakBytesUsed_, head_);
+  return offset;
+}
+
+} // namespace w3d::gfx
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace w3d::gfx {
+
+// Linear placement within one frame partition of a FrameRingBuffer, independent of Vulkan so
+// layouts can be unit tested. Offsets are relative to the start of the partition.
+class RingAllocator {
+public:
+  RingAllocator() = default;
+  RingAllocator(uint64_t capacity, uint64_t alignment);
+
+  // Start the partition over
+  void reset() { head_ = 0; }
+
+  // Offset of the new allocation, aligned to alignment(). Throws if the partition is exhausted.
+  uint64_t allocate(uint64_t size);
+
+  uint64_t capacity() const { return capacity_; }
+  uint64_t alignment() const { return alignment_; }
+
+  // Bytes allocated since the last reset and the high-water mark across all resets
+  uint64_t bytesUsed() const { return head_; }
+  uint64_t peakBytesUsed() const { return peakBytesUsed_; }
+
+private:
+  uint64_t capacity_ = 0;
+  uint64_t alignment_ = 1;
+  uint64_t head_ = 0;
+  uint64_t peakBytesUsed_ = 0;
+};
+
+} // namespace w3d::gfx
@@ -0,0 +1,63 @@
+#include "lib/gfx/ring_buffer.hpp"
+#include "lib/gfx/vulkan_context.hpp"
+
+#include <algorithm>
+
+namespace w3d::gfx {
+
+namespace {
+
+vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+FrameRingBuffer::~FrameRingBuffer() {
+  destroy();
+}
+
+void FrameRingBuffer::create(VulkanContext &context, vk::DeviceSize bytesPerFrame,
+                             uint32_t frameCount, vk::BufferUsageFlags usage) {
+  destroy();
+
+  // Every sub-allocation may be bound as a dynamic uniform or storage buffer
+  auto limits = context.physicalDevice().getProperties().limits;
+  vk::DeviceSize alignment = std::max({limits.minUniformBufferOffsetAlignment,
+                                       limits.minStorageBufferOffsetAlignment,
+                                       vk::DeviceSize{16}});
+
+  vk::DeviceSize frameSize = alignUp(bytesPerFrame, alignment);
+  partition_ = RingAllocator(frameSize, alignment);
+  frameCount_ = frameCount;
+
+  buffer_.create(context, frameSize * frameCount, usage,
+                 vk::MemoryPropertyFlagBits::eHostVisible |
+                     vk::MemoryPropertyFlagBits::eHostCoherent);
+  mapped_ = static_cast<uint8_t *>(buffer_.map());
+
+  frameBase_ = 0;
+}
+
+void FrameRingBuffer::destroy() {
+  buffer_.destroy();
+  mapped_ = nullptr;
+  partition_ = RingAllocator();
+  frameBase_ = 0;
+  frameCount_ = 0;
+}
+
+void FrameRingBuffer::beginFrame(uint32_t frameIndex) {
+  frameBase_ = partition_.capacity() * (frameIndex % std::max(frameCount_, 1u));
+  partition_.reset();
+}
+
+RingAllocation FrameRingBuffer::allocate(vk::DeviceSize size) {
+  RingAllocation allocation;
+  allocation.offset = frameBase_ + partition_.allocate(size);
+  allocation.size = size;
+  allocation.data = mapped_ + allocation.offset;
+  return allocation;
+}
+
+} // namespace w3d::gfx
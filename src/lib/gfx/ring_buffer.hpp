@@ -0,0 +1,77 @@
+#pragma once
+
+#include "lib/gfx/buffer.hpp"
+#include "lib/gfx/ring_allocator.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+namespace w3d::gfx {
+
+class VulkanContext;
+
+// A sub-allocation from a FrameRingBuffer. Valid until the same frame slot comes around again.
+struct RingAllocation {
+  void *data = nullptr;       // Host pointer into the persistently mapped buffer
+  vk::DeviceSize offset = 0;  // Offset from the start of the buffer
+  vk::DeviceSize size = 0;
+
+  explicit operator bool() const { return data != nullptr; }
+
+  // Offset for vkCmdBindDescriptorSets dynamic offsets
+  uint32_t dynamicOffset() const { return static_cast<uint32_t>(offset); }
+};
+
+// Persistently mapped, host-coherent buffer split into one partition per frame in flight.
+// Per-frame dynamic data (uniforms, bone palettes, per-draw data) is linearly sub-allocated
+// from the current partition and addressed with dynamic descriptor offsets.
+//
+// The caller guards reuse: beginFrame(i) may only be called once the fence of the frame
+// that last used partition i has signaled.
+class FrameRingBuffer {
+public:
+  FrameRingBuffer() = default;
+  ~FrameRingBuffer();
+
+  FrameRingBuffer(const FrameRingBuffer &) = delete;
+  FrameRingBuffer &operator=(const FrameRingBuffer &) = delete;
+
+  void create(VulkanContext &context, vk::DeviceSize bytesPerFrame, uint32_t frameCount,
+              vk::BufferUsageFlags usage);
+
+  void destroy();
+
+  // Reset the partition for a frame slot (after its fence has been waited on)
+  void beginFrame(uint32_t frameIndex);
+
+  // Sub-allocate from the current frame's partition. Offsets honor the device's minimum
+  // uniform/storage buffer offset alignment. Throws if the partition is exhausted.
+  RingAllocation allocate(vk::DeviceSize size);
+
+  // Allocate and copy a value in one step
+  template <typename T>
+  RingAllocation push(const T &value) {
+    RingAllocation allocation = allocate(sizeof(T));
+    std::memcpy(allocation.data, &value, sizeof(T));
+    return allocation;
+  }
+
+  vk::Buffer buffer() const { return buffer_.buffer(); }
+  vk::DeviceSize frameSize() const { return partition_.capacity(); }
+  vk::DeviceSize alignment() const { return partition_.alignment(); }
+
+  // Bytes allocated in the current frame and the high-water mark across all frames
+  vk::DeviceSize bytesUsed() const { return partition_.bytesUsed(); }
+  vk::DeviceSize peakBytesUsed() const { return partition_.peakBytesUsed(); }
+
+private:
+  Buffer buffer_;
+  uint8_t *mapped_ = nullptr;
+  RingAllocator partition_; // Placement within the current frame's partition
+  vk::DeviceSize frameBase_ = 0;
+  uint32_t frameCount_ = 0;
+};
+
+} // namespace w3d::gfx
@@ -39,9 +39,55 @@ TextureManager::~TextureManager() {
 
 void TextureManager::init(VulkanContext &context) {
   context_ = &context;
+  createDescriptorTable();
   createDefaultTexture();
 }
 
+void TextureManager::createDescriptorTable() {
+  vk::Device device = context_->device();
+
+  auto limits = context_->physicalDevice().getProperties().limits;
+  capacity_ = std::min({MAX_TEXTURES, limits.maxPerStageDescriptorSamplers,
+                        limits.maxPerStageDescriptorSampledImages,
+                        limits.maxDescriptorSetSamplers, limits.maxDescriptorSetSampledImages});
+
+  // Partially bound: slots past the last created texture never need valid descriptors
+  vk::DescriptorSetLayoutBinding binding{0, vk::DescriptorType::eCombinedImageSampler, capacity_,
+                                         vk::ShaderStageFlagBits::eFragment};
+  vk::DescriptorBindingFlags bindingFlags = vk::DescriptorBindingFlagBits::ePartiallyBound;
+  vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{bindingFlags};
+
+  vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, binding};
+  layoutInfo.pNext = &bindingFlagsInfo;
+  descriptorSetLayout_ = device.createDescriptorSetLayout(layoutInfo);
+
+  vk::DescriptorPoolSize poolSize{vk::DescriptorType::eCombinedImageSampler, capacity_};
+  vk::DescriptorPoolCreateInfo poolInfo{{}, 1, poolSize};
+  descriptorPool_ = device.createDescriptorPool(poolInfo);
+
+  vk::DescriptorSetAllocateInfo allocInfo{descriptorPool_, descriptorSetLayout_};
+  descriptorSet_ = device.allocateDescriptorSets(allocInfo)[0];
+}
+
+void TextureManager::writeDescriptor(uint32_t index) {
+  // Textures are created while no frame is in flight (models load after waitIdle), so the
+  // set can be written directly. Cached secondaries bind the set across frames; a new
+  // texture changes the renderer's DrawRecordKey::textureCount, which drops them before they
+  // replay against the written set. Any other change to the table must change that key too.
+  vk::DescriptorImageInfo imageInfo = descriptorInfo(index);
+  vk::WriteDescriptorSet write{descriptorSet_, 0, index, vk::DescriptorType::eCombinedImageSampler,
+                               imageInfo};
+  context_->device().updateDescriptorSets(write, {});
+}
+
+uint32_t TextureManager::addTexture(GPUTexture &&tex) {
+  uint32_t index = static_cast<uint32_t>(textures_.size());
+  textureNameMap_[tex.name] = index;
+  textures_.push_back(std::move(tex));
+  writeDescriptor(index);
+  return index;
+}
+
 void TextureManager::destroy() {
   if (!context_) {
     return;
@@ -59,13 +105,22 @@ void TextureManager::destroy() {
     if (tex.image) {
       device.destroyImage(tex.image);
     }
-    if (tex.memory) {
-      device.freeMemory(tex.memory);
-    }
+    context_->allocator().free(tex.allocation);
   }
 
   textures_.clear();
   textureNameMap_.clear();
+
+  if (descriptorPool_) {
+    device.destroyDescriptorPool(descriptorPool_);
+    descriptorPool_ = nullptr;
+    descriptorSet_ = nullptr;
+  }
+  if (descriptorSetLayout_) {
+    device.destroyDescriptorSetLayout(descriptorSetLayout_);
+    descriptorSetLayout_ = nullptr;
+  }
+  capacity_ = 0;
   context_ = nullptr;
 }
 
@@ -396,24 +451,12 @@ uint32_t TextureManager::createTexture(const std::string &name, uint32_t width,
     return it->second;
   }
 
-  vk::Device device = context_->device();
-  vk::DeviceSize imageSize = width * height * 4;
-
-  vk::BufferCreateInfo bufferInfo{{}, imageSize, vk::BufferUsageFlagBits::eTransferSrc};
-  vk::Buffer stagingBuffer = device.createBuffer(bufferInfo);
-
-  vk::MemoryRequirements memRequirements = device.getBufferMemoryRequirements(stagingBuffer);
-  vk::MemoryAllocateInfo allocInfo{memRequirements.size,
-                                   findMemoryType(memRequirements.memoryTypeBits,
-                                                  vk::MemoryPropertyFlagBits::eHostVisible |
-                                                      vk::MemoryPropertyFlagBits::eHostCoherent)};
-
-  vk::DeviceMemory stagingMemory = device.allocateMemory(allocInfo);
-  device.bindBufferMemory(stagingBuffer, stagingMemory, 0);
+  // Table full: callers fall back to the default texture, as for a missing file
+  if (textures_.size() >= capacity_) {
+    return 0;
+  }
 
-  void *mapped = device.mapMemory(stagingMemory, 0, imageSize);
-  std::memcpy(mapped, data, static_cast<size_t>(imageSize));
-  device.unmapMemory(stagingMemory);
+  vk::DeviceSize imageSize = width * height * 4;
 
   GPUTexture tex;
   tex.name = name;
@@ -422,25 +465,14 @@ uint32_t TextureManager::createTexture(const std::string &name, uint32_t width,
 
   createImage(width, height, vk::Format::eR8G8B8A8Srgb, vk::ImageTiling::eOptimal,
               vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-              vk::MemoryPropertyFlagBits::eDeviceLocal, tex.image, tex.memory);
+              vk::MemoryPropertyFlagBits::eDeviceLocal, tex.image, tex.allocation);
 
-  transitionImageLayout(tex.image, vk::ImageLayout::eUndefined,
-                        vk::ImageLayout::eTransferDstOptimal);
-  copyBufferToImage(stagingBuffer, tex.image, width, height);
-  transitionImageLayout(tex.image, vk::ImageLayout::eTransferDstOptimal,
-                        vk::ImageLayout::eShaderReadOnlyOptimal);
-
-  device.destroyBuffer(stagingBuffer);
-  device.freeMemory(stagingMemory);
+  context_->uploader().uploadImage(tex.image, data, imageSize, width, height);
 
   tex.view = createImageView(tex.image, vk::Format::eR8G8B8A8Srgb);
   tex.sampler = createSampler();
 
-  uint32_t index = static_cast<uint32_t>(textures_.size());
-  textures_.push_back(std::move(tex));
-  textureNameMap_[name] = index;
-
-  return index;
+  return addTexture(std::move(tex));
 }
 
 uint32_t TextureManager::createTextureWithFormat(const std::string &name, uint32_t width,
@@ -455,23 +487,10 @@ uint32_t TextureManager::createTextureWithFormat(const std::string &name, uint32
     return it->second;
   }
 
-  vk::Device device = context_->device();
-
-  vk::BufferCreateInfo bufferInfo{{}, dataSize, vk::BufferUsageFlagBits::eTransferSrc};
-  vk::Buffer stagingBuffer = device.createBuffer(bufferInfo);
-
-  vk::MemoryRequirements memRequirements = device.getBufferMemoryRequirements(stagingBuffer);
-  vk::MemoryAllocateInfo allocInfo{memRequirements.size,
-                                   findMemoryType(memRequirements.memoryTypeBits,
-                                                  vk::MemoryPropertyFlagBits::eHostVisible |
-                                                      vk::MemoryPropertyFlagBits::eHostCoherent)};
-
-  vk::DeviceMemory stagingMemory = device.allocateMemory(allocInfo);
-  device.bindBufferMemory(stagingBuffer, stagingMemory, 0);
-
-  void *mapped = device.mapMemory(stagingMemory, 0, dataSize);
-  std::memcpy(mapped, data, dataSize);
-  device.unmapMemory(stagingMemory);
+  // Table full: callers fall back to the default texture, as for a missing file
+  if (textures_.size() >= capacity_) {
+    return 0;
+  }
 
   GPUTexture tex;
   tex.name = name;
@@ -480,25 +499,14 @@ uint32_t TextureManager::createTextureWithFormat(const std::string &name, uint32
 
   createImage(width, height, format, vk::ImageTiling::eOptimal,
               vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-              vk::MemoryPropertyFlagBits::eDeviceLocal, tex.image, tex.memory);
+              vk::MemoryPropertyFlagBits::eDeviceLocal, tex.image, tex.allocation);
 
-  transitionImageLayout(tex.image, vk::ImageLayout::eUndefined,
-                        vk::ImageLayout::eTransferDstOptimal);
-  copyBufferToImage(stagingBuffer, tex.image, width, height);
-  transitionImageLayout(tex.image, vk::ImageLayout::eTransferDstOptimal,
-                        vk::ImageLayout::eShaderReadOnlyOptimal);
-
-  device.destroyBuffer(stagingBuffer);
-  device.freeMemory(stagingMemory);
+  context_->uploader().uploadImage(tex.image, data, dataSize, width, height);
 
   tex.view = createImageView(tex.image, format);
   tex.sampler = createSampler();
 
-  uint32_t index = static_cast<uint32_t>(textures_.size());
-  textures_.push_back(std::move(tex));
-  textureNameMap_[name] = index;
-
-  return index;
+  return addTexture(std::move(tex));
 }
 
 const GPUTexture &TextureManager::texture(uint32_t index) const {
@@ -537,7 +545,7 @@ vk::DescriptorImageInfo TextureManager::descriptorInfo(uint32_t index) const {
 void TextureManager::createImage(uint32_t width, uint32_t height, vk::Format format,
                                  vk::ImageTiling tiling, vk::ImageUsageFlags usage,
                                  vk::MemoryPropertyFlags properties, vk::Image &image,
-                                 vk::DeviceMemory &memory) {
+                                 MemoryAllocation &allocation) {
   vk::Device device = context_->device();
 
   vk::ImageCreateInfo imageInfo{
@@ -553,14 +561,16 @@ void TextureManager::createImage(uint32_t width, uint32_t height, vk::Format for
       vk::SharingMode::eExclusive
   };
 
-  image = device.createImage(imageInfo);
-
-  vk::MemoryRequirements memRequirements = device.getImageMemoryRequirements(image);
-  vk::MemoryAllocateInfo allocInfo{memRequirements.size,
-                                   findMemoryType(memRequirements.memoryTypeBits, properties)};
+  // Textures are filled on the transfer queue and sampled on the graphics queue
+  const auto &sharingFamilies = context_->uploadSharingFamilies();
+  if (!sharingFamilies.empty()) {
+    imageInfo.sharingMode = vk::SharingMode::eConcurrent;
+    imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingFamilies.size());
+    imageInfo.pQueueFamilyIndices = sharingFamilies.data();
+  }
 
-  memory = device.allocateMemory(allocInfo);
-  device.bindImageMemory(image, memory, 0);
+  image = device.createImage(imageInfo);
+  allocation = context_->allocator().allocateForImage(image, properties);
 }
 
 vk::ImageView TextureManager::createImageView(vk::Image image, vk::Format format) {
@@ -597,72 +607,4 @@ vk::Sampler TextureManager::createSampler() {
   return context_->device().createSampler(samplerInfo);
 }
 
-void TextureManager::transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout,
-                                           vk::ImageLayout newLayout) {
-  vk::CommandBuffer cmd = context_->beginSingleTimeCommands();
-
-  vk::ImageMemoryBarrier barrier{
-      {},
-      {},
-      oldLayout,
-      newLayout,
-      VK_QUEUE_FAMILY_IGNORED,
-      VK_QUEUE_FAMILY_IGNORED,
-      image,
-      {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
-  };
-
-  vk::PipelineStageFlags srcStage;
-  vk::PipelineStageFlags dstStage;
-
-  if (oldLayout == vk::ImageLayout::eUndefined &&
-      newLayout == vk::ImageLayout::eTransferDstOptimal) {
-    barrier.srcAccessMask = {};
-    barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-    srcStage = vk::PipelineStageFlagBits::eTopOfPipe;
-    dstStage = vk::PipelineStageFlagBits::eTransfer;
-  } else if (oldLayout == vk::ImageLayout::eTransferDstOptimal &&
-             newLayout == vk::ImageLayout::eShaderReadOnlyOptimal) {
-    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-    srcStage = vk::PipelineStageFlagBits::eTransfer;
-    dstStage = vk::PipelineStageFlagBits::eFragmentShader;
-  } else {
-    throw std::runtime_error("Unsupported layout transition");
-  }
-
-  cmd.pipelineBarrier(srcStage, dstStage, {}, {}, {}, barrier);
-
-  context_->endSingleTimeCommands(cmd);
-}
-
-void TextureManager::copyBufferToImage(vk::Buffer buffer, vk::Image image, uint32_t width,
-                                       uint32_t height) {
-  vk::CommandBuffer cmd = context_->beginSingleTimeCommands();
-
-  vk::BufferImageCopy region{
-      0, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
-         {0, 0, 0},
-         {width, height, 1}
-  };
-
-  cmd.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
-
-  context_->endSingleTimeCommands(cmd);
-}
-
-uint32_t TextureManager::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) {
-  vk::PhysicalDeviceMemoryProperties memProperties =
-      context_->physicalDevice().getMemoryProperties();
-
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) &&
-        (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-      return i;
-    }
-  }
-
-  throw std::runtime_error("Failed to find suitable memory type");
-}
-
 } // namespace w3d::gfx
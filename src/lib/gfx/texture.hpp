@@ -1,5 +1,7 @@
 #pragma once
 
+#include "lib/gfx/memory_allocator.hpp"
+
 #include <vulkan/vulkan.hpp>
 
 #include <GLFW/glfw3.h>
@@ -24,7 +26,7 @@ namespace w3d::gfx {
 
 struct GPUTexture {
   vk::Image image;
-  vk::DeviceMemory memory;
+  MemoryAllocation allocation;
   vk::ImageView view;
   vk::Sampler sampler;
   uint32_t width = 0;
@@ -34,8 +36,14 @@ struct GPUTexture {
   bool valid() const { return image && view && sampler; }
 };
 
+// Owns every texture of the viewer and a bindless table of them: descriptor set 1 of the mesh
+// pipelines is one partially bound sampler2D[] array, and a draw selects its texture by index
+// (MaterialPushConstant::textureIndex). Entries are written as textures are created.
 class TextureManager {
 public:
+  // Upper bound on the table size; the device's per-stage sampler limit may lower it
+  static constexpr uint32_t MAX_TEXTURES = 4096;
+
   TextureManager() = default;
   ~TextureManager();
 
@@ -74,7 +82,16 @@ public:
 
   vk::DescriptorImageInfo descriptorInfo(uint32_t index) const;
 
+  // Bindless texture table (set 1 of the mesh pipelines), valid after init()
+  vk::DescriptorSetLayout descriptorSetLayout() const { return descriptorSetLayout_; }
+  vk::DescriptorSet descriptorSet() const { return descriptorSet_; }
+  uint32_t capacity() const { return capacity_; }
+
 private:
+  void createDescriptorTable();
+  void writeDescriptor(uint32_t index);
+  uint32_t addTexture(GPUTexture &&tex);
+
   std::filesystem::path resolveTexturePath(const std::string &w3dName);
 
   bool loadTGA(const std::filesystem::path &path, std::vector<uint8_t> &data, uint32_t &width,
@@ -85,23 +102,22 @@ private:
 
   void createImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling,
                    vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::Image &image,
-                   vk::DeviceMemory &memory);
+                   MemoryAllocation &allocation);
 
   vk::ImageView createImageView(vk::Image image, vk::Format format);
   vk::Sampler createSampler();
 
-  void transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout);
-
-  void copyBufferToImage(vk::Buffer buffer, vk::Image image, uint32_t width, uint32_t height);
-
-  uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties);
-
   VulkanContext *context_ = nullptr;
   std::filesystem::path texturePath_;
   std::vector<GPUTexture> textures_;
   std::unordered_map<std::string, uint32_t> textureNameMap_;
   big::AssetRegistry *assetRegistry_ = nullptr;
   big::BigArchiveManager *bigArchiveManager_ = nullptr;
+
+  vk::DescriptorSetLayout descriptorSetLayout_;
+  vk::DescriptorPool descriptorPool_;
+  vk::DescriptorSet descriptorSet_;
+  uint32_t capacity_ = 0;
 };
 
 } // namespace w3d::gfx
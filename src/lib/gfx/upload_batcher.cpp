@@ -0,0 +1,219 @@
+#include "lib/gfx/upload_batcher.hpp"
+#include "lib/gfx/vulkan_context.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace w3d::gfx {
+
+namespace {
+
+// Satisfies copyBufferToImage offset rules for every format the viewer uploads
+// (multiple of 4 and of the 8/16 byte BC block size)
+constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
+
+} // namespace
+
+UploadBatcher::~UploadBatcher() {
+  destroy();
+}
+
+void UploadBatcher::init(VulkanContext &context) {
+  context_ = &context;
+  device_ = context.device();
+  queue_ = context.transferQueue();
+
+  vk::CommandPoolCreateInfo poolInfo{vk::CommandPoolCreateFlagBits::eTransient,
+                                     context.transferQueueFamily()};
+  commandPool_ = device_.createCommandPool(poolInfo);
+
+  vk::CommandBufferAllocateInfo allocInfo{commandPool_, vk::CommandBufferLevel::ePrimary, 1};
+  commandBuffer_ = device_.allocateCommandBuffers(allocInfo)[0];
+
+  vk::SemaphoreTypeCreateInfo typeInfo{vk::SemaphoreType::eTimeline, 0};
+  vk::SemaphoreCreateInfo semaphoreInfo{};
+  semaphoreInfo.pNext = &typeInfo;
+  timeline_ = device_.createSemaphore(semaphoreInfo);
+  timelineValue_ = 0;
+}
+
+void UploadBatcher::destroy() {
+  if (device_) {
+    stagingChunks_.clear();
+    bufferCopies_.clear();
+    imageCopies_.clear();
+
+    if (timeline_) {
+      device_.destroySemaphore(timeline_);
+      timeline_ = nullptr;
+    }
+    if (commandPool_) {
+      device_.destroyCommandPool(commandPool_);
+      commandPool_ = nullptr;
+      commandBuffer_ = nullptr;
+    }
+    device_ = nullptr;
+    context_ = nullptr;
+    depth_ = 0;
+  }
+}
+
+void UploadBatcher::begin() {
+  ++depth_;
+}
+
+void UploadBatcher::flush() {
+  if (depth_ > 0 && --depth_ == 0) {
+    submit();
+  }
+}
+
+void UploadBatcher::cancel() {
+  if (depth_ > 0 && --depth_ == 0) {
+    bufferCopies_.clear();
+    imageCopies_.clear();
+    recycleStaging();
+  }
+}
+
+void UploadBatcher::uploadBuffer(vk::Buffer dst, const void *data, vk::DeviceSize size,
+                                 vk::DeviceSize dstOffset) {
+  if (size == 0) {
+    return;
+  }
+
+  Scope scope(*this);
+  StagingSlice slice = stage(data, size);
+  bufferCopies_.push_back({slice.buffer, dst, vk::BufferCopy{slice.offset, dstOffset, size}});
+  scope.flush();
+}
+
+void UploadBatcher::uploadImage(vk::Image dst, const void *data, vk::DeviceSize size,
+                                uint32_t width, uint32_t height) {
+  Scope scope(*this);
+  StagingSlice slice = stage(data, size);
+
+  vk::BufferImageCopy region{
+      slice.offset, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+         {0, 0, 0},
+         {width, height, 1}
+  };
+  imageCopies_.push_back({slice.buffer, dst, region});
+  scope.flush();
+}
+
+UploadBatcher::StagingSlice UploadBatcher::stage(const void *data, vk::DeviceSize size) {
+  chunkOffset_ = (chunkOffset_ + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+
+  // Move on to the next chunk (allocating one if needed) when the current one is full
+  while (currentChunk_ >= stagingChunks_.size() ||
+         chunkOffset_ + size > stagingChunks_[currentChunk_].size()) {
+    if (currentChunk_ < stagingChunks_.size()) {
+      ++currentChunk_;
+      chunkOffset_ = 0;
+      continue;
+    }
+
+    Buffer chunk;
+    chunk.create(*context_, std::max(STAGING_CHUNK_SIZE, size),
+                 vk::BufferUsageFlagBits::eTransferSrc,
+                 vk::MemoryPropertyFlagBits::eHostVisible |
+                     vk::MemoryPropertyFlagBits::eHostCoherent);
+    stagingChunks_.push_back(std::move(chunk));
+    chunkOffset_ = 0;
+  }
+
+  Buffer &chunk = stagingChunks_[currentChunk_];
+  std::memcpy(static_cast<uint8_t *>(chunk.map()) + chunkOffset_, data,
+              static_cast<size_t>(size));
+
+  StagingSlice slice{chunk.buffer(), chunkOffset_};
+  chunkOffset_ += size;
+  return slice;
+}
+
+void UploadBatcher::submit() {
+  if (bufferCopies_.empty() && imageCopies_.empty()) {
+    return;
+  }
+
+  device_.resetCommandPool(commandPool_);
+  commandBuffer_.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+  const vk::ImageSubresourceRange colorRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+
+  // One barrier moves every image into transfer-dst layout
+  std::vector<vk::ImageMemoryBarrier> barriers;
+  barriers.reserve(imageCopies_.size());
+  for (const auto &copy : imageCopies_) {
+    barriers.push_back({{},
+                        vk::AccessFlagBits::eTransferWrite,
+                        vk::ImageLayout::eUndefined,
+                        vk::ImageLayout::eTransferDstOptimal,
+                        VK_QUEUE_FAMILY_IGNORED,
+                        VK_QUEUE_FAMILY_IGNORED,
+                        copy.dst,
+                        colorRange});
+  }
+  if (!barriers.empty()) {
+    commandBuffer_.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                   vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, barriers);
+  }
+
+  for (const auto &copy : bufferCopies_) {
+    commandBuffer_.copyBuffer(copy.src, copy.dst, copy.region);
+  }
+  for (const auto &copy : imageCopies_) {
+    commandBuffer_.copyBufferToImage(copy.src, copy.dst, vk::ImageLayout::eTransferDstOptimal,
+                                     copy.region);
+  }
+
+  // One barrier moves every image into its sampling layout. The destination stage is left at
+  // bottom-of-pipe because a transfer queue can't name shader stages; visibility to the
+  // graphics queue comes from its wait on the timeline semaphore.
+  for (auto &barrier : barriers) {
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = {};
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+  }
+  if (!barriers.empty()) {
+    commandBuffer_.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, barriers);
+  }
+
+  commandBuffer_.end();
+
+  uint64_t signalValue = ++timelineValue_;
+  vk::TimelineSemaphoreSubmitInfo timelineInfo{{}, signalValue};
+  vk::SubmitInfo submitInfo{{}, {}, commandBuffer_, timeline_};
+  submitInfo.pNext = &timelineInfo;
+  queue_.submit(submitInfo);
+
+  // Loads are synchronous, so wait here; this also lets the staging arena be reused
+  vk::SemaphoreWaitInfo waitInfo{{}, timeline_, signalValue};
+  if (device_.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max()) !=
+      vk::Result::eSuccess) {
+    throw std::runtime_error("Timed out waiting for upload batch");
+  }
+
+  bufferCopies_.clear();
+  imageCopies_.clear();
+  recycleStaging();
+}
+
+void UploadBatcher::recycleStaging() {
+  // Keep one chunk of the default size for the next batch; oversized loads shouldn't pin
+  // staging memory, and a chunk grown for one large upload is dropped with the rest
+  if (stagingChunks_.size() > 1) {
+    stagingChunks_.resize(1);
+  }
+  if (!stagingChunks_.empty() && stagingChunks_[0].size() > STAGING_CHUNK_SIZE) {
+    stagingChunks_.clear();
+  }
+  currentChunk_ = 0;
+  chunkOffset_ = 0;
+}
+
+} // namespace w3d::gfx
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "lib/gfx/buffer.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace w3d::gfx {
+
+class VulkanContext;
+
+// Collects buffer and image uploads and submits them as one command buffer.
+// Source data is copied into a shared staging arena; at flush() all image layout transitions
+// are recorded as one barrier, followed by every copy and one closing barrier. The batch runs
+// on the dedicated transfer queue when the device has one and signals a timeline semaphore.
+//
+// Uploads issued outside begin()/flush() are submitted immediately as a batch of one.
+class UploadBatcher {
+public:
+  static constexpr vk::DeviceSize STAGING_CHUNK_SIZE = 16 * 1024 * 1024;
+
+  UploadBatcher() = default;
+  ~UploadBatcher();
+
+  UploadBatcher(const UploadBatcher &) = delete;
+  UploadBatcher &operator=(const UploadBatcher &) = delete;
+
+  void init(VulkanContext &context);
+  void destroy();
+
+  // Start collecting uploads (calls nest; only the outermost flush() submits)
+  void begin();
+
+  // Submit everything recorded since begin() and wait for the transfer to complete
+  void flush();
+
+  // Leave a begin() without submitting, e.g. when the load it bracketed failed. Leaving the
+  // outermost level drops every upload recorded since, as their targets may be gone.
+  void cancel();
+
+  // begin() for the lifetime of a scope. flush() submits; a scope left without it (by an
+  // exception) cancels, so the nesting depth always returns to where it was.
+  class Scope {
+  public:
+    explicit Scope(UploadBatcher &batcher) : batcher_(&batcher) { batcher_->begin(); }
+    ~Scope() {
+      if (batcher_) {
+        batcher_->cancel();
+      }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    void flush() {
+      UploadBatcher *batcher = std::exchange(batcher_, nullptr);
+      batcher->flush();
+    }
+
+  private:
+    UploadBatcher *batcher_;
+  };
+
+  // Copy data into dst at dstOffset. dst must have been created with eTransferDst usage.
+  void uploadBuffer(vk::Buffer dst, const void *data, vk::DeviceSize size,
+                    vk::DeviceSize dstOffset = 0);
+
+  // Fill mip 0 of a color image with tightly packed data.
+  // The image is transitioned from undefined to shader-read-only as part of the batch.
+  void uploadImage(vk::Image dst, const void *data, vk::DeviceSize size, uint32_t width,
+                   uint32_t height);
+
+  // Timeline semaphore signaled with lastSubmittedValue() when the latest batch completes.
+  // Graphics submissions wait on it so uploaded data is visible to that queue.
+  vk::Semaphore timelineSemaphore() const { return timeline_; }
+  uint64_t lastSubmittedValue() const { return timelineValue_; }
+
+  bool batching() const { return depth_ > 0; }
+
+private:
+  struct BufferCopy {
+    vk::Buffer src;
+    vk::Buffer dst;
+    vk::BufferCopy region;
+  };
+
+  struct ImageCopy {
+    vk::Buffer src;
+    vk::Image dst;
+    vk::BufferImageCopy region;
+  };
+
+  struct StagingSlice {
+    vk::Buffer buffer;
+    vk::DeviceSize offset;
+  };
+
+  StagingSlice stage(const void *data, vk::DeviceSize size);
+  void submit();
+
+  // Rewind the staging arena for the next batch
+  void recycleStaging();
+
+  VulkanContext *context_ = nullptr;
+  vk::Device device_;
+  vk::Queue queue_;
+  vk::CommandPool commandPool_;
+  vk::CommandBuffer commandBuffer_;
+  vk::Semaphore timeline_;
+  uint64_t timelineValue_ = 0;
+
+  // Staging arena: chunks are filled front to back and recycled after each submit
+  std::vector<Buffer> stagingChunks_;
+  size_t currentChunk_ = 0;
+  vk::DeviceSize chunkOffset_ = 0;
+
+  std::vector<BufferCopy> bufferCopies_;
+  std::vector<ImageCopy> imageCopies_;
+  int depth_ = 0;
+};
+
+} // namespace w3d::gfx
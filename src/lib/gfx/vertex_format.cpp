@@ -0,0 +1,180 @@
+#include "lib/gfx/vertex_format.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace w3d::gfx {
+
+namespace {
+
+constexpr float UNORM16_MAX = 65535.0f;
+constexpr float SNORM16_MAX = 32767.0f;
+
+constexpr std::array<const char *, VERTEX_FORMAT_COUNT> FORMAT_NAMES = {"full", "compact",
+                                                                        "quantized"};
+
+uint32_t packSnorm16(float value) {
+  float scaled = std::round(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX);
+  return static_cast<uint16_t>(static_cast<int16_t>(scaled));
+}
+
+// As the GPU converts snorm: -32768 and -32767 both decode to -1
+float unpackSnorm16(uint32_t lane) {
+  auto value = static_cast<int16_t>(static_cast<uint16_t>(lane));
+  return std::max(static_cast<float>(value) / SNORM16_MAX, -1.0f);
+}
+
+float signNotZero(float value) {
+  return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+} // namespace
+
+const char *vertexFormatName(VertexFormat format) {
+  auto index = static_cast<uint32_t>(format);
+  return index < VERTEX_FORMAT_COUNT ? FORMAT_NAMES[index] : "unknown";
+}
+
+std::optional<VertexFormat> parseVertexFormat(std::string_view name) {
+  for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; ++i) {
+    if (name == FORMAT_NAMES[i]) {
+      return static_cast<VertexFormat>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+PositionQuantization PositionQuantization::fromBounds(const BoundingBox &bounds) {
+  PositionQuantization quantization;
+  if (bounds.valid()) {
+    quantization.offset = bounds.min;
+    quantization.scale = bounds.size();
+  }
+  return quantization;
+}
+
+std::array<uint16_t, 3> PositionQuantization::quantize(const glm::vec3 &position) const {
+  std::array<uint16_t, 3> lanes{};
+  for (int axis = 0; axis < 3; ++axis) {
+    if (scale[axis] <= 0.0f) {
+      continue;
+    }
+    float unit = std::clamp((position[axis] - offset[axis]) / scale[axis], 0.0f, 1.0f);
+    lanes[axis] = static_cast<uint16_t>(std::lround(unit * UNORM16_MAX));
+  }
+  return lanes;
+}
+
+glm::vec3 PositionQuantization::dequantize(const std::array<uint16_t, 3> &lanes) const {
+  glm::vec3 unit{static_cast<float>(lanes[0]), static_cast<float>(lanes[1]),
+                 static_cast<float>(lanes[2])};
+  return offset + unit / UNORM16_MAX * scale;
+}
+
+uint32_t packOctNormal(const glm::vec3 &normal) {
+  // Project onto the octahedron |x| + |y| + |z| = 1, folding the lower hemisphere over
+  // the upper one
+  float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (sum <= 0.0f) {
+    return 0; // Decodes to +Z
+  }
+  glm::vec2 oct = glm::vec2(normal) / sum;
+  if (normal.z < 0.0f) {
+    oct = glm::vec2((1.0f - std::abs(oct.y)) * signNotZero(oct.x),
+                    (1.0f - std::abs(oct.x)) * signNotZero(oct.y));
+  }
+  return packSnorm16(oct.x) | (packSnorm16(oct.y) << 16);
+}
+
+glm::vec3 unpackOctNormal(uint32_t packed) {
+  // Mirrors octDecode() in the mesh vertex shaders
+  glm::vec3 n{unpackSnorm16(packed), unpackSnorm16(packed >> 16), 0.0f};
+  n.z = 1.0f - std::abs(n.x) - std::abs(n.y);
+  float fold = std::max(-n.z, 0.0f);
+  n.x += n.x >= 0.0f ? -fold : fold;
+  n.y += n.y >= 0.0f ? -fold : fold;
+  return glm::normalize(n);
+}
+
+uint16_t packHalf(float value) {
+  auto bits = std::bit_cast<uint32_t>(value);
+  auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+  uint32_t exponent = (bits >> 23) & 0xFFu;
+  uint32_t mantissa = bits & 0x7FFFFFu;
+
+  if (exponent == 0xFFu) {
+    // Infinity stays infinity, NaN stays a (quiet) NaN
+    return sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u);
+  }
+
+  int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+  if (halfExponent >= 31) {
+    return sign | 0x7C00u; // Too large: infinity
+  }
+
+  uint32_t half = 0;
+  uint32_t shift = 13;
+  if (halfExponent <= 0) {
+    // Subnormal half: shift the mantissa, with its implicit bit, into place
+    if (halfExponent < -10) {
+      return sign; // Below half the smallest subnormal: zero
+    }
+    mantissa |= 0x800000u;
+    shift = static_cast<uint32_t>(14 - halfExponent);
+    half = mantissa >> shift;
+  } else {
+    half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> shift);
+  }
+
+  // Round to nearest even; a carry out of the mantissa correctly bumps the exponent
+  uint32_t remainder = mantissa & ((1u << shift) - 1);
+  uint32_t halfway = 1u << (shift - 1);
+  if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+    ++half;
+  }
+  return static_cast<uint16_t>(sign | half);
+}
+
+float unpackHalf(uint16_t half) {
+  uint32_t sign = (static_cast<uint32_t>(half) & 0x8000u) << 16;
+  uint32_t exponent = (half >> 10) & 0x1Fu;
+  uint32_t mantissa = half & 0x3FFu;
+
+  if (exponent == 0) {
+    float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -magnitude : magnitude;
+  }
+  if (exponent == 31) {
+    return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+  }
+  return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint32_t packHalf2(const glm::vec2 &value) {
+  return packHalf(value.x) | (static_cast<uint32_t>(packHalf(value.y)) << 16);
+}
+
+glm::vec2 unpackHalf2(uint32_t packed) {
+  return {unpackHalf(static_cast<uint16_t>(packed)),
+          unpackHalf(static_cast<uint16_t>(packed >> 16))};
+}
+
+uint32_t packColor(const glm::vec3 &color, uint8_t alpha) {
+  uint32_t packed = static_cast<uint32_t>(alpha) << 24;
+  for (int i = 0; i < 3; ++i) {
+    auto channel = static_cast<uint32_t>(std::lround(std::clamp(color[i], 0.0f, 1.0f) * 255.0f));
+    packed |= channel << (8 * i);
+  }
+  return packed;
+}
+
+glm::vec3 unpackColor(uint32_t packed) {
+  glm::vec3 color;
+  for (int i = 0; i < 3; ++i) {
+    color[i] = static_cast<float>((packed >> (8 * i)) & 0xFFu) / 255.0f;
+  }
+  return color;
+}
+
+} // namespace w3d::gfx
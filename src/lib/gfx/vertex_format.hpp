@@ -0,0 +1,113 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "lib/gfx/bounding_box.hpp"
+
+namespace w3d::gfx {
+
+// Layout of mesh vertices in GPU memory. Full keeps every attribute as 32-bit floats. The
+// compact formats store the normal octahedral-encoded in two 16-bit snorms, the UV as two
+// half floats and the color as RGBA8; Quantized also stores the position as 16-bit unorms
+// spanning the bounds of the vertex set. Skinned vertices of the compact formats keep their
+// bone index in the color's alpha byte.
+enum class VertexFormat : uint32_t {
+  Full = 0,     // 44 bytes, 48 skinned
+  Compact = 1,  // 24 bytes
+  Quantized = 2 // 20 bytes
+};
+
+constexpr uint32_t VERTEX_FORMAT_COUNT = 3;
+
+// Highest bone index the compact formats can store. Skinned sets referencing a higher bone
+// are kept in the full format.
+constexpr uint32_t COMPACT_MAX_BONE = 255;
+
+const char *vertexFormatName(VertexFormat format);
+
+// Format named by vertexFormatName(), or nullopt for an unknown name
+std::optional<VertexFormat> parseVertexFormat(std::string_view name);
+
+// Bytes per vertex
+constexpr uint32_t vertexStride(VertexFormat format, bool skinned) {
+  switch (format) {
+  case VertexFormat::Compact:
+    return 24;
+  case VertexFormat::Quantized:
+    return 20;
+  default:
+    return skinned ? 48 : 44;
+  }
+}
+
+// Maps 16-bit unorm position lanes to model space: position = offset + lane / 65535 * scale.
+// The default is the identity, which float positions are decoded with.
+struct PositionQuantization {
+  glm::vec3 offset{0.0f};
+  glm::vec3 scale{1.0f};
+
+  // Lanes spanning the box. A flat axis gets scale 0 and decodes exactly.
+  static PositionQuantization fromBounds(const BoundingBox &bounds);
+
+  // Positions outside the box are clamped to it
+  std::array<uint16_t, 3> quantize(const glm::vec3 &position) const;
+  glm::vec3 dequantize(const std::array<uint16_t, 3> &lanes) const;
+
+  // Largest distance per axis between a position inside the box and its decoded lanes
+  glm::vec3 maxError() const { return scale / (2.0f * 65535.0f); }
+};
+
+// How an uploaded vertex set is stored: what pipelines and shaders need to read it
+struct VertexEncoding {
+  VertexFormat format = VertexFormat::Full;
+  PositionQuantization quantization; // Identity unless Quantized
+};
+
+// Octahedral encoding of a unit normal into two snorm16 lanes (x in the low half)
+uint32_t packOctNormal(const glm::vec3 &normal);
+glm::vec3 unpackOctNormal(uint32_t packed);
+
+// IEEE half float, rounded to nearest even
+uint16_t packHalf(float value);
+float unpackHalf(uint16_t half);
+
+// Two half floats (x in the low half)
+uint32_t packHalf2(const glm::vec2 &value);
+glm::vec2 unpackHalf2(uint32_t packed);
+
+// RGBA8 unorm (red in the low byte); components are clamped to [0, 1]
+uint32_t packColor(const glm::vec3 &color, uint8_t alpha);
+glm::vec3 unpackColor(uint32_t packed);
+
+struct CompactVertex {
+  glm::vec3 position;
+  uint32_t normal;   // packOctNormal
+  uint32_t texCoord; // packHalf2
+  uint32_t color;    // packColor; alpha is the bone index of skinned vertices
+};
+
+struct QuantizedVertex {
+  std::array<uint16_t, 4> position; // PositionQuantization lanes, w unused
+  uint32_t normal;
+  uint32_t texCoord;
+  uint32_t color;
+};
+
+static_assert(sizeof(CompactVertex) == 24, "CompactVertex must be tightly packed");
+static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex must be tightly packed");
+
+// Vertices in a format's byte layout, ready for upload
+struct EncodedVertices {
+  VertexEncoding encoding;
+  uint32_t stride = 0;
+  uint32_t count = 0;
+  std::vector<uint8_t> data;
+};
+
+} // namespace w3d::gfx
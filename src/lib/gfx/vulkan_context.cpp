@@ -1,5 +1,7 @@
 #include "lib/gfx/vulkan_context.hpp"
 
+#include "lib/gfx/buffer.hpp"
+
 #include <algorithm>
 #include <iostream>
 #include <set>
@@ -34,12 +36,33 @@ void VulkanContext::init(GLFWwindow *window, bool enableValidation) {
   createSurface(window);
   pickPhysicalDevice();
   createLogicalDevice();
+  allocator_.init(physicalDevice_, device_);
+  pipelineCache_.init(physicalDevice_, device_, pipelineCacheFile_);
   createSwapchain(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
   createImageViews();
   createDepthResources();
   createRenderPass();
   createFramebuffers();
   createCommandPool();
+  uploader_.init(*this);
+}
+
+void VulkanContext::initHeadless(uint32_t width, uint32_t height, bool enableValidation) {
+  validationEnabled_ = enableValidation;
+  headless_ = true;
+
+  createInstance(enableValidation);
+  pickPhysicalDevice();
+  createLogicalDevice();
+  allocator_.init(physicalDevice_, device_);
+  pipelineCache_.init(physicalDevice_, device_, pipelineCacheFile_);
+  createOffscreenImages(width, height);
+  createImageViews();
+  createDepthResources();
+  createRenderPass();
+  createFramebuffers();
+  createCommandPool();
+  uploader_.init(*this);
 }
 
 void VulkanContext::cleanup() {
@@ -58,6 +81,10 @@ void VulkanContext::cleanup() {
       commandPool_ = nullptr;
     }
 
+    uploader_.destroy();
+    pipelineCache_.destroy();
+    allocator_.destroy();
+
     device_.destroy();
     device_ = nullptr;
   }
@@ -96,16 +123,24 @@ void VulkanContext::cleanupSwapchain() {
     device_.destroyImage(depthImage_);
     depthImage_ = nullptr;
   }
-  if (depthImageMemory_) {
-    device_.freeMemory(depthImageMemory_);
-    depthImageMemory_ = nullptr;
-  }
+  allocator_.free(depthImageAllocation_);
 
   for (auto imageView : swapchainImageViews_) {
     device_.destroyImageView(imageView);
   }
   swapchainImageViews_.clear();
 
+  if (headless_) {
+    for (auto image : swapchainImages_) {
+      device_.destroyImage(image);
+    }
+    for (auto &allocation : offscreenAllocations_) {
+      allocator_.free(allocation);
+    }
+    offscreenAllocations_.clear();
+  }
+  swapchainImages_.clear();
+
   if (swapchain_) {
     device_.destroySwapchainKHR(swapchain_);
     swapchain_ = nullptr;
@@ -114,7 +149,11 @@ void VulkanContext::cleanupSwapchain() {
 
 void VulkanContext::recreateSwapchain(uint32_t width, uint32_t height) {
   cleanupSwapchain();
-  createSwapchain(width, height);
+  if (headless_) {
+    createOffscreenImages(width, height);
+  } else {
+    createSwapchain(width, height);
+  }
   createImageViews();
   createDepthResources();
   createFramebuffers();
@@ -124,13 +163,16 @@ void VulkanContext::createInstance(bool enableValidation) {
   vk::ApplicationInfo appInfo{"W3D Viewer", VK_MAKE_VERSION(1, 0, 0), "W3D Engine",
                               VK_MAKE_VERSION(1, 0, 0), VK_API_VERSION_1_2};
 
-  uint32_t glfwExtensionCount = 0;
-  const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-  if (!glfwExtensions) {
-    throw std::runtime_error("Failed to get required GLFW extensions");
+  // Headless contexts present nothing, so they need no surface extensions (and no GLFW)
+  std::vector<const char *> extensions;
+  if (!headless_) {
+    uint32_t glfwExtensionCount = 0;
+    const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    if (!glfwExtensions) {
+      throw std::runtime_error("Failed to get required GLFW extensions");
+    }
+    extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
   }
-
-  std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
   std::vector<const char *> layers;
 
   if (enableValidation) {
@@ -203,16 +245,29 @@ bool VulkanContext::isDeviceSuitable(vk::PhysicalDevice device) {
   if (!indices.isComplete())
     return false;
 
-  auto extensions = device.enumerateDeviceExtensionProperties();
-  std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
-  for (const auto &ext : extensions) {
-    requiredExtensions.erase(ext.extensionName);
+  if (!headless_) {
+    auto extensions = device.enumerateDeviceExtensionProperties();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    for (const auto &ext : extensions) {
+      requiredExtensions.erase(ext.extensionName);
+    }
+    if (!requiredExtensions.empty())
+      return false;
+
+    auto swapchainSupport = querySwapchainSupport(device);
+    if (swapchainSupport.formats.empty() || swapchainSupport.presentModes.empty()) {
+      return false;
+    }
   }
-  if (!requiredExtensions.empty())
-    return false;
 
-  auto swapchainSupport = querySwapchainSupport(device);
-  if (swapchainSupport.formats.empty() || swapchainSupport.presentModes.empty()) {
+  // Upload batches signal completion with a timeline semaphore; textures are sampled from one
+  // partially bound descriptor array, indexed by a push constant
+  auto features =
+      device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+  const auto &core = features.get<vk::PhysicalDeviceFeatures2>().features;
+  const auto &vulkan12 = features.get<vk::PhysicalDeviceVulkan12Features>();
+  if (!core.shaderSampledImageArrayDynamicIndexing || !vulkan12.timelineSemaphore ||
+      !vulkan12.runtimeDescriptorArray || !vulkan12.descriptorBindingPartiallyBound) {
     return false;
   }
 
@@ -229,7 +284,9 @@ QueueFamilyIndices VulkanContext::findQueueFamilies(vk::PhysicalDevice device) {
       indices.graphicsFamily = i;
     }
 
-    if (device.getSurfaceSupportKHR(i, surface_)) {
+    // Without a surface nothing is presented; the graphics family stands in
+    if (surface_ ? device.getSurfaceSupportKHR(i, surface_)
+                 : static_cast<bool>(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)) {
       indices.presentFamily = i;
     }
 
@@ -238,6 +295,21 @@ QueueFamilyIndices VulkanContext::findQueueFamilies(vk::PhysicalDevice device) {
     i++;
   }
 
+  // Prefer a pure DMA family (transfer only), else any transfer family without graphics
+  for (i = 0; i < queueFamilies.size(); ++i) {
+    auto flags = queueFamilies[i].queueFlags;
+    if (!(flags & vk::QueueFlagBits::eTransfer) || (flags & vk::QueueFlagBits::eGraphics)) {
+      continue;
+    }
+    if (!(flags & vk::QueueFlagBits::eCompute)) {
+      indices.transferFamily = i;
+      break;
+    }
+    if (!indices.transferFamily) {
+      indices.transferFamily = i;
+    }
+  }
+
   return indices;
 }
 
@@ -246,7 +318,8 @@ void VulkanContext::createLogicalDevice() {
 
   std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
   std::set<uint32_t> uniqueQueueFamilies = {queueFamilies_.graphicsFamily.value(),
-                                            queueFamilies_.presentFamily.value()};
+                                            queueFamilies_.presentFamily.value(),
+                                            transferQueueFamily()};
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -261,12 +334,64 @@ void VulkanContext::createLogicalDevice() {
     deviceFeatures.samplerAnisotropy = VK_TRUE;
   }
 
-  vk::DeviceCreateInfo createInfo{{}, queueCreateInfos, {}, deviceExtensions, &deviceFeatures};
+  // basic.frag indexes the bindless texture array with the material's push constant
+  // (required by isDeviceSuitable)
+  deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+  // Lets a texture batch of indirect draws go out as one vkCmdDrawIndexedIndirect
+  multiDrawIndirect_ = supportedFeatures.multiDrawIndirect;
+  deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+
+  // Optional per-pass invocation counts in the GPU profiler
+  pipelineStatisticsQuery_ = supportedFeatures.pipelineStatisticsQuery;
+  deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+  // GPU picking writes gl_PrimitiveID from the fragment shader, which needs this feature
+  fragmentPrimitiveId_ = supportedFeatures.geometryShader;
+  deviceFeatures.geometryShader = supportedFeatures.geometryShader;
+
+  // Lets culled draw lists be consumed with a GPU-written draw count
+  auto supportedChain = physicalDevice_.getFeatures2<vk::PhysicalDeviceFeatures2,
+                                                     vk::PhysicalDeviceVulkan12Features>();
+  drawIndirectCount_ = supportedChain.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount;
+
+  vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+  vulkan12Features.timelineSemaphore = VK_TRUE;
+  vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+  vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+  vulkan12Features.drawIndirectCount = drawIndirectCount_;
+
+  std::vector<const char *> extensions;
+  if (!headless_) {
+    extensions.assign(deviceExtensions.begin(), deviceExtensions.end());
+  }
+
+  vk::DeviceCreateInfo createInfo{{}, queueCreateInfos, {}, extensions, &deviceFeatures};
+  createInfo.pNext = &vulkan12Features;
 
   device_ = physicalDevice_.createDevice(createInfo);
 
   graphicsQueue_ = device_.getQueue(queueFamilies_.graphicsFamily.value(), 0);
   presentQueue_ = device_.getQueue(queueFamilies_.presentFamily.value(), 0);
+  transferQueue_ = device_.getQueue(transferQueueFamily(), 0);
+
+  // GPU frame timing needs timestamps on the graphics queue
+  auto limits = physicalDevice_.getProperties().limits;
+  auto families = physicalDevice_.getQueueFamilyProperties();
+  timestampValidBits_ = families[queueFamilies_.graphicsFamily.value()].timestampValidBits;
+  bool timestamps = limits.timestampComputeAndGraphics || timestampValidBits_ > 0;
+  timestampPeriod_ = timestamps ? limits.timestampPeriod : 0.0f;
+  if (timestamps && timestampValidBits_ == 0) {
+    timestampValidBits_ = 64; // timestampComputeAndGraphics without a reported width
+  }
+
+  // Uploads run on the transfer queue and are read on the graphics queue; sharing the
+  // resources concurrently avoids queue family ownership transfers
+  uploadSharingFamilies_.clear();
+  if (hasDedicatedTransferQueue()) {
+    uploadSharingFamilies_ = {queueFamilies_.graphicsFamily.value(),
+                              queueFamilies_.transferFamily.value()};
+  }
 }
 
 SwapchainSupportDetails VulkanContext::querySwapchainSupport(vk::PhysicalDevice device) {
@@ -353,6 +478,32 @@ void VulkanContext::createSwapchain(uint32_t width, uint32_t height) {
   swapchainExtent_ = extent;
 }
 
+void VulkanContext::createOffscreenImages(uint32_t width, uint32_t height) {
+  // RGBA so a read back image needs no swizzle; copied out after the render pass
+  swapchainImageFormat_ = vk::Format::eR8G8B8A8Unorm;
+  swapchainExtent_ = vk::Extent2D{width, height};
+
+  vk::ImageCreateInfo imageInfo{
+      {},
+      vk::ImageType::e2D,
+      swapchainImageFormat_,
+      {width, height, 1},
+      1,
+      1,
+      vk::SampleCountFlagBits::e1,
+      vk::ImageTiling::eOptimal,
+      vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+      vk::SharingMode::eExclusive
+  };
+
+  for (uint32_t i = 0; i < OFFSCREEN_IMAGE_COUNT; ++i) {
+    vk::Image image = device_.createImage(imageInfo);
+    offscreenAllocations_.push_back(
+        allocator_.allocateForImage(image, vk::MemoryPropertyFlagBits::eDeviceLocal));
+    swapchainImages_.push_back(image);
+  }
+}
+
 void VulkanContext::createImageViews() {
   swapchainImageViews_.resize(swapchainImages_.size());
 
@@ -408,13 +559,8 @@ void VulkanContext::createDepthResources() {
 
   depthImage_ = device_.createImage(imageInfo);
 
-  auto memRequirements = device_.getImageMemoryRequirements(depthImage_);
-  vk::MemoryAllocateInfo allocInfo{
-      memRequirements.size,
-      findMemoryType(memRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal)};
-
-  depthImageMemory_ = device_.allocateMemory(allocInfo);
-  device_.bindImageMemory(depthImage_, depthImageMemory_, 0);
+  depthImageAllocation_ =
+      allocator_.allocateForImage(depthImage_, vk::MemoryPropertyFlagBits::eDeviceLocal);
 
   vk::ImageViewCreateInfo viewInfo{
       {},
@@ -435,7 +581,8 @@ void VulkanContext::createRenderPass() {
                                             vk::AttachmentLoadOp::eDontCare,
                                             vk::AttachmentStoreOp::eDontCare,
                                             vk::ImageLayout::eUndefined,
-                                            vk::ImageLayout::ePresentSrcKHR};
+                                            headless_ ? vk::ImageLayout::eTransferSrcOptimal
+                                                      : vk::ImageLayout::ePresentSrcKHR};
 
   vk::AttachmentDescription depthAttachment{{},
                                             depthFormat_,
@@ -464,9 +611,22 @@ void VulkanContext::createRenderPass() {
                                    vk::AccessFlagBits::eColorAttachmentWrite |
                                        vk::AccessFlagBits::eDepthStencilAttachmentWrite};
 
+  // Offscreen images are copied out after the pass, so make the color writes visible to it
+  vk::SubpassDependency readbackDependency{0,
+                                           VK_SUBPASS_EXTERNAL,
+                                           vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                           vk::PipelineStageFlagBits::eTransfer,
+                                           vk::AccessFlagBits::eColorAttachmentWrite,
+                                           vk::AccessFlagBits::eTransferRead};
+
+  std::vector<vk::SubpassDependency> dependencies = {dependency};
+  if (headless_) {
+    dependencies.push_back(readbackDependency);
+  }
+
   std::array<vk::AttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
 
-  vk::RenderPassCreateInfo renderPassInfo{{}, attachments, subpass, dependency};
+  vk::RenderPassCreateInfo renderPassInfo{{}, attachments, subpass, dependencies};
 
   renderPass_ = device_.createRenderPass(renderPassInfo);
 }
@@ -526,4 +686,38 @@ void VulkanContext::endSingleTimeCommands(vk::CommandBuffer commandBuffer) {
   device_.freeCommandBuffers(commandPool_, commandBuffer);
 }
 
+std::vector<uint8_t> VulkanContext::readOffscreenImage(uint32_t index) {
+  if (!headless_ || index >= swapchainImages_.size()) {
+    throw std::runtime_error("No offscreen image to read back");
+  }
+
+  // The last frame rendered into the image must be complete
+  device_.waitIdle();
+
+  vk::DeviceSize size = vk::DeviceSize{swapchainExtent_.width} * swapchainExtent_.height * 4;
+  Buffer staging;
+  staging.create(*this, size, vk::BufferUsageFlagBits::eTransferDst,
+                 vk::MemoryPropertyFlagBits::eHostVisible |
+                     vk::MemoryPropertyFlagBits::eHostCoherent);
+
+  // The render pass leaves the image in TRANSFER_SRC_OPTIMAL
+  vk::BufferImageCopy region{0, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {0, 0, 0},
+                             {swapchainExtent_.width, swapchainExtent_.height, 1}};
+
+  vk::CommandBuffer cmd = beginSingleTimeCommands();
+  cmd.copyImageToBuffer(swapchainImages_[index], vk::ImageLayout::eTransferSrcOptimal,
+                        staging.buffer(), region);
+
+  // Make the copy visible to host reads of the mapped staging memory
+  vk::MemoryBarrier hostRead{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+  cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+                      hostRead, {}, {});
+  endSingleTimeCommands(cmd);
+
+  const auto *pixels = static_cast<const uint8_t *>(staging.map());
+  std::vector<uint8_t> rgba(pixels, pixels + size);
+  staging.destroy();
+  return rgba;
+}
+
 } // namespace w3d::gfx
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "lib/gfx/memory_allocator.hpp"
+#include "lib/gfx/pipeline_cache.hpp"
+#include "lib/gfx/upload_batcher.hpp"
+
 #include <vulkan/vulkan.hpp>
 
 #include <GLFW/glfw3.h>
@@ -7,6 +11,8 @@
 #include <glm/glm.hpp>
 
 #include <array>
+#include <cstdint>
+#include <filesystem>
 #include <optional>
 #include <string>
 #include <vector>
@@ -18,6 +24,7 @@ class VulkanContext;
 struct QueueFamilyIndices {
   std::optional<uint32_t> graphicsFamily;
   std::optional<uint32_t> presentFamily;
+  std::optional<uint32_t> transferFamily; // Transfer-capable family without graphics, if any
 
   bool isComplete() const { return graphicsFamily.has_value() && presentFamily.has_value(); }
 };
@@ -36,7 +43,14 @@ public:
   VulkanContext(const VulkanContext &) = delete;
   VulkanContext &operator=(const VulkanContext &) = delete;
 
+  // File the pipeline cache is loaded from at init and saved to at cleanup (empty: none).
+  // Must be set before init.
+  void setPipelineCacheFile(const std::filesystem::path &file) { pipelineCacheFile_ = file; }
+
   void init(GLFWwindow *window, bool enableValidation = true);
+  // Without a window or surface: frames render into OFFSCREEN_IMAGE_COUNT color images that
+  // stand in for the swapchain images and can be read back
+  void initHeadless(uint32_t width, uint32_t height, bool enableValidation = true);
   void cleanup();
 
   void recreateSwapchain(uint32_t width, uint32_t height);
@@ -48,6 +62,7 @@ public:
   vk::Queue presentQueue() const { return presentQueue_; }
   vk::SurfaceKHR surface() const { return surface_; }
   vk::SwapchainKHR swapchain() const { return swapchain_; }
+  bool headless() const { return headless_; }
   vk::Format swapchainImageFormat() const { return swapchainImageFormat_; }
   vk::Extent2D swapchainExtent() const { return swapchainExtent_; }
   const std::vector<vk::ImageView> &swapchainImageViews() const { return swapchainImageViews_; }
@@ -57,7 +72,30 @@ public:
   vk::Format depthFormat() const { return depthFormat_; }
   vk::CommandPool commandPool() const { return commandPool_; }
   uint32_t graphicsQueueFamily() const { return queueFamilies_.graphicsFamily.value(); }
+  vk::Queue transferQueue() const { return transferQueue_; }
+  uint32_t transferQueueFamily() const {
+    return queueFamilies_.transferFamily.value_or(queueFamilies_.graphicsFamily.value());
+  }
+  bool multiDrawIndirect() const { return multiDrawIndirect_; }
+  bool drawIndirectCount() const { return drawIndirectCount_; }
+  // Nanoseconds per timestamp tick, or 0 when the graphics queue cannot write timestamps
+  float timestampPeriod() const { return timestampPeriod_; }
+  // Bits of a graphics queue timestamp that count; the counter wraps above them
+  uint32_t timestampValidBits() const { return timestampValidBits_; }
+  // Vertex and fragment invocation counts can be queried
+  bool pipelineStatisticsQuery() const { return pipelineStatisticsQuery_; }
+  // Fragment shaders can read gl_PrimitiveID (GPU picking)
+  bool fragmentPrimitiveId() const { return fragmentPrimitiveId_; }
+  bool hasDedicatedTransferQueue() const { return queueFamilies_.transferFamily.has_value(); }
+  // Families that upload targets must be shared between (empty without a transfer queue)
+  const std::vector<uint32_t> &uploadSharingFamilies() const { return uploadSharingFamilies_; }
   vk::RenderPass renderPass() const { return renderPass_; }
+  DeviceMemoryAllocator &allocator() { return allocator_; }
+  UploadBatcher &uploader() { return uploader_; }
+  // Shared by every pipeline the viewer creates
+  vk::PipelineCache pipelineCache() const { return pipelineCache_.handle(); }
+  // Bytes of pipeline cache data loaded from disk at init (0: started cold)
+  size_t pipelineCacheLoadedSize() const { return pipelineCache_.loadedSize(); }
   vk::Framebuffer framebuffer(uint32_t index) const { return framebuffers_[index]; }
 
   vk::CommandBuffer beginSingleTimeCommands();
@@ -65,12 +103,19 @@ public:
 
   uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties);
 
+  // Copy an offscreen color image (headless only) to tightly packed RGBA8 rows, top to bottom.
+  // Waits for the device to go idle first.
+  std::vector<uint8_t> readOffscreenImage(uint32_t index);
+
+  static constexpr uint32_t OFFSCREEN_IMAGE_COUNT = 2;
+
 private:
   void createInstance(bool enableValidation);
   void createSurface(GLFWwindow *window);
   void pickPhysicalDevice();
   void createLogicalDevice();
   void createSwapchain(uint32_t width, uint32_t height);
+  void createOffscreenImages(uint32_t width, uint32_t height);
   void createImageViews();
   void createDepthResources();
   void createRenderPass();
@@ -97,16 +142,23 @@ private:
   vk::Device device_;
   vk::Queue graphicsQueue_;
   vk::Queue presentQueue_;
+  vk::Queue transferQueue_;
   QueueFamilyIndices queueFamilies_;
+  std::vector<uint32_t> uploadSharingFamilies_;
+  DeviceMemoryAllocator allocator_;
+  UploadBatcher uploader_;
+  PipelineCache pipelineCache_;
+  std::filesystem::path pipelineCacheFile_;
 
   vk::SwapchainKHR swapchain_;
   std::vector<vk::Image> swapchainImages_;
   std::vector<vk::ImageView> swapchainImageViews_;
   vk::Format swapchainImageFormat_;
   vk::Extent2D swapchainExtent_;
+  std::vector<MemoryAllocation> offscreenAllocations_; // Headless images are owned here
 
   vk::Image depthImage_;
-  vk::DeviceMemory depthImageMemory_;
+  MemoryAllocation depthImageAllocation_;
   vk::ImageView depthImageView_;
   vk::Format depthFormat_;
 
@@ -116,6 +168,13 @@ private:
   std::vector<vk::Framebuffer> framebuffers_;
 
   bool validationEnabled_ = false;
+  bool headless_ = false;
+  bool multiDrawIndirect_ = false;
+  bool drawIndirectCount_ = false;
+  float timestampPeriod_ = 0.0f;
+  uint32_t timestampValidBits_ = 0;
+  bool pipelineStatisticsQuery_ = false;
+  bool fragmentPrimitiveId_ = false;
 
   static constexpr std::array<const char *, 1> validationLayers = {"VK_LAYER_KHRONOS_validation"};
 
@@ -1,5 +1,9 @@
+#include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "core/application.hpp"
 
@@ -12,12 +16,58 @@ int main(int argc, char *argv[]) {
   std::string modelPath;
   std::string texturePath;
   bool debugMode = false;
+  bool headless = false;
+  bool noPipelineCache = false;
+  uint32_t recordThreads = 0;
+  std::string vertexFormat;
+  std::vector<float> autoLodRatios;
+  w3d::HeadlessOptions headlessOptions;
 
   // Define command line options
-  app.add_option("model", modelPath, "W3D model file to load on startup")->check(CLI::ExistingFile);
+  auto *modelOption = app.add_option("model", modelPath, "W3D model file to load on startup")
+                          ->check(CLI::ExistingFile);
   app.add_option("-t,--textures", texturePath, "Set custom texture search path")
       ->check(CLI::ExistingDirectory);
   app.add_flag("-d,--debug", debugMode, "Enable verbose debug output");
+  app.add_flag("--no-pipeline-cache", noPipelineCache,
+               "Do not load or save the pipeline cache between sessions");
+  auto *recordThreadsOption =
+      app.add_option("--record-threads", recordThreads,
+                     "Threads recording draw commands (0: inline; default: saved setting)")
+          ->check(CLI::Range(0u, w3d::RenderState::MAX_RECORD_THREADS));
+  app.add_option("--vertex-format", vertexFormat,
+                 "Vertex format of uploaded meshes (default: saved setting)")
+      ->check(CLI::IsMember({"full", "compact", "quantized"}));
+  app.add_option("--auto-lod", autoLodRatios,
+                 "Triangle ratios of LOD levels generated for single-LOD models (e.g. 0.5,0.25)")
+      ->delimiter(',')
+      ->check(CLI::Range(0.01f, 0.99f));
+
+  // Headless rendering (no window; also works on software Vulkan such as lavapipe)
+  auto *headlessFlag =
+      app.add_flag("--headless", headless, "Render the model offscreen without a window")
+          ->needs(modelOption);
+  app.add_option("--frames", headlessOptions.frames, "Frames to render in headless mode")
+      ->check(CLI::Range(1u, 1000000u))
+      ->capture_default_str()
+      ->needs(headlessFlag);
+  app.add_option("--width", headlessOptions.width, "Headless render width")
+      ->check(CLI::Range(1u, 16384u))
+      ->capture_default_str()
+      ->needs(headlessFlag);
+  app.add_option("--height", headlessOptions.height, "Headless render height")
+      ->check(CLI::Range(1u, 16384u))
+      ->capture_default_str()
+      ->needs(headlessFlag);
+  app.add_option("--benchmark", headlessOptions.benchmarkPath,
+                 "Write frame timing statistics to a JSON file")
+      ->needs(headlessFlag);
+  app.add_flag("--pipeline-statistics", headlessOptions.pipelineStatistics,
+               "Count shader invocations per pass (adds query overhead to the timed frames)")
+      ->needs(headlessFlag);
+  app.add_option("--screenshot", headlessOptions.screenshotPath,
+                 "Write the final headless frame to a PNG file")
+      ->needs(headlessFlag);
 
   // Parse command line arguments
   CLI11_PARSE(app, argc, argv);
@@ -35,6 +85,22 @@ int main(int argc, char *argv[]) {
   if (!modelPath.empty()) {
     viewer.setInitialModel(modelPath);
   }
+  if (headless) {
+    viewer.setHeadless(headlessOptions);
+  }
+  if (noPipelineCache) {
+    viewer.setPipelineCacheEnabled(false);
+  }
+  if (recordThreadsOption->count() > 0) {
+    viewer.setRecordThreads(recordThreads);
+  }
+  if (auto format = w3d::gfx::parseVertexFormat(vertexFormat)) {
+    viewer.setVertexFormat(*format);
+  }
+  if (!autoLodRatios.empty()) {
+    std::sort(autoLodRatios.begin(), autoLodRatios.end(), std::greater<float>());
+    viewer.setGeneratedLODRatios(std::move(autoLodRatios));
+  }
 
   try {
     viewer.run();
@@ -1,56 +1,51 @@
 #pragma once
 
-#include "lib/gfx/buffer.hpp"
-#include "lib/gfx/vulkan_context.hpp"
-
 #include <glm/glm.hpp>
 
-#include <array>
+#include <cstddef>
 #include <vector>
 
 namespace w3d {
 
-// Storage buffer for bone matrices (SSBO)
-// Used for GPU skinning - equivalent to legacy HTreeClass::Get_Transform()
-// Double-buffered to allow CPU updates while GPU is reading previous frame.
+// Bone matrix palette for GPU skinning and the skeleton overlay
+// Equivalent to legacy HTreeClass::Get_Transform()
+// Kept on the CPU; the renderer copies it into its per-frame ring buffer and binds it as a
+// dynamic storage buffer (SSBO), so updates never touch GPU memory that is still in flight.
 class BoneMatrixBuffer {
 public:
   static constexpr size_t MAX_BONES = 256;
-  static constexpr uint32_t FRAME_COUNT = 2; // Double-buffering
 
   BoneMatrixBuffer() = default;
-  ~BoneMatrixBuffer();
 
   BoneMatrixBuffer(const BoneMatrixBuffer &) = delete;
   BoneMatrixBuffer &operator=(const BoneMatrixBuffer &) = delete;
 
-  // Create the buffers with space for maxBones matrices
-  void create(gfx::VulkanContext &context, size_t maxBones = MAX_BONES);
+  // Reserve space for maxBones matrices (initialized to identity)
+  void create(size_t maxBones = MAX_BONES);
 
-  // Update bone matrices for a specific frame
-  void update(uint32_t frameIndex, const std::vector<glm::mat4> &skinningMatrices);
+  // Update bone matrices (no allocation once created)
+  void update(const std::vector<glm::mat4> &skinningMatrices);
 
-  // Free GPU resources
+  // Release the palette
   void destroy();
 
-  // Check if buffers are created
-  bool isCreated() const { return buffers_[0].buffer(); }
+  // Check if the palette is created
+  bool isCreated() const { return !matrices_.empty(); }
 
-  // Get Vulkan buffer handle for a specific frame
-  vk::Buffer buffer(uint32_t frameIndex) const { return buffers_[frameIndex].buffer(); }
+  // Palette contents (maxBones() matrices, the first boneCount() are current)
+  const glm::mat4 *data() const { return matrices_.data(); }
 
-  // Get descriptor info for binding a specific frame
-  vk::DescriptorBufferInfo descriptorInfo(uint32_t frameIndex) const;
+  // Size in bytes of the full palette as bound to the shaders
+  size_t paletteSize() const { return sizeof(glm::mat4) * matrices_.size(); }
 
   // Get current bone count
   size_t boneCount() const { return boneCount_; }
 
   // Get maximum bone count
-  size_t maxBones() const { return maxBones_; }
+  size_t maxBones() const { return matrices_.size(); }
 
 private:
-  std::array<gfx::Buffer, FRAME_COUNT> buffers_;
-  size_t maxBones_ = 0;
+  std::vector<glm::mat4> matrices_;
   size_t boneCount_ = 0;
 };
 
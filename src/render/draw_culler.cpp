@@ -0,0 +1,205 @@
+#include "draw_culler.hpp"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "core/shader_loader.hpp"
+
+namespace w3d {
+
+namespace {
+
+constexpr uint32_t CULL_GROUP_SIZE = 64; // local_size_x in cull.comp
+
+constexpr vk::DeviceSize INPUT_RANGE = sizeof(CullInput) * DrawCuller::MAX_DRAWS;
+constexpr vk::DeviceSize COMMAND_RANGE = sizeof(IndirectDrawCommand) * DrawCuller::MAX_DRAWS;
+constexpr vk::DeviceSize COUNT_RANGE = sizeof(uint32_t) * DrawCuller::MAX_DRAWS;
+
+} // namespace
+
+DrawCuller::~DrawCuller() {
+  destroy();
+}
+
+void DrawCuller::create(gfx::VulkanContext &context, const gfx::FrameRingBuffer &frameData,
+                        vk::DeviceSize boneRange) {
+  destroy();
+
+  device_ = context.device();
+  multiDraw_ = context.multiDrawIndirect();
+  supported_ = context.drawIndirectCount() && context.multiDrawIndirect();
+
+  if (!supported_) {
+    return;
+  }
+
+  createPipeline(context.pipelineCache());
+
+  vk::DescriptorPoolSize poolSize{vk::DescriptorType::eStorageBufferDynamic, 4};
+  vk::DescriptorPoolCreateInfo poolInfo{{}, 1, poolSize};
+  descriptorPool_ = device_.createDescriptorPool(poolInfo);
+
+  vk::DescriptorSetAllocateInfo allocInfo{descriptorPool_, descriptorSetLayout_};
+  descriptorSet_ = device_.allocateDescriptorSets(allocInfo)[0];
+
+  // All four bindings address the frame ring buffer; the per-frame locations are dynamic
+  // offsets, so the set is written once
+  std::array<vk::DescriptorBufferInfo, 4> bufferInfos = {
+      vk::DescriptorBufferInfo{frameData.buffer(), 0, INPUT_RANGE},
+      vk::DescriptorBufferInfo{frameData.buffer(), 0, COMMAND_RANGE},
+      vk::DescriptorBufferInfo{frameData.buffer(), 0, COUNT_RANGE},
+      vk::DescriptorBufferInfo{frameData.buffer(), 0, boneRange}
+  };
+
+  std::array<vk::WriteDescriptorSet, 4> writes;
+  for (uint32_t i = 0; i < writes.size(); ++i) {
+    writes[i] = vk::WriteDescriptorSet{
+        descriptorSet_, i, 0, vk::DescriptorType::eStorageBufferDynamic, {}, bufferInfos[i]};
+  }
+  device_.updateDescriptorSets(writes, {});
+}
+
+void DrawCuller::createPipeline(vk::PipelineCache pipelineCache) {
+  std::array<vk::DescriptorSetLayoutBinding, 4> bindings;
+  for (uint32_t i = 0; i < bindings.size(); ++i) {
+    bindings[i] = vk::DescriptorSetLayoutBinding{i, vk::DescriptorType::eStorageBufferDynamic, 1,
+                                                 vk::ShaderStageFlagBits::eCompute};
+  }
+  vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, bindings};
+  descriptorSetLayout_ = device_.createDescriptorSetLayout(layoutInfo);
+
+  vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eCompute, 0,
+                                          sizeof(CullPushConstant)};
+  vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, descriptorSetLayout_, pushConstantRange};
+  pipelineLayout_ = device_.createPipelineLayout(pipelineLayoutInfo);
+
+  auto code = loadEmbeddedShader("cull.comp.spv");
+  vk::ShaderModuleCreateInfo moduleInfo{
+      {}, code.size(), reinterpret_cast<const uint32_t *>(code.data())};
+  vk::ShaderModule shaderModule = device_.createShaderModule(moduleInfo);
+
+  vk::PipelineShaderStageCreateInfo stageInfo{
+      {}, vk::ShaderStageFlagBits::eCompute, shaderModule, "main"};
+  vk::ComputePipelineCreateInfo pipelineInfo{{}, stageInfo, pipelineLayout_};
+
+  auto result = device_.createComputePipeline(pipelineCache, pipelineInfo);
+  device_.destroyShaderModule(shaderModule);
+  if (result.result != vk::Result::eSuccess) {
+    throw std::runtime_error("Failed to create cull compute pipeline");
+  }
+  pipeline_ = result.value;
+}
+
+void DrawCuller::destroy() {
+  if (device_) {
+    if (pipeline_) {
+      device_.destroyPipeline(pipeline_);
+      pipeline_ = nullptr;
+    }
+    if (pipelineLayout_) {
+      device_.destroyPipelineLayout(pipelineLayout_);
+      pipelineLayout_ = nullptr;
+    }
+    if (descriptorPool_) {
+      device_.destroyDescriptorPool(descriptorPool_);
+      descriptorPool_ = nullptr;
+      descriptorSet_ = nullptr;
+    }
+    if (descriptorSetLayout_) {
+      device_.destroyDescriptorSetLayout(descriptorSetLayout_);
+      descriptorSetLayout_ = nullptr;
+    }
+    device_ = nullptr;
+  }
+  supported_ = false;
+  list_ = nullptr;
+}
+
+void DrawCuller::cull(vk::CommandBuffer cmd, gfx::FrameRingBuffer &frameData,
+                      const DrawList &list, const Frustum &frustum, uint32_t boneOffset,
+                      const glm::mat4 *bones, size_t boneCount) {
+  list_ = &list;
+  gpuCulling_ = supported_ && !list.draws.empty() && list.draws.size() <= MAX_DRAWS;
+
+  if (!gpuCulling_) {
+    // CPU reference path: compact into the ring and remember the counts
+    cullDraws(frustum, list, bones, boneCount, cpuCommands_, cpuCounts_);
+    if (cpuCommands_.empty()) {
+      return;
+    }
+    auto commands = frameData.allocate(sizeof(IndirectDrawCommand) * cpuCommands_.size());
+    std::memcpy(commands.data, cpuCommands_.data(),
+                sizeof(IndirectDrawCommand) * cpuCommands_.size());
+    commandOffset_ = commands.offset;
+    return;
+  }
+
+  // Descriptor ranges are fixed, so every region is reserved at full capacity
+  auto inputs = frameData.allocate(INPUT_RANGE);
+  std::memcpy(inputs.data, list.draws.data(), sizeof(CullInput) * list.draws.size());
+
+  auto commands = frameData.allocate(COMMAND_RANGE);
+  commandOffset_ = commands.offset;
+
+  auto counts = frameData.allocate(COUNT_RANGE);
+  std::memset(counts.data, 0, sizeof(uint32_t) * list.batches.size());
+  countOffset_ = counts.offset;
+
+  CullPushConstant params{};
+  params.planes = frustum.planes;
+  params.drawCount = static_cast<uint32_t>(list.draws.size());
+  params.boneCount = static_cast<uint32_t>(boneCount);
+
+  const std::array<uint32_t, 4> offsets = {inputs.dynamicOffset(), commands.dynamicOffset(),
+                                           counts.dynamicOffset(), boneOffset};
+
+  cmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline_);
+  cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipelineLayout_, 0, descriptorSet_,
+                         offsets);
+  cmd.pushConstants(pipelineLayout_, vk::ShaderStageFlagBits::eCompute, 0,
+                    sizeof(CullPushConstant), &params);
+  cmd.dispatch((params.drawCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+  // Compacted commands and counts are consumed by the indirect draws of this frame
+  vk::MemoryBarrier barrier{vk::AccessFlagBits::eShaderWrite,
+                            vk::AccessFlagBits::eIndirectCommandRead};
+  cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                      vk::PipelineStageFlagBits::eDrawIndirect, {}, barrier, {}, {});
+}
+
+bool DrawCuller::mayDrawBatch(uint32_t batchIndex) const {
+  if (!list_ || batchIndex >= list_->batches.size()) {
+    return false;
+  }
+  return gpuCulling_ || cpuCounts_[batchIndex] > 0;
+}
+
+void DrawCuller::drawBatch(vk::CommandBuffer cmd, vk::Buffer frameBuffer,
+                           uint32_t batchIndex) const {
+  if (!mayDrawBatch(batchIndex)) {
+    return;
+  }
+
+  constexpr uint32_t stride = sizeof(IndirectDrawCommand);
+  const DrawBatch &batch = list_->batches[batchIndex];
+  vk::DeviceSize offset = commandOffset_ + vk::DeviceSize{batch.firstCommand} * stride;
+
+  if (gpuCulling_) {
+    cmd.drawIndexedIndirectCount(frameBuffer, offset, frameBuffer,
+                                 countOffset_ + vk::DeviceSize{batchIndex} * sizeof(uint32_t),
+                                 batch.commandCount, stride);
+    return;
+  }
+
+  uint32_t count = cpuCounts_[batchIndex];
+  if (multiDraw_) {
+    cmd.drawIndexedIndirect(frameBuffer, offset, count, stride);
+  } else {
+    for (uint32_t c = 0; c < count; ++c) {
+      cmd.drawIndexedIndirect(frameBuffer, offset + vk::DeviceSize{c} * stride, 1, stride);
+    }
+  }
+}
+
+} // namespace w3d
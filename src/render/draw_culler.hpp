@@ -0,0 +1,84 @@
+#pragma once
+
+#include "lib/gfx/ring_buffer.hpp"
+#include "lib/gfx/vulkan_context.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "draw_culling.hpp"
+
+namespace w3d {
+
+// Push constants of cull.comp
+struct CullPushConstant {
+  std::array<glm::vec4, 6> planes;
+  uint32_t drawCount;
+  uint32_t boneCount;
+};
+
+// Frustum-culls a DrawList and compacts the survivors into per-batch indirect command ranges.
+//
+// With drawIndirectCount and multiDrawIndirect the work runs in cull.comp before the render
+// pass and each batch is drawn with vkCmdDrawIndexedIndirectCount, so the CPU never sees
+// the visible set. Otherwise the same test runs on the CPU (cullDraws) and each batch is
+// drawn with its known count.
+class DrawCuller {
+public:
+  // Capacity of one cull pass; larger lists take the CPU path
+  static constexpr uint32_t MAX_DRAWS = 4096;
+
+  DrawCuller() = default;
+  ~DrawCuller();
+
+  DrawCuller(const DrawCuller &) = delete;
+  DrawCuller &operator=(const DrawCuller &) = delete;
+
+  // boneRange is the fixed size of the bone palette allocated in frameData each frame
+  void create(gfx::VulkanContext &context, const gfx::FrameRingBuffer &frameData,
+              vk::DeviceSize boneRange);
+
+  void destroy();
+
+  // Record outside a render pass. bones/boneCount is the CPU copy of the palette that was
+  // written to frameData at boneOffset (used by the CPU path).
+  void cull(vk::CommandBuffer cmd, gfx::FrameRingBuffer &frameData, const DrawList &list,
+            const Frustum &frustum, uint32_t boneOffset, const glm::mat4 *bones,
+            size_t boneCount);
+
+  // Record inside the render pass, after binding the batch's material
+  void drawBatch(vk::CommandBuffer cmd, vk::Buffer frameBuffer, uint32_t batchIndex) const;
+
+  // False if the CPU path found nothing visible in the batch (the GPU path always draws)
+  bool mayDrawBatch(uint32_t batchIndex) const;
+
+  bool gpuCulling() const { return gpuCulling_; }
+
+private:
+  void createPipeline(vk::PipelineCache pipelineCache);
+
+  vk::Device device_;
+  bool supported_ = false; // drawIndirectCount + multiDrawIndirect
+  bool multiDraw_ = false;
+
+  vk::DescriptorSetLayout descriptorSetLayout_;
+  vk::PipelineLayout pipelineLayout_;
+  vk::Pipeline pipeline_;
+  vk::DescriptorPool descriptorPool_;
+  vk::DescriptorSet descriptorSet_;
+
+  // State of the last cull() for drawBatch()
+  const DrawList *list_ = nullptr;
+  bool gpuCulling_ = false;
+  vk::DeviceSize commandOffset_ = 0;
+  vk::DeviceSize countOffset_ = 0;
+  std::vector<IndirectDrawCommand> cpuCommands_;
+  std::vector<uint32_t> cpuCounts_;
+};
+
+} // namespace w3d
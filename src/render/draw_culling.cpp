@@ -0,0 +1,70 @@
+#include "draw_culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace w3d {
+
+Frustum Frustum::fromMatrix(const glm::mat4 &clip) {
+  // Rows of the matrix (GLM is column-major)
+  glm::vec4 r0(clip[0][0], clip[1][0], clip[2][0], clip[3][0]);
+  glm::vec4 r1(clip[0][1], clip[1][1], clip[2][1], clip[3][1]);
+  glm::vec4 r2(clip[0][2], clip[1][2], clip[2][2], clip[3][2]);
+  glm::vec4 r3(clip[0][3], clip[1][3], clip[2][3], clip[3][3]);
+
+  Frustum frustum;
+  frustum.planes = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+
+  for (auto &plane : frustum.planes) {
+    float length = glm::length(glm::vec3(plane));
+    if (length > 0.0f) {
+      plane /= length;
+    }
+  }
+  return frustum;
+}
+
+bool Frustum::intersectsSphere(const glm::vec3 &center, float radius) const {
+  for (const auto &plane : planes) {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+glm::vec4 transformSphere(const glm::vec4 &sphere, uint32_t boneIndex, const glm::mat4 *bones,
+                          size_t boneCount) {
+  if (boneIndex == CullInput::NO_BONE || !bones || boneIndex >= boneCount) {
+    return sphere;
+  }
+
+  const glm::mat4 &bone = bones[boneIndex];
+  glm::vec3 center = glm::vec3(bone * glm::vec4(glm::vec3(sphere), 1.0f));
+
+  // Bones are rigid in practice, but scale the radius by the largest axis to stay safe
+  float scale = std::max({glm::length(glm::vec3(bone[0])), glm::length(glm::vec3(bone[1])),
+                          glm::length(glm::vec3(bone[2]))});
+  return glm::vec4(center, sphere.w * scale);
+}
+
+void cullDraws(const Frustum &frustum, const DrawList &list, const glm::mat4 *bones,
+               size_t boneCount, std::vector<IndirectDrawCommand> &out,
+               std::vector<uint32_t> &visibleCounts) {
+  out.resize(list.draws.size());
+  visibleCounts.assign(list.batches.size(), 0);
+
+  for (const auto &draw : list.draws) {
+    if (draw.sphere.w >= 0.0f) {
+      glm::vec4 sphere = transformSphere(draw.sphere, draw.boneIndex, bones, boneCount);
+      if (!frustum.intersectsSphere(glm::vec3(sphere), sphere.w)) {
+        continue;
+      }
+    }
+
+    uint32_t slot = draw.outputBase + visibleCounts[draw.batchIndex]++;
+    out[slot] = draw.command;
+  }
+}
+
+} // namespace w3d
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "render/material.hpp"
+
+namespace w3d {
+
+// Same layout as VkDrawIndexedIndirectCommand
+struct IndirectDrawCommand {
+  uint32_t indexCount;
+  uint32_t instanceCount;
+  uint32_t firstIndex;
+  int32_t vertexOffset;
+  uint32_t firstInstance;
+};
+
+static_assert(sizeof(IndirectDrawCommand) == 20, "Must match VkDrawIndexedIndirectCommand");
+
+// Per-draw input to frustum culling, laid out for std430 (matches DrawInput in cull.comp)
+struct CullInput {
+  static constexpr uint32_t NO_BONE = 0xFFFFFFFFu;
+
+  glm::vec4 sphere;            // xyz: center in mesh space, w: radius (negative: never culled)
+  IndirectDrawCommand command; // Written to the output list if the draw survives
+  uint32_t boneIndex;          // Palette entry that places the mesh in the world, or NO_BONE
+  uint32_t batchIndex;         // Batch whose visible count the draw increments
+  uint32_t outputBase;         // First output slot of that batch
+};
+
+static_assert(sizeof(CullInput) == 48, "Must match DrawInput in cull.comp");
+
+// A run of draws sharing a material (texture included) and hover tint.
+// After culling, batch i's surviving commands occupy
+// [firstCommand, firstCommand + visibleCount[i]) of the output list.
+struct DrawBatch {
+  const GPUMaterial *material;
+  glm::vec3 tint;
+  uint32_t firstCommand;
+  uint32_t commandCount;
+};
+
+// Draws for one frame, in batch order
+struct DrawList {
+  std::vector<CullInput> draws;
+  std::vector<DrawBatch> batches;
+
+  void clear() {
+    draws.clear();
+    batches.clear();
+  }
+};
+
+// View frustum as six inward-facing planes (xyz normal, w distance)
+struct Frustum {
+  std::array<glm::vec4, 6> planes;
+
+  // Extract planes from a clip matrix (projection * view * model). Uses the [-w, w] depth
+  // range, which contains Vulkan's [0, w] range, so the test stays conservative either way.
+  static Frustum fromMatrix(const glm::mat4 &clip);
+
+  bool intersectsSphere(const glm::vec3 &center, float radius) const;
+};
+
+// Bounding sphere of a draw after placing it with its bone (if any)
+glm::vec4 transformSphere(const glm::vec4 &sphere, uint32_t boneIndex, const glm::mat4 *bones,
+                          size_t boneCount);
+
+// CPU reference for cull.comp, also used when the GPU path is unavailable.
+// out receives draws.size() slots; visibleCounts one entry per batch.
+// Within a batch surviving draws keep their input order (the GPU order is unspecified).
+void cullDraws(const Frustum &frustum, const DrawList &list, const glm::mat4 *bones,
+               size_t boneCount, std::vector<IndirectDrawCommand> &out,
+               std::vector<uint32_t> &visibleCounts);
+
+} // namespace w3d
@@ -0,0 +1,114 @@
+#include "draw_packet.hpp"
+
+namespace w3d {
+
+namespace {
+
+void appendDraw(DrawList &out, const DrawPacket &packet, const glm::vec3 &tint, bool newRun,
+                const InstanceBuckets *instances) {
+  auto slot = static_cast<uint32_t>(out.draws.size());
+  if (newRun || out.batches.empty() || isTranslucent(packet.material) ||
+      !sameMaterial(*out.batches.back().material, packet.material)) {
+    out.batches.push_back({&packet.material, tint, slot, 0});
+  }
+  DrawBatch &batch = out.batches.back();
+
+  CullInput input;
+  input.sphere = packet.sphere;
+  input.command = packet.command;
+  input.boneIndex = packet.boneIndex;
+  input.batchIndex = static_cast<uint32_t>(out.batches.size() - 1);
+  input.outputBase = batch.firstCommand;
+  if (!instances) {
+    ++batch.commandCount;
+    out.draws.push_back(input);
+    return;
+  }
+
+  // One instanced draw per populated level the packet belongs to, over that level's
+  // instances (all of them for aggregates). The instances were frustum-culled when bucketed;
+  // the draws never are.
+  input.sphere.w = -1.0f;
+  auto appendInstanced = [&](uint32_t first, uint32_t count) {
+    input.command.firstInstance = InstanceBuckets::FIRST_SLOT + first;
+    input.command.instanceCount = count;
+    ++batch.commandCount;
+    out.draws.push_back(input);
+  };
+  if (packet.lodMask == DrawPacket::ALL_LODS) {
+    appendInstanced(0, instances->total());
+    return;
+  }
+  for (size_t level = 0; level < instances->levelCount(); ++level) {
+    if (instances->count(level) > 0 && (packet.lodMask & lodBit(level)) != 0) {
+      appendInstanced(instances->first(level), instances->count(level));
+    }
+  }
+}
+
+} // namespace
+
+bool sameMaterial(const GPUMaterial &a, const GPUMaterial &b) {
+  return a.textureIndex == b.textureIndex && a.flags == b.flags &&
+         a.alphaThreshold == b.alphaThreshold && a.diffuseColor == b.diffuseColor &&
+         a.emissiveColor == b.emissiveColor && a.specularColor == b.specularColor;
+}
+
+GPUMaterial packetMaterial(uint32_t textureIndex, BlendMode blend) {
+  GPUMaterial material{};
+  material.diffuseColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+  material.emissiveColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  material.specularColor = glm::vec4(0.2f, 0.2f, 0.2f, 32.0f);
+  material.textureIndex = textureIndex;
+  material.flags = (textureIndex > 0 ? MaterialFlags::HasTexture : 0) | blendFlags(blend);
+  material.alphaThreshold = 0.5f;
+  return material;
+}
+
+void sortDrawPackets(std::vector<DrawPacket> &packets) {
+  std::stable_sort(packets.begin(), packets.end(), [](const DrawPacket &a, const DrawPacket &b) {
+    if (a.material.textureIndex != b.material.textureIndex) {
+      return a.material.textureIndex < b.material.textureIndex;
+    }
+    return a.material.flags < b.material.flags;
+  });
+}
+
+void buildDrawList(const std::vector<DrawPacket> &packets, uint32_t lodMask,
+                   const std::vector<bool> &visibility, int hoverMeshIndex,
+                   const glm::vec3 &tintColor, DrawList &out,
+                   const InstanceBuckets *instances) {
+  out.clear();
+  out.draws.reserve(packets.size());
+
+  auto isDrawn = [&](const DrawPacket &packet) {
+    return (packet.lodMask & lodMask) != 0 &&
+           (packet.meshIndex >= visibility.size() || visibility[packet.meshIndex]);
+  };
+  auto hoverIndex = static_cast<uint32_t>(hoverMeshIndex);
+
+  bool hovered = false;
+  for (const DrawPacket &packet : packets) {
+    if (!isDrawn(packet)) {
+      continue;
+    }
+    if (hoverMeshIndex >= 0 && packet.meshIndex == hoverIndex) {
+      hovered = true;
+      continue;
+    }
+    appendDraw(out, packet, glm::vec3(1.0f), false, instances);
+  }
+
+  if (!hovered) {
+    return;
+  }
+  bool first = true;
+  for (const DrawPacket &packet : packets) {
+    if (packet.meshIndex == hoverIndex && isDrawn(packet)) {
+      appendDraw(out, packet, tintColor, first, instances);
+      first = false;
+    }
+  }
+}
+
+} // namespace w3d
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "render/draw_culling.hpp"
+#include "render/instance_set.hpp"
+#include "render/material.hpp"
+
+namespace w3d {
+
+// One mesh draw with everything resolved when the model is loaded: texture slot, material
+// constants, index range, cull sphere, bone and the LOD levels that draw it. Recording a
+// frame walks packets without touching names, maps or callbacks.
+struct DrawPacket {
+  static constexpr uint32_t ALL_LODS = 0xFFFFFFFFu;
+
+  GPUMaterial material;        // textureIndex is the bindless table slot (0: untextured)
+  glm::vec4 sphere;            // Same meaning as CullInput::sphere
+  IndirectDrawCommand command; // Range in the model's vertex/index buffers
+  uint32_t boneIndex;          // Same meaning as CullInput::boneIndex
+  uint32_t lodMask;            // Bit per LOD level drawing the mesh (see lodBit), or ALL_LODS
+  uint32_t meshIndex;          // Mesh the packet was compiled from, for visibility and hover
+};
+
+static_assert(std::is_trivially_copyable_v<DrawPacket>, "Draw packets must stay plain data");
+
+// LOD mask bit of a level; levels past 31 share the last bit
+inline uint32_t lodBit(size_t level) {
+  return 1u << std::min<size_t>(level, 31);
+}
+
+// Material of an HLod mesh sampling textureIndex (0 = vertex colours only)
+GPUMaterial packetMaterial(uint32_t textureIndex, BlendMode blend = BlendMode::Opaque);
+
+// Whether two draws can share material state
+bool sameMaterial(const GPUMaterial &a, const GPUMaterial &b);
+
+// Order packets so draws sharing a material are adjacent, keeping mesh order within each
+void sortDrawPackets(std::vector<DrawPacket> &packets);
+
+// Build the frame's draw list from sorted packets: those in lodMask and not hidden in
+// visibility (indexed by meshIndex; missing entries count as visible), one batch per run of
+// equal materials. Translucent packets get a batch each so they can be depth sorted.
+// Packets of the hovered mesh go last, in batches tinted with tintColor.
+// With instances, each packet is drawn once per populated LOD level it belongs to, over that
+// level's instance range, and lodMask should cover those levels. Such draws are never
+// culled: the instances were culled when bucketed.
+void buildDrawList(const std::vector<DrawPacket> &packets, uint32_t lodMask,
+                   const std::vector<bool> &visibility, int hoverMeshIndex,
+                   const glm::vec3 &tintColor, DrawList &out,
+                   const InstanceBuckets *instances = nullptr);
+
+} // namespace w3d
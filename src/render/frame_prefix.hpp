@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace w3d {
+
+// Sizes of the per-frame data the renderer writes ahead of the draws
+struct FramePrefixSizes {
+  uint64_t ubo = 0;
+  uint64_t palette = 0;   // Bone palette, over its fixed descriptor range
+  uint64_t instances = 0; // Instance transforms, over their fixed descriptor range
+};
+
+// The per-frame data allocated from the frame's ring partition before anything else.
+template <typename Allocation>
+struct FramePrefix {
+  Allocation ubo{};
+  Allocation pickUbo{}; // The UBO with the pick projection; only written on picking frames
+  Allocation palette{};
+  Allocation instances{};
+};
+
+// Allocate the prefix from a FrameRingBuffer, or a RingAllocator when checking the layout.
+// The pick UBO's slot is reserved on every frame, picking or not, so the culler's draw
+// commands and everything else allocated after the prefix land at the same offsets on every
+// frame: draws recorded on one frame read them where a later frame left them.
+template <typename Ring>
+auto allocateFramePrefix(Ring &ring, const FramePrefixSizes &sizes) {
+  FramePrefix<decltype(ring.allocate(0))> prefix;
+  prefix.ubo = ring.allocate(sizes.ubo);
+  prefix.pickUbo = ring.allocate(sizes.ubo);
+  prefix.palette = ring.allocate(sizes.palette);
+  prefix.instances = ring.allocate(sizes.instances);
+  return prefix;
+}
+
+} // namespace w3d
@@ -3,6 +3,8 @@
 #include <algorithm>
 
 #include "lib/formats/w3d/hlod_model.hpp"
+#include "mesh_bvh.hpp"
+#include "pick_id.hpp"
 #include "renderable_mesh.hpp"
 #include "skeleton.hpp"
 #include "skeleton_renderer.hpp"
@@ -28,24 +30,15 @@ void HoverDetector::testMeshes(const RenderableMesh &meshes) {
   size_t closestTriIndex = 0;
   glm::vec3 closestMeshPoint(0.0f);
 
-  // Test all meshes and all triangles
+  // Test all meshes, each through its triangle tree
   for (size_t meshIdx = 0; meshIdx < meshes.meshCount(); ++meshIdx) {
-    size_t triCount = meshes.triangleCount(meshIdx);
+    MeshHit hit = meshes.mesh(meshIdx).bvh.intersect(currentRay_);
 
-    for (size_t triIdx = 0; triIdx < triCount; ++triIdx) {
-      glm::vec3 v0, v1, v2;
-      if (!meshes.getTriangle(meshIdx, triIdx, v0, v1, v2)) {
-        continue;
-      }
-
-      TriangleHit hit = intersectRayTriangle(currentRay_, v0, v1, v2);
-
-      if (hit.hit && hit.distance < closestMeshDist) {
-        closestMeshDist = hit.distance;
-        closestMeshIndex = meshIdx;
-        closestTriIndex = triIdx;
-        closestMeshPoint = hit.point;
-      }
+    if (hit.hit.hit && hit.hit.distance < closestMeshDist) {
+      closestMeshDist = hit.hit.distance;
+      closestMeshIndex = meshIdx;
+      closestTriIndex = hit.triangleIndex;
+      closestMeshPoint = hit.hit.point;
     }
   }
 
@@ -86,22 +79,14 @@ void HoverDetector::testHLodMeshes(const HLodModel &model, const SkeletonPose *p
                                         pose->boneTransform(static_cast<size_t>(mesh.boneIndex)));
     }
 
-    // Test all triangles in this mesh
-    size_t triCount = model.triangleCount(visIdx);
-    for (size_t triIdx = 0; triIdx < triCount; ++triIdx) {
-      glm::vec3 v0, v1, v2;
-      if (!model.getTriangle(visIdx, triIdx, v0, v1, v2)) {
-        continue;
-      }
-
-      TriangleHit hit = intersectRayTriangle(testRay, v0, v1, v2);
+    // The mesh's triangle tree is in vertex space, as the ray now is
+    MeshHit hit = mesh.bvh.intersect(testRay);
 
-      if (hit.hit && hit.distance < closestDist) {
-        closestDist = hit.distance;
-        closestMeshIndex = visIdx;
-        closestTriIndex = triIdx;
-        closestPoint = hit.point;
-      }
+    if (hit.hit.hit && hit.hit.distance < closestDist) {
+      closestDist = hit.hit.distance;
+      closestMeshIndex = visIdx;
+      closestTriIndex = hit.triangleIndex;
+      closestPoint = hit.hit.point;
     }
   }
 
@@ -121,7 +106,8 @@ void HoverDetector::testHLodMeshes(const HLodModel &model, const SkeletonPose *p
   }
 }
 
-void HoverDetector::testHLodSkinnedMeshes(const HLodModel &model) {
+void HoverDetector::testHLodSkinnedMeshes(const HLodModel &model, const glm::mat4 *bones,
+                                          size_t boneCount) {
   if (!model.hasSkinning()) {
     return;
   }
@@ -135,11 +121,14 @@ void HoverDetector::testHLodSkinnedMeshes(const HLodModel &model) {
   glm::vec3 closestPoint(0.0f);
 
   for (size_t visIdx : visibleIndices) {
-    // Test all triangles in this mesh (rest-pose geometry)
+    // Test all triangles in this mesh, posed as drawn
     size_t triCount = model.skinnedTriangleCount(visIdx);
     for (size_t triIdx = 0; triIdx < triCount; ++triIdx) {
       glm::vec3 v0, v1, v2;
-      if (!model.getSkinnedTriangle(visIdx, triIdx, v0, v1, v2)) {
+      bool found = bones ? model.getPosedSkinnedTriangle(visIdx, triIdx, bones, boneCount, v0,
+                                                         v1, v2)
+                         : model.getSkinnedTriangle(visIdx, triIdx, v0, v1, v2);
+      if (!found) {
         continue;
       }
 
@@ -170,6 +159,81 @@ void HoverDetector::testHLodSkinnedMeshes(const HLodModel &model) {
   }
 }
 
+namespace {
+
+// Hover an HLod mesh (static or skinned) at a hit
+template <typename MeshT>
+void hoverHLodMesh(HoverState &state, const MeshT &mesh, size_t meshIndex, size_t triangleIndex,
+                   const TriangleHit &hit) {
+  state.type = HoverType::Mesh;
+  state.objectIndex = meshIndex;
+  state.triangleIndex = triangleIndex;
+  state.hitPoint = hit.point;
+  state.distance = hit.distance;
+  state.objectName = mesh.name;
+  state.baseName = mesh.baseName;
+  state.subMeshIndex = mesh.subMeshIndex;
+  state.subMeshTotal = mesh.subMeshTotal;
+}
+
+} // namespace
+
+void HoverDetector::pickMesh(const RenderableMesh &meshes, size_t meshIndex,
+                             size_t triangleIndex) {
+  glm::vec3 v0, v1, v2;
+  if (!meshes.getTriangle(meshIndex, triangleIndex, v0, v1, v2)) {
+    return;
+  }
+
+  TriangleHit hit = pickedTriangleHit(currentRay_, v0, v1, v2);
+  if (hit.hit && hit.distance < state_.distance) {
+    state_.type = HoverType::Mesh;
+    state_.objectIndex = meshIndex;
+    state_.triangleIndex = triangleIndex;
+    state_.hitPoint = hit.point;
+    state_.distance = hit.distance;
+    state_.objectName = meshes.meshName(meshIndex);
+  }
+}
+
+void HoverDetector::pickHLodMesh(const HLodModel &model, size_t meshIndex, size_t triangleIndex,
+                                 const SkeletonPose *pose) {
+  glm::vec3 v0, v1, v2;
+  if (!model.getTriangle(meshIndex, triangleIndex, v0, v1, v2)) {
+    return;
+  }
+  const auto &mesh = model.meshes()[meshIndex];
+
+  // Same bone-space ray as testHLodMeshes()
+  Ray testRay = currentRay_;
+  if (pose && mesh.boneIndex >= 0 && static_cast<size_t>(mesh.boneIndex) < pose->boneCount()) {
+    testRay = transformRayToBoneSpace(currentRay_,
+                                      pose->boneTransform(static_cast<size_t>(mesh.boneIndex)));
+  }
+
+  TriangleHit hit = pickedTriangleHit(testRay, v0, v1, v2);
+  if (hit.hit && hit.distance < state_.distance) {
+    hoverHLodMesh(state_, mesh, meshIndex, triangleIndex, hit);
+  }
+}
+
+void HoverDetector::pickHLodSkinnedMesh(const HLodModel &model, size_t meshIndex,
+                                        size_t triangleIndex, const glm::mat4 *bones,
+                                        size_t boneCount) {
+  glm::vec3 v0, v1, v2;
+  bool found = bones ? model.getPosedSkinnedTriangle(meshIndex, triangleIndex, bones, boneCount,
+                                                     v0, v1, v2)
+                     : model.getSkinnedTriangle(meshIndex, triangleIndex, v0, v1, v2);
+  if (!found) {
+    return;
+  }
+
+  TriangleHit hit = pickedTriangleHit(currentRay_, v0, v1, v2);
+  if (hit.hit && hit.distance < state_.distance) {
+    hoverHLodMesh(state_, model.skinnedMeshes()[meshIndex], meshIndex, triangleIndex, hit);
+  }
+}
+
 void HoverDetector::testSkeleton(const SkeletonRenderer &skeleton, float boneThickness) {
   if (!skeleton.hasData()) {
     return;
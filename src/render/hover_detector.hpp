@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
 #include <limits>
 #include <string>
 
@@ -89,18 +90,29 @@ public:
   void update(const glm::vec2 &mousePos, const glm::vec2 &screenSize, const glm::mat4 &viewMatrix,
               const glm::mat4 &projMatrix);
 
-  // Test against renderable meshes
+  // Test against renderable meshes, through each mesh's MeshBVH
   void testMeshes(const RenderableMesh &meshes);
 
   // Test against HLod model meshes (LOD-aware, bone-space ray transform)
-  // Only tests visible meshes (aggregates + current LOD level)
+  // Only tests visible meshes (aggregates + current LOD level), through each mesh's MeshBVH
   // pose: Optional skeleton pose for bone-space ray transformation
   void testHLodMeshes(const HLodModel &model, const SkeletonPose *pose = nullptr);
 
-  // Test against HLod skinned meshes (uses rest-pose geometry)
-  // Note: For GPU-skinned meshes, we test against rest-pose vertices
-  // which may be less accurate during animation
-  void testHLodSkinnedMeshes(const HLodModel &model);
+  // Test against HLod skinned meshes
+  // bones/boneCount: the bone palette the meshes are drawn with; triangles are posed by it
+  // as the shaders pose them. Without a palette, the rest-pose geometry is tested.
+  void testHLodSkinnedMeshes(const HLodModel &model, const glm::mat4 *bones = nullptr,
+                             size_t boneCount = 0);
+
+  // Take a mesh triangle picked on the GPU (see PickPass) as the hit, in place of the ray
+  // tests above: only that triangle is intersected, for the hit point and distance, with the
+  // same bone-space ray or palette pose as the matching test. Stale picks of meshes or
+  // triangles that no longer exist are ignored.
+  void pickMesh(const RenderableMesh &meshes, size_t meshIndex, size_t triangleIndex);
+  void pickHLodMesh(const HLodModel &model, size_t meshIndex, size_t triangleIndex,
+                    const SkeletonPose *pose = nullptr);
+  void pickHLodSkinnedMesh(const HLodModel &model, size_t meshIndex, size_t triangleIndex,
+                           const glm::mat4 *bones = nullptr, size_t boneCount = 0);
 
   // Test against skeleton
   void testSkeleton(const SkeletonRenderer &skeleton, float boneThickness = 0.05f);
@@ -0,0 +1,226 @@
+#include "instance_set.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <glm/gtc/constants.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define W3D_INSTANCE_SET_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace w3d {
+
+namespace {
+
+// Per level, the squared tangent of the half-angle at which a sphere reaches the level's
+// maxScreenSize: an instance is below it where radius^2 < tanSq * distance^2. Infinite for
+// levels that any instance is below, negative for levels with no maximum (never chosen).
+std::vector<float> levelThresholds(const InstanceView &view,
+                                   const std::vector<float> &maxScreenSizes) {
+  std::vector<float> thresholds(maxScreenSizes.size(), -1.0f);
+  for (size_t i = 0; i < maxScreenSizes.size(); ++i) {
+    if (maxScreenSizes[i] <= 0.0f) {
+      continue;
+    }
+    // screenSize = 2 * atan(r / d) / fovY * screenHeight < max  <=>  atan(r / d) < angle
+    float angle = view.screenHeight > 0.0f
+                      ? maxScreenSizes[i] * view.fovY / (2.0f * view.screenHeight)
+                      : std::numeric_limits<float>::infinity();
+    if (angle >= glm::half_pi<float>()) {
+      thresholds[i] = std::numeric_limits<float>::infinity();
+    } else {
+      float t = std::tan(angle);
+      thresholds[i] = t * t;
+    }
+  }
+  return thresholds;
+}
+
+#ifdef W3D_INSTANCE_SET_SSE2
+
+// Blocks of four instances; returns how many were assigned a level
+size_t selectLevelsSse2(const InstanceView &view, const std::vector<float> &thresholds,
+                        const float *centerX, const float *centerY, const float *centerZ,
+                        const float *radius, size_t count, int32_t *levels) {
+  size_t blockEnd = count & ~size_t{3};
+
+  __m128 px = _mm_set1_ps(view.cameraPosition.x);
+  __m128 py = _mm_set1_ps(view.cameraPosition.y);
+  __m128 pz = _mm_set1_ps(view.cameraPosition.z);
+  __m128 zero = _mm_setzero_ps();
+
+  for (size_t i = 0; i < blockEnd; i += 4) {
+    __m128 cx = _mm_loadu_ps(centerX + i);
+    __m128 cy = _mm_loadu_ps(centerY + i);
+    __m128 cz = _mm_loadu_ps(centerZ + i);
+    __m128 r = _mm_loadu_ps(radius + i);
+
+    // Frustum::intersectsSphere: outside if dot(plane, center) + w < -radius for any plane
+    __m128 negR = _mm_sub_ps(zero, r);
+    __m128 outside = zero;
+    for (const glm::vec4 &plane : view.frustum.planes) {
+      __m128 dist = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx),
+                               _mm_mul_ps(_mm_set1_ps(plane.y), cy));
+      dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.z), cz));
+      dist = _mm_add_ps(dist, _mm_set1_ps(plane.w));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negR));
+    }
+
+    __m128 dx = _mm_sub_ps(cx, px);
+    __m128 dy = _mm_sub_ps(cy, py);
+    __m128 dz = _mm_sub_ps(cz, pz);
+    __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                               _mm_mul_ps(dz, dz));
+    __m128 atCamera = _mm_cmpeq_ps(distSq, zero);
+    __m128 radiusSq = _mm_mul_ps(r, r);
+
+    __m128i level = _mm_setzero_si128();
+    for (size_t l = 0; l < thresholds.size(); ++l) {
+      if (thresholds[l] < 0.0f) {
+        continue;
+      }
+      __m128 below = _mm_or_ps(
+          atCamera, _mm_cmplt_ps(radiusSq, _mm_mul_ps(_mm_set1_ps(thresholds[l]), distSq)));
+      __m128i mask = _mm_castps_si128(below);
+      level = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(static_cast<int32_t>(l))),
+                           _mm_andnot_si128(mask, level));
+    }
+    // Culled lanes become -1
+    level = _mm_or_si128(level, _mm_castps_si128(outside));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(levels + i), level);
+  }
+  return blockEnd;
+}
+
+#endif
+
+} // namespace
+
+void InstanceSet::assign(std::vector<glm::mat4> transforms, const glm::vec4 &sphere) {
+  if (transforms.size() > MAX_INSTANCES) {
+    transforms.resize(MAX_INSTANCES);
+  }
+  transforms_ = std::move(transforms);
+
+  size_t count = transforms_.size();
+  centerX_.resize(count);
+  centerY_.resize(count);
+  centerZ_.resize(count);
+  radius_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const glm::mat4 &m = transforms_[i];
+    glm::vec3 center = glm::vec3(m * glm::vec4(glm::vec3(sphere), 1.0f));
+    float scale = std::max({glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])),
+                            glm::length(glm::vec3(m[2]))});
+    centerX_[i] = center.x;
+    centerY_[i] = center.y;
+    centerZ_[i] = center.z;
+    radius_[i] = sphere.w * scale;
+  }
+}
+
+void InstanceSet::clear() {
+  transforms_.clear();
+  centerX_.clear();
+  centerY_.clear();
+  centerZ_.clear();
+  radius_.clear();
+}
+
+void InstanceSet::bucket(const InstanceView &view, const std::vector<float> &maxScreenSizes,
+                         InstanceBuckets &out) const {
+  std::vector<int32_t> levels;
+  selectLevels(view, maxScreenSizes, true, levels);
+  gather(levels, std::max<size_t>(maxScreenSizes.size(), 1), out);
+}
+
+void InstanceSet::bucketScalar(const InstanceView &view,
+                               const std::vector<float> &maxScreenSizes,
+                               InstanceBuckets &out) const {
+  std::vector<int32_t> levels;
+  selectLevels(view, maxScreenSizes, false, levels);
+  gather(levels, std::max<size_t>(maxScreenSizes.size(), 1), out);
+}
+
+void InstanceSet::selectLevels(const InstanceView &view, const std::vector<float> &maxScreenSizes,
+                               bool batched, std::vector<int32_t> &levels) const {
+  std::vector<float> thresholds = levelThresholds(view, maxScreenSizes);
+  size_t count = transforms_.size();
+  levels.resize(count);
+
+  size_t done = 0;
+#ifdef W3D_INSTANCE_SET_SSE2
+  if (batched) {
+    done = selectLevelsSse2(view, thresholds, centerX_.data(), centerY_.data(), centerZ_.data(),
+                            radius_.data(), count, levels.data());
+  }
+#else
+  (void)batched;
+#endif
+
+  for (size_t i = done; i < count; ++i) {
+    glm::vec3 center(centerX_[i], centerY_[i], centerZ_[i]);
+    float r = radius_[i];
+    if (!view.frustum.intersectsSphere(center, r)) {
+      levels[i] = -1;
+      continue;
+    }
+    glm::vec3 d = center - view.cameraPosition;
+    float distSq = (d.x * d.x + d.y * d.y) + d.z * d.z;
+    int32_t level = 0;
+    for (size_t l = 0; l < thresholds.size(); ++l) {
+      if (thresholds[l] >= 0.0f && (distSq == 0.0f || r * r < thresholds[l] * distSq)) {
+        level = static_cast<int32_t>(l);
+      }
+    }
+    levels[i] = level;
+  }
+}
+
+void InstanceSet::gather(const std::vector<int32_t> &levels, size_t levelCount,
+                         InstanceBuckets &out) const {
+  out.offsets.assign(levelCount + 1, 0);
+  for (int32_t level : levels) {
+    if (level >= 0) {
+      ++out.offsets[static_cast<size_t>(level) + 1];
+    }
+  }
+  for (size_t l = 0; l < levelCount; ++l) {
+    out.offsets[l + 1] += out.offsets[l];
+  }
+
+  // Stable within each level, so instance order survives
+  out.transforms.resize(out.offsets[levelCount]);
+  std::vector<uint32_t> fill(out.offsets.begin(), out.offsets.end() - 1);
+  for (size_t i = 0; i < levels.size(); ++i) {
+    if (levels[i] >= 0) {
+      out.transforms[fill[static_cast<size_t>(levels[i])]++] = transforms_[i];
+    }
+  }
+}
+
+std::vector<glm::mat4> gridInstances(size_t count, float spacing) {
+  std::vector<glm::mat4> transforms;
+  if (count == 0) {
+    return transforms;
+  }
+  auto columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+  size_t rows = (count + columns - 1) / columns;
+  float originX = -0.5f * static_cast<float>(columns - 1) * spacing;
+  float originZ = -0.5f * static_cast<float>(rows - 1) * spacing;
+
+  transforms.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    glm::mat4 transform(1.0f);
+    transform[3] = glm::vec4(originX + static_cast<float>(i % columns) * spacing, 0.0f,
+                             originZ + static_cast<float>(i / columns) * spacing, 1.0f);
+    transforms.push_back(transform);
+  }
+  return transforms;
+}
+
+} // namespace w3d
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/draw_culling.hpp"
+
+namespace w3d {
+
+// Most copies an instance set holds; the renderer reserves a fixed per-frame range of this
+// many transforms for the vertex shaders
+constexpr size_t MAX_INSTANCES = 16384;
+
+// Camera state the instances are culled and assigned LOD levels against, as
+// HLodModel::updateLOD() sees it
+struct InstanceView {
+  Frustum frustum; // World space
+  glm::vec3 cameraPosition{0.0f};
+  float screenHeight = 0.0f;
+  float fovY = 0.0f;
+};
+
+// Visible instances sorted into LOD levels: level i draws transforms
+// [offsets[i], offsets[i + 1])
+struct InstanceBuckets {
+  // Slot of transforms[0] in the instance buffer; slot 0 holds the identity that
+  // non-instanced draws (firstInstance 0) read
+  static constexpr uint32_t FIRST_SLOT = 1;
+
+  std::vector<glm::mat4> transforms;
+  std::vector<uint32_t> offsets;
+
+  size_t levelCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+  uint32_t first(size_t level) const { return offsets[level]; }
+  uint32_t count(size_t level) const { return offsets[level + 1] - offsets[level]; }
+  uint32_t total() const { return static_cast<uint32_t>(transforms.size()); }
+};
+
+// Copies of one model, each placed by a transform of rotation, translation and uniform
+// scale. The world bounding sphere of every copy is kept in component arrays so bucket()
+// culls and picks LOD levels for four instances at a time.
+class InstanceSet {
+public:
+  // Replace the instances; sphere is the model's bounding sphere (center, radius) in model
+  // space. Transforms past MAX_INSTANCES are dropped.
+  void assign(std::vector<glm::mat4> transforms, const glm::vec4 &sphere);
+  void clear();
+
+  bool empty() const { return transforms_.empty(); }
+  size_t size() const { return transforms_.size(); }
+  const std::vector<glm::mat4> &transforms() const { return transforms_; }
+
+  // Drop the instances outside the view frustum and sort the rest into LOD levels. Level
+  // selection matches HLodModel::updateLOD() with the camera distance taken per instance:
+  // the last level whose maxScreenSize is positive and above the instance's screen size,
+  // else level 0. Runs with SSE2 where the target has it, and through bucketScalar()
+  // otherwise.
+  void bucket(const InstanceView &view, const std::vector<float> &maxScreenSizes,
+              InstanceBuckets &out) const;
+
+  // One instance at a time; the reference for the batched path
+  void bucketScalar(const InstanceView &view, const std::vector<float> &maxScreenSizes,
+                    InstanceBuckets &out) const;
+
+private:
+  // Level of each instance, or -1 where culled
+  void selectLevels(const InstanceView &view, const std::vector<float> &maxScreenSizes,
+                    bool batched, std::vector<int32_t> &levels) const;
+  void gather(const std::vector<int32_t> &levels, size_t levelCount,
+              InstanceBuckets &out) const;
+
+  std::vector<glm::mat4> transforms_;
+  std::vector<float> centerX_;
+  std::vector<float> centerY_;
+  std::vector<float> centerZ_;
+  std::vector<float> radius_;
+};
+
+// count transforms on a square grid in the XZ plane, spacing apart and centered on the
+// origin, filled row by row
+std::vector<glm::mat4> gridInstances(size_t count, float spacing);
+
+} // namespace w3d
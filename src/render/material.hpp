@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <string>
 
+#include "lib/gfx/pipeline_key.hpp"
+
 namespace w3d {
 
 // Blend mode for transparent materials
@@ -32,8 +34,67 @@ constexpr uint32_t HasTexture = 1 << 0;
 constexpr uint32_t HasAlphaTest = 1 << 1;
 constexpr uint32_t TwoSided = 1 << 2;
 constexpr uint32_t Unlit = 1 << 3;
+constexpr uint32_t AlphaBlend = 1 << 4; // Drawn blended, after opaque draws
+constexpr uint32_t Additive = 1 << 5;   // Drawn blended (one, one), after opaque draws
 } // namespace MaterialFlags
 
+// Blend mode encoded in a GPU material's flags
+inline BlendMode materialBlendMode(const GPUMaterial &material) {
+  if (material.flags & MaterialFlags::AlphaBlend) {
+    return BlendMode::AlphaBlend;
+  }
+  if (material.flags & MaterialFlags::Additive) {
+    return BlendMode::Additive;
+  }
+  return (material.flags & MaterialFlags::HasAlphaTest) ? BlendMode::AlphaTest : BlendMode::Opaque;
+}
+
+// Blended materials don't write depth and are drawn back to front after opaque ones
+inline bool isTranslucent(const GPUMaterial &material) {
+  return (material.flags & (MaterialFlags::AlphaBlend | MaterialFlags::Additive)) != 0;
+}
+
+// Mesh pipeline permutation that draws a material. Textures, alpha test and lighting are
+// selected by the pipeline rather than branched on per fragment.
+inline gfx::PipelineKey pipelineKey(const GPUMaterial &material, bool skinned) {
+  gfx::PipelineKey key;
+  key.skinned = skinned;
+  switch (materialBlendMode(material)) {
+  case BlendMode::AlphaBlend:
+    key.blend = gfx::PipelineBlend::AlphaBlend;
+    break;
+  case BlendMode::Additive:
+    key.blend = gfx::PipelineBlend::Additive;
+    break;
+  default:
+    break;
+  }
+  if (material.textureIndex > 0) {
+    key.shaderFeatures |= gfx::ShaderFeature::Textured;
+  }
+  if (material.flags & MaterialFlags::HasAlphaTest) {
+    key.shaderFeatures |= gfx::ShaderFeature::AlphaTest;
+  }
+  if (material.flags & MaterialFlags::Unlit) {
+    key.shaderFeatures |= gfx::ShaderFeature::Unlit;
+  }
+  return key;
+}
+
+// Material flags for a blend mode
+inline uint32_t blendFlags(BlendMode mode) {
+  switch (mode) {
+  case BlendMode::AlphaBlend:
+    return MaterialFlags::AlphaBlend;
+  case BlendMode::Additive:
+    return MaterialFlags::Additive;
+  case BlendMode::AlphaTest:
+    return MaterialFlags::HasAlphaTest;
+  default:
+    return 0;
+  }
+}
+
 // CPU-side material definition
 struct Material {
   std::string name;
@@ -72,9 +133,7 @@ struct Material {
     if (textureIndex > 0) {
       gpu.flags |= MaterialFlags::HasTexture;
     }
-    if (blendMode == BlendMode::AlphaTest) {
-      gpu.flags |= MaterialFlags::HasAlphaTest;
-    }
+    gpu.flags |= blendFlags(blendMode);
     if (twoSided) {
       gpu.flags |= MaterialFlags::TwoSided;
     }
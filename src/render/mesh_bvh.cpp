@@ -0,0 +1,339 @@
+#include "mesh_bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "lib/gfx/bounding_box.hpp"
+
+namespace w3d {
+
+using gfx::BoundingBox;
+
+namespace {
+
+constexpr uint32_t BIN_COUNT = 12;
+
+// Ranges up to this size may stay leaves when no split is cheaper
+constexpr uint32_t MAX_LEAF_TRIANGLES = 16;
+
+// SAH cost of a node's box test relative to testing one packet
+constexpr float TRAVERSAL_COST = 0.5f;
+
+// Slab distances are widened by pbrt's 1 + 2 * gamma(3) so rounding never misses a box the
+// ray touches, and nodes are entered up to this fraction past the nearest hit, so a triangle
+// tying it by distance is still reached and the lower index can win
+constexpr float SLAB_WIDENING = 1.0f + 2.0f * 3.0f * std::numeric_limits<float>::epsilon();
+constexpr float ENTRY_SLACK = 1.0f + 1e-4f;
+
+// Node bounds grow by this fraction of their size and position, so a hit Möller-Trumbore
+// accepts on a triangle's edge is never outside its (possibly flat) box
+constexpr float BOUNDS_PADDING = 1e-5f;
+
+uint32_t packetsFor(size_t triangles) {
+  return static_cast<uint32_t>((triangles + 3) / 4);
+}
+
+float surfaceArea(const BoundingBox &bounds) {
+  if (!bounds.valid()) {
+    return 0.0f;
+  }
+  glm::vec3 size = bounds.size();
+  return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+uint32_t binOf(float centroid, float min, float scale) {
+  auto bin = static_cast<uint32_t>((centroid - min) * scale);
+  return std::min(bin, BIN_COUNT - 1);
+}
+
+} // namespace
+
+struct MeshBVH::BuildTriangle {
+  BoundingBox bounds;
+  glm::vec3 centroid;
+  uint32_t index;
+  std::array<glm::vec3, 3> corners;
+};
+
+void MeshBVH::clear() {
+  minX_.clear();
+  minY_.clear();
+  minZ_.clear();
+  maxX_.clear();
+  maxY_.clear();
+  maxZ_.clear();
+  childOrPacket_.clear();
+  packetCount_.clear();
+  packets_.clear();
+  packetTriangles_.clear();
+}
+
+void MeshBVH::build(const std::vector<glm::vec3> &positions,
+                    const std::vector<uint32_t> &indices) {
+  clear();
+
+  std::vector<BuildTriangle> triangles;
+  triangles.reserve(indices.size() / 3);
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    if (indices[i] >= positions.size() || indices[i + 1] >= positions.size() ||
+        indices[i + 2] >= positions.size()) {
+      continue;
+    }
+
+    BuildTriangle triangle;
+    triangle.index = static_cast<uint32_t>(i / 3);
+    triangle.corners = {positions[indices[i]], positions[indices[i + 1]],
+                        positions[indices[i + 2]]};
+    for (const glm::vec3 &corner : triangle.corners) {
+      triangle.bounds.expand(corner);
+    }
+    triangle.centroid = triangle.bounds.center();
+    triangles.push_back(triangle);
+  }
+
+  if (!triangles.empty()) {
+    buildNode(triangles, 0, triangles.size(), 0);
+  }
+}
+
+void MeshBVH::buildNode(std::vector<BuildTriangle> &triangles, size_t begin, size_t end,
+                        uint32_t depth) {
+  BoundingBox bounds;
+  BoundingBox centroidBounds;
+  for (size_t i = begin; i < end; ++i) {
+    bounds.expand(triangles[i].bounds);
+    centroidBounds.expand(triangles[i].centroid);
+  }
+  uint32_t node = addNode(bounds.min, bounds.max);
+
+  size_t count = end - begin;
+  if (count <= LEAF_TRIANGLES || depth >= MAX_DEPTH) {
+    addLeaf(node, triangles, begin, end);
+    return;
+  }
+
+  // Binned SAH over all three axes: cost of testing each side's packets, weighted by the
+  // chance (surface area) of a ray reaching it
+  float bestCost = std::numeric_limits<float>::max();
+  int bestAxis = -1;
+  uint32_t bestSplit = 0; // Bins below it go left
+  for (int axis = 0; axis < 3; ++axis) {
+    float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+    if (!(extent > 0.0f)) {
+      continue;
+    }
+    float scale = static_cast<float>(BIN_COUNT) / extent;
+
+    std::array<BoundingBox, BIN_COUNT> binBounds;
+    std::array<size_t, BIN_COUNT> binCounts{};
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t bin = binOf(triangles[i].centroid[axis], centroidBounds.min[axis], scale);
+      binBounds[bin].expand(triangles[i].bounds);
+      ++binCounts[bin];
+    }
+
+    // Right side of every split, swept from the last bin
+    std::array<float, BIN_COUNT> rightCost{};
+    BoundingBox right;
+    size_t rightCount = 0;
+    for (uint32_t split = BIN_COUNT - 1; split > 0; --split) {
+      right.expand(binBounds[split]);
+      rightCount += binCounts[split];
+      rightCost[split] = surfaceArea(right) * static_cast<float>(packetsFor(rightCount));
+    }
+
+    BoundingBox left;
+    size_t leftCount = 0;
+    for (uint32_t split = 1; split < BIN_COUNT; ++split) {
+      left.expand(binBounds[split - 1]);
+      leftCount += binCounts[split - 1];
+      if (leftCount == 0 || leftCount == count) {
+        continue;
+      }
+      float cost = surfaceArea(left) * static_cast<float>(packetsFor(leftCount)) +
+                   rightCost[split];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestSplit = split;
+      }
+    }
+  }
+
+  float area = surfaceArea(bounds);
+  float leafCost = area * static_cast<float>(packetsFor(count));
+  bool splitPays = bestAxis >= 0 && TRAVERSAL_COST * area + bestCost < leafCost;
+  if (bestAxis < 0 || (count <= MAX_LEAF_TRIANGLES && !splitPays)) {
+    addLeaf(node, triangles, begin, end);
+    return;
+  }
+
+  // Binned exactly as above, so neither side is empty
+  float min = centroidBounds.min[bestAxis];
+  float scale = static_cast<float>(BIN_COUNT) / (centroidBounds.max[bestAxis] - min);
+  auto goesLeft = [&](const BuildTriangle &triangle) {
+    return binOf(triangle.centroid[bestAxis], min, scale) < bestSplit;
+  };
+  auto middle = std::partition(triangles.begin() + static_cast<std::ptrdiff_t>(begin),
+                               triangles.begin() + static_cast<std::ptrdiff_t>(end), goesLeft);
+  size_t split = static_cast<size_t>(middle - triangles.begin());
+
+  buildNode(triangles, begin, split, depth + 1);
+  childOrPacket_[node] = static_cast<uint32_t>(nodeCount());
+  buildNode(triangles, split, end, depth + 1);
+}
+
+uint32_t MeshBVH::addNode(const glm::vec3 &min, const glm::vec3 &max) {
+  glm::vec3 size = max - min;
+  glm::vec3 magnitude = glm::max(glm::abs(min), glm::abs(max));
+  float padding = BOUNDS_PADDING * std::max({size.x, size.y, size.z, magnitude.x, magnitude.y,
+                                             magnitude.z});
+
+  minX_.push_back(min.x - padding);
+  minY_.push_back(min.y - padding);
+  minZ_.push_back(min.z - padding);
+  maxX_.push_back(max.x + padding);
+  maxY_.push_back(max.y + padding);
+  maxZ_.push_back(max.z + padding);
+  childOrPacket_.push_back(0);
+  packetCount_.push_back(0);
+  return static_cast<uint32_t>(packetCount_.size() - 1);
+}
+
+void MeshBVH::addLeaf(uint32_t node, const std::vector<BuildTriangle> &triangles, size_t begin,
+                      size_t end) {
+  childOrPacket_[node] = static_cast<uint32_t>(packets_.size());
+  packetCount_[node] = packetsFor(end - begin);
+
+  for (size_t first = begin; first < end; first += 4) {
+    TrianglePacket4 packet;
+    for (size_t lane = 0; lane < 4; ++lane) {
+      if (first + lane >= end) {
+        packetTriangles_.push_back(0); // Zeroed corners: never hit
+        continue;
+      }
+      const BuildTriangle &triangle = triangles[first + lane];
+      for (size_t corner = 0; corner < 3; ++corner) {
+        packet.x[corner][lane] = triangle.corners[corner].x;
+        packet.y[corner][lane] = triangle.corners[corner].y;
+        packet.z[corner][lane] = triangle.corners[corner].z;
+      }
+      packetTriangles_.push_back(triangle.index);
+    }
+    packets_.push_back(packet);
+  }
+}
+
+bool MeshBVH::enter(uint32_t node, const Ray &ray, const glm::vec3 &inverseDirection,
+                    float &entry) const {
+  const float mins[3] = {minX_[node], minY_[node], minZ_[node]};
+  const float maxs[3] = {maxX_[node], maxY_[node], maxZ_[node]};
+
+  float tNear = 0.0f;
+  float tFar = std::numeric_limits<float>::max();
+  for (int axis = 0; axis < 3; ++axis) {
+    if (ray.direction[axis] == 0.0f) {
+      // Parallel to the slab: inside it everywhere or nowhere
+      if (ray.origin[axis] < mins[axis] || ray.origin[axis] > maxs[axis]) {
+        return false;
+      }
+      continue;
+    }
+    float t0 = (mins[axis] - ray.origin[axis]) * inverseDirection[axis];
+    float t1 = (maxs[axis] - ray.origin[axis]) * inverseDirection[axis];
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+    tNear = std::max(tNear, t0);
+    tFar = std::min(tFar, t1 * SLAB_WIDENING);
+    if (tNear > tFar) {
+      return false;
+    }
+  }
+
+  entry = tNear;
+  return true;
+}
+
+MeshHit MeshBVH::intersect(const Ray &ray) const {
+  MeshHit nearest;
+  if (empty()) {
+    return nearest;
+  }
+
+  glm::vec3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y,
+                             1.0f / ray.direction.z);
+
+  // Popping revisits at most one pending sibling per level
+  struct Pending {
+    uint32_t node;
+    float entry;
+  };
+  std::array<Pending, MAX_DEPTH + 2> stack;
+  size_t top = 0;
+
+  float rootEntry = 0.0f;
+  if (!enter(0, ray, inverseDirection, rootEntry)) {
+    return nearest;
+  }
+  stack[top++] = {0, rootEntry};
+
+  while (top > 0) {
+    Pending pending = stack[--top];
+    if (nearest.hit.hit && pending.entry > nearest.hit.distance * ENTRY_SLACK) {
+      continue;
+    }
+    uint32_t node = pending.node;
+
+    if (packetCount_[node] > 0) {
+      uint32_t firstPacket = childOrPacket_[node];
+      for (uint32_t p = firstPacket; p < firstPacket + packetCount_[node]; ++p) {
+        TriangleHits4 hits = intersectRayTriangles4(ray, packets_[p]);
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+          if ((hits.mask & (1u << lane)) == 0) {
+            continue;
+          }
+          size_t triangle = packetTriangles_[p * 4 + lane];
+          float distance = hits.distance[lane];
+          // As the linear loop: strictly nearer, or as near with a lower index
+          if (distance < nearest.hit.distance ||
+              (distance == nearest.hit.distance && triangle < nearest.triangleIndex)) {
+            nearest.hit.hit = true;
+            nearest.hit.distance = distance;
+            nearest.hit.u = hits.u[lane];
+            nearest.hit.v = hits.v[lane];
+            nearest.triangleIndex = triangle;
+          }
+        }
+      }
+      continue;
+    }
+
+    // Nearer child on top of the stack
+    uint32_t first = node + 1;
+    uint32_t second = childOrPacket_[node];
+    float firstEntry = 0.0f;
+    float secondEntry = 0.0f;
+    bool enterFirst = enter(first, ray, inverseDirection, firstEntry);
+    bool enterSecond = enter(second, ray, inverseDirection, secondEntry);
+    if (enterFirst && enterSecond && firstEntry > secondEntry) {
+      std::swap(first, second);
+      std::swap(firstEntry, secondEntry);
+      std::swap(enterFirst, enterSecond);
+    }
+    if (enterSecond) {
+      stack[top++] = {second, secondEntry};
+    }
+    if (enterFirst) {
+      stack[top++] = {first, firstEntry};
+    }
+  }
+
+  if (nearest.hit.hit) {
+    nearest.hit.point = ray.origin + ray.direction * nearest.hit.distance;
+  }
+  return nearest;
+}
+
+} // namespace w3d
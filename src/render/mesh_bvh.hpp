@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/raycast.hpp"
+
+namespace w3d {
+
+// Nearest triangle of a mesh a ray hits
+struct MeshHit {
+  TriangleHit hit;
+  size_t triangleIndex = 0;
+};
+
+// Bounding volume hierarchy over one mesh's triangles for CPU picking. Built once at load by
+// binned SAH and flattened depth-first into one array per node field; each leaf's triangles
+// are stored as TrianglePacket4s, so leaves are tested four triangles at a time by
+// intersectRayTriangles4(). intersect() finds the triangle the linear loop over
+// intersectRayTriangle() finds, the lower index winning ties, with the same hit.
+class MeshBVH {
+public:
+  // Ranges of at most this many triangles become leaves: one packet
+  static constexpr uint32_t LEAF_TRIANGLES = 4;
+  // Deeper ranges become leaves whatever their size; bounds the traversal stack
+  static constexpr uint32_t MAX_DEPTH = 48;
+
+  // Build over the positions of a mesh's vertices (gfx::Vertex, gfx::SkinnedVertex)
+  template <typename VertexT>
+  void build(const std::vector<VertexT> &vertices, const std::vector<uint32_t> &indices) {
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+    for (const auto &vertex : vertices) {
+      positions.push_back(vertex.position);
+    }
+    build(positions, indices);
+  }
+
+  // Triangles indexing past the positions are left out, as getTriangle() skips them
+  void build(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices);
+
+  void clear();
+
+  bool empty() const { return packetCount_.empty(); }
+  size_t nodeCount() const { return packetCount_.size(); }
+  size_t packetCount() const { return packets_.size(); }
+
+  // No hit (hit.hit false) for an empty tree
+  MeshHit intersect(const Ray &ray) const;
+
+private:
+  struct BuildTriangle;
+
+  void buildNode(std::vector<BuildTriangle> &triangles, size_t begin, size_t end, uint32_t depth);
+  uint32_t addNode(const glm::vec3 &min, const glm::vec3 &max);
+  void addLeaf(uint32_t node, const std::vector<BuildTriangle> &triangles, size_t begin,
+               size_t end);
+
+  // Entry distance of the ray into a node's bounds, if it reaches them
+  bool enter(uint32_t node, const Ray &ray, const glm::vec3 &inverseDirection,
+             float &entry) const;
+
+  // Nodes, depth-first: an inner node's first child follows it
+  std::vector<float> minX_, minY_, minZ_;
+  std::vector<float> maxX_, maxY_, maxZ_;
+  std::vector<uint32_t> childOrPacket_; // Inner node: second child. Leaf: first packet.
+  std::vector<uint32_t> packetCount_;   // 0 for inner nodes
+
+  std::vector<TrianglePacket4> packets_;
+  std::vector<uint32_t> packetTriangles_; // Mesh triangle of every packet lane
+};
+
+} // namespace w3d
@@ -1,8 +1,14 @@
 #include "mesh_converter.hpp"
 
-#include <map>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <thread>
+#include <type_traits>
 
+#include "core/thread_pool.hpp"
 #include "skeleton.hpp"
+#include "vertex_transform.hpp"
 
 namespace w3d {
 
@@ -10,6 +16,11 @@ namespace w3d {
 using gfx::BoundingBox;
 using gfx::SkinnedVertex;
 using gfx::Vertex;
+using gfx::VertexFormat;
+
+static_assert(sizeof(Vertex) == gfx::vertexStride(VertexFormat::Full, false) &&
+                  sizeof(SkinnedVertex) == gfx::vertexStride(VertexFormat::Full, true),
+              "Full vertex format strides must match the vertex structs");
 
 namespace {
 
@@ -21,374 +32,469 @@ std::string getTextureName(const Mesh &mesh, uint32_t texId) {
   return "";
 }
 
-// Build a vertex from mesh data at given vertex and triangle indices
-Vertex buildVertex(const Mesh &mesh, uint32_t vertIdx, size_t triIdx, int corner,
-                   const std::vector<Vector2> *uvSource, const std::vector<uint32_t> *perFaceUVIds,
-                   const std::function<glm::vec3(const Mesh &, uint32_t)> &getColor) {
-  Vertex v;
-
-  // Position
-  if (vertIdx < mesh.vertices.size()) {
-    v.position = {mesh.vertices[vertIdx].x, mesh.vertices[vertIdx].y, mesh.vertices[vertIdx].z};
+// Blend mode of a triangle from the first pass's shader (W3D shaders are per pass, and per
+// triangle when a pass lists several)
+BlendMode getBlendMode(const Mesh &mesh, size_t triIdx) {
+  if (mesh.materialPasses.empty() || mesh.materialPasses[0].shaderIds.empty()) {
+    return BlendMode::Opaque;
+  }
+  const auto &shaderIds = mesh.materialPasses[0].shaderIds;
+  uint32_t shaderId = shaderIds.size() > triIdx ? shaderIds[triIdx] : shaderIds[0];
+  if (shaderId >= mesh.shaders.size()) {
+    return BlendMode::Opaque;
   }
 
-  // Normal
-  if (vertIdx < mesh.normals.size()) {
-    v.normal = {mesh.normals[vertIdx].x, mesh.normals[vertIdx].y, mesh.normals[vertIdx].z};
-  } else {
-    v.normal = {0.0f, 1.0f, 0.0f};
+  const ShaderDef &shader = mesh.shaders[shaderId];
+  bool opaque =
+      shader.srcBlend == Shader::SRCBLENDFUNC_ONE && shader.destBlend == Shader::DESTBLENDFUNC_ZERO;
+  if (opaque) {
+    return shader.alphaTest == Shader::ALPHATEST_ENABLE ? BlendMode::AlphaTest : BlendMode::Opaque;
+  }
+  if (shader.destBlend == Shader::DESTBLENDFUNC_ONE) {
+    return BlendMode::Additive;
   }
+  return BlendMode::AlphaBlend;
+}
 
-  // UV - handle per-face UV indices if present
-  if (perFaceUVIds && !perFaceUVIds->empty()) {
-    size_t uvIdxPosition = triIdx * 3 + corner;
-    if (uvIdxPosition < perFaceUVIds->size()) {
-      uint32_t uvIdx = (*perFaceUVIds)[uvIdxPosition];
-      if (uvSource && uvIdx < uvSource->size()) {
-        v.texCoord = {(*uvSource)[uvIdx].u, (*uvSource)[uvIdx].v};
+// Where a mesh's UVs and texture IDs come from, resolved once per mesh
+struct MeshSources {
+  const std::vector<Vector2> *uvSource = nullptr;
+  const std::vector<uint32_t> *perFaceUVIds = nullptr; // Null without per-face UV indices
+  const std::vector<uint32_t> *textureIds = nullptr;
+};
+
+MeshSources findSources(const Mesh &mesh) {
+  MeshSources sources;
+  sources.uvSource = &mesh.texCoords;
+  for (const auto &pass : mesh.materialPasses) {
+    for (const auto &stage : pass.textureStages) {
+      if (!stage.textureIds.empty() && sources.textureIds == nullptr) {
+        sources.textureIds = &stage.textureIds;
+      }
+      if (!stage.perFaceTexCoordIds.empty() && sources.perFaceUVIds == nullptr) {
+        sources.perFaceUVIds = &stage.perFaceTexCoordIds;
+      }
+      // Stage UVs are used when the mesh has none of its own
+      if (!stage.texCoords.empty() && mesh.texCoords.empty()) {
+        sources.uvSource = &stage.texCoords;
       }
     }
-  } else if (uvSource && vertIdx < uvSource->size()) {
-    v.texCoord = {(*uvSource)[vertIdx].u, (*uvSource)[vertIdx].v};
-  } else {
-    v.texCoord = {0.0f, 0.0f};
   }
-
-  // Vertex color
-  v.color = getColor(mesh, vertIdx);
-
-  return v;
+  return sources;
 }
 
-// Build a skinned vertex from mesh data
-SkinnedVertex buildSkinnedVertex(const Mesh &mesh, uint32_t vertIdx, size_t triIdx, int corner,
-                                 const std::vector<Vector2> *uvSource,
-                                 const std::vector<uint32_t> *perFaceUVIds,
-                                 const std::function<glm::vec3(const Mesh &, uint32_t)> &getColor,
-                                 uint32_t fallbackBoneIndex) {
-  SkinnedVertex v;
-
-  // Position
-  if (vertIdx < mesh.vertices.size()) {
-    v.position = {mesh.vertices[vertIdx].x, mesh.vertices[vertIdx].y, mesh.vertices[vertIdx].z};
-  }
-
-  // Normal
-  if (vertIdx < mesh.normals.size()) {
-    v.normal = {mesh.normals[vertIdx].x, mesh.normals[vertIdx].y, mesh.normals[vertIdx].z};
-  } else {
-    v.normal = {0.0f, 1.0f, 0.0f};
+// Triangles grouped by texture ID: groups in ascending ID order, each keeping the input order
+// of its triangles
+struct TextureGroups {
+  std::vector<uint32_t> textureIds; // Of each group
+  std::vector<uint32_t> offsets;    // Group g is triangles[offsets[g], offsets[g + 1])
+  std::vector<uint32_t> triangles;
+};
+
+// A counting sort over the texture IDs. A texture list shorter than the triangle list (a
+// single entry excepted) puts every triangle on texture 0.
+TextureGroups groupByTexture(size_t triCount, const std::vector<uint32_t> *textureIds) {
+  TextureGroups groups;
+  groups.triangles.resize(triCount);
+
+  bool perTriangle = textureIds && textureIds->size() > 1 && textureIds->size() >= triCount;
+  if (!perTriangle) {
+    groups.textureIds = {textureIds && textureIds->size() == 1 ? (*textureIds)[0] : 0};
+    groups.offsets = {0, static_cast<uint32_t>(triCount)};
+    std::iota(groups.triangles.begin(), groups.triangles.end(), 0u);
+    return groups;
   }
 
-  // UV - handle per-face UV indices if present
-  if (perFaceUVIds && !perFaceUVIds->empty()) {
-    size_t uvIdxPosition = triIdx * 3 + corner;
-    if (uvIdxPosition < perFaceUVIds->size()) {
-      uint32_t uvIdx = (*perFaceUVIds)[uvIdxPosition];
-      if (uvSource && uvIdx < uvSource->size()) {
-        v.texCoord = {(*uvSource)[uvIdx].u, (*uvSource)[uvIdx].v};
-      }
+  // Texture IDs index the mesh's textures and so are bucketed directly. Only IDs too large
+  // for a table the size of the triangle list (corrupt files) are ranked among the distinct
+  // IDs instead.
+  const uint32_t *ids = textureIds->data();
+  uint32_t maxId = *std::max_element(ids, ids + triCount);
+  std::vector<uint32_t> distinct;
+  std::vector<uint32_t> bucket(ids, ids + triCount);
+  if (maxId >= triCount) {
+    distinct = bucket;
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    for (uint32_t &b : bucket) {
+      b = static_cast<uint32_t>(std::lower_bound(distinct.begin(), distinct.end(), b) -
+                                distinct.begin());
     }
-  } else if (uvSource && vertIdx < uvSource->size()) {
-    v.texCoord = {(*uvSource)[vertIdx].u, (*uvSource)[vertIdx].v};
-  } else {
-    v.texCoord = {0.0f, 0.0f};
   }
+  size_t bucketCount = distinct.empty() ? size_t{maxId} + 1 : distinct.size();
 
-  // Vertex color
-  v.color = getColor(mesh, vertIdx);
-
-  // Bone index - use per-vertex influence if available, otherwise fallback
-  if (vertIdx < mesh.vertexInfluences.size()) {
-    v.boneIndex = mesh.vertexInfluences[vertIdx].boneIndex;
-  } else {
-    v.boneIndex = fallbackBoneIndex;
+  std::vector<uint32_t> start(bucketCount + 1, 0);
+  for (uint32_t b : bucket) {
+    ++start[b + 1];
+  }
+  std::partial_sum(start.begin(), start.end(), start.begin());
+  std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+  for (size_t t = 0; t < triCount; ++t) {
+    groups.triangles[fill[bucket[t]]++] = static_cast<uint32_t>(t);
   }
 
-  return v;
+  for (size_t b = 0; b < bucketCount; ++b) {
+    if (start[b + 1] > start[b]) {
+      groups.textureIds.push_back(distinct.empty() ? static_cast<uint32_t>(b) : distinct[b]);
+      groups.offsets.push_back(start[b]);
+    }
+  }
+  groups.offsets.push_back(static_cast<uint32_t>(triCount));
+  return groups;
 }
 
-} // namespace
-
-ConvertedMesh MeshConverter::convert(const Mesh &mesh) {
-  ConvertedMesh result;
-  result.name = mesh.header.meshName;
+template <typename ColorT>
+glm::vec3 toColor(const ColorT &c) {
+  return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f};
+}
 
-  size_t vertexCount = mesh.vertices.size();
-  if (vertexCount == 0 || mesh.triangles.empty()) {
-    return result;
+// Resolve the attributes of mesh vertices [begin, end) into out, which must be
+// value-initialized. Each attribute is copied over the vertices that have it and defaulted
+// over the rest, so the loops carry no per-vertex checks:
+// - positions beyond the mesh stay at the origin, missing normals point up, missing UVs are 0
+// - colors come from the vertex colors, then the first pass's DCG, then the first vertex
+//   material's diffuse, then light gray
+// - skinned vertices take their influence's bone, or fallbackBone
+template <typename VertexT>
+void resolveVertices(const Mesh &mesh, const std::vector<Vector2> &uvs, uint32_t fallbackBone,
+                     size_t begin, size_t end, VertexT *out) {
+  auto until = [&](size_t available) { return std::clamp(available, begin, end); };
+
+  for (size_t i = begin; i < until(mesh.vertices.size()); ++i) {
+    const auto &p = mesh.vertices[i];
+    out[i - begin].position = {p.x, p.y, p.z};
   }
 
-  // Find UV source and check for per-face UV indices
-  const std::vector<Vector2> *uvSource = &mesh.texCoords;
-  const std::vector<uint32_t> *perFaceUVIds = nullptr;
+  size_t normals = until(mesh.normals.size());
+  for (size_t i = begin; i < normals; ++i) {
+    const auto &n = mesh.normals[i];
+    out[i - begin].normal = {n.x, n.y, n.z};
+  }
+  for (size_t i = normals; i < end; ++i) {
+    out[i - begin].normal = {0.0f, 1.0f, 0.0f};
+  }
 
-  // Get texture IDs (per-triangle or single)
-  const std::vector<uint32_t> *textureIds = nullptr;
+  for (size_t i = begin; i < until(uvs.size()); ++i) {
+    out[i - begin].texCoord = {uvs[i].u, uvs[i].v};
+  }
 
+  size_t vertexColors = until(mesh.vertexColors.size());
+  for (size_t i = begin; i < vertexColors; ++i) {
+    out[i - begin].color = toColor(mesh.vertexColors[i]);
+  }
+  size_t passColors = vertexColors;
   if (!mesh.materialPasses.empty()) {
-    for (const auto &pass : mesh.materialPasses) {
-      for (const auto &stage : pass.textureStages) {
-        // Get texture IDs
-        if (!stage.textureIds.empty() && textureIds == nullptr) {
-          textureIds = &stage.textureIds;
-        }
-        // Check for per-face UV indices
-        if (!stage.perFaceTexCoordIds.empty() && perFaceUVIds == nullptr) {
-          perFaceUVIds = &stage.perFaceTexCoordIds;
-        }
-        // Get UV source from stage if mesh-level UVs are empty
-        if (!stage.texCoords.empty() && mesh.texCoords.empty()) {
-          uvSource = &stage.texCoords;
-        }
-      }
+    const auto &dcg = mesh.materialPasses[0].dcg;
+    passColors = std::max(vertexColors, until(dcg.size()));
+    for (size_t i = vertexColors; i < passColors; ++i) {
+      out[i - begin].color = toColor(dcg[i]);
     }
   }
+  glm::vec3 materialColor = mesh.vertexMaterials.empty()
+                                ? glm::vec3(0.8f, 0.8f, 0.8f)
+                                : toColor(mesh.vertexMaterials[0].diffuse);
+  for (size_t i = passColors; i < end; ++i) {
+    out[i - begin].color = materialColor;
+  }
 
-  // Build per-triangle texture ID array
-  size_t triCount = mesh.triangles.size();
-  std::vector<uint32_t> triangleTextureIds(triCount, 0);
-
-  if (textureIds) {
-    if (textureIds->size() == 1) {
-      // Single texture for all triangles
-      std::fill(triangleTextureIds.begin(), triangleTextureIds.end(), (*textureIds)[0]);
-    } else if (textureIds->size() >= triCount) {
-      // Per-triangle texture assignment
-      for (size_t i = 0; i < triCount; ++i) {
-        triangleTextureIds[i] = (*textureIds)[i];
-      }
+  if constexpr (std::is_same_v<VertexT, SkinnedVertex>) {
+    size_t influences = until(mesh.vertexInfluences.size());
+    for (size_t i = begin; i < influences; ++i) {
+      out[i - begin].boneIndex = mesh.vertexInfluences[i].boneIndex;
+    }
+    for (size_t i = influences; i < end; ++i) {
+      out[i - begin].boneIndex = fallbackBone;
     }
   }
+}
 
-  // Group triangles by texture ID
-  std::map<uint32_t, std::vector<size_t>> textureToTriangles;
-  for (size_t i = 0; i < triCount; ++i) {
-    textureToTriangles[triangleTextureIds[i]].push_back(i);
+// Shares one vertex between the corners of an unrolled sub-mesh whose position, normal, UV,
+// color (and bone) are bitwise identical, so the result renders exactly like the unrolled one.
+// An open-addressing table of vertex indices, sized so it never fills.
+template <typename VertexT>
+class VertexWelder {
+public:
+  VertexWelder(std::vector<VertexT> &vertices, size_t cornerCount) : vertices_(vertices) {
+    size_t capacity = 16;
+    while (capacity < cornerCount * 2) {
+      capacity *= 2;
+    }
+    slots_.assign(capacity, EMPTY_SLOT);
+    mask_ = capacity - 1;
   }
 
-  // Create a sub-mesh for each texture group
-  for (const auto &[texId, triangleIndices] : textureToTriangles) {
-    ConvertedSubMesh subMesh;
-    subMesh.textureName = getTextureName(mesh, texId);
-
-    // Reserve space
-    subMesh.vertices.reserve(triangleIndices.size() * 3);
-    subMesh.indices.reserve(triangleIndices.size() * 3);
-
-    // Check if we need to unroll (per-face UVs require unrolling, multi-texture also requires it)
-    bool needsUnroll = (perFaceUVIds && !perFaceUVIds->empty()) || textureToTriangles.size() > 1;
-
-    if (needsUnroll) {
-      // Unrolled mesh: create separate vertices for each triangle corner
-      for (size_t triIdx : triangleIndices) {
-        const auto &tri = mesh.triangles[triIdx];
-
-        for (int corner = 0; corner < 3; ++corner) {
-          uint32_t vertIdx = tri.vertexIndices[corner];
-          Vertex v =
-              buildVertex(mesh, vertIdx, triIdx, corner, uvSource, perFaceUVIds, getVertexColor);
-
-          subMesh.bounds.expand(v.position);
-          subMesh.indices.push_back(static_cast<uint32_t>(subMesh.vertices.size()));
-          subMesh.vertices.push_back(v);
-        }
+  // Index of the vertex equal to v, appended if there is none yet
+  uint32_t add(const VertexT &v) {
+    for (size_t slot = hash(v) & mask_;; slot = (slot + 1) & mask_) {
+      uint32_t index = slots_[slot];
+      if (index == EMPTY_SLOT) {
+        index = static_cast<uint32_t>(vertices_.size());
+        vertices_.push_back(v);
+        slots_[slot] = index;
+        return index;
       }
-    } else {
-      // Standard indexed mesh (only when single texture and no per-face UVs)
-      // Build vertex array
-      subMesh.vertices.reserve(vertexCount);
-      for (size_t i = 0; i < vertexCount; ++i) {
-        Vertex v;
-        v.position = {mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z};
-
-        if (i < mesh.normals.size()) {
-          v.normal = {mesh.normals[i].x, mesh.normals[i].y, mesh.normals[i].z};
-        } else {
-          v.normal = {0.0f, 1.0f, 0.0f};
-        }
-
-        if (uvSource && i < uvSource->size()) {
-          v.texCoord = {(*uvSource)[i].u, (*uvSource)[i].v};
-        } else {
-          v.texCoord = {0.0f, 0.0f};
-        }
-
-        v.color = getVertexColor(mesh, static_cast<uint32_t>(i));
-
-        subMesh.vertices.push_back(v);
-        subMesh.bounds.expand(v.position);
+      if (std::memcmp(&vertices_[index], &v, sizeof(VertexT)) == 0) {
+        return index;
       }
+    }
+  }
 
-      // Build index array
-      for (size_t triIdx : triangleIndices) {
-        const auto &tri = mesh.triangles[triIdx];
-        subMesh.indices.push_back(tri.vertexIndices[0]);
-        subMesh.indices.push_back(tri.vertexIndices[1]);
-        subMesh.indices.push_back(tri.vertexIndices[2]);
-      }
+private:
+  static_assert(std::is_trivially_copyable_v<VertexT> && sizeof(VertexT) % 4 == 0,
+                "Vertices are hashed and compared as 32-bit words");
+  static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+
+  static size_t hash(const VertexT &v) {
+    uint32_t words[sizeof(VertexT) / 4];
+    std::memcpy(words, &v, sizeof(VertexT));
+    uint64_t h = 0;
+    for (uint32_t word : words) {
+      h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+      h ^= h >> 29;
     }
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
 
-    result.combinedBounds.expand(subMesh.bounds);
-    result.subMeshes.push_back(std::move(subMesh));
+  std::vector<VertexT> &vertices_;
+  std::vector<uint32_t> slots_;
+  size_t mask_ = 0;
+};
+
+// One vertex in a compact layout; skinned vertices put their bone index in the color alpha
+template <typename PackedT, typename VertexT>
+PackedT packVertex(const VertexT &v, const gfx::PositionQuantization &quantization) {
+  PackedT packed{};
+  if constexpr (std::is_same_v<PackedT, gfx::QuantizedVertex>) {
+    auto lanes = quantization.quantize(v.position);
+    packed.position = {lanes[0], lanes[1], lanes[2], 0};
+  } else {
+    packed.position = v.position;
   }
+  packed.normal = gfx::packOctNormal(v.normal);
+  packed.texCoord = gfx::packHalf2(v.texCoord);
 
-  return result;
+  uint8_t alpha = 255;
+  if constexpr (std::is_same_v<VertexT, SkinnedVertex>) {
+    alpha = static_cast<uint8_t>(v.boneIndex);
+  }
+  packed.color = gfx::packColor(v.color, alpha);
+  return packed;
 }
 
-ConvertedSkinnedMesh MeshConverter::convertSkinned(const Mesh &mesh, int32_t fallbackBoneIndex) {
-  ConvertedSkinnedMesh result;
-  result.name = mesh.header.meshName;
-  result.fallbackBoneIndex = fallbackBoneIndex;
-  result.hasSkinning = !mesh.vertexInfluences.empty();
+template <typename PackedT, typename VertexT>
+void packVertices(const std::vector<VertexT> &vertices,
+                  const gfx::PositionQuantization &quantization, std::vector<uint8_t> &out) {
+  out.resize(vertices.size() * sizeof(PackedT));
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    PackedT packed = packVertex<PackedT>(vertices[i], quantization);
+    std::memcpy(out.data() + i * sizeof(PackedT), &packed, sizeof(PackedT));
+  }
+}
 
-  size_t vertexCount = mesh.vertices.size();
-  if (vertexCount == 0 || mesh.triangles.empty()) {
-    return result;
+template <typename SubMeshT>
+VertexCacheStats optimizeSubMesh(SubMeshT &subMesh) {
+  VertexCacheStats stats;
+  stats.triangles = subMesh.indices.size() / 3;
+  stats.missesBefore = countCacheMisses(subMesh.indices, subMesh.vertices.size());
+
+  if (subMesh.blendMode != BlendMode::AlphaBlend) {
+    subMesh.indices = optimizeVertexCache(subMesh.indices, subMesh.vertices.size());
   }
+  remapVertices(subMesh.vertices, optimizeVertexFetch(subMesh.indices, subMesh.vertices.size()));
 
-  // Determine the fallback bone index to use
-  uint32_t fallbackBone = fallbackBoneIndex >= 0 ? static_cast<uint32_t>(fallbackBoneIndex) : 0;
+  stats.missesAfter = countCacheMisses(subMesh.indices, subMesh.vertices.size());
+  return stats;
+}
 
-  // Find UV source and check for per-face UV indices
-  const std::vector<Vector2> *uvSource = &mesh.texCoords;
-  const std::vector<uint32_t> *perFaceUVIds = nullptr;
+template <typename MeshT>
+VertexCacheStats optimizeSubMeshes(MeshT &mesh) {
+  VertexCacheStats stats;
+  for (auto &subMesh : mesh.subMeshes) {
+    stats.add(optimizeSubMesh(subMesh));
+  }
+  return stats;
+}
 
-  // Get texture IDs (per-triangle or single)
-  const std::vector<uint32_t> *textureIds = nullptr;
+// Build the triangles of one texture group corner by corner from the resolved vertices,
+// welding identical corners. Per-face UVs are the only attribute that differs between the
+// corners of one vertex, so the loop is instantiated with and without them.
+template <bool PerFaceUVs, typename SubMeshT, typename VertexT>
+void buildCorners(const Mesh &mesh, const MeshSources &sources,
+                  const std::vector<VertexT> &resolved, uint32_t fallbackBone,
+                  const uint32_t *triangles, size_t triCount, SubMeshT &subMesh) {
+  const auto &uvs = *sources.uvSource;
+  VertexWelder<VertexT> welder(subMesh.vertices, triCount * 3);
+  subMesh.indices.reserve(triCount * 3);
+
+  for (size_t t = 0; t < triCount; ++t) {
+    size_t triIdx = triangles[t];
+    const auto &tri = mesh.triangles[triIdx];
+
+    for (int corner = 0; corner < 3; ++corner) {
+      uint32_t vertIdx = tri.vertexIndices[corner];
+      VertexT v{};
+      if (vertIdx < resolved.size()) {
+        v = resolved[vertIdx];
+      } else {
+        resolveVertices(mesh, uvs, fallbackBone, vertIdx, size_t{vertIdx} + 1, &v);
+      }
 
-  if (!mesh.materialPasses.empty()) {
-    for (const auto &pass : mesh.materialPasses) {
-      for (const auto &stage : pass.textureStages) {
-        if (!stage.textureIds.empty() && textureIds == nullptr) {
-          textureIds = &stage.textureIds;
-        }
-        if (!stage.perFaceTexCoordIds.empty() && perFaceUVIds == nullptr) {
-          perFaceUVIds = &stage.perFaceTexCoordIds;
-        }
-        if (!stage.texCoords.empty() && mesh.texCoords.empty()) {
-          uvSource = &stage.texCoords;
-        }
+      if constexpr (PerFaceUVs) {
+        const auto &uvIds = *sources.perFaceUVIds;
+        size_t slot = triIdx * 3 + corner;
+        uint32_t uvIdx = slot < uvIds.size() ? uvIds[slot] : UNUSED_VERTEX;
+        v.texCoord = uvIdx < uvs.size() ? glm::vec2(uvs[uvIdx].u, uvs[uvIdx].v) : glm::vec2(0.0f);
       }
+
+      subMesh.bounds.expand(v.position);
+      subMesh.indices.push_back(welder.add(v));
     }
   }
+}
+
+// Shared by convert() and convertSkinned(): one sub-mesh per texture group. A mesh with a
+// single group and no per-face UVs is indexed as it is; otherwise each group is built corner
+// by corner.
+template <typename ResultT>
+void convertInto(const Mesh &mesh, uint32_t fallbackBone, ResultT &result) {
+  using SubMeshT = typename decltype(ResultT::subMeshes)::value_type;
+  using VertexT = typename decltype(SubMeshT::vertices)::value_type;
 
-  // Build per-triangle texture ID array
+  size_t vertexCount = mesh.vertices.size();
   size_t triCount = mesh.triangles.size();
-  std::vector<uint32_t> triangleTextureIds(triCount, 0);
-
-  if (textureIds) {
-    if (textureIds->size() == 1) {
-      std::fill(triangleTextureIds.begin(), triangleTextureIds.end(), (*textureIds)[0]);
-    } else if (textureIds->size() >= triCount) {
-      for (size_t i = 0; i < triCount; ++i) {
-        triangleTextureIds[i] = (*textureIds)[i];
+  if (vertexCount == 0 || triCount == 0) {
+    return;
+  }
+
+  MeshSources sources = findSources(mesh);
+  TextureGroups groups = groupByTexture(triCount, sources.textureIds);
+  std::vector<VertexT> resolved(vertexCount);
+  resolveVertices(mesh, *sources.uvSource, fallbackBone, 0, vertexCount, resolved.data());
+
+  size_t groupCount = groups.textureIds.size();
+  result.subMeshes.reserve(groupCount);
+  for (size_t g = 0; g < groupCount; ++g) {
+    const uint32_t *triangles = groups.triangles.data() + groups.offsets[g];
+    size_t groupTriCount = groups.offsets[g + 1] - groups.offsets[g];
+
+    SubMeshT subMesh;
+    subMesh.textureName = getTextureName(mesh, groups.textureIds[g]);
+    subMesh.blendMode = getBlendMode(mesh, triangles[0]);
+
+    if (sources.perFaceUVIds) {
+      buildCorners<true>(mesh, sources, resolved, fallbackBone, triangles, groupTriCount,
+                         subMesh);
+    } else if (groupCount > 1) {
+      buildCorners<false>(mesh, sources, resolved, fallbackBone, triangles, groupTriCount,
+                          subMesh);
+    } else {
+      subMesh.indices.reserve(groupTriCount * 3);
+      for (size_t t = 0; t < groupTriCount; ++t) {
+        const auto &tri = mesh.triangles[triangles[t]];
+        subMesh.indices.insert(subMesh.indices.end(), tri.vertexIndices,
+                               tri.vertexIndices + 3);
+      }
+      subMesh.vertices = std::move(resolved);
+      for (const auto &v : subMesh.vertices) {
+        subMesh.bounds.expand(v.position);
       }
     }
+
+    result.combinedBounds.expand(subMesh.bounds);
+    result.subMeshes.push_back(std::move(subMesh));
   }
+}
 
-  // Group triangles by texture ID
-  std::map<uint32_t, std::vector<size_t>> textureToTriangles;
-  for (size_t i = 0; i < triCount; ++i) {
-    textureToTriangles[triangleTextureIds[i]].push_back(i);
+// Bone of a mesh in the HLod's mesh-to-bone map, looked up by its full name
+// (containerName.meshName) first, then by its mesh name
+int32_t findMeshBone(const std::unordered_map<std::string, int32_t> &meshToBone,
+                     const Mesh &mesh, int32_t notFound) {
+  auto it = meshToBone.find(mesh.header.containerName + "." + mesh.header.meshName);
+  if (it == meshToBone.end()) {
+    it = meshToBone.find(mesh.header.meshName);
   }
+  return it != meshToBone.end() ? it->second : notFound;
+}
 
-  // Create a sub-mesh for each texture group
-  for (const auto &[texId, triangleIndices] : textureToTriangles) {
-    ConvertedSkinnedSubMesh subMesh;
-    subMesh.textureName = getTextureName(mesh, texId);
+// Shared by every batch conversion and optimization; the calling thread works too. Batches
+// from concurrent loads take turns, as the pool runs one job at a time.
+ThreadPool &conversionPool() {
+  static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  return pool;
+}
 
-    subMesh.vertices.reserve(triangleIndices.size() * 3);
-    subMesh.indices.reserve(triangleIndices.size() * 3);
+void runParallel(size_t count, const std::function<void(uint32_t)> &task) {
+  if (count < 2) {
+    for (uint32_t i = 0; i < count; ++i) {
+      task(i);
+    }
+    return;
+  }
+  conversionPool().parallelFor(static_cast<uint32_t>(count), task);
+}
 
-    // Check if we need to unroll
-    bool needsUnroll = (perFaceUVIds && !perFaceUVIds->empty()) || textureToTriangles.size() > 1;
+template <typename MeshT>
+VertexCacheStats optimizeMeshes(std::vector<MeshT> &meshes) {
+  std::vector<VertexCacheStats> stats(meshes.size());
+  runParallel(meshes.size(),
+              [&](uint32_t i) { stats[i] = MeshConverter::optimize(meshes[i]); });
 
-    if (needsUnroll) {
-      // Unrolled mesh: create separate vertices for each triangle corner
-      for (size_t triIdx : triangleIndices) {
-        const auto &tri = mesh.triangles[triIdx];
+  VertexCacheStats total;
+  for (const auto &s : stats) {
+    total.add(s);
+  }
+  return total;
+}
 
-        for (int corner = 0; corner < 3; ++corner) {
-          uint32_t vertIdx = tri.vertexIndices[corner];
-          SkinnedVertex v = buildSkinnedVertex(mesh, vertIdx, triIdx, corner, uvSource,
-                                               perFaceUVIds, getVertexColor, fallbackBone);
+} // namespace
 
-          subMesh.bounds.expand(v.position);
-          subMesh.indices.push_back(static_cast<uint32_t>(subMesh.vertices.size()));
-          subMesh.vertices.push_back(v);
-        }
-      }
-    } else {
-      // Standard indexed mesh
-      subMesh.vertices.reserve(vertexCount);
-      for (size_t i = 0; i < vertexCount; ++i) {
-        SkinnedVertex v;
-        v.position = {mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z};
-
-        if (i < mesh.normals.size()) {
-          v.normal = {mesh.normals[i].x, mesh.normals[i].y, mesh.normals[i].z};
-        } else {
-          v.normal = {0.0f, 1.0f, 0.0f};
-        }
-
-        if (uvSource && i < uvSource->size()) {
-          v.texCoord = {(*uvSource)[i].u, (*uvSource)[i].v};
-        } else {
-          v.texCoord = {0.0f, 0.0f};
-        }
-
-        v.color = getVertexColor(mesh, static_cast<uint32_t>(i));
-
-        // Bone index
-        if (i < mesh.vertexInfluences.size()) {
-          v.boneIndex = mesh.vertexInfluences[i].boneIndex;
-        } else {
-          v.boneIndex = fallbackBone;
-        }
-
-        subMesh.vertices.push_back(v);
-        subMesh.bounds.expand(v.position);
-      }
+ConvertedMesh MeshConverter::convert(const Mesh &mesh) {
+  ConvertedMesh result;
+  result.name = mesh.header.meshName;
+  convertInto(mesh, 0, result);
+  return result;
+}
 
-      // Build index array
-      for (size_t triIdx : triangleIndices) {
-        const auto &tri = mesh.triangles[triIdx];
-        subMesh.indices.push_back(tri.vertexIndices[0]);
-        subMesh.indices.push_back(tri.vertexIndices[1]);
-        subMesh.indices.push_back(tri.vertexIndices[2]);
-      }
-    }
+ConvertedSkinnedMesh MeshConverter::convertSkinned(const Mesh &mesh, int32_t fallbackBoneIndex) {
+  ConvertedSkinnedMesh result;
+  result.name = mesh.header.meshName;
+  result.fallbackBoneIndex = fallbackBoneIndex;
+  result.hasSkinning = !mesh.vertexInfluences.empty();
 
-    result.combinedBounds.expand(subMesh.bounds);
-    result.subMeshes.push_back(std::move(subMesh));
-  }
+  // Determine the fallback bone index to use
+  uint32_t fallbackBone = fallbackBoneIndex >= 0 ? static_cast<uint32_t>(fallbackBoneIndex) : 0;
+  convertInto(mesh, fallbackBone, result);
+  return result;
+}
 
+std::vector<ConvertedMesh> MeshConverter::convertMany(const std::vector<MeshConversionJob> &jobs) {
+  std::vector<ConvertedMesh> result(jobs.size());
+  runParallel(jobs.size(), [&](uint32_t i) { result[i] = convert(*jobs[i].mesh); });
   return result;
 }
 
-std::vector<ConvertedSkinnedMesh> MeshConverter::convertAllSkinned(const W3DFile &file) {
-  std::vector<ConvertedSkinnedMesh> result;
-  result.reserve(file.meshes.size());
+std::vector<ConvertedSkinnedMesh>
+MeshConverter::convertManySkinned(const std::vector<MeshConversionJob> &jobs) {
+  std::vector<ConvertedSkinnedMesh> result(jobs.size());
+  runParallel(jobs.size(), [&](uint32_t i) {
+    result[i] = convertSkinned(*jobs[i].mesh, jobs[i].fallbackBoneIndex);
+  });
+  return result;
+}
 
+std::vector<ConvertedSkinnedMesh> MeshConverter::convertAllSkinned(const W3DFile &file) {
   // Build mesh name to bone index mapping from HLod data
   auto meshToBone = buildMeshToBoneMap(file);
 
+  std::vector<MeshConversionJob> jobs;
+  jobs.reserve(file.meshes.size());
   for (const auto &mesh : file.meshes) {
-    // Find fallback bone index for this mesh
-    int32_t fallbackBoneIndex = 0;
-    std::string fullName = mesh.header.containerName + "." + mesh.header.meshName;
-    auto it = meshToBone.find(fullName);
-    if (it != meshToBone.end()) {
-      fallbackBoneIndex = it->second;
-    } else {
-      it = meshToBone.find(mesh.header.meshName);
-      if (it != meshToBone.end()) {
-        fallbackBoneIndex = it->second;
-      }
-    }
+    jobs.push_back({&mesh, findMeshBone(meshToBone, mesh, 0)});
+  }
 
-    auto converted = convertSkinned(mesh, fallbackBoneIndex);
+  std::vector<ConvertedSkinnedMesh> result;
+  result.reserve(file.meshes.size());
+  for (auto &converted : convertManySkinned(jobs)) {
     if (!converted.subMeshes.empty()) {
       result.push_back(std::move(converted));
     }
@@ -422,38 +528,31 @@ std::vector<ConvertedMesh> MeshConverter::convertAll(const W3DFile &file) {
 
 std::vector<ConvertedMesh> MeshConverter::convertAllWithPose(const W3DFile &file,
                                                              const SkeletonPose *pose) {
-  std::vector<ConvertedMesh> result;
-  result.reserve(file.meshes.size());
-
   // Build mesh name to bone index mapping from HLod data
   auto meshToBone = buildMeshToBoneMap(file);
 
+  std::vector<MeshConversionJob> jobs;
+  jobs.reserve(file.meshes.size());
   for (const auto &mesh : file.meshes) {
-    auto converted = convert(mesh);
-    if (!converted.subMeshes.empty()) {
-      // Try to find bone index for this mesh
-      // First try full name (containerName.meshName)
-      std::string fullName = mesh.header.containerName + "." + mesh.header.meshName;
-      auto it = meshToBone.find(fullName);
-      if (it != meshToBone.end()) {
-        converted.boneIndex = it->second;
-      } else {
-        // Try just mesh name
-        it = meshToBone.find(mesh.header.meshName);
-        if (it != meshToBone.end()) {
-          converted.boneIndex = it->second;
-        }
-      }
+    jobs.push_back({&mesh, findMeshBone(meshToBone, mesh, -1)});
+  }
 
-      // Apply bone transform if skeleton pose is provided
-      if (pose && converted.boneIndex >= 0 &&
-          static_cast<size_t>(converted.boneIndex) < pose->boneCount()) {
-        glm::mat4 boneTransform = pose->boneTransform(static_cast<size_t>(converted.boneIndex));
-        applyBoneTransform(converted, boneTransform);
-      }
+  std::vector<ConvertedMesh> result;
+  result.reserve(file.meshes.size());
+  auto converted = convertMany(jobs);
+  for (size_t i = 0; i < converted.size(); ++i) {
+    if (converted[i].subMeshes.empty()) {
+      continue;
+    }
+    converted[i].boneIndex = jobs[i].fallbackBoneIndex;
 
-      result.push_back(std::move(converted));
+    // Apply bone transform if skeleton pose is provided
+    int32_t bone = converted[i].boneIndex;
+    if (pose && bone >= 0 && static_cast<size_t>(bone) < pose->boneCount()) {
+      applyBoneTransform(converted[i], pose->boneTransform(static_cast<size_t>(bone)));
     }
+
+    result.push_back(std::move(converted[i]));
   }
 
   return result;
@@ -463,24 +562,10 @@ void MeshConverter::applyBoneTransform(ConvertedMesh &mesh, const glm::mat4 &tra
   // Reset combined bounds since we're transforming vertices
   mesh.combinedBounds = BoundingBox{};
 
-  // Transform each vertex position and normal
-  glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
-
   for (auto &subMesh : mesh.subMeshes) {
     subMesh.bounds = BoundingBox{};
-
-    for (auto &v : subMesh.vertices) {
-      // Transform position
-      glm::vec4 pos = transform * glm::vec4(v.position, 1.0f);
-      v.position = glm::vec3(pos);
-
-      // Transform normal (using normal matrix to handle non-uniform scaling)
-      v.normal = glm::normalize(normalMatrix * v.normal);
-
-      // Update bounds
-      subMesh.bounds.expand(v.position);
-    }
-
+    transformVertices(subMesh.vertices.data(), subMesh.vertices.size(), transform,
+                      subMesh.bounds);
     mesh.combinedBounds.expand(subMesh.bounds);
   }
 }
@@ -501,27 +586,61 @@ BoundingBox MeshConverter::combinedBounds(const std::vector<ConvertedSkinnedMesh
   return combined;
 }
 
-glm::vec3 MeshConverter::getVertexColor(const Mesh &mesh, uint32_t idx) {
-  // Priority 1: Per-vertex colors
-  if (idx < mesh.vertexColors.size()) {
-    const auto &c = mesh.vertexColors[idx];
-    return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f};
-  }
+VertexCacheStats MeshConverter::optimize(ConvertedMesh &mesh) {
+  return optimizeSubMeshes(mesh);
+}
 
-  // Priority 2: Material pass DCG (diffuse color per vertex)
-  if (!mesh.materialPasses.empty() && idx < mesh.materialPasses[0].dcg.size()) {
-    const auto &c = mesh.materialPasses[0].dcg[idx];
-    return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f};
-  }
+VertexCacheStats MeshConverter::optimize(ConvertedSkinnedMesh &mesh) {
+  return optimizeSubMeshes(mesh);
+}
+
+VertexCacheStats MeshConverter::optimizeAll(std::vector<ConvertedMesh> &meshes) {
+  return optimizeMeshes(meshes);
+}
+
+VertexCacheStats MeshConverter::optimizeAll(std::vector<ConvertedSkinnedMesh> &meshes) {
+  return optimizeMeshes(meshes);
+}
 
-  // Priority 3: First vertex material diffuse color
-  if (!mesh.vertexMaterials.empty()) {
-    const auto &c = mesh.vertexMaterials[0].diffuse;
-    return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f};
+template <typename VertexT>
+gfx::EncodedVertices MeshConverter::encodeVertices(const std::vector<VertexT> &vertices,
+                                                   VertexFormat format, const BoundingBox &bounds) {
+  constexpr bool skinned = std::is_same_v<VertexT, SkinnedVertex>;
+  if constexpr (skinned) {
+    for (const auto &v : vertices) {
+      if (v.boneIndex > gfx::COMPACT_MAX_BONE) {
+        format = VertexFormat::Full;
+        break;
+      }
+    }
   }
 
-  // Fallback: Light gray
-  return {0.8f, 0.8f, 0.8f};
+  gfx::EncodedVertices encoded;
+  encoded.encoding.format = format;
+  encoded.stride = gfx::vertexStride(format, skinned);
+  encoded.count = static_cast<uint32_t>(vertices.size());
+
+  switch (format) {
+  case VertexFormat::Compact:
+    packVertices<gfx::CompactVertex>(vertices, encoded.encoding.quantization, encoded.data);
+    break;
+  case VertexFormat::Quantized:
+    encoded.encoding.quantization = gfx::PositionQuantization::fromBounds(bounds);
+    packVertices<gfx::QuantizedVertex>(vertices, encoded.encoding.quantization, encoded.data);
+    break;
+  default:
+    encoded.data.resize(vertices.size() * sizeof(VertexT));
+    if (!vertices.empty()) {
+      std::memcpy(encoded.data.data(), vertices.data(), encoded.data.size());
+    }
+    break;
+  }
+  return encoded;
 }
 
+template gfx::EncodedVertices MeshConverter::encodeVertices(const std::vector<Vertex> &,
+                                                            VertexFormat, const BoundingBox &);
+template gfx::EncodedVertices MeshConverter::encodeVertices(const std::vector<SkinnedVertex> &,
+                                                            VertexFormat, const BoundingBox &);
+
 } // namespace w3d
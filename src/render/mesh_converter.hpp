@@ -8,6 +8,9 @@
 
 #include "lib/formats/w3d/types.hpp"
 #include "lib/gfx/bounding_box.hpp"
+#include "lib/gfx/vertex_format.hpp"
+#include "render/material.hpp"
+#include "render/mesh_optimizer.hpp"
 
 namespace w3d {
 
@@ -19,6 +22,7 @@ struct ConvertedSubMesh {
   std::vector<uint32_t> indices;
   gfx::BoundingBox bounds;
   std::string textureName;
+  BlendMode blendMode = BlendMode::Opaque; // From the shader of its first triangle
 };
 
 // A skinned sub-mesh with per-vertex bone indices
@@ -27,6 +31,7 @@ struct ConvertedSkinnedSubMesh {
   std::vector<uint32_t> indices;
   gfx::BoundingBox bounds;
   std::string textureName;
+  BlendMode blendMode = BlendMode::Opaque; // From the shader of its first triangle
 };
 
 // Result of converting a mesh (may have multiple sub-meshes if per-triangle textures)
@@ -46,6 +51,13 @@ struct ConvertedSkinnedMesh {
   bool hasSkinning = false;                       // True if mesh has per-vertex bone indices
 };
 
+// One mesh of a batch conversion; the fallback bone is used by skinned conversion and by
+// convertAllWithPose() for the mesh's bone
+struct MeshConversionJob {
+  const Mesh *mesh = nullptr;
+  int32_t fallbackBoneIndex = 0;
+};
+
 class MeshConverter {
 public:
   // Convert a single W3D mesh to GPU format
@@ -54,6 +66,13 @@ public:
   // Convert a single W3D mesh to skinned GPU format (with per-vertex bone indices)
   static ConvertedSkinnedMesh convertSkinned(const Mesh &mesh, int32_t fallbackBoneIndex);
 
+  // Convert independent meshes in parallel, one task per mesh, on a pool shared by all
+  // conversions. Results are in job order, including empty ones. Call from one thread at a
+  // time.
+  static std::vector<ConvertedMesh> convertMany(const std::vector<MeshConversionJob> &jobs);
+  static std::vector<ConvertedSkinnedMesh>
+  convertManySkinned(const std::vector<MeshConversionJob> &jobs);
+
   // Convert all meshes in a W3D file (without bone transforms applied)
   static std::vector<ConvertedMesh> convertAll(const W3DFile &file);
 
@@ -73,10 +92,26 @@ public:
   // Calculate combined bounds for skinned meshes
   static gfx::BoundingBox combinedBounds(const std::vector<ConvertedSkinnedMesh> &meshes);
 
-private:
-  // Get vertex color with fallback to default
-  static glm::vec3 getVertexColor(const Mesh &mesh, uint32_t vertexIndex);
+  // Optimization stage run after conversion: reorder each sub-mesh's triangles for the
+  // post-transform vertex cache, then its vertices for fetch locality. Alpha-blended
+  // sub-meshes keep their triangle order, which is their blend order. Returns the cache
+  // misses before and after.
+  static VertexCacheStats optimize(ConvertedMesh &mesh);
+  static VertexCacheStats optimize(ConvertedSkinnedMesh &mesh);
+
+  // optimize() every mesh in parallel on the conversion pool; returns the summed stats
+  static VertexCacheStats optimizeAll(std::vector<ConvertedMesh> &meshes);
+  static VertexCacheStats optimizeAll(std::vector<ConvertedSkinnedMesh> &meshes);
+
+  // Encode gfx::Vertex or gfx::SkinnedVertex data in a vertex format for upload. Quantized
+  // positions span bounds, which should contain every vertex. Skinned vertices referencing a
+  // bone above gfx::COMPACT_MAX_BONE keep the full format.
+  template <typename VertexT>
+  static gfx::EncodedVertices encodeVertices(const std::vector<VertexT> &vertices,
+                                             gfx::VertexFormat format,
+                                             const gfx::BoundingBox &bounds);
 
+private:
   // Build mesh name to bone index mapping from HLod data
   static std::unordered_map<std::string, int32_t> buildMeshToBoneMap(const W3DFile &file);
 };
@@ -0,0 +1,189 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace w3d {
+
+namespace {
+
+// Scoring constants from Forsyth, "Linear-Speed Vertex Cache Optimisation"
+constexpr uint32_t LRU_SIZE = 32; // Cache modeled while scoring
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+// Vertices in the cache score by recency (the last triangle's corners a fixed amount, so the
+// next triangle does not simply reuse its edge), and vertices with few triangles left get a
+// boost so they are finished off instead of stranding lone triangles
+float vertexScore(int32_t cachePosition, uint32_t remainingTriangles) {
+  if (remainingTriangles == 0) {
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    if (cachePosition < 3) {
+      score = LAST_TRIANGLE_SCORE;
+    } else {
+      float scale = 1.0f / static_cast<float>(LRU_SIZE - 3);
+      score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, CACHE_DECAY_POWER);
+    }
+  }
+  score += VALENCE_BOOST_SCALE *
+           std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+  return score;
+}
+
+} // namespace
+
+uint64_t countCacheMisses(const std::vector<uint32_t> &indices, size_t vertexCount,
+                          uint32_t cacheSize) {
+  // A vertex is cached while fewer than cacheSize misses happened since its own
+  std::vector<uint64_t> insertedAt(vertexCount, 0);
+  uint64_t timestamp = static_cast<uint64_t>(cacheSize) + 1;
+  uint64_t misses = 0;
+  for (uint32_t index : indices) {
+    if (index >= vertexCount) {
+      ++misses;
+      continue;
+    }
+    if (timestamp - insertedAt[index] > cacheSize) {
+      insertedAt[index] = timestamp++;
+      ++misses;
+    }
+  }
+  return misses;
+}
+
+std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t> &indices,
+                                          size_t vertexCount) {
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0 || indices.size() % 3 != 0 ||
+      std::any_of(indices.begin(), indices.end(),
+                  [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+    return indices;
+  }
+
+  // Triangles still to emit around each vertex, packed per vertex
+  std::vector<uint32_t> remaining(vertexCount, 0);
+  for (uint32_t index : indices) {
+    ++remaining[index];
+  }
+  std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; ++v) {
+    adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  std::vector<int32_t> cachePosition(vertexCount, -1);
+  std::vector<float> score(vertexCount);
+  for (size_t v = 0; v < vertexCount; ++v) {
+    score[v] = vertexScore(-1, remaining[v]);
+  }
+  std::vector<float> triangleScore(triangleCount);
+  for (size_t t = 0; t < triangleCount; ++t) {
+    const uint32_t *corners = &indices[t * 3];
+    triangleScore[t] = score[corners[0]] + score[corners[1]] + score[corners[2]];
+  }
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> nextCache;
+  cache.reserve(LRU_SIZE + 3);
+  nextCache.reserve(LRU_SIZE + 3);
+
+  std::vector<uint32_t> out;
+  out.reserve(indices.size());
+  size_t nextInOrder = 0;
+  uint32_t best = NO_TRIANGLE;
+
+  for (size_t count = 0; count < triangleCount; ++count) {
+    if (best == NO_TRIANGLE) {
+      // Nothing in the cache has triangles left: continue with the next one in input order
+      while (emitted[nextInOrder]) {
+        ++nextInOrder;
+      }
+      best = static_cast<uint32_t>(nextInOrder);
+    }
+
+    const uint32_t *corners = &indices[static_cast<size_t>(best) * 3];
+    emitted[best] = true;
+    out.insert(out.end(), corners, corners + 3);
+
+    // The triangle no longer counts towards its vertices' valence
+    nextCache.clear();
+    for (int c = 0; c < 3; ++c) {
+      uint32_t v = corners[c];
+      auto begin = adjacency.begin() + adjacencyStart[v];
+      auto end = begin + remaining[v];
+      auto it = std::find(begin, end, best);
+      if (it != end) {
+        std::iter_swap(it, end - 1);
+        --remaining[v];
+      }
+      if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+        nextCache.push_back(v);
+      }
+    }
+
+    // LRU update: the corners move to the front, the oldest entries fall out
+    for (uint32_t v : cache) {
+      if (v != corners[0] && v != corners[1] && v != corners[2]) {
+        nextCache.push_back(v);
+      }
+    }
+    for (size_t i = 0; i < nextCache.size(); ++i) {
+      uint32_t v = nextCache[i];
+      cachePosition[v] = i < LRU_SIZE ? static_cast<int32_t>(i) : -1;
+      score[v] = vertexScore(cachePosition[v], remaining[v]);
+    }
+
+    // Rescore the triangles around every vertex whose score changed; the next triangle is
+    // the best one touching the cache
+    best = NO_TRIANGLE;
+    float bestScore = -std::numeric_limits<float>::max();
+    for (size_t i = 0; i < nextCache.size(); ++i) {
+      uint32_t v = nextCache[i];
+      for (uint32_t a = 0; a < remaining[v]; ++a) {
+        uint32_t t = adjacency[adjacencyStart[v] + a];
+        const uint32_t *tc = &indices[static_cast<size_t>(t) * 3];
+        triangleScore[t] = score[tc[0]] + score[tc[1]] + score[tc[2]];
+        if (i < LRU_SIZE && triangleScore[t] > bestScore) {
+          bestScore = triangleScore[t];
+          best = t;
+        }
+      }
+    }
+
+    nextCache.resize(std::min<size_t>(nextCache.size(), LRU_SIZE));
+    std::swap(cache, nextCache);
+  }
+
+  return out;
+}
+
+std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount) {
+  std::vector<uint32_t> remap(vertexCount, UNUSED_VERTEX);
+  uint32_t next = 0;
+  for (uint32_t &index : indices) {
+    if (index >= vertexCount) {
+      continue;
+    }
+    if (remap[index] == UNUSED_VERTEX) {
+      remap[index] = next++;
+    }
+    index = remap[index];
+  }
+  return remap;
+}
+
+} // namespace w3d
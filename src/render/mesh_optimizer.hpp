@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace w3d {
+
+// Entries of the FIFO post-transform cache that ACMR is measured against, a conservative
+// size for the GPUs the viewer runs on
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Vertex shader invocations of triangle lists before and after optimization. ACMR (average
+// cache miss ratio) is misses per triangle: 3 without any reuse, 0.5 for an ideal large grid.
+struct VertexCacheStats {
+  uint64_t triangles = 0;
+  uint64_t missesBefore = 0;
+  uint64_t missesAfter = 0;
+
+  double acmrBefore() const { return acmr(missesBefore); }
+  double acmrAfter() const { return acmr(missesAfter); }
+
+  void add(const VertexCacheStats &other) {
+    triangles += other.triangles;
+    missesBefore += other.missesBefore;
+    missesAfter += other.missesAfter;
+  }
+
+private:
+  double acmr(uint64_t misses) const {
+    return triangles > 0 ? static_cast<double>(misses) / static_cast<double>(triangles) : 0.0;
+  }
+};
+
+// Vertices a FIFO cache of cacheSize entries transforms for a triangle list
+uint64_t countCacheMisses(const std::vector<uint32_t> &indices, size_t vertexCount,
+                          uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorder a triangle list for the post-transform cache (Forsyth's linear-speed algorithm).
+// Triangles keep their corners and winding; only their order changes. Lists with an index
+// out of range are returned unchanged.
+std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t> &indices,
+                                          size_t vertexCount);
+
+// Renumber vertices in the order the triangle list first uses them, so vertex fetches walk
+// the buffer forwards. Rewrites indices (all below vertexCount) and returns the old-to-new
+// remap; unreferenced vertices map to UNUSED_VERTEX and are dropped.
+constexpr uint32_t UNUSED_VERTEX = 0xFFFFFFFFu;
+std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount);
+
+// Apply a remap from optimizeVertexFetch() to a vertex array
+template <typename VertexT>
+void remapVertices(std::vector<VertexT> &vertices, const std::vector<uint32_t> &remap) {
+  size_t used = 0;
+  for (uint32_t target : remap) {
+    used += target != UNUSED_VERTEX ? 1 : 0;
+  }
+
+  std::vector<VertexT> remapped(used);
+  for (size_t i = 0; i < remap.size() && i < vertices.size(); ++i) {
+    if (remap[i] != UNUSED_VERTEX) {
+      remapped[remap[i]] = vertices[i];
+    }
+  }
+  vertices = std::move(remapped);
+}
+
+} // namespace w3d
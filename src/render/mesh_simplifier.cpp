@@ -0,0 +1,274 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace w3d {
+
+namespace {
+
+// Minimum cosine between a triangle's normal before and after a collapse; rejects collapses
+// that fold a triangle over or turn it by more than about 75 degrees
+constexpr float MIN_NORMAL_COSINE = 0.25f;
+
+// Sum of squared distances to a set of planes, each weighted by its triangle's area:
+// error(p) = p^T A p + 2 b.p + c
+struct Quadric {
+  double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+  double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+  double c = 0.0;
+  double weight = 0.0; // Total area, to turn the error back into a distance
+
+  static Quadric fromPlane(const glm::vec3 &normal, float distance, double weight) {
+    double x = normal.x, y = normal.y, z = normal.z, d = distance;
+    Quadric q;
+    q.a00 = weight * x * x;
+    q.a01 = weight * x * y;
+    q.a02 = weight * x * z;
+    q.a11 = weight * y * y;
+    q.a12 = weight * y * z;
+    q.a22 = weight * z * z;
+    q.b0 = weight * x * d;
+    q.b1 = weight * y * d;
+    q.b2 = weight * z * d;
+    q.c = weight * d * d;
+    q.weight = weight;
+    return q;
+  }
+
+  void add(const Quadric &o) {
+    a00 += o.a00;
+    a01 += o.a01;
+    a02 += o.a02;
+    a11 += o.a11;
+    a12 += o.a12;
+    a22 += o.a22;
+    b0 += o.b0;
+    b1 += o.b1;
+    b2 += o.b2;
+    c += o.c;
+    weight += o.weight;
+  }
+
+  double evaluate(const glm::vec3 &p) const {
+    double x = p.x, y = p.y, z = p.z;
+    double error = a00 * x * x + a11 * y * y + a22 * z * z +
+                   2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    return std::max(error, 0.0);
+  }
+};
+
+struct Collapse {
+  double cost;
+  uint32_t from;
+  uint32_t to;
+
+  bool operator<(const Collapse &o) const {
+    if (cost != o.cost) {
+      return cost < o.cost;
+    }
+    return from != o.from ? from < o.from : to < o.to;
+  }
+};
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+  return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+// Vertices on an edge that does not join exactly two triangles
+std::vector<bool> openEdgeVertices(const std::vector<uint32_t> &indices, size_t vertexCount) {
+  std::vector<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    for (size_t e = 0; e < 3; ++e) {
+      edges.push_back(edgeKey(indices[i + e], indices[i + (e + 1) % 3]));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+
+  std::vector<bool> open(vertexCount, false);
+  for (size_t i = 0; i < edges.size();) {
+    size_t end = i;
+    while (end < edges.size() && edges[end] == edges[i]) {
+      ++end;
+    }
+    if (end - i != 2) {
+      open[edges[i] >> 32] = true;
+      open[edges[i] & 0xFFFFFFFFu] = true;
+    }
+    i = end;
+  }
+  return open;
+}
+
+} // namespace
+
+SimplifiedMesh simplifyMesh(const std::vector<uint32_t> &indices,
+                            const std::vector<glm::vec3> &positions, size_t targetIndexCount,
+                            const std::vector<uint32_t> *vertexGroups) {
+  SimplifiedMesh result;
+  result.indices = indices;
+  size_t vertexCount = positions.size();
+  if (indices.size() % 3 != 0 || (vertexGroups && vertexGroups->size() < vertexCount) ||
+      std::any_of(indices.begin(), indices.end(),
+                  [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+    return result;
+  }
+
+  std::vector<Quadric> quadrics(vertexCount);
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const glm::vec3 &p0 = positions[indices[i]];
+    glm::vec3 normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+    float length = glm::length(normal);
+    if (length <= 0.0f) {
+      continue;
+    }
+    normal /= length;
+    Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, p0), 0.5 * length);
+    for (size_t c = 0; c < 3; ++c) {
+      quadrics[indices[i + c]].add(plane);
+    }
+  }
+
+  std::vector<bool> locked = openEdgeVertices(indices, vertexCount);
+  auto canCollapse = [&](uint32_t from, uint32_t to) {
+    return !locked[from] && (!vertexGroups || (*vertexGroups)[from] == (*vertexGroups)[to]);
+  };
+
+  std::vector<uint32_t> adjacencyStart(vertexCount + 1);
+  std::vector<uint32_t> adjacency;
+  std::vector<uint32_t> remap(vertexCount);
+  std::vector<bool> touched(vertexCount);
+  std::vector<Collapse> candidates;
+  double maxError = 0.0;
+
+  // Each pass collapses the cheapest edges whose neighbourhoods do not overlap, so every
+  // collapse is judged against triangles no other collapse of the pass changes
+  while (result.indices.size() > targetIndexCount) {
+    const auto &current = result.indices;
+
+    std::fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+    for (uint32_t index : current) {
+      ++adjacencyStart[index + 1];
+    }
+    std::partial_sum(adjacencyStart.begin(), adjacencyStart.end(), adjacencyStart.begin());
+    adjacency.resize(current.size());
+    std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t i = 0; i < current.size(); ++i) {
+      adjacency[fill[current[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // The cheaper direction of every edge, each edge once from the triangle listing it with
+    // its lower vertex first
+    candidates.clear();
+    for (size_t i = 0; i < current.size(); i += 3) {
+      for (size_t e = 0; e < 3; ++e) {
+        uint32_t a = current[i + e];
+        uint32_t b = current[i + (e + 1) % 3];
+        if (a >= b) {
+          continue;
+        }
+        Collapse best{std::numeric_limits<double>::max(), a, b};
+        for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+          if (!canCollapse(from, to)) {
+            continue;
+          }
+          Quadric merged = quadrics[from];
+          merged.add(quadrics[to]);
+          Collapse collapse{merged.evaluate(positions[to]), from, to};
+          if (collapse < best) {
+            best = collapse;
+          }
+        }
+        if (best.cost != std::numeric_limits<double>::max()) {
+          candidates.push_back(best);
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::iota(remap.begin(), remap.end(), 0u);
+    std::fill(touched.begin(), touched.end(), false);
+    size_t trianglesToRemove = (current.size() - targetIndexCount + 2) / 3;
+    size_t removed = 0;
+    size_t collapses = 0;
+
+    for (const Collapse &collapse : candidates) {
+      if (removed >= trianglesToRemove) {
+        break;
+      }
+      uint32_t from = collapse.from;
+      uint32_t to = collapse.to;
+      if (touched[from] || touched[to]) {
+        continue;
+      }
+
+      // Triangles around from keep their orientation with from moved onto to
+      bool folds = false;
+      size_t collapsed = 0;
+      for (uint32_t a = adjacencyStart[from]; a < adjacencyStart[from + 1] && !folds; ++a) {
+        const uint32_t *tri = &current[static_cast<size_t>(adjacency[a]) * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+          ++collapsed;
+          continue;
+        }
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (int c = 0; c < 3; ++c) {
+          before[c] = positions[tri[c]];
+          after[c] = tri[c] == from ? positions[to] : before[c];
+        }
+        glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+        folds = glm::dot(n0, n1) <= MIN_NORMAL_COSINE * glm::length(n0) * glm::length(n1);
+      }
+      if (folds) {
+        continue;
+      }
+
+      remap[from] = to;
+      quadrics[to].add(quadrics[from]);
+      if (quadrics[to].weight > 0.0) {
+        maxError = std::max(maxError, std::sqrt(collapse.cost / quadrics[to].weight));
+      }
+      for (uint32_t a = adjacencyStart[from]; a < adjacencyStart[from + 1]; ++a) {
+        const uint32_t *tri = &current[static_cast<size_t>(adjacency[a]) * 3];
+        touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+      }
+      removed += collapsed;
+      ++collapses;
+    }
+
+    if (collapses == 0) {
+      break;
+    }
+
+    std::vector<uint32_t> next;
+    next.reserve(current.size() - removed * 3);
+    for (size_t i = 0; i < current.size(); i += 3) {
+      uint32_t a = remap[current[i]];
+      uint32_t b = remap[current[i + 1]];
+      uint32_t c = remap[current[i + 2]];
+      if (a != b && b != c && a != c) {
+        next.insert(next.end(), {a, b, c});
+      }
+    }
+    result.indices = std::move(next);
+  }
+
+  result.error = static_cast<float>(maxError);
+  return result;
+}
+
+float lodMaxScreenSize(float error, float radius) {
+  // A model of screen size S spans about S / (2 * radius) pixels per unit
+  if (error <= 0.0f) {
+    return std::numeric_limits<float>::max();
+  }
+  return 2.0f * radius * LOD_PIXEL_ERROR / error;
+}
+
+} // namespace w3d
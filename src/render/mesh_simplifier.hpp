@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace w3d {
+
+// Screen-space error, in pixels as HLodModel::updateLOD() measures screen size, that a
+// generated LOD level may show before the next more detailed level takes over
+constexpr float LOD_PIXEL_ERROR = 1.0f;
+
+struct SimplifiedMesh {
+  std::vector<uint32_t> indices;
+  float error = 0.0f; // Largest collapse error, as an RMS distance to the merged planes
+};
+
+// Reduce a triangle list towards targetIndexCount indices by quadric error metric edge
+// collapses (Garland-Heckbert). Every collapse moves a vertex onto a neighbouring vertex, so
+// the result references the input vertices unchanged and keeps their attributes exactly.
+// Vertices on open edges stay in place: in a welded sub-mesh those are UV and color seams,
+// texture-group boundaries and the mesh outline, so simplified levels do not crack along
+// them. With vertexGroups (e.g. bone indices), vertices only collapse within their group.
+// Collapses are chosen by cost with ties broken by vertex index, so the result is
+// deterministic. Compact the result with optimizeVertexFetch().
+SimplifiedMesh simplifyMesh(const std::vector<uint32_t> &indices,
+                            const std::vector<glm::vec3> &positions, size_t targetIndexCount,
+                            const std::vector<uint32_t> *vertexGroups = nullptr);
+
+// Largest screen size (see HLodModel::updateLOD) at which a level with the given error stays
+// within LOD_PIXEL_ERROR for a model of the given bounding radius. Lossless levels get
+// FLT_MAX, W3D's "no maximum".
+float lodMaxScreenSize(float error, float radius);
+
+} // namespace w3d
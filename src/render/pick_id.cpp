@@ -0,0 +1,54 @@
+#include "pick_id.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+
+namespace w3d {
+
+uint32_t encodePickId(uint32_t meshIndex, uint32_t triangleIndex) {
+  return ((meshIndex + 1) << PICK_TRIANGLE_BITS) | (triangleIndex & PICK_TRIANGLE_MASK);
+}
+
+std::optional<PickedTriangle> decodePickId(uint32_t id) {
+  if (id == PICK_NONE) {
+    return std::nullopt;
+  }
+  return PickedTriangle{(id >> PICK_TRIANGLE_BITS) - 1, id & PICK_TRIANGLE_MASK};
+}
+
+glm::mat4 pickProjection(const glm::mat4 &proj, const glm::vec2 &cursor,
+                         const glm::vec2 &screenSize, float targetSize) {
+  // The cursor in NDC, as screenToWorldRay maps it (Vulkan NDC is Y-down)
+  glm::vec2 center = cursor / screenSize * 2.0f - 1.0f;
+
+  // Applied to clip coordinates, so the translation scales with w like the projected point
+  glm::mat4 zoom = glm::scale(
+      glm::mat4(1.0f), glm::vec3(screenSize.x / targetSize, screenSize.y / targetSize, 1.0f));
+  return zoom * glm::translate(glm::mat4(1.0f), glm::vec3(-center.x, -center.y, 0.0f)) * proj;
+}
+
+TriangleHit pickedTriangleHit(const Ray &ray, const glm::vec3 &v0, const glm::vec3 &v1,
+                              const glm::vec3 &v2) {
+  TriangleHit hit = intersectRayTriangle(ray, v0, v1, v2);
+  if (hit.hit) {
+    return hit;
+  }
+
+  glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+  float facing = glm::dot(normal, ray.direction);
+  if (std::abs(facing) < 1e-8f) {
+    return hit;
+  }
+  float distance = glm::dot(normal, v0 - ray.origin) / facing;
+  if (distance < 0.0f) {
+    return hit;
+  }
+
+  hit.hit = true;
+  hit.distance = distance;
+  hit.point = ray.origin + ray.direction * distance;
+  return hit;
+}
+
+} // namespace w3d
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <optional>
+
+#include "render/raycast.hpp"
+
+namespace w3d {
+
+// IDs pick.frag writes to the picking attachment: the mesh index plus one in the high bits
+// and the triangle within the mesh in the low PICK_TRIANGLE_BITS, so 0 means no mesh
+constexpr uint32_t PICK_NONE = 0;
+constexpr uint32_t PICK_TRIANGLE_BITS = 20;
+constexpr uint32_t PICK_TRIANGLE_MASK = (1u << PICK_TRIANGLE_BITS) - 1;
+// Meshes from this index on are not drawn into the attachment; triangles past the mask alias
+constexpr uint32_t PICK_MAX_MESHES = (1u << (32 - PICK_TRIANGLE_BITS)) - 1;
+
+struct PickedTriangle {
+  size_t meshIndex = 0;
+  size_t triangleIndex = 0;
+};
+
+// Same encoding as pick.frag
+uint32_t encodePickId(uint32_t meshIndex, uint32_t triangleIndex);
+
+// Empty for PICK_NONE
+std::optional<PickedTriangle> decodePickId(uint32_t id);
+
+// Projection for a picking target of targetSize pixels square: the region of that size
+// centered on cursor (in pixels, (0,0) = top-left, as screenToWorldRay takes it) is scaled up
+// to fill the target, so its center texel is the cursor's. proj is the frame's projection,
+// with the Vulkan Y-flip.
+glm::mat4 pickProjection(const glm::mat4 &proj, const glm::vec2 &cursor,
+                         const glm::vec2 &screenSize, float targetSize);
+
+// Hit of the cursor ray on a triangle the GPU picked. The cursor is inside the triangle's
+// coverage but may miss it by rasterization precision at an edge; the ray then meets the
+// triangle's plane instead. No hit only for a triangle parallel to or behind the ray.
+TriangleHit pickedTriangleHit(const Ray &ray, const glm::vec3 &v0, const glm::vec3 &v1,
+                              const glm::vec3 &v2);
+
+} // namespace w3d
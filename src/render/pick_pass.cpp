@@ -0,0 +1,239 @@
+#include "pick_pass.hpp"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace w3d {
+
+namespace {
+
+constexpr vk::Format ID_FORMAT = vk::Format::eR32Uint;
+
+static_assert(sizeof(PickPushConstant) <= sizeof(gfx::MaterialPushConstant),
+              "Pick constants must fit the mesh pipelines' push constant range");
+
+} // namespace
+
+PickPass::~PickPass() {
+  destroy();
+}
+
+void PickPass::create(gfx::VulkanContext &context, vk::DescriptorSetLayout textureSetLayout,
+                      uint32_t frameCount) {
+  destroy();
+
+  context_ = &context;
+  device_ = context.device();
+  textureSetLayout_ = textureSetLayout;
+  createRenderPass();
+
+  slots_.resize(frameCount);
+  for (uint32_t i = 0; i < frameCount; ++i) {
+    createSlot(i);
+  }
+}
+
+void PickPass::createRenderPass() {
+  vk::AttachmentDescription idAttachment{{},
+                                         ID_FORMAT,
+                                         vk::SampleCountFlagBits::e1,
+                                         vk::AttachmentLoadOp::eClear,
+                                         vk::AttachmentStoreOp::eStore,
+                                         vk::AttachmentLoadOp::eDontCare,
+                                         vk::AttachmentStoreOp::eDontCare,
+                                         vk::ImageLayout::eUndefined,
+                                         vk::ImageLayout::eTransferSrcOptimal};
+
+  vk::AttachmentDescription depthAttachment{{},
+                                            context_->depthFormat(),
+                                            vk::SampleCountFlagBits::e1,
+                                            vk::AttachmentLoadOp::eClear,
+                                            vk::AttachmentStoreOp::eDontCare,
+                                            vk::AttachmentLoadOp::eDontCare,
+                                            vk::AttachmentStoreOp::eDontCare,
+                                            vk::ImageLayout::eUndefined,
+                                            vk::ImageLayout::eDepthStencilAttachmentOptimal};
+
+  vk::AttachmentReference idAttachmentRef{0, vk::ImageLayout::eColorAttachmentOptimal};
+  vk::AttachmentReference depthAttachmentRef{1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
+
+  vk::SubpassDescription subpass{
+      {}, vk::PipelineBindPoint::eGraphics, {}, idAttachmentRef, {}, &depthAttachmentRef};
+
+  vk::SubpassDependency dependency{VK_SUBPASS_EXTERNAL,
+                                   0,
+                                   vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                       vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                                   vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                       vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                                   {},
+                                   vk::AccessFlagBits::eColorAttachmentWrite |
+                                       vk::AccessFlagBits::eDepthStencilAttachmentWrite};
+
+  // The IDs are copied out after the pass
+  vk::SubpassDependency readbackDependency{0,
+                                           VK_SUBPASS_EXTERNAL,
+                                           vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                           vk::PipelineStageFlagBits::eTransfer,
+                                           vk::AccessFlagBits::eColorAttachmentWrite,
+                                           vk::AccessFlagBits::eTransferRead};
+
+  std::array<vk::AttachmentDescription, 2> attachments = {idAttachment, depthAttachment};
+  std::array<vk::SubpassDependency, 2> dependencies = {dependency, readbackDependency};
+
+  vk::RenderPassCreateInfo renderPassInfo{{}, attachments, subpass, dependencies};
+  renderPass_ = device_.createRenderPass(renderPassInfo);
+}
+
+void PickPass::createSlot(uint32_t frameIndex) {
+  // Every frame slot has its own target, so a frame's pass never waits on the copy of the
+  // frame before it
+  Slot &slot = slots_[frameIndex];
+  auto &allocator = context_->allocator();
+
+  vk::ImageCreateInfo imageInfo{
+      {},
+      vk::ImageType::e2D,
+      ID_FORMAT,
+      {TARGET_SIZE, TARGET_SIZE, 1},
+      1,
+      1,
+      vk::SampleCountFlagBits::e1,
+      vk::ImageTiling::eOptimal,
+      vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+      vk::SharingMode::eExclusive
+  };
+  slot.idImage = device_.createImage(imageInfo);
+  slot.idMemory =
+      allocator.allocateForImage(slot.idImage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  imageInfo.format = context_->depthFormat();
+  imageInfo.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
+  slot.depthImage = device_.createImage(imageInfo);
+  slot.depthMemory =
+      allocator.allocateForImage(slot.depthImage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  slot.idView = device_.createImageView(vk::ImageViewCreateInfo{
+      {},
+      slot.idImage,
+      vk::ImageViewType::e2D,
+      ID_FORMAT,
+      {},
+      {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
+  });
+  slot.depthView = device_.createImageView(vk::ImageViewCreateInfo{
+      {},
+      slot.depthImage,
+      vk::ImageViewType::e2D,
+      context_->depthFormat(),
+      {},
+      {vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1}
+  });
+
+  std::array<vk::ImageView, 2> attachments = {slot.idView, slot.depthView};
+  slot.framebuffer = device_.createFramebuffer(
+      vk::FramebufferCreateInfo{{}, renderPass_, attachments, TARGET_SIZE, TARGET_SIZE, 1});
+
+  slot.readback.create(*context_, sizeof(uint32_t), vk::BufferUsageFlagBits::eTransferDst,
+                       vk::MemoryPropertyFlagBits::eHostVisible |
+                           vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+void PickPass::destroy() {
+  if (device_) {
+    auto &allocator = context_->allocator();
+    for (Slot &slot : slots_) {
+      device_.destroyFramebuffer(slot.framebuffer);
+      device_.destroyImageView(slot.idView);
+      device_.destroyImageView(slot.depthView);
+      device_.destroyImage(slot.idImage);
+      device_.destroyImage(slot.depthImage);
+      allocator.free(slot.idMemory);
+      allocator.free(slot.depthMemory);
+    }
+    slots_.clear(); // Frees the readback buffers
+
+    for (auto &formatPipelines : pipelines_) {
+      for (auto &pipeline : formatPipelines) {
+        pipeline.reset();
+      }
+    }
+    if (renderPass_) {
+      device_.destroyRenderPass(renderPass_);
+      renderPass_ = nullptr;
+    }
+    device_ = nullptr;
+  }
+  context_ = nullptr;
+}
+
+const gfx::Pipeline &PickPass::pipeline(gfx::VertexFormat format, bool skinned) {
+  auto &pipeline = pipelines_[static_cast<uint32_t>(format)][skinned ? 1 : 0];
+  if (!pipeline) {
+    // Two-sided like the CPU ray test, and opaque: every mesh writes its ID where it is nearest
+    gfx::PipelineConfig config;
+    config.twoSided = true;
+    config.vertexFormat = format;
+    config.renderPass = renderPass_;
+
+    pipeline = std::make_unique<gfx::Pipeline>();
+    if (skinned) {
+      pipeline->createSkinned(*context_, "shaders/skinned.vert.spv", "shaders/pick.frag.spv",
+                              textureSetLayout_, config);
+    } else {
+      pipeline->createWithTexture(*context_, "shaders/basic.vert.spv", "shaders/pick.frag.spv",
+                                  textureSetLayout_, config);
+    }
+  }
+  return *pipeline;
+}
+
+void PickPass::begin(vk::CommandBuffer cmd, uint32_t frameIndex) const {
+  std::array<vk::ClearValue, 2> clearValues{};
+  clearValues[0].color = vk::ClearColorValue{
+      std::array<uint32_t, 4>{PICK_NONE, 0, 0, 0}
+  };
+  clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
+
+  vk::Extent2D extent{TARGET_SIZE, TARGET_SIZE};
+  vk::RenderPassBeginInfo renderPassInfo{renderPass_, slots_[frameIndex].framebuffer,
+                                         vk::Rect2D{{0, 0}, extent}, clearValues};
+  cmd.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+
+  vk::Viewport viewport{0.0f, 0.0f, static_cast<float>(TARGET_SIZE),
+                        static_cast<float>(TARGET_SIZE), 0.0f, 1.0f};
+  cmd.setViewport(0, viewport);
+  cmd.setScissor(0, vk::Rect2D{{0, 0}, extent});
+}
+
+void PickPass::end(vk::CommandBuffer cmd, uint32_t frameIndex, PickSet set, uint64_t revision) {
+  Slot &slot = slots_[frameIndex];
+  cmd.endRenderPass();
+
+  // The render pass left the target in transfer layout, its writes visible to the copy
+  constexpr int32_t center = TARGET_SIZE / 2;
+  vk::BufferImageCopy region{0, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+                             {center, center, 0}, {1, 1, 1}};
+  cmd.copyImageToBuffer(slot.idImage, vk::ImageLayout::eTransferSrcOptimal,
+                        slot.readback.buffer(), region);
+
+  vk::MemoryBarrier barrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+  cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+                      barrier, {}, {});
+
+  slot.pending = PickResult{PICK_NONE, set, revision};
+}
+
+std::optional<PickResult> PickPass::collect(uint32_t frameIndex) {
+  if (frameIndex >= slots_.size() || !slots_[frameIndex].pending) {
+    return std::nullopt;
+  }
+  Slot &slot = slots_[frameIndex];
+
+  PickResult result = *std::exchange(slot.pending, std::nullopt);
+  std::memcpy(&result.id, slot.readback.map(), sizeof(result.id));
+  return result;
+}
+
+} // namespace w3d
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "lib/gfx/buffer.hpp"
+#include "lib/gfx/memory_allocator.hpp"
+#include "lib/gfx/pipeline.hpp"
+#include "lib/gfx/vulkan_context.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "render/pick_id.hpp"
+
+namespace w3d {
+
+// Push constants of pick.frag, at the start of the mesh pipelines' fragment range
+struct PickPushConstant {
+  uint32_t meshIndex;
+  uint32_t firstTriangle; // Of the draw within the mesh, added to gl_PrimitiveID
+};
+
+// Mesh set a pick's mesh indices refer to
+enum class PickSet { Meshes, HLodMeshes, HLodSkinnedMeshes };
+
+// What covered the cursor in a frame's picking pass
+struct PickResult {
+  uint32_t id = PICK_NONE; // encodePickId() of the nearest triangle, or PICK_NONE
+  PickSet set = PickSet::Meshes;
+  uint64_t revision = 0; // Of the model drawn; a newer revision may have other meshes
+};
+
+// GPU picking: the frame's meshes drawn again after the render pass into a tiny R32_UINT
+// target around the cursor, through pickProjection(), each fragment writing its mesh and
+// triangle (pick.frag). The texel under the cursor is copied to a host-visible buffer of the
+// frame slot and read once the slot's fence has signaled, so a pick costs no CPU triangle
+// tests and its result arrives a frame slot later. CPU reference: HoverDetector's ray tests.
+class PickPass {
+public:
+  // Pixels of the target's side. One: only the texel under the cursor is read.
+  static constexpr uint32_t TARGET_SIZE = 1;
+
+  PickPass() = default;
+  ~PickPass();
+
+  PickPass(const PickPass &) = delete;
+  PickPass &operator=(const PickPass &) = delete;
+
+  // Mesh pipelines sample from textureSetLayout (set 1); the pick pipelines keep their layouts
+  // so the frame's descriptor sets bind to them unchanged
+  void create(gfx::VulkanContext &context, vk::DescriptorSetLayout textureSetLayout,
+              uint32_t frameCount);
+
+  void destroy();
+
+  bool valid() const { return static_cast<bool>(renderPass_); }
+
+  // Pipeline drawing IDs for meshes of the vertex format through the static or skinned
+  // vertex shader, created on first use. Draws push a PickPushConstant.
+  const gfx::Pipeline &pipeline(gfx::VertexFormat format, bool skinned);
+
+  // Record outside a render pass: begin the picking pass on the frame slot's target, with
+  // viewport and scissor set
+  void begin(vk::CommandBuffer cmd, uint32_t frameIndex) const;
+
+  // End the picking pass and copy the texel under the cursor for collect()
+  void end(vk::CommandBuffer cmd, uint32_t frameIndex, PickSet set, uint64_t revision);
+
+  // After the frame slot's fence was waited on: the pick its last submission recorded, once
+  std::optional<PickResult> collect(uint32_t frameIndex);
+
+private:
+  void createRenderPass();
+  void createSlot(uint32_t frameIndex);
+
+  struct Slot {
+    vk::Image idImage;
+    vk::Image depthImage;
+    gfx::MemoryAllocation idMemory;
+    gfx::MemoryAllocation depthMemory;
+    vk::ImageView idView;
+    vk::ImageView depthView;
+    vk::Framebuffer framebuffer;
+    gfx::Buffer readback;
+    std::optional<PickResult> pending; // Recorded, not yet collected
+  };
+
+  using FormatPipelines = std::array<std::unique_ptr<gfx::Pipeline>, 2>; // Static, skinned
+
+  gfx::VulkanContext *context_ = nullptr;
+  vk::Device device_;
+  vk::DescriptorSetLayout textureSetLayout_;
+
+  vk::RenderPass renderPass_;
+  std::vector<Slot> slots_;
+  std::array<FormatPipelines, gfx::VERTEX_FORMAT_COUNT> pipelines_;
+};
+
+} // namespace w3d
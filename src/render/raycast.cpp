@@ -5,6 +5,11 @@
 #include <algorithm>
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define W3D_RAYCAST_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace w3d {
 
 Ray screenToWorldRay(const glm::vec2 &screenPos, const glm::vec2 &screenSize,
@@ -93,6 +98,92 @@ TriangleHit intersectRayTriangle(const Ray &ray, const glm::vec3 &v0, const glm:
   return hit;
 }
 
+#ifdef W3D_RAYCAST_SSE2
+
+namespace {
+
+// glm::dot's grouping, (x + y) + z
+__m128 dot4(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+} // namespace
+
+TriangleHits4 intersectRayTriangles4(const Ray &ray, const TrianglePacket4 &triangles) {
+  const __m128 epsilon = _mm_set1_ps(1e-8f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  const __m128 dx = _mm_set1_ps(ray.direction.x);
+  const __m128 dy = _mm_set1_ps(ray.direction.y);
+  const __m128 dz = _mm_set1_ps(ray.direction.z);
+
+  const __m128 v0x = _mm_load_ps(triangles.x[0]);
+  const __m128 v0y = _mm_load_ps(triangles.y[0]);
+  const __m128 v0z = _mm_load_ps(triangles.z[0]);
+  const __m128 e1x = _mm_sub_ps(_mm_load_ps(triangles.x[1]), v0x);
+  const __m128 e1y = _mm_sub_ps(_mm_load_ps(triangles.y[1]), v0y);
+  const __m128 e1z = _mm_sub_ps(_mm_load_ps(triangles.z[1]), v0z);
+  const __m128 e2x = _mm_sub_ps(_mm_load_ps(triangles.x[2]), v0x);
+  const __m128 e2y = _mm_sub_ps(_mm_load_ps(triangles.y[2]), v0y);
+  const __m128 e2z = _mm_sub_ps(_mm_load_ps(triangles.z[2]), v0z);
+
+  // h = cross(direction, edge2), a = dot(edge1, h)
+  const __m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(e2y, dz));
+  const __m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(e2z, dx));
+  const __m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(e2x, dy));
+  const __m128 a = dot4(e1x, e1y, e1z, hx, hy, hz);
+  const __m128 absA = _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+
+  const __m128 f = _mm_div_ps(one, a);
+  const __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), v0x);
+  const __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), v0y);
+  const __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), v0z);
+  const __m128 u = _mm_mul_ps(f, dot4(sx, sy, sz, hx, hy, hz));
+
+  // q = cross(s, edge1)
+  const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(e1y, sz));
+  const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(e1z, sx));
+  const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(e1x, sy));
+  const __m128 v = _mm_mul_ps(f, dot4(dx, dy, dz, qx, qy, qz));
+  const __m128 t = _mm_mul_ps(f, dot4(e2x, e2y, e2z, qx, qy, qz));
+
+  // The scalar test's rejections, so NaN lanes pass exactly where they pass there
+  __m128 rejected = _mm_cmplt_ps(absA, epsilon);
+  rejected = _mm_or_ps(rejected, _mm_or_ps(_mm_cmplt_ps(u, zero), _mm_cmpgt_ps(u, one)));
+  rejected = _mm_or_ps(rejected, _mm_cmplt_ps(v, zero));
+  rejected = _mm_or_ps(rejected, _mm_cmpgt_ps(_mm_add_ps(u, v), one));
+  rejected = _mm_or_ps(rejected, _mm_cmplt_ps(t, epsilon));
+
+  TriangleHits4 hits;
+  hits.mask = ~static_cast<uint32_t>(_mm_movemask_ps(rejected)) & 0xFu;
+  _mm_storeu_ps(hits.distance, t);
+  _mm_storeu_ps(hits.u, u);
+  _mm_storeu_ps(hits.v, v);
+  return hits;
+}
+
+#else
+
+TriangleHits4 intersectRayTriangles4(const Ray &ray, const TrianglePacket4 &triangles) {
+  TriangleHits4 hits;
+  for (uint32_t i = 0; i < 4; ++i) {
+    TriangleHit hit = intersectRayTriangle(
+        ray, glm::vec3(triangles.x[0][i], triangles.y[0][i], triangles.z[0][i]),
+        glm::vec3(triangles.x[1][i], triangles.y[1][i], triangles.z[1][i]),
+        glm::vec3(triangles.x[2][i], triangles.y[2][i], triangles.z[2][i]));
+    if (hit.hit) {
+      hits.mask |= 1u << i;
+      hits.distance[i] = hit.distance;
+      hits.u[i] = hit.u;
+      hits.v[i] = hit.v;
+    }
+  }
+  return hits;
+}
+
+#endif
+
 LineHit intersectRayLineSegment(const Ray &ray, const glm::vec3 &lineStart,
                                 const glm::vec3 &lineEnd, float tolerance) {
   const float EPSILON = 1e-8f;
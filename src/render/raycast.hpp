@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <limits>
 
 namespace w3d {
@@ -46,6 +47,27 @@ Ray screenToWorldRay(const glm::vec2 &screenPos, const glm::vec2 &screenSize,
 TriangleHit intersectRayTriangle(const Ray &ray, const glm::vec3 &v0, const glm::vec3 &v1,
                                  const glm::vec3 &v2);
 
+// Four triangles in SoA layout for intersectRayTriangles4(): x[c][i] is the x coordinate of
+// corner c of triangle i. Unused lanes are left zeroed; a degenerate triangle is never hit.
+struct alignas(16) TrianglePacket4 {
+  float x[3][4] = {};
+  float y[3][4] = {};
+  float z[3][4] = {};
+};
+
+// Lanes of missed triangles hold no meaningful values
+struct TriangleHits4 {
+  uint32_t mask = 0; // Bit i set when triangle i is hit
+  float distance[4] = {};
+  float u[4] = {}; // Barycentric coordinates
+  float v[4] = {};
+};
+
+// Möller-Trumbore against four triangles at once, with SSE2 where available. Every lane
+// computes what intersectRayTriangle() computes for its triangle, in the same order, so hits,
+// distances and barycentrics are identical to the scalar test.
+TriangleHits4 intersectRayTriangles4(const Ray &ray, const TrianglePacket4 &triangles);
+
 // Ray-line segment intersection with tolerance for clickability
 // tolerance: Click radius around the line segment
 LineHit intersectRayLineSegment(const Ray &ray, const glm::vec3 &lineStart,
@@ -0,0 +1,139 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+#include "render/draw_packet.hpp"
+
+namespace w3d {
+
+namespace {
+
+// Order-preserving bits of a view depth; depths behind the camera clamp to zero
+uint32_t depthBits(float depth) {
+  return depth > 0.0f ? std::bit_cast<uint32_t>(depth) : 0u;
+}
+
+template <typename ItemAt>
+StateChangeCounts countStateChanges(size_t count, ItemAt itemAt) {
+  BoundState state;
+  for (size_t i = 0; i < count; ++i) {
+    const RenderItem &item = itemAt(i);
+    state.setPipeline(item.pipeline);
+    state.setVertexBuffer(item.vertexBuffer);
+    state.setMaterial(*item.material, item.tint);
+  }
+  return state.counts();
+}
+
+} // namespace
+
+bool BoundState::setPipeline(uint32_t pipeline) {
+  if (pipeline == pipeline_) {
+    return false;
+  }
+  pipeline_ = pipeline;
+  ++counts_.pipelines;
+  return true;
+}
+
+bool BoundState::setVertexBuffer(uint32_t vertexBuffer) {
+  if (vertexBuffer == vertexBuffer_) {
+    return false;
+  }
+  vertexBuffer_ = vertexBuffer;
+  ++counts_.vertexBuffers;
+  return true;
+}
+
+bool BoundState::setMaterial(const GPUMaterial &material, const glm::vec3 &tint) {
+  bool bound = material_ == &material || (material_ && sameMaterial(*material_, material));
+  if (bound && tint == tint_) {
+    return false;
+  }
+  material_ = &material;
+  tint_ = tint;
+  ++counts_.materials;
+  return true;
+}
+
+uint64_t RenderQueue::sortKey(const RenderItem &item) {
+  const uint64_t pipeline = std::min(item.pipeline, MAX_PIPELINES - 1);
+  const uint64_t blend = static_cast<uint64_t>(materialBlendMode(*item.material)) & 0x3u;
+  const uint64_t texture = item.material->textureIndex & 0xFFFFu;
+  const uint64_t vertexBuffer = item.vertexBuffer & 0x3Fu;
+  const uint64_t depth = depthBits(item.depth);
+
+  if (isTranslucent(*item.material)) {
+    const uint64_t farToNear = ~depth & 0xFFFFFFFFu;
+    return (uint64_t{1} << 63) | (farToNear << 31) | (pipeline << 24) | (blend << 22) |
+           (texture << 6) | vertexBuffer;
+  }
+  return (pipeline << 56) | (blend << 54) | (texture << 38) | (vertexBuffer << 32) | depth;
+}
+
+void RenderQueue::clear() {
+  items_.clear();
+  order_.clear();
+}
+
+void RenderQueue::submit(const RenderItem &item) {
+  order_.push_back({sortKey(item), static_cast<uint32_t>(items_.size())});
+  items_.push_back(item);
+}
+
+void RenderQueue::sort() {
+  // LSD radix sort, one byte per pass; passes where every key has the same byte are skipped
+  scratch_.resize(order_.size());
+  for (int shift = 0; shift < 64; shift += 8) {
+    std::array<uint32_t, 256> offsets{};
+    for (const Entry &entry : order_) {
+      ++offsets[(entry.key >> shift) & 0xFFu];
+    }
+    if (std::find(offsets.begin(), offsets.end(), order_.size()) != offsets.end()) {
+      continue;
+    }
+
+    uint32_t sum = 0;
+    for (uint32_t &offset : offsets) {
+      uint32_t count = offset;
+      offset = sum;
+      sum += count;
+    }
+    for (const Entry &entry : order_) {
+      scratch_[offsets[(entry.key >> shift) & 0xFFu]++] = entry;
+    }
+    order_.swap(scratch_);
+  }
+}
+
+RenderQueueStats RenderQueue::stats() const {
+  RenderQueueStats stats;
+  stats.draws = static_cast<uint32_t>(items_.size());
+  for (const RenderItem &item : items_) {
+    stats.translucentDraws += isTranslucent(*item.material) ? 1 : 0;
+  }
+  stats.submitted =
+      countStateChanges(items_.size(), [&](size_t i) -> const RenderItem & { return items_[i]; });
+  stats.sorted = countStateChanges(order_.size(), [&](size_t i) -> const RenderItem & {
+    return items_[order_[i].item];
+  });
+  return stats;
+}
+
+float batchDepth(const DrawList &list, uint32_t batchIndex, const glm::mat4 &viewProj,
+                 const glm::mat4 *bones, size_t boneCount) {
+  const DrawBatch &batch = list.batches[batchIndex];
+  float nearest = std::numeric_limits<float>::max();
+  for (uint32_t i = 0; i < batch.commandCount; ++i) {
+    const CullInput &draw = list.draws[batch.firstCommand + i];
+    glm::vec4 sphere = transformSphere(draw.sphere, draw.boneIndex, bones, boneCount);
+    glm::vec4 clip = viewProj * glm::vec4(glm::vec3(sphere), 1.0f);
+    nearest = std::min(nearest, clip.w);
+  }
+  return nearest;
+}
+
+} // namespace w3d
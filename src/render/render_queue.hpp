@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/draw_culling.hpp"
+#include "render/material.hpp"
+
+namespace w3d {
+
+// One queued draw and the state it needs bound
+struct RenderItem {
+  uint32_t pipeline;           // gfx::PipelineKey id (below RenderQueue::MAX_PIPELINES)
+  uint32_t vertexBuffer;       // Id of the vertex/index buffers the draw reads
+  const GPUMaterial *material; // Pushed as material constants with tint
+  glm::vec3 tint;
+  float depth;                 // View depth used for ordering (clip w)
+  uint32_t draw;               // Caller's handle for the draw (batch or packet index)
+};
+
+// Bind and push counts while recording a sequence of items
+struct StateChangeCounts {
+  uint32_t pipelines = 0;
+  uint32_t vertexBuffers = 0;
+  uint32_t materials = 0;
+};
+
+// Bind statistics of the last recorded frame
+struct RenderQueueStats {
+  uint32_t draws = 0;
+  uint32_t translucentDraws = 0;
+  StateChangeCounts submitted; // Recording in submission order, skipping redundant binds
+  StateChangeCounts sorted;    // Recording in queue order, as the renderer does
+};
+
+// CPU time of recording the queue's draws. With recording threads, the queue is split into
+// one contiguous chunk per thread and each chunk's time and draw count are kept.
+struct RecordStats {
+  uint32_t threads = 0; // Recording threads asked for (0: the calling thread alone)
+  bool reused = false;  // Replayed the draws recorded for an unchanged frame
+  double totalMs = 0.0;
+  std::vector<double> threadMs;
+  std::vector<uint32_t> threadDraws;
+};
+
+// State bound while recording. Each set*() returns true when the bind must be issued.
+class BoundState {
+public:
+  bool setPipeline(uint32_t pipeline);
+  bool setVertexBuffer(uint32_t vertexBuffer);
+  bool setMaterial(const GPUMaterial &material, const glm::vec3 &tint);
+
+  void reset() { *this = BoundState{}; }
+
+  const StateChangeCounts &counts() const { return counts_; }
+
+private:
+  static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+  uint32_t pipeline_ = NONE;
+  uint32_t vertexBuffer_ = NONE;
+  const GPUMaterial *material_ = nullptr;
+  glm::vec3 tint_{0.0f};
+  StateChangeCounts counts_;
+};
+
+// Per-frame draw queue ordered by 64-bit sort keys.
+//
+// Opaque keys, most significant bits first:
+//   [63] 0 | [62:56] pipeline | [55:54] blend | [53:38] texture | [37:32] vertex buffer |
+//   [31:0] depth, near to far
+// Translucent keys:
+//   [63] 1 | [62:31] depth, far to near | [30:24] pipeline | [23:22] blend | [21:6] texture |
+//   [5:0] vertex buffer
+// so opaque draws group by state (front to back within equal state) and translucent draws
+// follow back to front. Texture and vertex buffer ids beyond their field wrap, which only
+// affects grouping.
+class RenderQueue {
+public:
+  static constexpr uint32_t MAX_PIPELINES = 128;
+
+  static uint64_t sortKey(const RenderItem &item);
+
+  void clear();
+  void submit(const RenderItem &item);
+
+  // Radix sort the submitted items by key (stable, so equal keys keep submission order)
+  void sort();
+
+  size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+
+  // i-th item in sorted order (submission order before sort())
+  const RenderItem &operator[](size_t i) const { return items_[order_[i].item]; }
+
+  // State changes recording the items in submission order and in sorted order
+  RenderQueueStats stats() const;
+
+private:
+  struct Entry {
+    uint64_t key;
+    uint32_t item;
+  };
+
+  std::vector<RenderItem> items_;
+  std::vector<Entry> order_;
+  std::vector<Entry> scratch_;
+};
+
+static_assert(gfx::PipelineKey::COUNT <= RenderQueue::MAX_PIPELINES,
+              "Pipeline permutation ids must fit the sort key's pipeline field");
+
+// Nearest view depth (clip w) among a batch's draws, after placing them with their bones
+float batchDepth(const DrawList &list, uint32_t batchIndex, const glm::mat4 &viewProj,
+                 const glm::mat4 *bones, size_t boneCount);
+
+} // namespace w3d
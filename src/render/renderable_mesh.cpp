@@ -2,6 +2,7 @@
 
 #include "lib/gfx/vulkan_context.hpp"
 
+#include "material.hpp"
 #include "mesh_converter.hpp"
 
 namespace w3d {
@@ -20,6 +21,7 @@ void RenderableMesh::loadWithPose(gfx::VulkanContext &context, const W3DFile &fi
 
   auto converted = MeshConverter::convertAllWithPose(file, pose);
   bounds_ = MeshConverter::combinedBounds(converted);
+  vertexCacheStats_.add(MeshConverter::optimizeAll(converted));
 
   // Count total sub-meshes for reservation
   size_t totalSubMeshes = 0;
@@ -37,16 +39,35 @@ void RenderableMesh::loadWithPose(gfx::VulkanContext &context, const W3DFile &fi
       MeshGPUData gpu;
       gpu.name = cm.name;
       gpu.boneIndex = cm.boneIndex;
-      gpu.vertexBuffer.create(context, subMesh.vertices);
+      gpu.vertexBuffer.create(context,
+                              MeshConverter::encodeVertices(subMesh.vertices, vertexFormat_,
+                                                            bounds_));
+      encoding_ = gpu.vertexBuffer.encoding();
       gpu.indexBuffer.create(context, subMesh.indices);
 
       // Store CPU copies for ray-triangle intersection
       gpu.cpuVertices = subMesh.vertices;
       gpu.cpuIndices = subMesh.indices;
+      gpu.bvh.build(gpu.cpuVertices, gpu.cpuIndices);
 
       meshes_.push_back(std::move(gpu));
     }
   }
+
+  // Untextured, unculled and drawn at every LOD: only the material and range matter
+  const GPUMaterial material = createDefaultMaterial().toGPU();
+  packets_.reserve(meshes_.size());
+  for (size_t i = 0; i < meshes_.size(); ++i) {
+    DrawPacket packet{};
+    packet.material = material;
+    packet.sphere = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+    packet.command = {meshes_[i].indexBuffer.indexCount(), 1, 0, 0, 0};
+    packet.boneIndex = CullInput::NO_BONE;
+    packet.lodMask = DrawPacket::ALL_LODS;
+    packet.meshIndex = static_cast<uint32_t>(i);
+    packets_.push_back(packet);
+  }
+  ++revision_;
 }
 
 bool RenderableMesh::getTriangle(size_t meshIndex, size_t triangleIndex, glm::vec3 &v0,
@@ -83,18 +104,46 @@ void RenderableMesh::draw(vk::CommandBuffer cmd) const {
     vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
     vk::DeviceSize offsets[] = {0};
     cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
+    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, mesh.indexBuffer.indexType());
     cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
   }
 }
 
+void RenderableMesh::bindMesh(vk::CommandBuffer cmd, size_t meshIndex) const {
+  const auto &mesh = meshes_[meshIndex];
+  vk::Buffer vertexBuffer = mesh.vertexBuffer.buffer();
+  vk::DeviceSize offset = 0;
+  cmd.bindVertexBuffers(0, 1, &vertexBuffer, &offset);
+  cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, mesh.indexBuffer.indexType());
+}
+
+vk::DeviceSize RenderableMesh::vertexBytes() const {
+  vk::DeviceSize bytes = 0;
+  for (const auto &mesh : meshes_) {
+    bytes += mesh.vertexBuffer.size();
+  }
+  return bytes;
+}
+
+vk::DeviceSize RenderableMesh::indexBytes() const {
+  vk::DeviceSize bytes = 0;
+  for (const auto &mesh : meshes_) {
+    bytes += mesh.indexBuffer.size();
+  }
+  return bytes;
+}
+
 void RenderableMesh::destroy() {
   for (auto &mesh : meshes_) {
     mesh.vertexBuffer.destroy();
     mesh.indexBuffer.destroy();
   }
   meshes_.clear();
+  packets_.clear();
   bounds_ = gfx::BoundingBox{};
+  encoding_ = {};
+  vertexCacheStats_ = {};
+  ++revision_;
 }
 
 } // namespace w3d
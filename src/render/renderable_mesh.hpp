@@ -6,18 +6,22 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "lib/formats/w3d/types.hpp"
 #include "lib/gfx/bounding_box.hpp"
+#include "render/draw_packet.hpp"
+#include "render/mesh_bvh.hpp"
+#include "render/mesh_optimizer.hpp"
 #include "skeleton.hpp"
 
 namespace w3d {
 
 // GPU resources for a single mesh
 struct MeshGPUData {
-  gfx::VertexBuffer<gfx::Vertex> vertexBuffer;
+  gfx::EncodedVertexBuffer vertexBuffer;
   gfx::IndexBuffer indexBuffer;
   std::string name;
   int32_t boneIndex = -1; // Index into skeleton hierarchy (-1 = no bone)
@@ -25,6 +29,7 @@ struct MeshGPUData {
   // CPU-side copies for ray-triangle intersection
   std::vector<gfx::Vertex> cpuVertices;
   std::vector<uint32_t> cpuIndices;
+  MeshBVH bvh; // Over the CPU copies
 };
 
 // Manages GPU resources for all meshes in a loaded file
@@ -48,9 +53,27 @@ public:
   // Check if any meshes are loaded
   bool hasData() const { return !meshes_.empty(); }
 
+  // Incremented on every load and destroy; renderers compare it to reuse recorded draws
+  uint64_t revision() const { return revision_; }
+
   // Get bounds for camera positioning (optionally transformed by skeleton)
   const gfx::BoundingBox &bounds() const { return bounds_; }
 
+  // Vertex format used by the next load. Every mesh is quantized against the model bounds,
+  // so all of them share one encoding.
+  gfx::VertexFormat vertexFormat() const { return vertexFormat_; }
+  void setVertexFormat(gfx::VertexFormat format) { vertexFormat_ = format; }
+  const gfx::VertexEncoding &vertexEncoding() const { return encoding_; }
+
+  // GPU memory of all vertex buffers
+  vk::DeviceSize vertexBytes() const;
+
+  // GPU memory of all index buffers (16-bit wherever a mesh allows)
+  vk::DeviceSize indexBytes() const;
+
+  // Post-transform cache efficiency of the loaded meshes before and after optimization
+  const VertexCacheStats &vertexCacheStats() const { return vertexCacheStats_; }
+
   // Get mesh count
   size_t meshCount() const { return meshes_.size(); }
 
@@ -84,13 +107,12 @@ public:
   // Record draw commands for all meshes (simple version, no bone transforms)
   void draw(vk::CommandBuffer cmd) const;
 
-  // Draw with hover highlighting on a specific mesh
-  // hoverMeshIndex: Index of mesh to highlight (-1 for none)
-  // tintColor: Color to multiply with hovered mesh
-  // pushConstantCallback: Callback to fill and push material constants with tint applied
-  template <typename PushConstantFunc>
-  void drawWithHover(vk::CommandBuffer cmd, int hoverMeshIndex, const glm::vec3 &tintColor,
-                     PushConstantFunc pushConstantCallback) const;
+  // One packet per mesh with the default material, compiled at load. A packet's command
+  // indexes the buffers bound by bindMesh(cmd, packet.meshIndex).
+  const std::vector<DrawPacket> &drawPackets() const { return packets_; }
+
+  // Bind the vertex and index buffers of one mesh
+  void bindMesh(vk::CommandBuffer cmd, size_t meshIndex) const;
 
   // Record draw commands with per-mesh bone transforms
   // updateModelMatrix callback is called for each mesh with its bone transform
@@ -100,7 +122,12 @@ public:
 
 private:
   std::vector<MeshGPUData> meshes_;
+  std::vector<DrawPacket> packets_;
   gfx::BoundingBox bounds_;
+  gfx::VertexFormat vertexFormat_ = gfx::VertexFormat::Full;
+  gfx::VertexEncoding encoding_;
+  VertexCacheStats vertexCacheStats_;
+  uint64_t revision_ = 0;
 };
 
 // Template implementation must be in header
@@ -121,29 +148,7 @@ void RenderableMesh::drawWithBoneTransforms(vk::CommandBuffer cmd, const Skeleto
     vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
     vk::DeviceSize offsets[] = {0};
     cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
-    cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
-  }
-}
-
-template <typename PushConstantFunc>
-void RenderableMesh::drawWithHover(vk::CommandBuffer cmd, int hoverMeshIndex,
-                                   const glm::vec3 &tintColor,
-                                   PushConstantFunc pushConstantCallback) const {
-  for (size_t i = 0; i < meshes_.size(); ++i) {
-    const auto &mesh = meshes_[i];
-
-    // Determine tint for this mesh
-    glm::vec3 meshTint = (static_cast<int>(i) == hoverMeshIndex) ? tintColor : glm::vec3(1.0f);
-
-    // Let callback push material constants with the tint
-    pushConstantCallback(i, meshTint);
-
-    // Draw this mesh
-    vk::Buffer vertexBuffers[] = {mesh.vertexBuffer.buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, vk::IndexType::eUint32);
+    cmd.bindIndexBuffer(mesh.indexBuffer.buffer(), 0, mesh.indexBuffer.indexType());
     cmd.drawIndexed(mesh.indexBuffer.indexCount(), 1, 0, 0, 0);
   }
 }
@@ -6,9 +6,11 @@
 #include <array>
 #include <cmath>
 #include <filesystem>
+#include <limits>
 #include <map>
 #include <stdexcept>
 
+#include "bone_buffer.hpp"
 #include "core/shader_loader.hpp"
 
 namespace w3d {
@@ -21,17 +23,24 @@ void SkeletonRenderer::create(VulkanContext &context) {
   device_ = context.device();
   createDescriptorSetLayout(context);
   createPipeline(context);
+
+  // Unit sphere shared by every joint; scaled and positioned in the vertex shader
+  auto sphere = generateUnitSphere();
+  sphereBuffer_.create(context, sphere);
+  sphereVertexCount_ = static_cast<uint32_t>(sphere.size());
 }
 
 void SkeletonRenderer::createDescriptorSetLayout(VulkanContext & /*context*/) {
-  // Match the main pipeline layout (UBO + texture sampler) for descriptor set compatibility
-  // Even though skeleton shader doesn't use textures, we need compatible layouts to share
-  // descriptor sets
-  std::array<vk::DescriptorSetLayoutBinding, 2> bindings = {
-      vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBuffer,        1,
-                                     vk::ShaderStageFlagBits::eVertex  },
-      vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eCombinedImageSampler, 1,
-                                     vk::ShaderStageFlagBits::eFragment}
+  // Match set 0 of the skinned pipeline layout (UBO + bone matrices + instance transforms)
+  // for descriptor set compatibility: the skeleton shaders read bone positions from the same
+  // SSBO the skinned meshes use. The instance binding goes unused.
+  std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {
+      vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBufferDynamic, 1,
+                                     vk::ShaderStageFlagBits::eVertex},
+      vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageBufferDynamic, 1,
+                                     vk::ShaderStageFlagBits::eVertex},
+      vk::DescriptorSetLayoutBinding{3, vk::DescriptorType::eStorageBufferDynamic, 1,
+                                     vk::ShaderStageFlagBits::eVertex}
   };
 
   vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, bindings};
@@ -55,26 +64,17 @@ vk::ShaderModule createShaderModule(vk::Device device, const std::vector<char> &
 }
 
 void SkeletonRenderer::createPipeline(VulkanContext &context) {
-  // Load skeleton shaders
-  auto vertShaderCode = readShaderFile("shaders/skeleton.vert.spv");
+  // Load skeleton shaders (separate vertex shaders for lines and instanced joints)
+  auto lineVertShaderCode = readShaderFile("shaders/skeleton_line.vert.spv");
+  auto jointVertShaderCode = readShaderFile("shaders/skeleton_joint.vert.spv");
   auto fragShaderCode = readShaderFile("shaders/skeleton.frag.spv");
 
-  auto vertShaderModule = createShaderModule(device_, vertShaderCode);
+  auto lineVertShaderModule = createShaderModule(device_, lineVertShaderCode);
+  auto jointVertShaderModule = createShaderModule(device_, jointVertShaderCode);
   auto fragShaderModule = createShaderModule(device_, fragShaderCode);
 
-  vk::PipelineShaderStageCreateInfo vertShaderStageInfo{
-      {}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main"};
   vk::PipelineShaderStageCreateInfo fragShaderStageInfo{
       {}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main"};
-  std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo,
-                                                                   fragShaderStageInfo};
-
-  // Vertex input - simplified for skeleton
-  auto bindingDescription = SkeletonVertex::getBindingDescription();
-  auto attributeDescriptions = SkeletonVertex::getAttributeDescriptions();
-
-  vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
-      {}, bindingDescription, attributeDescriptions};
 
   // Dynamic viewport and scissor
   std::array<vk::DynamicState, 2> dynamicStates = {vk::DynamicState::eViewport,
@@ -110,11 +110,11 @@ void SkeletonRenderer::createPipeline(VulkanContext &context) {
   vk::PipelineColorBlendStateCreateInfo colorBlending{
       {}, VK_FALSE, vk::LogicOp::eCopy, colorBlendAttachment};
 
-  // Pipeline layout - use our descriptor set layout with push constant for hover tint
+  // Pipeline layout - hover tint (fragment) and joint radius (vertex) as push constants
   vk::PushConstantRange pushConstantRange{
-      vk::ShaderStageFlagBits::eFragment, // Stage flags
-      0,                                  // Offset
-      sizeof(glm::vec3)                   // Size (vec3 hoverTint)
+      vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, // Stage flags
+      0,                                                                     // Offset
+      sizeof(SkeletonPushConstant)                                           // Size
   };
 
   vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, descriptorSetLayout_, pushConstantRange};
@@ -122,6 +122,19 @@ void SkeletonRenderer::createPipeline(VulkanContext &context) {
 
   // Create LINE pipeline
   {
+    vk::PipelineShaderStageCreateInfo vertShaderStageInfo{
+        {}, vk::ShaderStageFlagBits::eVertex, lineVertShaderModule, "main"};
+    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo,
+                                                                     fragShaderStageInfo};
+
+    // Vertex input - one bone index + color per line vertex
+    auto bindingDescription =
+        SkeletonBoneVertex::getBindingDescription(0, vk::VertexInputRate::eVertex);
+    auto attributeDescriptions = SkeletonBoneVertex::getAttributeDescriptions(0, 0);
+
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
+        {}, bindingDescription, attributeDescriptions};
+
     vk::PipelineInputAssemblyStateCreateInfo inputAssembly{
         {}, vk::PrimitiveTopology::eLineList, VK_FALSE};
 
@@ -156,7 +169,7 @@ void SkeletonRenderer::createPipeline(VulkanContext &context) {
         0 // subpass
     };
 
-    auto result = device_.createGraphicsPipeline(nullptr, pipelineInfo);
+    auto result = device_.createGraphicsPipeline(context.pipelineCache(), pipelineInfo);
     if (result.result != vk::Result::eSuccess) {
       throw std::runtime_error("Failed to create skeleton line pipeline");
     }
@@ -165,6 +178,23 @@ void SkeletonRenderer::createPipeline(VulkanContext &context) {
 
   // Create POINT pipeline for joints
   {
+    vk::PipelineShaderStageCreateInfo vertShaderStageInfo{
+        {}, vk::ShaderStageFlagBits::eVertex, jointVertShaderModule, "main"};
+    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo,
+                                                                     fragShaderStageInfo};
+
+    // Vertex input - unit sphere positions per vertex, bone index + color per instance
+    std::array<vk::VertexInputBindingDescription, 2> bindingDescriptions = {
+        vk::VertexInputBindingDescription{0, sizeof(glm::vec3), vk::VertexInputRate::eVertex},
+        SkeletonBoneVertex::getBindingDescription(1, vk::VertexInputRate::eInstance)};
+    auto instanceAttributes = SkeletonBoneVertex::getAttributeDescriptions(1, 1);
+    std::array<vk::VertexInputAttributeDescription, 3> attributeDescriptions = {
+        vk::VertexInputAttributeDescription{0, 0, vk::Format::eR32G32B32Sfloat, 0},
+        instanceAttributes[0], instanceAttributes[1]};
+
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
+        {}, bindingDescriptions, attributeDescriptions};
+
     vk::PipelineInputAssemblyStateCreateInfo inputAssembly{
         {}, vk::PrimitiveTopology::eTriangleList, VK_FALSE};
 
@@ -199,7 +229,7 @@ void SkeletonRenderer::createPipeline(VulkanContext &context) {
         0 // subpass
     };
 
-    auto result = device_.createGraphicsPipeline(nullptr, pipelineInfo);
+    auto result = device_.createGraphicsPipeline(context.pipelineCache(), pipelineInfo);
     if (result.result != vk::Result::eSuccess) {
       throw std::runtime_error("Failed to create skeleton point pipeline");
     }
@@ -207,13 +237,12 @@ void SkeletonRenderer::createPipeline(VulkanContext &context) {
   }
 
   // Cleanup shader modules
-  device_.destroyShaderModule(vertShaderModule);
+  device_.destroyShaderModule(lineVertShaderModule);
+  device_.destroyShaderModule(jointVertShaderModule);
   device_.destroyShaderModule(fragShaderModule);
 }
 
-std::vector<SkeletonVertex> SkeletonRenderer::generateJointSphere(const glm::vec3 &center,
-                                                                  float radius,
-                                                                  const glm::vec3 &color) const {
+std::vector<glm::vec3> SkeletonRenderer::generateUnitSphere() {
   // Generate an icosphere (subdivided icosahedron) for joints
   // Start with icosahedron vertices
   const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
@@ -281,41 +310,30 @@ std::vector<SkeletonVertex> SkeletonRenderer::generateJointSphere(const glm::vec
     faces = std::move(newFaces);
   }
 
-  // Generate output vertices
-  std::vector<SkeletonVertex> result;
+  // Generate output vertices (non-indexed triangle list)
+  std::vector<glm::vec3> result;
   result.reserve(faces.size() * 3);
 
   for (const auto &face : faces) {
     for (int idx : face) {
-      SkeletonVertex v;
-      v.position = center + vertices[idx] * radius;
-      v.color = color;
-      result.push_back(v);
+      result.push_back(vertices[idx]);
     }
   }
 
   return result;
 }
 
-void SkeletonRenderer::updateFromPose(VulkanContext &context, uint32_t frameIndex,
-                                      const SkeletonPose &pose) {
-  if (frameIndex >= FRAME_COUNT) {
-    return;
-  }
+void SkeletonRenderer::load(VulkanContext &context, const SkeletonPose &pose) {
+  clear();
 
   if (!pose.isValid()) {
-    lineVertexCount_[frameIndex] = 0;
-    jointVertexCount_[frameIndex] = 0;
-    bonePositions_.clear();
-    parentIndices_.clear();
-    boneNames_.clear();
     return;
   }
 
+  // Bones beyond the SSBO capacity can't be drawn from the bone matrix buffer
+  size_t drawableBones = std::min(pose.boneCount(), BoneMatrixBuffer::MAX_BONES);
+
   // Store bone data for hover detection
-  bonePositions_.clear();
-  parentIndices_.clear();
-  boneNames_.clear();
   bonePositions_.reserve(pose.boneCount());
   parentIndices_.reserve(pose.boneCount());
   boneNames_.reserve(pose.boneCount());
@@ -326,7 +344,7 @@ void SkeletonRenderer::updateFromPose(VulkanContext &context, uint32_t frameInde
     boneNames_.push_back(pose.boneName(i));
   }
 
-  // Calculate skeleton scale for joint size
+  // Joint size is derived from the rest pose extent and stays fixed while animating
   float minX = std::numeric_limits<float>::max();
   float maxX = std::numeric_limits<float>::lowest();
   float minY = std::numeric_limits<float>::max();
@@ -334,8 +352,7 @@ void SkeletonRenderer::updateFromPose(VulkanContext &context, uint32_t frameInde
   float minZ = std::numeric_limits<float>::max();
   float maxZ = std::numeric_limits<float>::lowest();
 
-  for (size_t i = 0; i < pose.boneCount(); ++i) {
-    glm::vec3 pos = pose.bonePosition(i);
+  for (const auto &pos : bonePositions_) {
     minX = std::min(minX, pos.x);
     maxX = std::max(maxX, pos.x);
     minY = std::min(minY, pos.y);
@@ -348,85 +365,91 @@ void SkeletonRenderer::updateFromPose(VulkanContext &context, uint32_t frameInde
   jointRadius_ = skeletonSize * kJointSizeRatio;
   jointRadius_ = std::max(jointRadius_, 0.01f); // Minimum size
 
-  // Generate line vertices (bone connections)
-  std::vector<SkeletonVertex> lineVertices;
-  lineVertices.reserve(pose.boneCount() * 2);
+  // Line vertices reference the parent and child bone of each connection
+  std::vector<SkeletonBoneVertex> lineVertices;
+  lineVertices.reserve(drawableBones * 2);
 
-  for (size_t i = 0; i < pose.boneCount(); ++i) {
+  for (size_t i = 0; i < drawableBones; ++i) {
     int parent = pose.parentIndex(i);
-    if (parent >= 0) {
-      // Draw line from parent to child
-      SkeletonVertex v1, v2;
-      v1.position = pose.bonePosition(static_cast<size_t>(parent));
-      v1.color = boneColor_;
-      v2.position = pose.bonePosition(i);
-      v2.color = boneColor_;
-
-      lineVertices.push_back(v1);
-      lineVertices.push_back(v2);
+    if (parent >= 0 && static_cast<size_t>(parent) < drawableBones) {
+      lineVertices.push_back({static_cast<uint32_t>(parent), boneColor_});
+      lineVertices.push_back({static_cast<uint32_t>(i), boneColor_});
     }
   }
 
-  // Generate joint spheres
-  std::vector<SkeletonVertex> jointVertices;
+  // One joint sphere instance per bone
+  std::vector<SkeletonBoneVertex> jointInstances;
+  jointInstances.reserve(drawableBones);
 
-  for (size_t i = 0; i < pose.boneCount(); ++i) {
-    glm::vec3 pos = pose.bonePosition(i);
+  for (size_t i = 0; i < drawableBones; ++i) {
     glm::vec3 color = (pose.parentIndex(i) < 0) ? rootColor_ : jointColor_;
-
-    auto sphereVerts = generateJointSphere(pos, jointRadius_, color);
-    jointVertices.insert(jointVertices.end(), sphereVerts.begin(), sphereVerts.end());
+    jointInstances.push_back({static_cast<uint32_t>(i), color});
   }
 
-  // Upload line buffer for this frame
   if (!lineVertices.empty()) {
-    lineBuffers_[frameIndex].destroy();
-    lineBuffers_[frameIndex].create(context, lineVertices);
-    lineVertexCount_[frameIndex] = static_cast<uint32_t>(lineVertices.size());
-  } else {
-    lineVertexCount_[frameIndex] = 0;
+    lineBuffer_.create(context, lineVertices);
+    lineVertexCount_ = static_cast<uint32_t>(lineVertices.size());
+  }
+
+  if (!jointInstances.empty()) {
+    jointBuffer_.create(context, jointInstances);
+    jointInstanceCount_ = static_cast<uint32_t>(jointInstances.size());
+  }
+}
+
+void SkeletonRenderer::updateFromPose(const SkeletonPose &pose) {
+  // Topology is fixed at load time; only refresh positions in place for hover tests
+  if (pose.boneCount() != bonePositions_.size()) {
+    return;
   }
 
-  // Upload joint buffer for this frame
-  if (!jointVertices.empty()) {
-    jointBuffers_[frameIndex].destroy();
-    jointBuffers_[frameIndex].create(context, jointVertices);
-    jointVertexCount_[frameIndex] = static_cast<uint32_t>(jointVertices.size());
-  } else {
-    jointVertexCount_[frameIndex] = 0;
+  for (size_t i = 0; i < bonePositions_.size(); ++i) {
+    bonePositions_[i] = pose.bonePosition(i);
   }
 }
 
-void SkeletonRenderer::draw(vk::CommandBuffer cmd, uint32_t frameIndex) const {
-  drawWithHover(cmd, frameIndex, glm::vec3(1.0f, 1.0f, 1.0f)); // No tint
+void SkeletonRenderer::clear() {
+  lineBuffer_.destroy();
+  jointBuffer_.destroy();
+  lineVertexCount_ = 0;
+  jointInstanceCount_ = 0;
+
+  bonePositions_.clear();
+  parentIndices_.clear();
+  boneNames_.clear();
+}
+
+void SkeletonRenderer::draw(vk::CommandBuffer cmd) const {
+  drawWithHover(cmd, glm::vec3(1.0f, 1.0f, 1.0f)); // No tint
 }
 
-void SkeletonRenderer::drawWithHover(vk::CommandBuffer cmd, uint32_t frameIndex,
-                                     const glm::vec3 &tintColor) const {
-  if (frameIndex >= FRAME_COUNT || !hasData()) {
+void SkeletonRenderer::drawWithHover(vk::CommandBuffer cmd, const glm::vec3 &tintColor) const {
+  if (!hasData()) {
     return;
   }
 
-  // Push hover tint constant
-  cmd.pushConstants(pipelineLayout_, vk::ShaderStageFlagBits::eFragment, 0, sizeof(glm::vec3),
-                    &tintColor);
+  // Push hover tint and joint radius
+  SkeletonPushConstant pushData{tintColor, jointRadius_};
+  cmd.pushConstants(pipelineLayout_,
+                    vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0,
+                    sizeof(SkeletonPushConstant), &pushData);
 
   // Draw bone lines
-  if (lineVertexCount_[frameIndex] > 0) {
+  if (lineVertexCount_ > 0) {
     cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, linePipeline_);
-    vk::Buffer vertexBuffers[] = {lineBuffers_[frameIndex].buffer()};
+    vk::Buffer vertexBuffers[] = {lineBuffer_.buffer()};
     vk::DeviceSize offsets[] = {0};
     cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.draw(lineVertexCount_[frameIndex], 1, 0, 0);
+    cmd.draw(lineVertexCount_, 1, 0, 0);
   }
 
-  // Draw joint spheres
-  if (jointVertexCount_[frameIndex] > 0) {
+  // Draw joint spheres (one instance per bone)
+  if (jointInstanceCount_ > 0 && sphereVertexCount_ > 0) {
     cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pointPipeline_);
-    vk::Buffer vertexBuffers[] = {jointBuffers_[frameIndex].buffer()};
-    vk::DeviceSize offsets[] = {0};
-    cmd.bindVertexBuffers(0, 1, vertexBuffers, offsets);
-    cmd.draw(jointVertexCount_[frameIndex], 1, 0, 0);
+    vk::Buffer vertexBuffers[] = {sphereBuffer_.buffer(), jointBuffer_.buffer()};
+    vk::DeviceSize offsets[] = {0, 0};
+    cmd.bindVertexBuffers(0, 2, vertexBuffers, offsets);
+    cmd.draw(sphereVertexCount_, jointInstanceCount_, 0, 0);
   }
 }
 
@@ -456,12 +479,9 @@ bool SkeletonRenderer::getJointSphere(size_t jointIndex, glm::vec3 &center, floa
 }
 
 void SkeletonRenderer::destroy() {
-  for (uint32_t i = 0; i < FRAME_COUNT; ++i) {
-    lineBuffers_[i].destroy();
-    jointBuffers_[i].destroy();
-    lineVertexCount_[i] = 0;
-    jointVertexCount_[i] = 0;
-  }
+  clear();
+  sphereBuffer_.destroy();
+  sphereVertexCount_ = 0;
 
   if (device_) {
     if (linePipeline_) {
@@ -9,6 +9,7 @@
 #include <glm/glm.hpp>
 
 #include <array>
+#include <string>
 #include <vector>
 
 #include "skeleton.hpp"
@@ -19,47 +20,64 @@ namespace w3d {
 using gfx::VertexBuffer;
 using gfx::VulkanContext;
 
-// Simple vertex for skeleton visualization (position + color)
-struct SkeletonVertex {
-  glm::vec3 position;
+// Per-bone reference used by the skeleton overlay.
+// Bone lines use it as a per-vertex attribute (two vertices per parent/child pair),
+// joint spheres use it as a per-instance attribute (one instance per bone).
+// Positions are never stored: the vertex shaders read them from the bone matrix SSBO.
+struct SkeletonBoneVertex {
+  uint32_t boneIndex;
   glm::vec3 color;
 
-  static vk::VertexInputBindingDescription getBindingDescription() {
-    return vk::VertexInputBindingDescription{0, sizeof(SkeletonVertex),
-                                             vk::VertexInputRate::eVertex};
+  static vk::VertexInputBindingDescription
+  getBindingDescription(uint32_t binding, vk::VertexInputRate inputRate) {
+    return vk::VertexInputBindingDescription{binding, sizeof(SkeletonBoneVertex), inputRate};
   }
 
-  static std::array<vk::VertexInputAttributeDescription, 2> getAttributeDescriptions() {
+  static std::array<vk::VertexInputAttributeDescription, 2>
+  getAttributeDescriptions(uint32_t binding, uint32_t firstLocation) {
     return {
-        {{0, 0, vk::Format::eR32G32B32Sfloat, offsetof(SkeletonVertex, position)},
-         {1, 0, vk::Format::eR32G32B32Sfloat, offsetof(SkeletonVertex, color)}}
+        {{firstLocation, binding, vk::Format::eR32Uint, offsetof(SkeletonBoneVertex, boneIndex)},
+         {firstLocation + 1, binding, vk::Format::eR32G32B32Sfloat,
+          offsetof(SkeletonBoneVertex, color)}}
     };
   }
 };
 
-// Renders a skeleton as lines and joint spheres
-// Double-buffered to allow CPU updates while GPU is reading previous frame.
+// Push constants shared by the line and joint pipelines
+struct SkeletonPushConstant {
+  glm::vec3 hoverTint; // Fragment: RGB tint (1,1,1 = no tint)
+  float jointRadius;   // Vertex: joint sphere radius in world units
+};
+
+// Renders a skeleton as lines and joint spheres.
+// All geometry is static: a unit icosphere drawn once per bone (instanced) and a
+// line list of bone indices. Bone positions come from the bone matrix SSBO, so
+// animating the skeleton costs no CPU geometry work or buffer uploads.
 class SkeletonRenderer {
 public:
-  static constexpr uint32_t FRAME_COUNT = 2; // Double-buffering
-
   SkeletonRenderer() = default;
   ~SkeletonRenderer();
 
   SkeletonRenderer(const SkeletonRenderer &) = delete;
   SkeletonRenderer &operator=(const SkeletonRenderer &) = delete;
 
-  // Create pipeline and resources
+  // Create pipelines and the shared unit sphere mesh
   void create(VulkanContext &context);
 
-  // Update skeleton geometry from pose for a specific frame
-  void updateFromPose(VulkanContext &context, uint32_t frameIndex, const SkeletonPose &pose);
+  // Build the per-bone buffers for a skeleton (call once per loaded model)
+  void load(VulkanContext &context, const SkeletonPose &pose);
+
+  // Refresh bone positions used for hover detection (no GPU work, no allocations)
+  void updateFromPose(const SkeletonPose &pose);
+
+  // Release per-skeleton buffers (pipelines and sphere mesh are kept)
+  void clear();
 
   // Free resources
   void destroy();
 
   // Check if skeleton is loaded
-  bool hasData() const { return lineVertexCount_[0] > 0 || jointVertexCount_[0] > 0; }
+  bool hasData() const { return lineVertexCount_ > 0 || jointInstanceCount_ > 0; }
 
   // Get pipeline for drawing
   vk::Pipeline linePipeline() const { return linePipeline_; }
@@ -67,13 +85,13 @@ public:
   vk::PipelineLayout pipelineLayout() const { return pipelineLayout_; }
   vk::DescriptorSetLayout descriptorSetLayout() const { return descriptorSetLayout_; }
 
-  // Record draw commands for a specific frame (call after binding descriptor set)
-  void draw(vk::CommandBuffer cmd, uint32_t frameIndex) const;
+  // Record draw commands (call after binding a descriptor set with UBO and bone matrices)
+  void draw(vk::CommandBuffer cmd) const;
 
-  // Draw with optional hover tint for a specific frame (applies to all skeleton elements)
-  void drawWithHover(vk::CommandBuffer cmd, uint32_t frameIndex, const glm::vec3 &tintColor) const;
+  // Draw with optional hover tint (applies to all skeleton elements)
+  void drawWithHover(vk::CommandBuffer cmd, const glm::vec3 &tintColor) const;
 
-  // Color configuration
+  // Color configuration (takes effect on the next load)
   void setBoneColor(const glm::vec3 &color) { boneColor_ = color; }
   void setJointColor(const glm::vec3 &color) { jointColor_ = color; }
   void setRootColor(const glm::vec3 &color) { rootColor_ = color; }
@@ -101,9 +119,8 @@ private:
   void createPipeline(VulkanContext &context);
   void createDescriptorSetLayout(VulkanContext &context);
 
-  // Generate joint sphere vertices (icosphere approximation)
-  std::vector<SkeletonVertex> generateJointSphere(const glm::vec3 &center, float radius,
-                                                  const glm::vec3 &color) const;
+  // Generate unit joint sphere vertices (icosphere approximation)
+  static std::vector<glm::vec3> generateUnitSphere();
 
   vk::Device device_;
 
@@ -113,11 +130,13 @@ private:
   vk::PipelineLayout pipelineLayout_;
   vk::DescriptorSetLayout descriptorSetLayout_;
 
-  // Geometry buffers (double-buffered)
-  std::array<VertexBuffer<SkeletonVertex>, FRAME_COUNT> lineBuffers_;
-  std::array<VertexBuffer<SkeletonVertex>, FRAME_COUNT> jointBuffers_;
-  std::array<uint32_t, FRAME_COUNT> lineVertexCount_ = {};
-  std::array<uint32_t, FRAME_COUNT> jointVertexCount_ = {};
+  // Static geometry
+  VertexBuffer<glm::vec3> sphereBuffer_;           // Unit icosphere, shared by all joints
+  VertexBuffer<SkeletonBoneVertex> lineBuffer_;    // Parent/child bone index pairs
+  VertexBuffer<SkeletonBoneVertex> jointBuffer_;   // One instance per bone
+  uint32_t sphereVertexCount_ = 0;
+  uint32_t lineVertexCount_ = 0;
+  uint32_t jointInstanceCount_ = 0;
 
   // Colors
   glm::vec3 boneColor_{0.8f, 0.8f, 0.2f};  // Yellow for bones
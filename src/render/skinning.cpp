@@ -0,0 +1,33 @@
+#include "skinning.hpp"
+
+namespace w3d {
+
+namespace {
+
+const glm::mat4 IDENTITY(1.0f);
+
+} // namespace
+
+const glm::mat4 &skinningBone(uint32_t boneIndex, const glm::mat4 *bones, size_t boneCount) {
+  return boneIndex < boneCount ? bones[boneIndex] : IDENTITY;
+}
+
+glm::vec3 skinPosition(const gfx::SkinnedVertex &vertex, const glm::mat4 *bones,
+                       size_t boneCount) {
+  return glm::vec3(skinningBone(vertex.boneIndex, bones, boneCount) *
+                   glm::vec4(vertex.position, 1.0f));
+}
+
+void skinVertices(const gfx::SkinnedVertex *vertices, size_t count, const glm::mat4 *bones,
+                  size_t boneCount, gfx::Vertex *out) {
+  for (size_t i = 0; i < count; ++i) {
+    const gfx::SkinnedVertex &v = vertices[i];
+    const glm::mat4 &bone = skinningBone(v.boneIndex, bones, boneCount);
+    out[i].position = glm::vec3(bone * glm::vec4(v.position, 1.0f));
+    out[i].normal = glm::mat3(bone) * v.normal;
+    out[i].texCoord = v.texCoord;
+    out[i].color = v.color;
+  }
+}
+
+} // namespace w3d
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "lib/gfx/pipeline.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace w3d {
+
+// Rigid skinning as skinned.vert and skin.comp do it (legacy Matrix3D::Transform_Vector):
+// every vertex follows the one bone it names. A bone past boneCount leaves the vertex in its
+// rest pose.
+const glm::mat4 &skinningBone(uint32_t boneIndex, const glm::mat4 *bones, size_t boneCount);
+
+glm::vec3 skinPosition(const gfx::SkinnedVertex &vertex, const glm::mat4 *bones,
+                       size_t boneCount);
+
+// Pose count vertices into out, in the full static layout: positions as points, normals by
+// the bone's upper 3x3 (rotation only, not renormalized, as the shaders do), texture
+// coordinates and colors copied. The CPU reference for skin.comp.
+void skinVertices(const gfx::SkinnedVertex *vertices, size_t count, const glm::mat4 *bones,
+                  size_t boneCount, gfx::Vertex *out);
+
+} // namespace w3d
@@ -0,0 +1,162 @@
+#include "skinning_pass.hpp"
+
+#include <array>
+#include <stdexcept>
+
+#include "core/shader_loader.hpp"
+#include "lib/gfx/pipeline.hpp"
+
+namespace w3d {
+
+namespace {
+
+constexpr uint32_t SKIN_GROUP_SIZE = 64; // local_size_x in skin.comp
+
+// skin.comp addresses both layouts as packed floats
+static_assert(sizeof(gfx::SkinnedVertex) == 12 * sizeof(float),
+              "SkinnedVertex must match SOURCE_STRIDE in skin.comp");
+static_assert(sizeof(gfx::Vertex) == 11 * sizeof(float),
+              "Vertex must match POSED_STRIDE in skin.comp");
+
+} // namespace
+
+SkinningPass::~SkinningPass() {
+  destroy();
+}
+
+void SkinningPass::create(gfx::VulkanContext &context, const gfx::FrameRingBuffer &frameData,
+                          vk::DeviceSize boneRange, uint32_t frameCount) {
+  destroy();
+
+  context_ = &context;
+  device_ = context.device();
+  createPipeline(context.pipelineCache());
+
+  std::array<vk::DescriptorPoolSize, 2> poolSizes = {
+      vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer, 2 * frameCount},
+      vk::DescriptorPoolSize{vk::DescriptorType::eStorageBufferDynamic, frameCount}
+  };
+  vk::DescriptorPoolCreateInfo poolInfo{{}, frameCount, poolSizes};
+  descriptorPool_ = device_.createDescriptorPool(poolInfo);
+
+  std::vector<vk::DescriptorSetLayout> layouts(frameCount, descriptorSetLayout_);
+  vk::DescriptorSetAllocateInfo allocInfo{descriptorPool_, layouts};
+  auto sets = device_.allocateDescriptorSets(allocInfo);
+
+  // The palette is in the frame ring buffer at a dynamic offset; skin() writes the source and
+  // output bindings
+  slots_.resize(frameCount);
+  for (uint32_t i = 0; i < frameCount; ++i) {
+    slots_[i].descriptorSet = sets[i];
+    vk::DescriptorBufferInfo boneInfo{frameData.buffer(), 0, boneRange};
+    vk::WriteDescriptorSet write{
+        sets[i], 1, 0, vk::DescriptorType::eStorageBufferDynamic, {}, boneInfo};
+    device_.updateDescriptorSets(write, {});
+  }
+}
+
+void SkinningPass::createPipeline(vk::PipelineCache pipelineCache) {
+  std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {
+      vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eStorageBuffer, 1,
+                                     vk::ShaderStageFlagBits::eCompute},
+      vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eStorageBufferDynamic, 1,
+                                     vk::ShaderStageFlagBits::eCompute},
+      vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageBuffer, 1,
+                                     vk::ShaderStageFlagBits::eCompute}
+  };
+  vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, bindings};
+  descriptorSetLayout_ = device_.createDescriptorSetLayout(layoutInfo);
+
+  vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eCompute, 0,
+                                          sizeof(SkinPushConstant)};
+  vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, descriptorSetLayout_, pushConstantRange};
+  pipelineLayout_ = device_.createPipelineLayout(pipelineLayoutInfo);
+
+  auto code = loadEmbeddedShader("skin.comp.spv");
+  vk::ShaderModuleCreateInfo moduleInfo{
+      {}, code.size(), reinterpret_cast<const uint32_t *>(code.data())};
+  vk::ShaderModule shaderModule = device_.createShaderModule(moduleInfo);
+
+  vk::PipelineShaderStageCreateInfo stageInfo{
+      {}, vk::ShaderStageFlagBits::eCompute, shaderModule, "main"};
+  vk::ComputePipelineCreateInfo pipelineInfo{{}, stageInfo, pipelineLayout_};
+
+  auto result = device_.createComputePipeline(pipelineCache, pipelineInfo);
+  device_.destroyShaderModule(shaderModule);
+  if (result.result != vk::Result::eSuccess) {
+    throw std::runtime_error("Failed to create skinning compute pipeline");
+  }
+  pipeline_ = result.value;
+}
+
+void SkinningPass::destroy() {
+  if (device_) {
+    slots_.clear(); // Frees the output buffers
+    if (pipeline_) {
+      device_.destroyPipeline(pipeline_);
+      pipeline_ = nullptr;
+    }
+    if (pipelineLayout_) {
+      device_.destroyPipelineLayout(pipelineLayout_);
+      pipelineLayout_ = nullptr;
+    }
+    if (descriptorPool_) {
+      device_.destroyDescriptorPool(descriptorPool_);
+      descriptorPool_ = nullptr;
+    }
+    if (descriptorSetLayout_) {
+      device_.destroyDescriptorSetLayout(descriptorSetLayout_);
+      descriptorSetLayout_ = nullptr;
+    }
+    device_ = nullptr;
+  }
+  context_ = nullptr;
+}
+
+bool SkinningPass::skin(vk::CommandBuffer cmd, uint32_t frameIndex, vk::Buffer source,
+                        uint32_t vertexCount, uint32_t boneOffset, uint32_t boneCount) {
+  if (!source || vertexCount == 0) {
+    return false;
+  }
+  Slot &slot = slots_[frameIndex];
+
+  // The slot's fence was waited on, so its previous output is no longer read
+  bool recreated = vertexCount > slot.capacity;
+  if (recreated) {
+    slot.output.destroy();
+    slot.output.create(*context_, vk::DeviceSize{sizeof(gfx::Vertex)} * vertexCount,
+                       vk::BufferUsageFlagBits::eStorageBuffer |
+                           vk::BufferUsageFlagBits::eVertexBuffer,
+                       vk::MemoryPropertyFlagBits::eDeviceLocal);
+    slot.capacity = vertexCount;
+  }
+
+  // Rewritten every frame: the source is the model's and may have been replaced by a load.
+  // The slot's set is only bound by its own frame's command buffer.
+  vk::DescriptorBufferInfo sourceInfo{source, 0, VK_WHOLE_SIZE};
+  vk::DescriptorBufferInfo outputInfo{slot.output.buffer(), 0, VK_WHOLE_SIZE};
+  std::array<vk::WriteDescriptorSet, 2> writes = {
+      vk::WriteDescriptorSet{slot.descriptorSet, 0, 0, vk::DescriptorType::eStorageBuffer, {},
+                             sourceInfo},
+      vk::WriteDescriptorSet{slot.descriptorSet, 2, 0, vk::DescriptorType::eStorageBuffer, {},
+                             outputInfo}
+  };
+  device_.updateDescriptorSets(writes, {});
+
+  SkinPushConstant params{vertexCount, boneCount};
+  cmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline_);
+  cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipelineLayout_, 0,
+                         slot.descriptorSet, boneOffset);
+  cmd.pushConstants(pipelineLayout_, vk::ShaderStageFlagBits::eCompute, 0,
+                    sizeof(SkinPushConstant), &params);
+  cmd.dispatch((vertexCount + SKIN_GROUP_SIZE - 1) / SKIN_GROUP_SIZE, 1, 1);
+
+  // The posed vertices are fetched by this frame's draws
+  vk::MemoryBarrier barrier{vk::AccessFlagBits::eShaderWrite,
+                            vk::AccessFlagBits::eVertexAttributeRead};
+  cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                      vk::PipelineStageFlagBits::eVertexInput, {}, barrier, {}, {});
+  return recreated;
+}
+
+} // namespace w3d
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "lib/gfx/buffer.hpp"
+#include "lib/gfx/ring_buffer.hpp"
+#include "lib/gfx/vulkan_context.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace w3d {
+
+// Push constants of skin.comp
+struct SkinPushConstant {
+  uint32_t vertexCount;
+  uint32_t boneCount;
+};
+
+// Skinning pre-pass: skin.comp poses the skinned set once per frame, before the render pass,
+// into a vertex buffer of the frame slot in the full static layout. The frame's skinned
+// draws bind that buffer through the static pipelines, so however many passes draw the set,
+// its vertices are skinned once. CPU reference: skinVertices().
+class SkinningPass {
+public:
+  SkinningPass() = default;
+  ~SkinningPass();
+
+  SkinningPass(const SkinningPass &) = delete;
+  SkinningPass &operator=(const SkinningPass &) = delete;
+
+  // boneRange is the fixed size of the bone palette allocated in frameData each frame
+  void create(gfx::VulkanContext &context, const gfx::FrameRingBuffer &frameData,
+              vk::DeviceSize boneRange, uint32_t frameCount);
+
+  void destroy();
+
+  // Record outside a render pass, after the frame slot's fence was waited on: pose the
+  // vertexCount vertices of source (gfx::SkinnedVertex) with the palette written to
+  // frameData at boneOffset. Returns true when the slot's output buffer was recreated to fit,
+  // which invalidates draws recorded against the old one.
+  bool skin(vk::CommandBuffer cmd, uint32_t frameIndex, vk::Buffer source,
+            uint32_t vertexCount, uint32_t boneOffset, uint32_t boneCount);
+
+  // Posed vertices (gfx::Vertex) written by the frame slot's last skin()
+  vk::Buffer output(uint32_t frameIndex) const { return slots_[frameIndex].output.buffer(); }
+
+private:
+  void createPipeline(vk::PipelineCache pipelineCache);
+
+  struct Slot {
+    gfx::Buffer output;
+    uint32_t capacity = 0; // Vertices output holds
+    vk::DescriptorSet descriptorSet;
+  };
+
+  gfx::VulkanContext *context_ = nullptr;
+  vk::Device device_;
+
+  vk::DescriptorSetLayout descriptorSetLayout_;
+  vk::PipelineLayout pipelineLayout_;
+  vk::Pipeline pipeline_;
+  vk::DescriptorPool descriptorPool_;
+  std::vector<Slot> slots_;
+};
+
+} // namespace w3d
@@ -0,0 +1,157 @@
+#include "vertex_transform.hpp"
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define W3D_VERTEX_TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace w3d {
+
+using gfx::BoundingBox;
+using gfx::Vertex;
+
+namespace {
+
+void transformScalar(Vertex *vertices, size_t count, const glm::mat4 &transform,
+                     const glm::mat3 &normalMatrix, BoundingBox &bounds) {
+  for (size_t i = 0; i < count; ++i) {
+    Vertex &v = vertices[i];
+    v.position = glm::vec3(transform * glm::vec4(v.position, 1.0f));
+    v.normal = glm::normalize(normalMatrix * v.normal);
+    bounds.expand(v.position);
+  }
+}
+
+#ifdef W3D_VERTEX_TRANSFORM_SSE2
+
+// The kernel loads position + normal.x and normal.yz + texCoord as two unaligned 4-float
+// rows per vertex, and transposes four vertices into one register per component
+static_assert(offsetof(Vertex, position) == 0 && offsetof(Vertex, normal) == 12 &&
+                  offsetof(Vertex, texCoord) == 24,
+              "Vertex must start with packed position, normal and texCoord");
+
+// Column c, row r of m broadcast to every lane
+template <typename MatT>
+__m128 splat(const MatT &m, int c, int r) {
+  return _mm_set1_ps(m[c][r]);
+}
+
+float horizontalMin(__m128 v) {
+  v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtss_f32(v);
+}
+
+float horizontalMax(__m128 v) {
+  v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtss_f32(v);
+}
+
+// Blocks of four vertices; returns how many were transformed. Sums are grouped as glm groups
+// them, so the results match the scalar path.
+size_t transformSse2(Vertex *vertices, size_t count, const glm::mat4 &m, const glm::mat3 &n,
+                     BoundingBox &bounds) {
+  size_t blockEnd = count & ~size_t{3};
+  if (blockEnd == 0) {
+    return 0;
+  }
+
+  __m128 m00 = splat(m, 0, 0), m01 = splat(m, 0, 1), m02 = splat(m, 0, 2);
+  __m128 m10 = splat(m, 1, 0), m11 = splat(m, 1, 1), m12 = splat(m, 1, 2);
+  __m128 m20 = splat(m, 2, 0), m21 = splat(m, 2, 1), m22 = splat(m, 2, 2);
+  __m128 m30 = splat(m, 3, 0), m31 = splat(m, 3, 1), m32 = splat(m, 3, 2);
+  __m128 n00 = splat(n, 0, 0), n01 = splat(n, 0, 1), n02 = splat(n, 0, 2);
+  __m128 n10 = splat(n, 1, 0), n11 = splat(n, 1, 1), n12 = splat(n, 1, 2);
+  __m128 n20 = splat(n, 2, 0), n21 = splat(n, 2, 1), n22 = splat(n, 2, 2);
+  __m128 one = _mm_set1_ps(1.0f);
+
+  __m128 minX = _mm_set1_ps(bounds.min.x), minY = _mm_set1_ps(bounds.min.y);
+  __m128 minZ = _mm_set1_ps(bounds.min.z);
+  __m128 maxX = _mm_set1_ps(bounds.max.x), maxY = _mm_set1_ps(bounds.max.y);
+  __m128 maxZ = _mm_set1_ps(bounds.max.z);
+
+  for (size_t i = 0; i < blockEnd; i += 4) {
+    float *p[4];
+    for (int k = 0; k < 4; ++k) {
+      p[k] = &vertices[i + k].position.x;
+    }
+
+    // Rows: (px, py, pz, nx) and (ny, nz, u, v); columns after the transposes
+    __m128 x = _mm_loadu_ps(p[0]), y = _mm_loadu_ps(p[1]);
+    __m128 z = _mm_loadu_ps(p[2]), nx = _mm_loadu_ps(p[3]);
+    __m128 ny = _mm_loadu_ps(p[0] + 4), nz = _mm_loadu_ps(p[1] + 4);
+    __m128 u = _mm_loadu_ps(p[2] + 4), v = _mm_loadu_ps(p[3] + 4);
+    _MM_TRANSPOSE4_PS(x, y, z, nx);
+    _MM_TRANSPOSE4_PS(ny, nz, u, v);
+
+    // Points: (m[0] * x + m[1] * y) + (m[2] * z + m[3])
+    __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)),
+                           _mm_add_ps(_mm_mul_ps(m20, z), m30));
+    __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)),
+                           _mm_add_ps(_mm_mul_ps(m21, z), m31));
+    __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)),
+                           _mm_add_ps(_mm_mul_ps(m22, z), m32));
+
+    // Directions: n[0] * nx + n[1] * ny + n[2] * nz, then scaled by 1 / length
+    __m128 tnx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n00, nx), _mm_mul_ps(n10, ny)),
+                            _mm_mul_ps(n20, nz));
+    __m128 tny = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n01, nx), _mm_mul_ps(n11, ny)),
+                            _mm_mul_ps(n21, nz));
+    __m128 tnz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n02, nx), _mm_mul_ps(n12, ny)),
+                            _mm_mul_ps(n22, nz));
+    __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tnx, tnx), _mm_mul_ps(tny, tny)),
+                                 _mm_mul_ps(tnz, tnz));
+    __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+    tnx = _mm_mul_ps(tnx, invLength);
+    tny = _mm_mul_ps(tny, invLength);
+    tnz = _mm_mul_ps(tnz, invLength);
+
+    minX = _mm_min_ps(minX, tx);
+    minY = _mm_min_ps(minY, ty);
+    minZ = _mm_min_ps(minZ, tz);
+    maxX = _mm_max_ps(maxX, tx);
+    maxY = _mm_max_ps(maxY, ty);
+    maxZ = _mm_max_ps(maxZ, tz);
+
+    // Back to rows; the texCoord lanes are written back unchanged
+    _MM_TRANSPOSE4_PS(tx, ty, tz, tnx);
+    _MM_TRANSPOSE4_PS(tny, tnz, u, v);
+    _mm_storeu_ps(p[0], tx);
+    _mm_storeu_ps(p[1], ty);
+    _mm_storeu_ps(p[2], tz);
+    _mm_storeu_ps(p[3], tnx);
+    _mm_storeu_ps(p[0] + 4, tny);
+    _mm_storeu_ps(p[1] + 4, tnz);
+    _mm_storeu_ps(p[2] + 4, u);
+    _mm_storeu_ps(p[3] + 4, v);
+  }
+
+  bounds.min = glm::vec3(horizontalMin(minX), horizontalMin(minY), horizontalMin(minZ));
+  bounds.max = glm::vec3(horizontalMax(maxX), horizontalMax(maxY), horizontalMax(maxZ));
+  return blockEnd;
+}
+
+#endif
+
+} // namespace
+
+void transformVertices(Vertex *vertices, size_t count, const glm::mat4 &transform,
+                       BoundingBox &bounds) {
+  glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+  size_t done = 0;
+#ifdef W3D_VERTEX_TRANSFORM_SSE2
+  done = transformSse2(vertices, count, transform, normalMatrix, bounds);
+#endif
+  transformScalar(vertices + done, count - done, transform, normalMatrix, bounds);
+}
+
+void transformVerticesScalar(Vertex *vertices, size_t count, const glm::mat4 &transform,
+                             BoundingBox &bounds) {
+  glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+  transformScalar(vertices, count, transform, normalMatrix, bounds);
+}
+
+} // namespace w3d
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "lib/gfx/pipeline.hpp"
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "lib/gfx/bounding_box.hpp"
+
+namespace w3d {
+
+// Transform count vertices in place: positions as points, normals as directions by the
+// inverse transpose of the upper 3x3 and renormalized. bounds is expanded by every
+// transformed position in the same pass. Runs four vertices at a time with SSE2 where the
+// target has it, and through transformVerticesScalar() otherwise.
+void transformVertices(gfx::Vertex *vertices, size_t count, const glm::mat4 &transform,
+                       gfx::BoundingBox &bounds);
+
+// One vertex at a time through glm; the reference for the batched kernel
+void transformVerticesScalar(gfx::Vertex *vertices, size_t count, const glm::mat4 &transform,
+                             gfx::BoundingBox &bounds);
+
+} // namespace w3d
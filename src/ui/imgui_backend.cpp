@@ -60,7 +60,7 @@ void ImGuiBackend::init(GLFWwindow *window, gfx::VulkanContext &context) {
   initInfo.Device = context.device();
   initInfo.QueueFamily = context.graphicsQueueFamily();
   initInfo.Queue = context.graphicsQueue();
-  initInfo.PipelineCache = VK_NULL_HANDLE;
+  initInfo.PipelineCache = context.pipelineCache();
   initInfo.DescriptorPool = descriptorPool_;
   initInfo.MinImageCount = 2;
   initInfo.ImageCount = static_cast<uint32_t>(context.swapchainImages().size());
@@ -103,6 +103,9 @@ void ImGuiBackend::newFrame() {
 }
 
 void ImGuiBackend::render(vk::CommandBuffer cmd) {
+  if (!initialized_)
+    return;
+
   ImGui::Render();
   ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
 }
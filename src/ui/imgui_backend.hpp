@@ -27,7 +27,7 @@ public:
   // Begin a new ImGui frame
   void newFrame();
 
-  // Render ImGui draw data
+  // Render ImGui draw data (nothing when not initialized, as in headless runs)
   void render(vk::CommandBuffer cmd);
 
   // Handle swapchain recreation
@@ -0,0 +1,87 @@
+#include "gpu_profiler_panel.hpp"
+
+#include "../ui_context.hpp"
+#include "core/render_state.hpp"
+#include "lib/gfx/gpu_profiler.hpp"
+
+#include <imgui.h>
+
+namespace w3d {
+
+void GpuProfilerPanel::draw(UIContext &ctx) {
+  if (!ctx.gpuProfiler || !ctx.gpuProfiler->hasTimestamps()) {
+    ImGui::TextDisabled("GPU timestamps not supported");
+    return;
+  }
+
+  const auto &scopes = ctx.gpuProfiler->scopes();
+  if (ImGui::BeginTable("GpuPasses", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("Last ms");
+    ImGui::TableSetupColumn("Avg ms");
+    ImGui::TableSetupColumn("Max ms");
+    ImGui::TableHeadersRow();
+
+    for (const auto &scope : scopes) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(scope.name.c_str());
+      if (scope.history.empty()) {
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("-");
+        ImGui::TableNextColumn();
+        ImGui::TableNextColumn();
+        continue;
+      }
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.history.latest());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.history.mean());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.history.max());
+    }
+    ImGui::EndTable();
+  }
+
+  for (const auto &scope : scopes) {
+    if (scope.history.empty()) {
+      continue;
+    }
+    ImGui::PlotLines(scope.name.c_str(), scope.history.data(),
+                     static_cast<int>(scope.history.size()),
+                     static_cast<int>(scope.history.offset()), nullptr, 0.0f,
+                     scope.history.max() * 1.2f, ImVec2(0, 40));
+  }
+
+  if (!ctx.gpuProfiler->hasPipelineStatistics() || !ctx.renderState) {
+    return;
+  }
+
+  ImGui::Checkbox("Pipeline statistics", &ctx.renderState->gpuPipelineStatistics);
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Count the shader invocations of each pass");
+  }
+  if (!ctx.renderState->gpuPipelineStatistics) {
+    return;
+  }
+
+  if (ImGui::BeginTable("GpuInvocations", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("Vertex");
+    ImGui::TableSetupColumn("Fragment");
+    ImGui::TableHeadersRow();
+
+    for (const auto &scope : scopes) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(scope.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(scope.counts.vertexInvocations));
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(scope.counts.fragmentInvocations));
+    }
+    ImGui::EndTable();
+  }
+}
+
+} // namespace w3d
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../ui_panel.hpp"
+
+namespace w3d {
+
+/// Panel showing the GPU time of each render pass, with a rolling history of recent frames.
+/// Optionally counts the vertex and fragment shader invocations of each pass.
+class GpuProfilerPanel : public UIPanel {
+public:
+  const char *title() const override { return "GPU Profiler"; }
+  void draw(UIContext &ctx) override;
+};
+
+} // namespace w3d
@@ -0,0 +1,56 @@
+#include "instance_panel.hpp"
+
+#include "../ui_context.hpp"
+#include "lib/formats/w3d/hlod_model.hpp"
+#include "render/instance_set.hpp"
+#include "render/render_queue.hpp"
+
+#include <imgui.h>
+
+namespace w3d {
+
+void InstancePanel::draw(UIContext &ctx) {
+  if (!ctx.renderState || !ctx.renderState->useHLodModel || !ctx.hlodModel ||
+      !ctx.hlodModel->hasData()) {
+    ImGui::TextDisabled("No HLod model loaded");
+    return;
+  }
+
+  auto &model = *ctx.hlodModel;
+
+  // Grid spawner
+  ImGui::SliderInt("Count", &count_, 1, static_cast<int>(MAX_INSTANCES), "%d",
+                   ImGuiSliderFlags_Logarithmic);
+  ImGui::SliderFloat("Spacing", &spacing_, 1.0f, 5.0f, "%.1f x size");
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Distance between neighbouring copies, in model diameters");
+  }
+
+  if (ImGui::Button("Spawn Grid")) {
+    float diameter = 2.0f * model.bounds().radius();
+    model.setInstances(gridInstances(static_cast<size_t>(count_), spacing_ * diameter));
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Clear")) {
+    model.clearInstances();
+  }
+
+  if (model.instances().empty()) {
+    ImGui::TextDisabled("Drawing the single model");
+    return;
+  }
+
+  ImGui::Text("Instances: %zu", model.instances().size());
+  if (ctx.instanceBuckets && ctx.instanceBuckets->levelCount() > 0) {
+    const auto &buckets = *ctx.instanceBuckets;
+    ImGui::Text("In view: %u", buckets.total());
+    for (size_t level = 0; level < buckets.levelCount(); ++level) {
+      ImGui::BulletText("LOD %zu: %u", level, buckets.count(level));
+    }
+  }
+  if (ctx.renderStats) {
+    ImGui::Text("Draws: %u", ctx.renderStats->draws);
+  }
+}
+
+} // namespace w3d
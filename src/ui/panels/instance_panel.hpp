@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../ui_panel.hpp"
+
+namespace w3d {
+
+/// Panel for drawing many copies of the HLod model.
+/// Spawns a grid of instances, and shows how many are in view per LOD level next to the
+/// draw count, which does not grow with the instance count.
+class InstancePanel : public UIPanel {
+public:
+  const char *title() const override { return "Instances"; }
+  void draw(UIContext &ctx) override;
+
+private:
+  int count_ = 100;
+  float spacing_ = 1.5f; // In model diameters
+};
+
+} // namespace w3d
@@ -0,0 +1,97 @@
+#include "render_stats_panel.hpp"
+
+#include "../ui_context.hpp"
+#include "core/render_state.hpp"
+#include "render/render_queue.hpp"
+
+#include <imgui.h>
+
+namespace w3d {
+
+void RenderStatsPanel::draw(UIContext &ctx) {
+  if (ctx.renderState) {
+    int threads = static_cast<int>(ctx.renderState->recordThreads);
+    if (ImGui::SliderInt("Record threads", &threads, 0,
+                         static_cast<int>(RenderState::MAX_RECORD_THREADS))) {
+      ctx.renderState->recordThreads = static_cast<uint32_t>(threads);
+    }
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Threads recording draws into secondary command buffers (0: inline)");
+    }
+    ImGui::Checkbox("Reuse draw commands", &ctx.renderState->reuseDrawCommands);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Replay the recorded draws while nothing in the scene changes");
+    }
+    ImGui::Checkbox("Compute skinning", &ctx.renderState->computeSkinning);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Pose skinned meshes once per frame in a compute pass");
+    }
+    ImGui::Checkbox("GPU picking", &ctx.renderState->gpuPicking);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Hover meshes by rendering IDs under the cursor instead of ray tests");
+    }
+  }
+
+  if (!ctx.renderStats || ctx.renderStats->draws == 0) {
+    ImGui::TextDisabled("No draws recorded");
+    return;
+  }
+
+  const auto &stats = *ctx.renderStats;
+  ImGui::Text("Draws: %u (%u translucent)", stats.draws, stats.translucentDraws);
+
+  if (ImGui::BeginTable("BindCounts", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    ImGui::TableSetupColumn("Binds");
+    ImGui::TableSetupColumn("Submitted");
+    ImGui::TableSetupColumn("Sorted");
+    ImGui::TableHeadersRow();
+
+    auto row = [](const char *label, uint32_t submitted, uint32_t sorted) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(label);
+      ImGui::TableNextColumn();
+      ImGui::Text("%u", submitted);
+      ImGui::TableNextColumn();
+      ImGui::Text("%u", sorted);
+    };
+    row("Pipelines", stats.submitted.pipelines, stats.sorted.pipelines);
+    row("Vertex buffers", stats.submitted.vertexBuffers, stats.sorted.vertexBuffers);
+    row("Materials", stats.submitted.materials, stats.sorted.materials);
+    ImGui::EndTable();
+  }
+
+  if (!ctx.recordStats) {
+    return;
+  }
+
+  const auto &record = *ctx.recordStats;
+  if (record.reused) {
+    ImGui::Text("Recording: reused (%.3f ms)", record.totalMs);
+    return;
+  }
+  ImGui::Text("Recording: %.3f ms", record.totalMs);
+  if (record.threadMs.empty()) {
+    return;
+  }
+
+  if (ImGui::BeginTable("RecordThreads", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    ImGui::TableSetupColumn("Thread");
+    ImGui::TableSetupColumn("Draws");
+    ImGui::TableSetupColumn("ms");
+    ImGui::TableHeadersRow();
+
+    for (size_t i = 0; i < record.threadMs.size(); ++i) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", i);
+      ImGui::TableNextColumn();
+      ImGui::Text("%u", record.threadDraws[i]);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", record.threadMs[i]);
+    }
+    ImGui::EndTable();
+  }
+}
+
+} // namespace w3d
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../ui_panel.hpp"
+
+namespace w3d {
+
+/// Panel showing the render queue's draw and bind counts for the last frame.
+/// Compares the binds of the sorted queue with recording in submission order, and shows the
+/// draw recording time per thread.
+class RenderStatsPanel : public UIPanel {
+public:
+  const char *title() const override { return "Render Stats"; }
+  void draw(UIContext &ctx) override;
+};
+
+} // namespace w3d
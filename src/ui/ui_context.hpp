@@ -19,9 +19,16 @@ class HLodModel;
 class RenderableMesh;
 class SkeletonPose;
 struct HoverState;
+struct InstanceBuckets;
+struct RecordStats;
+struct RenderQueueStats;
 struct Settings;
 struct W3DFile;
 
+namespace gfx {
+class GpuProfiler;
+} // namespace gfx
+
 /// Shared UI context passed to all windows and panels.
 /// Contains references to application state that UI components need to read/modify.
 ///
@@ -68,6 +75,16 @@ struct UIContext {
   /// Current hover state (read-only for UI display)
   const HoverState *hoverState = nullptr;
 
+  // === Render Statistics ===
+  /// Render queue draw and bind counts of the last frame (read-only)
+  const RenderQueueStats *renderStats = nullptr;
+  /// Draw recording time of the last frame, per recording thread (read-only)
+  const RecordStats *recordStats = nullptr;
+  /// Per-pass GPU times and invocation counts (read-only)
+  const gfx::GpuProfiler *gpuProfiler = nullptr;
+  /// HLod model instances in view per LOD level in the last frame (read-only)
+  const InstanceBuckets *instanceBuckets = nullptr;
+
   // === Application Settings ===
   /// Persistent application settings (for settings window)
   Settings *settings = nullptr;
@@ -3,9 +3,12 @@
 #include "panels/animation_panel.hpp"
 #include "panels/camera_panel.hpp"
 #include "panels/display_panel.hpp"
+#include "panels/gpu_profiler_panel.hpp"
+#include "panels/instance_panel.hpp"
 #include "panels/lod_panel.hpp"
 #include "panels/mesh_visibility_panel.hpp"
 #include "panels/model_info_panel.hpp"
+#include "panels/render_stats_panel.hpp"
 
 #include <imgui.h>
 
@@ -17,8 +20,11 @@ ViewportWindow::ViewportWindow() {
   addPanel<AnimationPanel>();
   addPanel<DisplayPanel>();
   addPanel<LODPanel>();
+  addPanel<InstancePanel>();
   addPanel<MeshVisibilityPanel>();
   addPanel<CameraPanel>();
+  addPanel<RenderStatsPanel>();
+  addPanel<GpuProfilerPanel>();
 }
 
 void ViewportWindow::draw(UIContext &ctx) {
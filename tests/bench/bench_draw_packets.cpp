@@ -0,0 +1,153 @@
+// Headless microbenchmark of per-frame draw recording.
+//
+// Compares the old per-frame path (sort meshes by texture name, look each texture up by
+// name, build the material constants) with walking precompiled draw packets. "Recording"
+// appends what the renderer would push and draw to a plain command stream, so no Vulkan
+// device is needed.
+//
+// Usage: draw_packet_bench [meshCount] [frames]
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render/draw_packet.hpp"
+
+using namespace w3d;
+
+namespace {
+
+// What recording a batch costs the renderer: material constants plus a draw range
+struct RecordedBatch {
+  GPUMaterial material;
+  glm::vec3 tint;
+  uint32_t firstCommand;
+  uint32_t commandCount;
+};
+
+struct Mesh {
+  std::string textureName;
+  IndirectDrawCommand command;
+  size_t lodLevel;
+  bool isAggregate;
+};
+
+struct Scene {
+  std::vector<Mesh> meshes;
+  std::unordered_map<std::string, uint32_t> textures;
+  std::vector<DrawPacket> packets;
+};
+
+Scene makeScene(size_t meshCount) {
+  Scene scene;
+  const size_t textureCount = std::max<size_t>(meshCount / 8, 1);
+  for (size_t t = 0; t < textureCount; ++t) {
+    scene.textures["texture_" + std::to_string(t) + ".tga"] = static_cast<uint32_t>(t + 1);
+  }
+
+  for (size_t i = 0; i < meshCount; ++i) {
+    Mesh mesh;
+    mesh.textureName = "texture_" + std::to_string((i * 7) % textureCount) + ".tga";
+    mesh.command = {36, 1, static_cast<uint32_t>(i * 36), 0, 0};
+    mesh.lodLevel = i % 3;
+    mesh.isAggregate = (i % 16) == 0;
+    scene.meshes.push_back(mesh);
+
+    DrawPacket packet{};
+    packet.material = packetMaterial(scene.textures[mesh.textureName]);
+    packet.sphere = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    packet.command = mesh.command;
+    packet.boneIndex = CullInput::NO_BONE;
+    packet.lodMask = mesh.isAggregate ? DrawPacket::ALL_LODS : lodBit(mesh.lodLevel);
+    packet.meshIndex = static_cast<uint32_t>(i);
+    scene.packets.push_back(packet);
+  }
+  sortDrawPackets(scene.packets);
+  return scene;
+}
+
+// Per-frame work before draw packets: filter, sort by name, resolve names while recording
+void recordByName(const Scene &scene, size_t lod, std::vector<uint32_t> &order,
+                  std::vector<RecordedBatch> &stream) {
+  order.clear();
+  for (size_t i = 0; i < scene.meshes.size(); ++i) {
+    if (scene.meshes[i].isAggregate || scene.meshes[i].lodLevel == lod) {
+      order.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return scene.meshes[a].textureName < scene.meshes[b].textureName;
+  });
+
+  stream.clear();
+  for (uint32_t slot = 0; slot < order.size(); ++slot) {
+    const Mesh &mesh = scene.meshes[order[slot]];
+    if (!stream.empty() && scene.meshes[order[slot - 1]].textureName == mesh.textureName) {
+      ++stream.back().commandCount;
+      continue;
+    }
+    auto it = scene.textures.find(mesh.textureName);
+    uint32_t texIdx = it != scene.textures.end() ? it->second : 0;
+    stream.push_back({packetMaterial(texIdx), glm::vec3(1.0f), slot, 1});
+  }
+}
+
+// Per-frame work with draw packets
+void recordPackets(const Scene &scene, size_t lod, DrawList &list,
+                   std::vector<RecordedBatch> &stream) {
+  buildDrawList(scene.packets, lodBit(lod), {}, -1, glm::vec3(1.0f), list);
+
+  stream.clear();
+  for (const DrawBatch &batch : list.batches) {
+    stream.push_back({*batch.material, batch.tint, batch.firstCommand, batch.commandCount});
+  }
+}
+
+template <typename Func>
+double nanosecondsPerFrame(size_t frames, Func recordFrame) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t f = 0; f < frames; ++f) {
+    recordFrame(f % 3);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(frames);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t meshCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+  if (meshCount == 0 || frames == 0) {
+    std::fprintf(stderr, "usage: %s [meshCount] [frames]\n", argv[0]);
+    return 1;
+  }
+
+  Scene scene = makeScene(meshCount);
+
+  std::vector<uint32_t> order;
+  std::vector<RecordedBatch> stream;
+  DrawList list;
+  size_t checksum = 0;
+
+  double byName = nanosecondsPerFrame(frames, [&](size_t lod) {
+    recordByName(scene, lod, order, stream);
+    checksum += stream.size();
+  });
+  double byPacket = nanosecondsPerFrame(frames, [&](size_t lod) {
+    recordPackets(scene, lod, list, stream);
+    checksum += stream.size();
+  });
+
+  std::printf("%zu meshes, %zu frames (checksum %zu)\n", meshCount, frames, checksum);
+  std::printf("  name lookups:  %10.1f ns/frame\n", byName);
+  std::printf("  draw packets:  %10.1f ns/frame (%.1fx)\n", byPacket, byName / byPacket);
+  return 0;
+}
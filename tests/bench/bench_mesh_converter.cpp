@@ -0,0 +1,138 @@
+// Headless throughput benchmark of MeshConverter.
+//
+// Converts a synthetic set of W3D meshes: multi-texture "buildings" with per-face UVs, which
+// take the corner-by-corner path, and single-texture "props", which are indexed as they are.
+// Reports triangles per second converting one mesh after another with convert() and as one
+// parallel batch with convertMany().
+//
+// Usage: mesh_converter_bench [meshCount] [rounds]
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "render/mesh_converter.hpp"
+
+using namespace w3d;
+
+namespace {
+
+// A size x size grid of quads; buildings spread their cells over four textures and give
+// every corner its own UV index, as exported walls do
+Mesh makeMesh(size_t index, uint32_t size, bool building) {
+  Mesh mesh;
+  mesh.header.meshName = (building ? "building_" : "prop_") + std::to_string(index);
+  uint32_t stride = size + 1;
+  for (uint32_t y = 0; y <= size; ++y) {
+    for (uint32_t x = 0; x <= size; ++x) {
+      float fx = static_cast<float>(x);
+      float fy = static_cast<float>(y);
+      mesh.vertices.push_back({fx, fy, static_cast<float>((x * 7 + y * 3) % 5)});
+      mesh.normals.push_back({0.0f, 0.0f, 1.0f});
+      mesh.texCoords.push_back({fx / size, fy / size});
+      mesh.vertexColors.push_back({static_cast<uint8_t>(x * 16), static_cast<uint8_t>(y * 16),
+                                   128, 255});
+    }
+  }
+
+  TextureStage stage;
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      uint32_t v = y * stride + x;
+      Triangle lower;
+      lower.vertexIndices[0] = v;
+      lower.vertexIndices[1] = v + 1;
+      lower.vertexIndices[2] = v + stride;
+      Triangle upper;
+      upper.vertexIndices[0] = v + 1;
+      upper.vertexIndices[1] = v + stride + 1;
+      upper.vertexIndices[2] = v + stride;
+      mesh.triangles.push_back(lower);
+      mesh.triangles.push_back(upper);
+
+      if (building) {
+        uint32_t texture = (x / 4 + y / 4) % 4;
+        stage.textureIds.insert(stage.textureIds.end(), {texture, texture});
+        for (const Triangle &tri : {lower, upper}) {
+          stage.perFaceTexCoordIds.insert(stage.perFaceTexCoordIds.end(), tri.vertexIndices,
+                                          tri.vertexIndices + 3);
+        }
+      }
+    }
+  }
+
+  if (building) {
+    stage.texCoords = mesh.texCoords;
+    mesh.texCoords.clear();
+    mesh.textures.resize(4);
+    for (size_t t = 0; t < mesh.textures.size(); ++t) {
+      mesh.textures[t].name = "wall_" + std::to_string(t) + ".tga";
+    }
+  } else {
+    stage.textureIds.push_back(0);
+    mesh.textures.resize(1);
+    mesh.textures[0].name = "prop.tga";
+  }
+  MaterialPass pass;
+  pass.textureStages.push_back(stage);
+  mesh.materialPasses.push_back(pass);
+  return mesh;
+}
+
+template <typename Func>
+double secondsPerRound(size_t rounds, Func convertAll) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < rounds; ++r) {
+    convertAll();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double>(elapsed).count() / static_cast<double>(rounds);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t meshCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+  if (meshCount == 0 || rounds == 0) {
+    std::fprintf(stderr, "usage: %s [meshCount] [rounds]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<Mesh> meshes;
+  std::vector<MeshConversionJob> jobs;
+  size_t triangles = 0;
+  meshes.reserve(meshCount);
+  for (size_t i = 0; i < meshCount; ++i) {
+    meshes.push_back(makeMesh(i, 16 + static_cast<uint32_t>(i % 4) * 8, i % 2 == 0));
+    triangles += meshes.back().triangles.size();
+  }
+  for (const auto &mesh : meshes) {
+    jobs.push_back({&mesh, 0});
+  }
+
+  size_t checksum = 0;
+  double serial = secondsPerRound(rounds, [&] {
+    for (const auto &mesh : meshes) {
+      checksum += MeshConverter::convert(mesh).subMeshes.size();
+    }
+  });
+  double parallel = secondsPerRound(rounds, [&] {
+    for (const auto &converted : MeshConverter::convertMany(jobs)) {
+      checksum += converted.subMeshes.size();
+    }
+  });
+
+  double mtris = static_cast<double>(triangles) / 1e6;
+  std::printf("%zu meshes, %zu triangles, %zu rounds (checksum %zu)\n", meshCount, triangles,
+              rounds, checksum);
+  std::printf("  convert():     %8.2f ms/round, %7.1f Mtri/s\n", serial * 1e3, mtris / serial);
+  std::printf("  convertMany(): %8.2f ms/round, %7.1f Mtri/s (%.1fx)\n", parallel * 1e3,
+              mtris / parallel, serial / parallel);
+  return 0;
+}
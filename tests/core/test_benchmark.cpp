@@ -0,0 +1,99 @@
+#include <vector>
+
+#include "core/benchmark.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+TEST(BenchmarkTest, EmptySeriesGivesZeroSummary) {
+  TimingSummary summary = summarizeTimings({});
+  EXPECT_EQ(summary.samples, 0u);
+  EXPECT_EQ(summary.mean, 0.0);
+  EXPECT_EQ(summary.p99, 0.0);
+}
+
+TEST(BenchmarkTest, PercentilesUseNearestRank) {
+  std::vector<double> samples;
+  for (int i = 100; i >= 1; --i) {
+    samples.push_back(static_cast<double>(i));
+  }
+
+  TimingSummary summary = summarizeTimings(samples);
+  EXPECT_EQ(summary.samples, 100u);
+  EXPECT_DOUBLE_EQ(summary.mean, 50.5);
+  EXPECT_DOUBLE_EQ(summary.min, 1.0);
+  EXPECT_DOUBLE_EQ(summary.max, 100.0);
+  EXPECT_DOUBLE_EQ(summary.p50, 50.0);
+  EXPECT_DOUBLE_EQ(summary.p90, 90.0);
+  EXPECT_DOUBLE_EQ(summary.p95, 95.0);
+  EXPECT_DOUBLE_EQ(summary.p99, 99.0);
+}
+
+TEST(BenchmarkTest, SingleSampleIsEveryPercentile) {
+  TimingSummary summary = summarizeTimings({4.25});
+  EXPECT_DOUBLE_EQ(summary.p50, 4.25);
+  EXPECT_DOUBLE_EQ(summary.p99, 4.25);
+  EXPECT_DOUBLE_EQ(summary.min, summary.max);
+}
+
+TEST(BenchmarkTest, ReportJsonHasTimingsAndNullGpuWithoutSamples) {
+  BenchmarkReport report;
+  report.model = "tank.w3d";
+  report.device = "llvmpipe";
+  report.width = 640;
+  report.height = 480;
+  report.cpuFrameMs = summarizeTimings({1.0, 2.0, 3.0});
+  report.renderStats.draws = 12;
+  report.renderStats.sorted.pipelines = 2;
+  report.recordThreads = 4;
+  report.vertexFormat = "quantized";
+  report.vertexBytes = 2000;
+  report.indexBytes = 600;
+  report.acmrBefore = 1.0;
+  report.acmrAfter = 0.75;
+
+  nlohmann::json json = toJson(report);
+  EXPECT_EQ(json["model"], "tank.w3d");
+  EXPECT_EQ(json["resolution"][0], 640);
+  EXPECT_EQ(json["cpuFrameMs"]["samples"], 3);
+  EXPECT_DOUBLE_EQ(json["cpuFrameMs"]["p50"].get<double>(), 2.0);
+  EXPECT_TRUE(json["gpuFrameMs"].is_null());
+  EXPECT_EQ(json["renderStats"]["draws"], 12);
+  EXPECT_EQ(json["renderStats"]["binds"]["pipelines"], 2);
+  EXPECT_EQ(json["recording"]["threads"], 4);
+  EXPECT_EQ(json["recording"]["ms"]["samples"], 0);
+  EXPECT_EQ(json["pipelineStartup"]["cacheBytes"], 0);
+  EXPECT_EQ(json["vertices"]["format"], "quantized");
+  EXPECT_EQ(json["vertices"]["bytes"], 2000);
+  EXPECT_EQ(json["indices"]["bytes"], 600);
+  EXPECT_DOUBLE_EQ(json["indices"]["acmrAfter"].get<double>(), 0.75);
+
+  report.gpuFrameMs = summarizeTimings({0.5});
+  EXPECT_DOUBLE_EQ(toJson(report)["gpuFrameMs"]["max"].get<double>(), 0.5);
+}
+
+TEST(BenchmarkTest, ReportJsonListsGpuPasses) {
+  BenchmarkReport report;
+  EXPECT_TRUE(toJson(report)["gpuPasses"].empty());
+
+  GpuPassReport mesh;
+  mesh.name = "Mesh";
+  mesh.ms = summarizeTimings({0.25, 0.75});
+  report.gpuPasses.push_back(mesh);
+
+  GpuPassReport imgui;
+  imgui.name = "ImGui";
+  imgui.hasStatistics = true;
+  imgui.vertexInvocations = 600;
+  imgui.fragmentInvocations = 20000;
+  report.gpuPasses.push_back(imgui);
+
+  nlohmann::json passes = toJson(report)["gpuPasses"];
+  ASSERT_EQ(passes.size(), 2u);
+  EXPECT_EQ(passes[0]["name"], "Mesh");
+  EXPECT_DOUBLE_EQ(passes[0]["ms"]["mean"].get<double>(), 0.5);
+  EXPECT_TRUE(passes[0]["invocations"].is_null());
+  EXPECT_EQ(passes[1]["invocations"]["vertex"], 600);
+  EXPECT_EQ(passes[1]["invocations"]["fragment"], 20000);
+}
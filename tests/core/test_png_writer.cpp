@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/png_writer.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+namespace {
+
+uint32_t readU32(const std::vector<uint8_t> &data, size_t offset) {
+  return (uint32_t{data[offset]} << 24) | (uint32_t{data[offset + 1]} << 16) |
+         (uint32_t{data[offset + 2]} << 8) | uint32_t{data[offset + 3]};
+}
+
+struct Chunk {
+  std::string type;
+  std::vector<uint8_t> data;
+  uint32_t crc;
+};
+
+std::vector<Chunk> readChunks(const std::vector<uint8_t> &png) {
+  std::vector<Chunk> chunks;
+  size_t offset = 8;
+  while (offset + 12 <= png.size()) {
+    uint32_t length = readU32(png, offset);
+    Chunk chunk;
+    chunk.type.assign(png.begin() + offset + 4, png.begin() + offset + 8);
+    chunk.data.assign(png.begin() + offset + 8, png.begin() + offset + 8 + length);
+    chunk.crc = readU32(png, offset + 8 + length);
+    chunks.push_back(chunk);
+    offset += 12 + length;
+  }
+  return chunks;
+}
+
+// Concatenate the payloads of a zlib stream made of stored deflate blocks
+std::vector<uint8_t> unstore(const std::vector<uint8_t> &zlib) {
+  std::vector<uint8_t> raw;
+  size_t offset = 2;
+  bool last = false;
+  while (!last) {
+    last = zlib[offset] & 1;
+    size_t length = zlib[offset + 1] | (zlib[offset + 2] << 8);
+    raw.insert(raw.end(), zlib.begin() + offset + 5, zlib.begin() + offset + 5 + length);
+    offset += 5 + length;
+  }
+  return raw;
+}
+
+} // namespace
+
+TEST(PngWriterTest, WritesSignatureHeaderAndEnd) {
+  std::vector<uint8_t> rgba(3 * 2 * 4, 0x80);
+  std::vector<uint8_t> png = encodePng(3, 2, rgba);
+
+  const std::vector<uint8_t> signature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  ASSERT_GE(png.size(), signature.size());
+  EXPECT_TRUE(std::equal(signature.begin(), signature.end(), png.begin()));
+
+  auto chunks = readChunks(png);
+  ASSERT_EQ(chunks.size(), 3u);
+  EXPECT_EQ(chunks[0].type, "IHDR");
+  EXPECT_EQ(readU32(chunks[0].data, 0), 3u);
+  EXPECT_EQ(readU32(chunks[0].data, 4), 2u);
+  EXPECT_EQ(chunks[0].data[8], 8);  // Bit depth
+  EXPECT_EQ(chunks[0].data[9], 6);  // RGBA
+  EXPECT_EQ(chunks[1].type, "IDAT");
+  EXPECT_EQ(chunks[2].type, "IEND");
+  EXPECT_EQ(chunks[2].crc, 0xAE426082u); // CRC of the empty IEND chunk
+}
+
+TEST(PngWriterTest, ImageDataIsFilteredScanlines) {
+  std::vector<uint8_t> rgba;
+  for (uint8_t i = 0; i < 2 * 2 * 4; ++i) {
+    rgba.push_back(i);
+  }
+  auto chunks = readChunks(encodePng(2, 2, rgba));
+  std::vector<uint8_t> raw = unstore(chunks[1].data);
+
+  std::vector<uint8_t> expected = {0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 8, 9, 10, 11, 12, 13, 14, 15};
+  EXPECT_EQ(raw, expected);
+}
+
+TEST(PngWriterTest, LargeImagesSpanSeveralStoredBlocks) {
+  const uint32_t width = 256, height = 128; // 128K of pixels: three stored blocks
+  std::vector<uint8_t> rgba(width * height * 4);
+  for (size_t i = 0; i < rgba.size(); ++i) {
+    rgba[i] = static_cast<uint8_t>(i * 7);
+  }
+  auto chunks = readChunks(encodePng(width, height, rgba));
+  std::vector<uint8_t> raw = unstore(chunks[1].data);
+
+  ASSERT_EQ(raw.size(), (width * 4 + 1) * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    const uint8_t *row = raw.data() + y * (width * 4 + 1);
+    ASSERT_EQ(row[0], 0);
+    ASSERT_TRUE(std::equal(row + 1, row + 1 + width * 4, rgba.begin() + y * width * 4));
+  }
+}
+
+TEST(PngWriterTest, RejectsMismatchedPixelCount) {
+  std::vector<uint8_t> rgba(10);
+  EXPECT_THROW(encodePng(2, 2, rgba), std::runtime_error);
+  EXPECT_THROW(encodePng(0, 0, {}), std::runtime_error);
+}
@@ -30,6 +30,8 @@ TEST_F(SettingsTest, DefaultValuesAreReasonable) {
   EXPECT_EQ(s.windowHeight, 720);
   EXPECT_TRUE(s.showMesh);
   EXPECT_TRUE(s.showSkeleton);
+  EXPECT_EQ(s.recordThreads, 0);
+  EXPECT_EQ(s.vertexFormat, "quantized");
   EXPECT_TRUE(s.texturePath.empty());
   EXPECT_TRUE(s.lastBrowsedDirectory.empty());
 }
@@ -42,6 +44,8 @@ TEST_F(SettingsTest, SaveAndLoadRoundTrip) {
   original.windowHeight = 1080;
   original.showMesh = false;
   original.showSkeleton = true;
+  original.recordThreads = 4;
+  original.vertexFormat = "compact";
 
   ASSERT_TRUE(original.save(tempSettingsPath));
   ASSERT_TRUE(std::filesystem::exists(tempSettingsPath));
@@ -54,6 +58,8 @@ TEST_F(SettingsTest, SaveAndLoadRoundTrip) {
   EXPECT_EQ(restored.windowHeight, original.windowHeight);
   EXPECT_EQ(restored.showMesh, original.showMesh);
   EXPECT_EQ(restored.showSkeleton, original.showSkeleton);
+  EXPECT_EQ(restored.recordThreads, original.recordThreads);
+  EXPECT_EQ(restored.vertexFormat, original.vertexFormat);
 }
 
 TEST_F(SettingsTest, LoadNonexistentFileReturnsDefaults) {
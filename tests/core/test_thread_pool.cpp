@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "core/thread_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+TEST(ThreadPoolTest, RunsEveryIndexOnce) {
+  ThreadPool pool(3);
+  std::vector<std::atomic<int>> runs(100);
+
+  pool.parallelFor(static_cast<uint32_t>(runs.size()), [&](uint32_t i) { runs[i]++; });
+
+  for (const auto &count : runs) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+TEST(ThreadPoolTest, WithoutWorkersRunsInline) {
+  ThreadPool pool;
+  std::vector<uint32_t> order;
+
+  pool.parallelFor(4, [&](uint32_t i) { order.push_back(i); });
+
+  EXPECT_EQ(pool.workerCount(), 0u);
+  EXPECT_EQ(order, (std::vector<uint32_t>{0, 1, 2, 3}));
+}
+
+TEST(ThreadPoolTest, ReusedAcrossJobs) {
+  ThreadPool pool(2);
+  std::atomic<uint32_t> total{0};
+
+  for (uint32_t job = 0; job < 200; ++job) {
+    pool.parallelFor(job % 7, [&](uint32_t i) { total += i + 1; });
+  }
+
+  // Sum over jobs of 1 + 2 + ... + (job % 7)
+  uint32_t expected = 0;
+  for (uint32_t job = 0; job < 200; ++job) {
+    uint32_t n = job % 7;
+    expected += n * (n + 1) / 2;
+  }
+  EXPECT_EQ(total.load(), expected);
+}
+
+TEST(ThreadPoolTest, ResizeKeepsWorking) {
+  ThreadPool pool(1);
+  pool.resize(4);
+  EXPECT_EQ(pool.workerCount(), 4u);
+
+  std::atomic<uint32_t> count{0};
+  pool.parallelFor(64, [&](uint32_t) { count++; });
+  EXPECT_EQ(count.load(), 64u);
+
+  pool.resize(0);
+  pool.parallelFor(3, [&](uint32_t) { count++; });
+  EXPECT_EQ(count.load(), 67u);
+}
+
+TEST(ThreadPoolTest, RethrowsTaskExceptionAfterAllTasks) {
+  ThreadPool pool(2);
+  std::atomic<uint32_t> count{0};
+
+  EXPECT_THROW(pool.parallelFor(16,
+                                [&](uint32_t i) {
+                                  count++;
+                                  if (i == 5) {
+                                    throw std::runtime_error("task failed");
+                                  }
+                                }),
+               std::runtime_error);
+  EXPECT_EQ(count.load(), 16u);
+
+  // The pool is usable after a failed job
+  pool.parallelFor(4, [&](uint32_t) { count++; });
+  EXPECT_EQ(count.load(), 20u);
+}
+
+TEST(ThreadPoolTest, ConcurrentCallersEachRunTheirWholeJob) {
+  ThreadPool pool(3);
+  constexpr uint32_t CALLERS = 4;
+  constexpr uint32_t JOBS = 50;
+  constexpr uint32_t COUNT = 97;
+
+  // Each caller's tasks only touch its own counters; a job overwritten by another caller
+  // would leave indices unrun or run the wrong task
+  std::vector<std::vector<std::atomic<uint32_t>>> runs(CALLERS);
+  for (auto &callerRuns : runs) {
+    callerRuns = std::vector<std::atomic<uint32_t>>(COUNT);
+  }
+
+  std::vector<std::thread> callers;
+  for (uint32_t c = 0; c < CALLERS; ++c) {
+    callers.emplace_back([&, c] {
+      for (uint32_t job = 0; job < JOBS; ++job) {
+        pool.parallelFor(COUNT, [&](uint32_t i) { runs[c][i]++; });
+      }
+    });
+  }
+  for (auto &caller : callers) {
+    caller.join();
+  }
+
+  for (const auto &callerRuns : runs) {
+    for (const auto &count : callerRuns) {
+      EXPECT_EQ(count.load(), JOBS);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, WorkersStartedAfterEarlierJobsOnlyJoinNewOnes) {
+  ThreadPool pool(2);
+  constexpr uint32_t COUNT = 16;
+
+  // Like Renderer::setRecordThreads() before recording: a resize right before each job. A new
+  // worker taking the last finished job for a new one checks out of a job it never joined,
+  // and the caller can return while another worker is still running a task.
+  std::atomic<uint32_t> running{0};
+  for (uint32_t round = 0; round < 100; ++round) {
+    pool.resize(1 + round % 4);
+    std::vector<std::atomic<uint32_t>> runs(COUNT);
+    pool.parallelFor(COUNT, [&](uint32_t i) {
+      running++;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      runs[i]++;
+      running--;
+    });
+    ASSERT_EQ(running.load(), 0u) << "round " << round;
+    for (const auto &count : runs) {
+      ASSERT_EQ(count.load(), 1u) << "round " << round;
+    }
+  }
+}
@@ -0,0 +1,170 @@
+#include "lib/gfx/block_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d::gfx;
+
+TEST(BlockAllocatorTest, EmptyBlockIsOneFreeRegion) {
+  BlockAllocator block(1024);
+
+  EXPECT_TRUE(block.empty());
+  EXPECT_EQ(block.bytesUsed(), 0u);
+  EXPECT_EQ(block.largestFreeRegion(), 1024u);
+  EXPECT_EQ(block.freeRegionCount(), 1u);
+  EXPECT_FLOAT_EQ(block.fragmentation(), 0.0f);
+}
+
+TEST(BlockAllocatorTest, AllocatesSequentially) {
+  BlockAllocator block(1024);
+
+  auto a = block.allocate(100, 1, AllocationKind::Linear);
+  auto b = block.allocate(200, 1, AllocationKind::Linear);
+
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+  EXPECT_EQ(*a, 0u);
+  EXPECT_EQ(*b, 100u);
+  EXPECT_EQ(block.bytesUsed(), 300u);
+  EXPECT_EQ(block.allocationCount(), 2u);
+}
+
+TEST(BlockAllocatorTest, HonorsAlignment) {
+  BlockAllocator block(1024);
+
+  block.allocate(10, 1, AllocationKind::Linear);
+  auto aligned = block.allocate(64, 256, AllocationKind::Linear);
+
+  ASSERT_TRUE(aligned.has_value());
+  EXPECT_EQ(*aligned % 256, 0u);
+  EXPECT_EQ(*aligned, 256u);
+}
+
+TEST(BlockAllocatorTest, FailsWhenFull) {
+  BlockAllocator block(256);
+
+  EXPECT_TRUE(block.allocate(256, 1, AllocationKind::Linear).has_value());
+  EXPECT_FALSE(block.allocate(1, 1, AllocationKind::Linear).has_value());
+}
+
+TEST(BlockAllocatorTest, RejectsZeroSize) {
+  BlockAllocator block(256);
+
+  EXPECT_FALSE(block.allocate(0, 1, AllocationKind::Linear).has_value());
+  EXPECT_TRUE(block.empty());
+}
+
+TEST(BlockAllocatorTest, FreeMergesNeighbours) {
+  BlockAllocator block(300);
+
+  auto a = block.allocate(100, 1, AllocationKind::Linear);
+  auto b = block.allocate(100, 1, AllocationKind::Linear);
+  auto c = block.allocate(100, 1, AllocationKind::Linear);
+
+  block.free(*a);
+  block.free(*c);
+  EXPECT_EQ(block.freeRegionCount(), 2u);
+  EXPECT_GT(block.fragmentation(), 0.0f);
+
+  block.free(*b);
+  EXPECT_TRUE(block.empty());
+  EXPECT_EQ(block.freeRegionCount(), 1u);
+  EXPECT_EQ(block.largestFreeRegion(), 300u);
+  EXPECT_FLOAT_EQ(block.fragmentation(), 0.0f);
+}
+
+TEST(BlockAllocatorTest, FreeUnknownOffsetIsIgnored) {
+  BlockAllocator block(256);
+  block.allocate(64, 1, AllocationKind::Linear);
+
+  block.free(32);
+  block.free(128);
+
+  EXPECT_EQ(block.allocationCount(), 1u);
+  EXPECT_EQ(block.bytesUsed(), 64u);
+}
+
+TEST(BlockAllocatorTest, BestFitPrefersSmallestHole) {
+  BlockAllocator block(1000);
+
+  auto a = block.allocate(300, 1, AllocationKind::Linear);
+  block.allocate(10, 1, AllocationKind::Linear);
+  auto c = block.allocate(100, 1, AllocationKind::Linear);
+  block.allocate(10, 1, AllocationKind::Linear);
+
+  block.free(*a); // 300-byte hole at 0
+  block.free(*c); // 100-byte hole at 310
+
+  auto fit = block.allocate(80, 1, AllocationKind::Linear);
+  ASSERT_TRUE(fit.has_value());
+  EXPECT_EQ(*fit, 310u);
+}
+
+TEST(BlockAllocatorTest, ReusesFreedSpace) {
+  BlockAllocator block(256);
+
+  auto a = block.allocate(128, 1, AllocationKind::Linear);
+  block.allocate(128, 1, AllocationKind::Linear);
+  block.free(*a);
+
+  auto b = block.allocate(128, 1, AllocationKind::Linear);
+  ASSERT_TRUE(b.has_value());
+  EXPECT_EQ(*b, 0u);
+}
+
+TEST(BlockAllocatorTest, GranularitySeparatesLinearAndOptimal) {
+  BlockAllocator block(4096, 1024);
+
+  auto buffer = block.allocate(100, 4, AllocationKind::Linear);
+  auto image = block.allocate(100, 4, AllocationKind::Optimal);
+
+  ASSERT_TRUE(buffer.has_value());
+  ASSERT_TRUE(image.has_value());
+  EXPECT_EQ(*buffer, 0u);
+  EXPECT_EQ(*image, 1024u); // Pushed onto the next page
+}
+
+TEST(BlockAllocatorTest, GranularityAllowsSameKindOnSamePage) {
+  BlockAllocator block(4096, 1024);
+
+  block.allocate(100, 4, AllocationKind::Optimal);
+  auto second = block.allocate(100, 4, AllocationKind::Optimal);
+
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(*second, 100u);
+}
+
+TEST(BlockAllocatorTest, GranularityChecksFollowingNeighbour) {
+  BlockAllocator block(1600, 1024);
+
+  auto first = block.allocate(1500, 4, AllocationKind::Optimal);
+  auto image = block.allocate(100, 4, AllocationKind::Optimal);
+  ASSERT_TRUE(image.has_value());
+  EXPECT_EQ(*image, 1500u);
+  block.free(*first);
+
+  // The hole before the image spans page 0 and part of page 1. Buffers fit on page 0 only.
+  auto buffer = block.allocate(1000, 4, AllocationKind::Linear);
+  ASSERT_TRUE(buffer.has_value());
+  EXPECT_EQ(*buffer, 0u);
+  EXPECT_FALSE(block.allocate(100, 4, AllocationKind::Linear).has_value());
+
+  // Images may still use the part of the hole that shares a page with the image
+  auto other = block.allocate(100, 4, AllocationKind::Optimal);
+  ASSERT_TRUE(other.has_value());
+  EXPECT_GE(*other, 1024u);
+}
+
+TEST(BlockAllocatorTest, FragmentationReflectsSplitFreeSpace) {
+  BlockAllocator block(400);
+
+  auto a = block.allocate(100, 1, AllocationKind::Linear);
+  block.allocate(100, 1, AllocationKind::Linear);
+  auto c = block.allocate(100, 1, AllocationKind::Linear);
+  block.allocate(100, 1, AllocationKind::Linear);
+
+  block.free(*a);
+  block.free(*c);
+
+  // Two equal 100-byte holes: largest is half the free space
+  EXPECT_FLOAT_EQ(block.fragmentation(), 0.5f);
+}
@@ -0,0 +1,57 @@
+#include "lib/gfx/gpu_timing.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace w3d::gfx;
+
+TEST(GpuTimingTest, DeltaConvertsTicksWithPeriod) {
+  // 1.5 million ticks of 2 ns
+  EXPECT_DOUBLE_EQ(timestampDeltaMs(1000, 1'501'000, 64, 2.0f), 3.0);
+  EXPECT_DOUBLE_EQ(timestampDeltaMs(42, 42, 64, 1.0f), 0.0);
+}
+
+TEST(GpuTimingTest, DeltaHandlesCounterWrap) {
+  // 36-bit counter wrapping between the two timestamps
+  uint64_t top = (uint64_t{1} << 36) - 100;
+  EXPECT_DOUBLE_EQ(timestampDeltaMs(top, 900, 36, 1.0f), 1000 * 1e-6);
+
+  // Bits above the valid range are ignored
+  uint64_t garbage = uint64_t{0xABCD} << 48;
+  EXPECT_DOUBLE_EQ(timestampDeltaMs(garbage | 10, 20, 36, 1.0f), 10 * 1e-6);
+
+  // Full 64-bit counters wrap too
+  EXPECT_DOUBLE_EQ(timestampDeltaMs(~uint64_t{0}, 1, 64, 1.0f), 2 * 1e-6);
+}
+
+TEST(GpuTimingTest, RollingTimingFillsThenOverwritesOldest) {
+  RollingTiming timing(3);
+  EXPECT_TRUE(timing.empty());
+  EXPECT_FLOAT_EQ(timing.mean(), 0.0f);
+
+  timing.push(1.0f);
+  timing.push(2.0f);
+  EXPECT_EQ(timing.size(), 2u);
+  EXPECT_EQ(timing.offset(), 0u);
+  EXPECT_FLOAT_EQ(timing.latest(), 2.0f);
+  EXPECT_FLOAT_EQ(timing.mean(), 1.5f);
+
+  timing.push(3.0f);
+  timing.push(6.0f); // Replaces 1.0
+  EXPECT_EQ(timing.size(), 3u);
+  EXPECT_FLOAT_EQ(timing.latest(), 6.0f);
+  EXPECT_FLOAT_EQ(timing.mean(), 11.0f / 3.0f);
+  EXPECT_FLOAT_EQ(timing.max(), 6.0f);
+
+  // Oldest first from offset(): 2, 3, 6
+  std::vector<float> ordered;
+  for (size_t i = 0; i < timing.size(); ++i) {
+    ordered.push_back(timing.data()[(timing.offset() + i) % timing.size()]);
+  }
+  EXPECT_EQ(ordered, (std::vector<float>{2.0f, 3.0f, 6.0f}));
+
+  timing.clear();
+  EXPECT_TRUE(timing.empty());
+  EXPECT_FLOAT_EQ(timing.latest(), 0.0f);
+}
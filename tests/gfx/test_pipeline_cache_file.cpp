@@ -0,0 +1,139 @@
+#include "lib/gfx/pipeline_cache_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+using namespace w3d::gfx;
+
+namespace {
+
+PipelineCacheIdentity makeIdentity() {
+  PipelineCacheIdentity identity;
+  identity.vendorID = 0x10DE;
+  identity.deviceID = 0x2204;
+  identity.driverVersion = 0x0200A000;
+  for (size_t i = 0; i < identity.pipelineCacheUUID.size(); ++i) {
+    identity.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7 + 1);
+  }
+  return identity;
+}
+
+void putU32(std::vector<uint8_t> &out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+// Blob as vkGetPipelineCacheData returns it: VkPipelineCacheHeaderVersionOne, then driver data
+std::vector<uint8_t> makeBlob(const PipelineCacheIdentity &identity, size_t payload = 64) {
+  std::vector<uint8_t> blob;
+  putU32(blob, 32);
+  putU32(blob, 1);
+  putU32(blob, identity.vendorID);
+  putU32(blob, identity.deviceID);
+  blob.insert(blob.end(), identity.pipelineCacheUUID.begin(), identity.pipelineCacheUUID.end());
+  for (size_t i = 0; i < payload; ++i) {
+    blob.push_back(static_cast<uint8_t>(i));
+  }
+  return blob;
+}
+
+} // namespace
+
+TEST(PipelineCacheFileTest, RoundTrip) {
+  auto identity = makeIdentity();
+  auto blob = makeBlob(identity);
+
+  auto file = packPipelineCache(blob, identity);
+  auto unpacked = unpackPipelineCache(file, identity);
+
+  ASSERT_TRUE(unpacked.has_value());
+  EXPECT_EQ(*unpacked, blob);
+}
+
+TEST(PipelineCacheFileTest, RejectsOtherDevice) {
+  auto identity = makeIdentity();
+  auto file = packPipelineCache(makeBlob(identity), identity);
+
+  auto otherVendor = identity;
+  otherVendor.vendorID = 0x1002;
+  EXPECT_FALSE(unpackPipelineCache(file, otherVendor).has_value());
+
+  auto otherDevice = identity;
+  otherDevice.deviceID += 1;
+  EXPECT_FALSE(unpackPipelineCache(file, otherDevice).has_value());
+
+  auto otherUuid = identity;
+  otherUuid.pipelineCacheUUID[15] ^= 0xFF;
+  EXPECT_FALSE(unpackPipelineCache(file, otherUuid).has_value());
+}
+
+TEST(PipelineCacheFileTest, RejectsOtherDriverVersion) {
+  auto identity = makeIdentity();
+  auto file = packPipelineCache(makeBlob(identity), identity);
+
+  auto updated = identity;
+  updated.driverVersion += 1;
+  EXPECT_FALSE(unpackPipelineCache(file, updated).has_value());
+}
+
+TEST(PipelineCacheFileTest, RejectsCorruptOrTruncatedFiles) {
+  auto identity = makeIdentity();
+  auto file = packPipelineCache(makeBlob(identity), identity);
+
+  auto flipped = file;
+  flipped.back() ^= 0x01;
+  EXPECT_FALSE(unpackPipelineCache(flipped, identity).has_value());
+
+  auto truncated = file;
+  truncated.pop_back();
+  EXPECT_FALSE(unpackPipelineCache(truncated, identity).has_value());
+
+  auto badMagic = file;
+  badMagic[0] = 'X';
+  EXPECT_FALSE(unpackPipelineCache(badMagic, identity).has_value());
+
+  EXPECT_FALSE(unpackPipelineCache({}, identity).has_value());
+}
+
+TEST(PipelineCacheFileTest, RejectsMismatchedVulkanHeader) {
+  auto identity = makeIdentity();
+
+  // Wrapper written for this device, but the driver blob claims another one
+  auto other = identity;
+  other.deviceID += 1;
+  auto file = packPipelineCache(makeBlob(other), identity);
+  EXPECT_FALSE(unpackPipelineCache(file, identity).has_value());
+
+  // Blob too short to hold the Vulkan header
+  std::vector<uint8_t> shortBlob(8, 0);
+  EXPECT_FALSE(unpackPipelineCache(packPipelineCache(shortBlob, identity), identity).has_value());
+}
+
+TEST(PipelineCacheFileTest, AtomicWriteReplacesFile) {
+  auto dir = std::filesystem::temp_directory_path() / "w3d_pipeline_cache_test";
+  std::filesystem::remove_all(dir);
+  auto path = dir / "nested" / "pipeline_cache.bin";
+
+  std::vector<uint8_t> first = {1, 2, 3};
+  std::vector<uint8_t> second = {4, 5, 6, 7};
+  ASSERT_TRUE(writeFileAtomically(path, first));
+  ASSERT_TRUE(writeFileAtomically(path, second));
+
+  auto data = readBinaryFile(path);
+  ASSERT_TRUE(data.has_value());
+  EXPECT_EQ(*data, second);
+
+  auto temp = path;
+  temp += ".tmp";
+  EXPECT_FALSE(std::filesystem::exists(temp));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST(PipelineCacheFileTest, MissingFileReadsAsNothing) {
+  auto path = std::filesystem::temp_directory_path() / "w3d_pipeline_cache_missing.bin";
+  std::filesystem::remove(path);
+  EXPECT_FALSE(readBinaryFile(path).has_value());
+}
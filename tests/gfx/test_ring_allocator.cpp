@@ -0,0 +1,71 @@
+#include "lib/gfx/ring_allocator.hpp"
+#include "render/frame_prefix.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+using namespace w3d;
+using namespace w3d::gfx;
+
+TEST(RingAllocatorTest, AllocatesAlignedAndInOrder) {
+  RingAllocator ring(1024, 64);
+  EXPECT_EQ(ring.allocate(10), 0u);
+  EXPECT_EQ(ring.allocate(64), 64u);
+  EXPECT_EQ(ring.allocate(1), 128u);
+  EXPECT_EQ(ring.bytesUsed(), 129u);
+}
+
+TEST(RingAllocatorTest, ThrowsWhenThePartitionIsExhausted) {
+  RingAllocator ring(256, 64);
+  ring.allocate(200);
+  EXPECT_THROW(ring.allocate(64), std::runtime_error);
+  EXPECT_EQ(ring.allocate(0), 256u); // Still fits exactly at the end
+}
+
+TEST(RingAllocatorTest, ResetStartsOverAndKeepsThePeak) {
+  RingAllocator ring(1024, 16);
+  ring.allocate(300);
+  ring.reset();
+  EXPECT_EQ(ring.bytesUsed(), 0u);
+  EXPECT_EQ(ring.allocate(8), 0u);
+  EXPECT_EQ(ring.peakBytesUsed(), 300u);
+}
+
+TEST(RingAllocatorTest, ZeroAlignmentIsTreatedAsOne) {
+  RingAllocator ring(64, 0);
+  EXPECT_EQ(ring.alignment(), 1u);
+  ring.allocate(3);
+  EXPECT_EQ(ring.allocate(5), 3u);
+}
+
+TEST(FramePrefixTest, SlotsDoNotOverlap) {
+  RingAllocator ring(1 << 20, 256);
+  auto prefix = allocateFramePrefix(ring, {336, 128 * 64, 1024 * 64});
+  EXPECT_EQ(prefix.ubo, 0u);
+  EXPECT_GE(prefix.pickUbo, prefix.ubo + 336);
+  EXPECT_GE(prefix.palette, prefix.pickUbo + 336);
+  EXPECT_GE(prefix.instances, prefix.palette + 128 * 64);
+  EXPECT_EQ(prefix.pickUbo % 256, 0u);
+}
+
+TEST(FramePrefixTest, CulledCommandsKeepTheirOffsetOnPickingFrames) {
+  // Draws recorded on a frame without a pick are replayed on later frames, reading the culled
+  // commands where that frame put them: a pick must not move them
+  const FramePrefixSizes sizes{336, 128 * 64, 1024 * 64};
+  const uint64_t commandBytes = 20 * 500; // The CPU path's compacted commands
+
+  RingAllocator ring(4 * 1024 * 1024, 64);
+  uint64_t commandOffset[2] = {};
+  uint64_t pickOffset[2] = {};
+  for (int picking = 0; picking < 2; ++picking) {
+    ring.reset();
+    auto prefix = allocateFramePrefix(ring, sizes);
+    pickOffset[picking] = prefix.pickUbo;
+    commandOffset[picking] = ring.allocate(commandBytes);
+    EXPECT_GE(commandOffset[picking], prefix.instances + sizes.instances);
+  }
+  EXPECT_EQ(commandOffset[0], commandOffset[1]);
+  EXPECT_EQ(pickOffset[0], pickOffset[1]);
+}
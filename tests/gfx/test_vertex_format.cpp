@@ -0,0 +1,98 @@
+#include "lib/gfx/vertex_format.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace w3d::gfx;
+
+TEST(VertexFormatTest, NamesRoundTrip) {
+  for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; ++i) {
+    auto format = static_cast<VertexFormat>(i);
+    EXPECT_EQ(parseVertexFormat(vertexFormatName(format)), format);
+  }
+  EXPECT_FALSE(parseVertexFormat("packed").has_value());
+}
+
+TEST(VertexFormatTest, CompactFormatsHalveVertexSize) {
+  EXPECT_LT(2 * vertexStride(VertexFormat::Quantized, false),
+            vertexStride(VertexFormat::Full, false));
+  EXPECT_LT(2 * vertexStride(VertexFormat::Quantized, true),
+            vertexStride(VertexFormat::Full, true));
+  EXPECT_LT(vertexStride(VertexFormat::Compact, true), vertexStride(VertexFormat::Full, true));
+}
+
+TEST(VertexFormatTest, OctNormalsStayWithinErrorBound) {
+  // Normals spread over the sphere, including the axes and the folded lower hemisphere
+  float maxError = 0.0f;
+  for (int i = 0; i <= 64; ++i) {
+    float theta = glm::pi<float>() * static_cast<float>(i) / 64.0f;
+    for (int j = 0; j < 128; ++j) {
+      float phi = glm::two_pi<float>() * static_cast<float>(j) / 128.0f;
+      glm::vec3 n{std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi),
+                  std::cos(theta)};
+      glm::vec3 decoded = unpackOctNormal(packOctNormal(n));
+      maxError = std::max(maxError, glm::length(decoded - n));
+    }
+  }
+  EXPECT_LT(maxError, 1e-4f); // Chord length, so under 0.006 degrees
+
+  EXPECT_NEAR(unpackOctNormal(packOctNormal({0.0f, 0.0f, -1.0f})).z, -1.0f, 1e-6f);
+  EXPECT_EQ(unpackOctNormal(packOctNormal(glm::vec3(0.0f))), glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+TEST(VertexFormatTest, HalfFloatsRoundToNearest) {
+  EXPECT_EQ(packHalf(0.0f), 0x0000);
+  EXPECT_EQ(packHalf(-0.0f), 0x8000);
+  EXPECT_EQ(packHalf(1.0f), 0x3C00);
+  EXPECT_EQ(packHalf(-2.0f), 0xC000);
+  EXPECT_EQ(packHalf(65504.0f), 0x7BFF);
+  EXPECT_EQ(packHalf(1e6f), 0x7C00);
+  EXPECT_EQ(packHalf(std::ldexp(1.0f, -24)), 0x0001); // Smallest subnormal
+  EXPECT_EQ(packHalf(1.0f + std::ldexp(1.0f, -11)), 0x3C00); // Tie rounds to even
+  EXPECT_TRUE(std::isnan(unpackHalf(packHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+  // UVs in [-8, 8] keep 11 significant bits
+  for (float uv = -8.0f; uv <= 8.0f; uv += 0.01f) {
+    float decoded = unpackHalf(packHalf(uv));
+    EXPECT_LE(std::abs(decoded - uv), std::abs(uv) * std::ldexp(1.0f, -11) + 1e-7f) << uv;
+  }
+  EXPECT_EQ(unpackHalf2(packHalf2({0.25f, 0.75f})), glm::vec2(0.25f, 0.75f));
+}
+
+TEST(VertexFormatTest, QuantizedPositionsStayWithinErrorBound) {
+  BoundingBox bounds;
+  bounds.expand(glm::vec3(-12.5f, 0.0f, 3.0f));
+  bounds.expand(glm::vec3(40.0f, 18.0f, 3.0f)); // Flat in z
+  auto quantization = PositionQuantization::fromBounds(bounds);
+  glm::vec3 bound = quantization.maxError() + glm::vec3(1e-5f);
+
+  for (int i = 0; i <= 100; ++i) {
+    float t = static_cast<float>(i) / 100.0f;
+    glm::vec3 p = glm::mix(bounds.min, bounds.max, glm::vec3(t, 1.0f - t, t * t));
+    glm::vec3 error = glm::abs(quantization.dequantize(quantization.quantize(p)) - p);
+    EXPECT_LE(error.x, bound.x);
+    EXPECT_LE(error.y, bound.y);
+    EXPECT_EQ(error.z, 0.0f);
+  }
+
+  // Outside the box clamps to its faces
+  auto lanes = quantization.quantize(glm::vec3(-100.0f, 100.0f, 3.0f));
+  EXPECT_EQ(lanes[0], 0);
+  EXPECT_EQ(lanes[1], 65535);
+}
+
+TEST(VertexFormatTest, ColorsPackAsRgba8) {
+  uint32_t packed = packColor({1.0f, 0.5f, 0.0f}, 42);
+  EXPECT_EQ(packed, 0x2A0080FFu);
+  glm::vec3 color{0.2f, 0.4f, 0.8f};
+  glm::vec3 decoded = unpackColor(packColor(color, 0));
+  EXPECT_NEAR(decoded.r, color.r, 0.5f / 255.0f);
+  EXPECT_NEAR(decoded.g, color.g, 0.5f / 255.0f);
+  EXPECT_NEAR(decoded.b, color.b, 0.5f / 255.0f);
+  EXPECT_EQ(packColor({2.0f, -1.0f, 0.0f}, 0), 0x000000FFu);
+}
@@ -1,6 +1,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <vector>
 
 #include "render/raycast.hpp"
 
@@ -232,3 +235,55 @@ TEST(RaycastTest, ScreenToWorldRayCorner) {
   EXPECT_GT(ray.direction.y, 0.0f);
   EXPECT_LT(ray.direction.z, 0.0f);
 }
+
+// The batched kernel must reproduce intersectRayTriangle() lane for lane
+TEST(RaycastTest, BatchedTrianglesMatchScalarTest) {
+  std::vector<std::array<glm::vec3, 3>> triangles = {
+      {glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 1.0f)},
+      {glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 3.0f), glm::vec3(1.0f, 0.0f, 3.0f)},
+      {glm::vec3(2.0f, 2.0f, 1.0f), glm::vec3(3.0f, 2.0f, 1.0f), glm::vec3(2.0f, 3.0f, 1.0f)},
+      {glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, -1.0f)},
+      {glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(2.0f, 0.0f, 0.0f)},
+      {glm::vec3(0.5f, 0.0f, 1.0f), glm::vec3(0.0f, 0.5f, 1.0f), glm::vec3(0.0f, 0.0f, 4.0f)},
+      {glm::vec3(0.1f, 0.3f, 2.0f), glm::vec3(0.7f, -0.2f, 2.5f), glm::vec3(-0.3f, 0.9f, 1.5f)},
+  };
+  std::vector<Ray> rays = {
+      {glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)},
+      {glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)},
+      {glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f)},
+      {glm::vec3(-1.0f, -2.0f, -3.0f), glm::normalize(glm::vec3(0.3f, 0.6f, 1.0f))},
+      {glm::vec3(0.2f, 0.2f, 5.0f), glm::vec3(0.0f, 0.0f, -1.0f)},
+  };
+
+  for (size_t r = 0; r < rays.size(); ++r) {
+    // Every triangle in every lane, with the unused lanes of the last packet left zeroed
+    for (size_t first = 0; first < triangles.size(); ++first) {
+      TrianglePacket4 packet;
+      size_t lanes = std::min<size_t>(4, triangles.size() - first);
+      for (size_t lane = 0; lane < lanes; ++lane) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+          packet.x[corner][lane] = triangles[first + lane][corner].x;
+          packet.y[corner][lane] = triangles[first + lane][corner].y;
+          packet.z[corner][lane] = triangles[first + lane][corner].z;
+        }
+      }
+
+      TriangleHits4 hits = intersectRayTriangles4(rays[r], packet);
+      for (size_t lane = 0; lane < 4; ++lane) {
+        SCOPED_TRACE(testing::Message() << "ray " << r << ", triangle " << first + lane);
+        if (lane >= lanes) {
+          EXPECT_EQ(hits.mask & (1u << lane), 0u);
+          continue;
+        }
+        const auto &tri = triangles[first + lane];
+        TriangleHit expected = intersectRayTriangle(rays[r], tri[0], tri[1], tri[2]);
+        ASSERT_EQ((hits.mask & (1u << lane)) != 0, expected.hit);
+        if (expected.hit) {
+          EXPECT_EQ(hits.distance[lane], expected.distance);
+          EXPECT_EQ(hits.u[lane], expected.u);
+          EXPECT_EQ(hits.v[lane], expected.v);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,168 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+
+#include "render/draw_culling.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+class DrawCullingTest : public ::testing::Test {
+protected:
+  // Camera at the origin looking down -Z, same conventions as the renderer
+  Frustum makeFrustum() const {
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                                 glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    proj[1][1] *= -1;
+    return Frustum::fromMatrix(proj * view);
+  }
+
+  // Append a draw with a fresh index range to batch, creating batches as needed
+  void addDraw(DrawList &list, uint32_t batch, const glm::vec4 &sphere,
+               uint32_t bone = CullInput::NO_BONE) {
+    while (list.batches.size() <= batch) {
+      list.batches.push_back({&material_, glm::vec3(1.0f),
+                              static_cast<uint32_t>(list.draws.size()), 0});
+    }
+    CullInput input{};
+    input.sphere = sphere;
+    input.command = {3, 1, static_cast<uint32_t>(list.draws.size()) * 3, 0, 0};
+    input.boneIndex = bone;
+    input.batchIndex = batch;
+    input.outputBase = list.batches[batch].firstCommand;
+    ++list.batches[batch].commandCount;
+    list.draws.push_back(input);
+  }
+
+  GPUMaterial material_{};
+};
+
+// =============================================================================
+// Frustum Tests
+// =============================================================================
+
+TEST_F(DrawCullingTest, SphereInFrontIsInside) {
+  Frustum frustum = makeFrustum();
+  EXPECT_TRUE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f));
+}
+
+TEST_F(DrawCullingTest, SphereBehindCameraIsOutside) {
+  Frustum frustum = makeFrustum();
+  EXPECT_FALSE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f));
+}
+
+TEST_F(DrawCullingTest, SphereBeyondFarPlaneIsOutside) {
+  Frustum frustum = makeFrustum();
+  EXPECT_FALSE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -200.0f), 1.0f));
+}
+
+TEST_F(DrawCullingTest, SphereOffToTheSideIsOutside) {
+  Frustum frustum = makeFrustum();
+  EXPECT_FALSE(frustum.intersectsSphere(glm::vec3(50.0f, 0.0f, -10.0f), 1.0f));
+  EXPECT_FALSE(frustum.intersectsSphere(glm::vec3(0.0f, -50.0f, -10.0f), 1.0f));
+}
+
+TEST_F(DrawCullingTest, SphereStraddlingPlaneIsInside) {
+  Frustum frustum = makeFrustum();
+  // Center just outside the right plane, radius reaches back in
+  EXPECT_TRUE(frustum.intersectsSphere(glm::vec3(5.0f, 0.0f, -10.0f), 2.0f));
+}
+
+TEST_F(DrawCullingTest, PlanesAreNormalized) {
+  Frustum frustum = makeFrustum();
+  for (const auto &plane : frustum.planes) {
+    EXPECT_NEAR(glm::length(glm::vec3(plane)), 1.0f, 1e-5f);
+  }
+}
+
+// =============================================================================
+// Sphere Transform Tests
+// =============================================================================
+
+TEST_F(DrawCullingTest, TransformSphereWithoutBoneIsUnchanged) {
+  glm::vec4 sphere(1.0f, 2.0f, 3.0f, 4.0f);
+  glm::mat4 bone = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f));
+
+  EXPECT_EQ(transformSphere(sphere, CullInput::NO_BONE, &bone, 1), sphere);
+  EXPECT_EQ(transformSphere(sphere, 5, &bone, 1), sphere); // Out of range
+}
+
+TEST_F(DrawCullingTest, TransformSphereAppliesBoneAndScale) {
+  glm::mat4 bone = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f));
+  bone = glm::scale(bone, glm::vec3(1.0f, 3.0f, 1.0f));
+
+  glm::vec4 result = transformSphere(glm::vec4(0.0f, 1.0f, 0.0f, 2.0f), 0, &bone, 1);
+  EXPECT_FLOAT_EQ(result.x, 10.0f);
+  EXPECT_FLOAT_EQ(result.y, 3.0f);
+  EXPECT_FLOAT_EQ(result.z, 0.0f);
+  EXPECT_FLOAT_EQ(result.w, 6.0f); // Largest axis scale
+}
+
+// =============================================================================
+// Draw Compaction Tests
+// =============================================================================
+
+TEST_F(DrawCullingTest, CompactsSurvivorsIntoBatchRanges) {
+  DrawList list;
+  addDraw(list, 0, glm::vec4(0.0f, 0.0f, -10.0f, 1.0f)); // Visible
+  addDraw(list, 0, glm::vec4(0.0f, 0.0f, 10.0f, 1.0f));  // Behind
+  addDraw(list, 0, glm::vec4(1.0f, 0.0f, -20.0f, 1.0f)); // Visible
+  addDraw(list, 1, glm::vec4(0.0f, 0.0f, 10.0f, 1.0f));  // Behind
+  addDraw(list, 2, glm::vec4(0.0f, 1.0f, -5.0f, 1.0f));  // Visible
+
+  std::vector<IndirectDrawCommand> out;
+  std::vector<uint32_t> counts;
+  cullDraws(makeFrustum(), list, nullptr, 0, out, counts);
+
+  ASSERT_EQ(out.size(), list.draws.size());
+  ASSERT_EQ(counts.size(), 3u);
+  EXPECT_EQ(counts[0], 2u);
+  EXPECT_EQ(counts[1], 0u);
+  EXPECT_EQ(counts[2], 1u);
+
+  // Survivors keep their order at the start of their batch's range
+  EXPECT_EQ(out[0].firstIndex, list.draws[0].command.firstIndex);
+  EXPECT_EQ(out[1].firstIndex, list.draws[2].command.firstIndex);
+  EXPECT_EQ(out[list.batches[2].firstCommand].firstIndex, list.draws[4].command.firstIndex);
+}
+
+TEST_F(DrawCullingTest, NegativeRadiusIsNeverCulled) {
+  DrawList list;
+  addDraw(list, 0, glm::vec4(0.0f, 0.0f, 1000.0f, -1.0f));
+
+  std::vector<IndirectDrawCommand> out;
+  std::vector<uint32_t> counts;
+  cullDraws(makeFrustum(), list, nullptr, 0, out, counts);
+
+  EXPECT_EQ(counts[0], 1u);
+}
+
+TEST_F(DrawCullingTest, BoneMovesSphereIntoView) {
+  // Mesh-space sphere behind the camera, placed in front of it by its bone
+  std::vector<glm::mat4> bones = {
+      glm::mat4(1.0f), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -30.0f))};
+
+  DrawList list;
+  addDraw(list, 0, glm::vec4(0.0f, 0.0f, 10.0f, 1.0f), 1);
+  addDraw(list, 0, glm::vec4(0.0f, 0.0f, 10.0f, 1.0f), 0);
+
+  std::vector<IndirectDrawCommand> out;
+  std::vector<uint32_t> counts;
+  cullDraws(makeFrustum(), list, bones.data(), bones.size(), out, counts);
+
+  ASSERT_EQ(counts[0], 1u);
+  EXPECT_EQ(out[0].firstIndex, list.draws[0].command.firstIndex);
+}
+
+TEST_F(DrawCullingTest, EmptyListProducesNothing) {
+  DrawList list;
+  std::vector<IndirectDrawCommand> out;
+  std::vector<uint32_t> counts;
+  cullDraws(makeFrustum(), list, nullptr, 0, out, counts);
+
+  EXPECT_TRUE(out.empty());
+  EXPECT_TRUE(counts.empty());
+}
@@ -0,0 +1,144 @@
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "render/draw_packet.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+class DrawPacketTest : public ::testing::Test {
+protected:
+  // A packet with a distinct index range, drawn at the given LODs
+  DrawPacket makePacket(uint32_t meshIndex, uint32_t textureIndex,
+                        uint32_t lodMask = DrawPacket::ALL_LODS) const {
+    DrawPacket packet{};
+    packet.material = packetMaterial(textureIndex);
+    packet.sphere = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    packet.command = {3, 1, meshIndex * 3, 0, 0};
+    packet.boneIndex = CullInput::NO_BONE;
+    packet.lodMask = lodMask;
+    packet.meshIndex = meshIndex;
+    return packet;
+  }
+
+  const glm::vec3 tint_{1.5f, 1.5f, 1.3f};
+};
+
+TEST_F(DrawPacketTest, LodBitClampsHighLevels) {
+  EXPECT_EQ(lodBit(0), 1u);
+  EXPECT_EQ(lodBit(3), 8u);
+  EXPECT_EQ(lodBit(31), 0x80000000u);
+  EXPECT_EQ(lodBit(40), 0x80000000u);
+}
+
+TEST_F(DrawPacketTest, PacketMaterialFlagsTexturedDraws) {
+  EXPECT_EQ(packetMaterial(0).flags & MaterialFlags::HasTexture, 0u);
+  EXPECT_NE(packetMaterial(5).flags & MaterialFlags::HasTexture, 0u);
+  EXPECT_EQ(packetMaterial(5).textureIndex, 5u);
+}
+
+TEST_F(DrawPacketTest, SortGroupsByTextureKeepingMeshOrder) {
+  std::vector<DrawPacket> packets = {makePacket(0, 2), makePacket(1, 1), makePacket(2, 2),
+                                     makePacket(3, 1)};
+  sortDrawPackets(packets);
+
+  ASSERT_EQ(packets.size(), 4u);
+  EXPECT_EQ(packets[0].meshIndex, 1u);
+  EXPECT_EQ(packets[1].meshIndex, 3u);
+  EXPECT_EQ(packets[2].meshIndex, 0u);
+  EXPECT_EQ(packets[3].meshIndex, 2u);
+}
+
+TEST_F(DrawPacketTest, OneBatchPerMaterialRun) {
+  std::vector<DrawPacket> packets = {makePacket(0, 1), makePacket(1, 1), makePacket(2, 2)};
+  DrawList list;
+  buildDrawList(packets, lodBit(0), {}, -1, tint_, list);
+
+  ASSERT_EQ(list.draws.size(), 3u);
+  ASSERT_EQ(list.batches.size(), 2u);
+  EXPECT_EQ(list.batches[0].commandCount, 2u);
+  EXPECT_EQ(list.batches[0].material->textureIndex, 1u);
+  EXPECT_EQ(list.batches[1].firstCommand, 2u);
+  EXPECT_EQ(list.batches[1].material->textureIndex, 2u);
+  EXPECT_EQ(list.draws[2].batchIndex, 1u);
+  EXPECT_EQ(list.draws[2].outputBase, 2u);
+  EXPECT_EQ(list.draws[2].command.firstIndex, 6u);
+}
+
+TEST_F(DrawPacketTest, SkipsOtherLodsButKeepsAggregates) {
+  std::vector<DrawPacket> packets = {makePacket(0, 1, lodBit(0)), makePacket(1, 1, lodBit(1)),
+                                     makePacket(2, 1)};
+  DrawList list;
+  buildDrawList(packets, lodBit(1), {}, -1, tint_, list);
+
+  ASSERT_EQ(list.draws.size(), 2u);
+  EXPECT_EQ(list.draws[0].command.firstIndex, 3u);
+  EXPECT_EQ(list.draws[1].command.firstIndex, 6u);
+}
+
+TEST_F(DrawPacketTest, SkipsHiddenMeshes) {
+  std::vector<DrawPacket> packets = {makePacket(0, 1), makePacket(1, 1), makePacket(2, 1)};
+  std::vector<bool> visibility = {true, false}; // Mesh 2 has no entry: visible
+  DrawList list;
+  buildDrawList(packets, lodBit(0), visibility, -1, tint_, list);
+
+  ASSERT_EQ(list.draws.size(), 2u);
+  EXPECT_EQ(list.draws[0].command.firstIndex, 0u);
+  EXPECT_EQ(list.draws[1].command.firstIndex, 6u);
+}
+
+TEST_F(DrawPacketTest, HoveredMeshGetsTintedBatchAtTheEnd) {
+  std::vector<DrawPacket> packets = {makePacket(0, 1), makePacket(1, 1), makePacket(2, 1)};
+  DrawList list;
+  buildDrawList(packets, lodBit(0), {}, 1, tint_, list);
+
+  ASSERT_EQ(list.batches.size(), 2u);
+  EXPECT_EQ(list.batches[0].commandCount, 2u);
+  EXPECT_EQ(list.batches[0].tint, glm::vec3(1.0f));
+  EXPECT_EQ(list.batches[1].commandCount, 1u);
+  EXPECT_EQ(list.batches[1].tint, tint_);
+  EXPECT_EQ(list.draws[2].command.firstIndex, 3u);
+  EXPECT_EQ(list.draws[2].batchIndex, 1u);
+}
+
+TEST_F(DrawPacketTest, HiddenHoveredMeshIsNotDrawn) {
+  std::vector<DrawPacket> packets = {makePacket(0, 1), makePacket(1, 1)};
+  std::vector<bool> visibility = {true, false};
+  DrawList list;
+  buildDrawList(packets, lodBit(0), visibility, 1, tint_, list);
+
+  ASSERT_EQ(list.batches.size(), 1u);
+  EXPECT_EQ(list.draws.size(), 1u);
+}
+
+TEST_F(DrawPacketTest, InstancedDrawsCoverTheirLevelsBuckets) {
+  std::vector<DrawPacket> packets = {makePacket(0, 1, lodBit(0)), makePacket(1, 1, lodBit(1)),
+                                     makePacket(2, 1, lodBit(2)), makePacket(3, 1)};
+  // Two instances at level 0, none at level 1, three at level 2
+  InstanceBuckets instances;
+  instances.transforms.resize(5, glm::mat4(1.0f));
+  instances.offsets = {0, 2, 2, 5};
+
+  DrawList list;
+  buildDrawList(packets, lodBit(0) | lodBit(2), {}, -1, tint_, list, &instances);
+
+  ASSERT_EQ(list.draws.size(), 3u);
+  ASSERT_EQ(list.batches.size(), 1u);
+  EXPECT_EQ(list.batches[0].commandCount, 3u);
+
+  // Level 0 and level 2 meshes over their ranges, the aggregate over every instance
+  EXPECT_EQ(list.draws[0].command.firstIndex, 0u);
+  EXPECT_EQ(list.draws[0].command.firstInstance, InstanceBuckets::FIRST_SLOT);
+  EXPECT_EQ(list.draws[0].command.instanceCount, 2u);
+  EXPECT_EQ(list.draws[1].command.firstIndex, 6u);
+  EXPECT_EQ(list.draws[1].command.firstInstance, InstanceBuckets::FIRST_SLOT + 2);
+  EXPECT_EQ(list.draws[1].command.instanceCount, 3u);
+  EXPECT_EQ(list.draws[2].command.firstIndex, 9u);
+  EXPECT_EQ(list.draws[2].command.firstInstance, InstanceBuckets::FIRST_SLOT);
+  EXPECT_EQ(list.draws[2].command.instanceCount, 5u);
+  for (const CullInput &draw : list.draws) {
+    EXPECT_LT(draw.sphere.w, 0.0f);
+  }
+}
@@ -0,0 +1,146 @@
+#include "render/instance_set.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace w3d;
+
+namespace {
+
+// Planes every sphere is inside of
+Frustum openFrustum() {
+  Frustum frustum;
+  frustum.planes.fill(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  return frustum;
+}
+
+glm::mat4 placed(const glm::vec3 &position, float scale = 1.0f) {
+  glm::mat4 transform(scale);
+  transform[3] = glm::vec4(position, 1.0f);
+  return transform;
+}
+
+// Screen size as HLodModel::updateLOD() measures it
+float screenSize(float radius, float distance, float screenHeight, float fovY) {
+  return 2.0f * std::atan(radius / distance) / fovY * screenHeight;
+}
+
+} // namespace
+
+// Counts around the four-instance block size cover the scalar tail
+TEST(InstanceSetTest, BatchedMatchesScalarPath) {
+  InstanceView view;
+  view.frustum = openFrustum();
+  view.frustum.planes[0] = glm::vec4(1.0f, 0.0f, 0.0f, 20.0f); // Drops x < -20 (plus radius)
+  view.cameraPosition = glm::vec3(3.0f, 10.0f, -7.0f);
+  view.screenHeight = 720.0f;
+  view.fovY = 0.785f;
+  std::vector<float> maxScreenSizes = {0.0f, 400.0f, 150.0f, 40.0f};
+
+  for (size_t count : {0u, 1u, 3u, 4u, 5u, 17u, 1000u}) {
+    SCOPED_TRACE(count);
+    std::vector<glm::mat4> transforms;
+    for (size_t i = 0; i < count; ++i) {
+      float f = static_cast<float>(i);
+      transforms.push_back(placed(
+          glm::vec3(std::sin(f) * 60.0f, std::cos(f * 0.3f) * 5.0f, f * 0.5f - 100.0f),
+          0.5f + 0.25f * static_cast<float>(i % 5)));
+    }
+    InstanceSet set;
+    set.assign(transforms, glm::vec4(0.5f, 1.0f, 0.0f, 2.0f));
+
+    InstanceBuckets batched;
+    InstanceBuckets scalar;
+    set.bucket(view, maxScreenSizes, batched);
+    set.bucketScalar(view, maxScreenSizes, scalar);
+    EXPECT_EQ(batched.offsets, scalar.offsets);
+    EXPECT_EQ(batched.transforms, scalar.transforms);
+    EXPECT_EQ(batched.levelCount(), maxScreenSizes.size());
+  }
+}
+
+TEST(InstanceSetTest, LevelsFollowScreenSizePerInstance) {
+  InstanceView view;
+  view.frustum = openFrustum();
+  view.screenHeight = 1000.0f;
+  view.fovY = 0.8f;
+  std::vector<float> maxScreenSizes = {0.0f, 300.0f, 60.0f};
+  const float radius = 5.0f;
+
+  // Distances well inside each level's range: level 0 up close, the last level far away
+  std::vector<float> distances = {5.0f, 12.0f, 30.0f, 60.0f, 200.0f, 400.0f, 1000.0f};
+  std::vector<glm::mat4> transforms;
+  for (float d : distances) {
+    transforms.push_back(placed(glm::vec3(0.0f, 0.0f, -d)));
+  }
+  InstanceSet set;
+  set.assign(transforms, glm::vec4(0.0f, 0.0f, 0.0f, radius));
+
+  InstanceBuckets buckets;
+  set.bucket(view, maxScreenSizes, buckets);
+  ASSERT_EQ(buckets.levelCount(), 3u);
+  EXPECT_EQ(buckets.total(), distances.size());
+
+  for (size_t level = 0; level < buckets.levelCount(); ++level) {
+    for (uint32_t i = buckets.first(level); i < buckets.first(level) + buckets.count(level);
+         ++i) {
+      float d = -buckets.transforms[i][3].z;
+      float size = screenSize(radius, d, view.screenHeight, view.fovY);
+      size_t expected = 0;
+      for (size_t l = 0; l < maxScreenSizes.size(); ++l) {
+        if (maxScreenSizes[l] > 0.0f && size < maxScreenSizes[l]) {
+          expected = l;
+        }
+      }
+      EXPECT_EQ(level, expected) << "distance " << d;
+    }
+  }
+  EXPECT_GT(buckets.count(0), 0u);
+  EXPECT_GT(buckets.count(1), 0u);
+  EXPECT_GT(buckets.count(2), 0u);
+}
+
+TEST(InstanceSetTest, ScaledAndOutsideInstancesAreCulled) {
+  InstanceView view;
+  view.frustum = openFrustum();
+  view.frustum.planes[0] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f); // Keeps x >= -radius
+  view.screenHeight = 720.0f;
+  view.fovY = 0.8f;
+
+  // Unit spheres at x = -3; only the one scaled past the plane survives
+  std::vector<glm::mat4> transforms = {placed(glm::vec3(-3.0f, 0.0f, 0.0f)),
+                                       placed(glm::vec3(-3.0f, 0.0f, 0.0f), 4.0f),
+                                       placed(glm::vec3(2.0f, 0.0f, 0.0f))};
+  InstanceSet set;
+  set.assign(transforms, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+  InstanceBuckets buckets;
+  set.bucket(view, {}, buckets);
+  ASSERT_EQ(buckets.levelCount(), 1u);
+  ASSERT_EQ(buckets.total(), 2u);
+  EXPECT_EQ(buckets.transforms[0], transforms[1]);
+  EXPECT_EQ(buckets.transforms[1], transforms[2]);
+}
+
+TEST(InstanceSetTest, AssignKeepsAtMostMaxInstances) {
+  InstanceSet set;
+  set.assign(std::vector<glm::mat4>(MAX_INSTANCES + 10, glm::mat4(1.0f)), glm::vec4(1.0f));
+  EXPECT_EQ(set.size(), MAX_INSTANCES);
+  set.clear();
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(InstanceSetTest, GridIsCenteredAndSpaced) {
+  EXPECT_TRUE(gridInstances(0, 10.0f).empty());
+
+  // 10 copies: 4 columns, 3 rows, the last row partly filled
+  auto grid = gridInstances(10, 10.0f);
+  ASSERT_EQ(grid.size(), 10u);
+  EXPECT_EQ(glm::vec3(grid[0][3]), glm::vec3(-15.0f, 0.0f, -10.0f));
+  EXPECT_EQ(glm::vec3(grid[3][3]), glm::vec3(15.0f, 0.0f, -10.0f));
+  EXPECT_EQ(glm::vec3(grid[4][3]), glm::vec3(-15.0f, 0.0f, 0.0f));
+  EXPECT_EQ(glm::vec3(grid[9][3]), glm::vec3(-5.0f, 0.0f, 10.0f));
+  EXPECT_EQ(glm::mat3(grid[9]), glm::mat3(1.0f));
+}
@@ -0,0 +1,188 @@
+#include "render/mesh_bvh.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace w3d;
+
+namespace {
+
+struct Mesh {
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+};
+
+// What HoverDetector did before the tree: every triangle, the first of the nearest winning
+MeshHit linearHit(const Mesh &mesh, const Ray &ray) {
+  MeshHit nearest;
+  for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+    TriangleHit hit = intersectRayTriangle(ray, mesh.positions[mesh.indices[i]],
+                                           mesh.positions[mesh.indices[i + 1]],
+                                           mesh.positions[mesh.indices[i + 2]]);
+    if (hit.hit && hit.distance < nearest.hit.distance) {
+      nearest.hit = hit;
+      nearest.triangleIndex = i / 3;
+    }
+  }
+  return nearest;
+}
+
+// Random triangles of varied size in a box
+Mesh triangleSoup(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+  std::uniform_real_distribution<float> offset(-0.6f, 0.6f);
+
+  Mesh mesh;
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec3 center(position(rng), position(rng), position(rng));
+    for (int corner = 0; corner < 3; ++corner) {
+      mesh.indices.push_back(static_cast<uint32_t>(mesh.positions.size()));
+      mesh.positions.push_back(center + glm::vec3(offset(rng), offset(rng), offset(rng)));
+    }
+  }
+  return mesh;
+}
+
+// A flat, shared-vertex grid in the z = 0 plane: every node's box is flat
+Mesh grid(uint32_t cells) {
+  Mesh mesh;
+  for (uint32_t y = 0; y <= cells; ++y) {
+    for (uint32_t x = 0; x <= cells; ++x) {
+      mesh.positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    }
+  }
+  for (uint32_t y = 0; y < cells; ++y) {
+    for (uint32_t x = 0; x < cells; ++x) {
+      uint32_t corner = y * (cells + 1) + x;
+      mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, corner + cells + 1});
+      mesh.indices.insert(mesh.indices.end(),
+                          {corner + 1, corner + cells + 2, corner + cells + 1});
+    }
+  }
+  return mesh;
+}
+
+std::vector<Ray> randomRays(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> origin(-8.0f, 8.0f);
+  std::uniform_real_distribution<float> target(-4.0f, 4.0f);
+
+  std::vector<Ray> rays;
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec3 from(origin(rng), origin(rng), origin(rng));
+    glm::vec3 to(target(rng), target(rng), target(rng));
+    rays.push_back({from, glm::normalize(to - from)});
+  }
+  return rays;
+}
+
+void expectSameHit(const MeshBVH &bvh, const Mesh &mesh, const Ray &ray) {
+  MeshHit expected = linearHit(mesh, ray);
+  MeshHit actual = bvh.intersect(ray);
+  ASSERT_EQ(actual.hit.hit, expected.hit.hit);
+  if (expected.hit.hit) {
+    EXPECT_EQ(actual.triangleIndex, expected.triangleIndex);
+    EXPECT_EQ(actual.hit.distance, expected.hit.distance);
+    EXPECT_EQ(actual.hit.u, expected.hit.u);
+    EXPECT_EQ(actual.hit.v, expected.hit.v);
+    EXPECT_EQ(actual.hit.point, expected.hit.point);
+  }
+}
+
+} // namespace
+
+TEST(MeshBVHTest, EmptyMeshHasNoTreeAndNoHits) {
+  MeshBVH bvh;
+  bvh.build(std::vector<glm::vec3>{}, std::vector<uint32_t>{});
+  EXPECT_TRUE(bvh.empty());
+  EXPECT_FALSE(bvh.intersect({glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f)}).hit.hit);
+}
+
+TEST(MeshBVHTest, MatchesTheLinearTestOnATriangleSoup) {
+  Mesh mesh = triangleSoup(2000, 7);
+  MeshBVH bvh;
+  bvh.build(mesh.positions, mesh.indices);
+
+  // Split into many leaves of at most a few packets
+  EXPECT_GT(bvh.nodeCount(), 100u);
+  EXPECT_LE(bvh.packetCount(), 2000u / 2);
+
+  size_t hits = 0;
+  for (const Ray &ray : randomRays(500, 11)) {
+    expectSameHit(bvh, mesh, ray);
+    hits += linearHit(mesh, ray).hit.hit ? 1 : 0;
+  }
+  EXPECT_GT(hits, 100u); // The rays exercise hits, not only misses
+}
+
+TEST(MeshBVHTest, MatchesTheLinearTestOnAFlatGrid) {
+  Mesh mesh = grid(24);
+  MeshBVH bvh;
+  bvh.build(mesh.positions, mesh.indices);
+
+  // Straight down onto vertices, edges and cell centers, and one grazing ray
+  for (float y = -0.5f; y <= 25.0f; y += 0.5f) {
+    for (float x = -0.5f; x <= 25.0f; x += 0.5f) {
+      SCOPED_TRACE(testing::Message() << x << ", " << y);
+      expectSameHit(bvh, mesh, {glm::vec3(x, y, 3.0f), glm::vec3(0.0f, 0.0f, -1.0f)});
+    }
+  }
+  expectSameHit(bvh, mesh, {glm::vec3(-1.0f, 3.3f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f)});
+  expectSameHit(bvh, mesh,
+                {glm::vec3(-10.0f, -10.0f, 2.0f), glm::normalize(glm::vec3(1.0f, 1.0f, -0.1f))});
+}
+
+TEST(MeshBVHTest, LowerIndexWinsTiesLikeTheLinearTest) {
+  // The same triangle four times over, apart from the other geometry: the first copy wins
+  Mesh mesh = triangleSoup(64, 3);
+  glm::vec3 a(20.0f, 0.0f, 0.0f), b(21.0f, 0.0f, 0.0f), c(20.0f, 1.0f, 0.0f);
+  for (int copy = 0; copy < 4; ++copy) {
+    uint32_t first = static_cast<uint32_t>(mesh.positions.size());
+    mesh.positions.insert(mesh.positions.end(), {a, b, c});
+    mesh.indices.insert(mesh.indices.end(), {first, first + 1, first + 2});
+  }
+
+  MeshBVH bvh;
+  bvh.build(mesh.positions, mesh.indices);
+  MeshHit hit = bvh.intersect({glm::vec3(20.25f, 0.25f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)});
+  ASSERT_TRUE(hit.hit.hit);
+  EXPECT_EQ(hit.triangleIndex, 64u);
+}
+
+TEST(MeshBVHTest, SkipsTrianglesIndexingPastTheVertices) {
+  Mesh mesh;
+  mesh.positions = {glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f),
+                    glm::vec3(0.0f, 1.0f, 1.0f)};
+  mesh.indices = {0, 1, 9, 0, 1, 2};
+
+  MeshBVH bvh;
+  bvh.build(mesh.positions, mesh.indices);
+  MeshHit hit = bvh.intersect({glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)});
+  ASSERT_TRUE(hit.hit.hit);
+  EXPECT_EQ(hit.triangleIndex, 1u); // Indices keep counting the skipped triangle
+  EXPECT_FLOAT_EQ(hit.hit.distance, 1.0f);
+}
+
+TEST(MeshBVHTest, BuildsFromVertexPositions) {
+  struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+  };
+  std::vector<Vertex> vertices = {{glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f)},
+                                  {glm::vec3(1.0f, 0.0f, 2.0f), glm::vec3(0.0f)},
+                                  {glm::vec3(0.0f, 1.0f, 2.0f), glm::vec3(0.0f)}};
+  std::vector<uint32_t> indices = {0, 1, 2};
+
+  MeshBVH bvh;
+  bvh.build(vertices, indices);
+  MeshHit hit = bvh.intersect({glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)});
+  ASSERT_TRUE(hit.hit.hit);
+  EXPECT_FLOAT_EQ(hit.hit.distance, 2.0f);
+
+  bvh.clear();
+  EXPECT_TRUE(bvh.empty());
+}
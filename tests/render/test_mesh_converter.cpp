@@ -3,6 +3,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 using namespace w3d;
 
 class MeshConverterTest : public ::testing::Test {
@@ -273,30 +277,27 @@ TEST_F(MeshConverterTest, PerFaceUVIndicesUnrollMesh) {
   const auto &verts = converted.subMeshes[0].vertices;
   const auto &indices = converted.subMeshes[0].indices;
 
-  // With per-face UVs, mesh should be unrolled: 2 tris * 3 verts = 6 vertices
-  ASSERT_EQ(verts.size(), 6);
+  // With per-face UVs the mesh is unrolled, then the corners both triangles share with the
+  // same UV (vertices 0 and 2) are welded: 4 vertices instead of 6
+  ASSERT_EQ(verts.size(), 4);
   ASSERT_EQ(indices.size(), 6);
+  EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2, 0, 2, 3}));
 
   // Verify triangle 1 UVs (indices 0,1,2 -> UVs 0,1,2)
-  EXPECT_FLOAT_EQ(verts[0].texCoord.x, 0.0f);
-  EXPECT_FLOAT_EQ(verts[0].texCoord.y, 0.0f);
-  EXPECT_FLOAT_EQ(verts[1].texCoord.x, 1.0f);
-  EXPECT_FLOAT_EQ(verts[1].texCoord.y, 0.0f);
-  EXPECT_FLOAT_EQ(verts[2].texCoord.x, 1.0f);
-  EXPECT_FLOAT_EQ(verts[2].texCoord.y, 1.0f);
+  EXPECT_FLOAT_EQ(verts[indices[0]].texCoord.x, 0.0f);
+  EXPECT_FLOAT_EQ(verts[indices[0]].texCoord.y, 0.0f);
+  EXPECT_FLOAT_EQ(verts[indices[1]].texCoord.x, 1.0f);
+  EXPECT_FLOAT_EQ(verts[indices[1]].texCoord.y, 0.0f);
+  EXPECT_FLOAT_EQ(verts[indices[2]].texCoord.x, 1.0f);
+  EXPECT_FLOAT_EQ(verts[indices[2]].texCoord.y, 1.0f);
 
   // Verify triangle 2 UVs (indices 0,2,3 -> UVs 0,2,3)
-  EXPECT_FLOAT_EQ(verts[3].texCoord.x, 0.0f);
-  EXPECT_FLOAT_EQ(verts[3].texCoord.y, 0.0f);
-  EXPECT_FLOAT_EQ(verts[4].texCoord.x, 1.0f);
-  EXPECT_FLOAT_EQ(verts[4].texCoord.y, 1.0f);
-  EXPECT_FLOAT_EQ(verts[5].texCoord.x, 0.0f);
-  EXPECT_FLOAT_EQ(verts[5].texCoord.y, 1.0f);
-
-  // Indices should be sequential for unrolled mesh
-  for (size_t i = 0; i < 6; ++i) {
-    EXPECT_EQ(indices[i], static_cast<uint32_t>(i));
-  }
+  EXPECT_FLOAT_EQ(verts[indices[3]].texCoord.x, 0.0f);
+  EXPECT_FLOAT_EQ(verts[indices[3]].texCoord.y, 0.0f);
+  EXPECT_FLOAT_EQ(verts[indices[4]].texCoord.x, 1.0f);
+  EXPECT_FLOAT_EQ(verts[indices[4]].texCoord.y, 1.0f);
+  EXPECT_FLOAT_EQ(verts[indices[5]].texCoord.x, 0.0f);
+  EXPECT_FLOAT_EQ(verts[indices[5]].texCoord.y, 1.0f);
 }
 
 TEST_F(MeshConverterTest, PerFaceUVPreservesPositions) {
@@ -397,7 +398,10 @@ TEST_F(MeshConverterTest, PerFaceUVWithSharedVertexDifferentUVs) {
 
   ASSERT_EQ(converted.subMeshes.size(), 1);
   const auto &verts = converted.subMeshes[0].vertices;
-  ASSERT_EQ(verts.size(), 6);
+  const auto &indices = converted.subMeshes[0].indices;
+  // Only vertex 2, which keeps UV 2 in both triangles, is welded
+  ASSERT_EQ(verts.size(), 5);
+  EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2, 3, 2, 4}));
 
   // Vertex 0 in triangle 1 should have UV (0,0)
   EXPECT_FLOAT_EQ(verts[0].texCoord.x, 0.0f);
@@ -414,6 +418,121 @@ TEST_F(MeshConverterTest, PerFaceUVWithSharedVertexDifferentUVs) {
   EXPECT_FLOAT_EQ(verts[3].position.y, 0.0f);
 }
 
+// =============================================================================
+// Vertex Welding Tests
+// =============================================================================
+
+namespace {
+
+// A size x size grid of quads in the XY plane whose left and right halves use different
+// textures, like the walls of a multi-texture building
+Mesh createTwoTextureGrid(uint32_t size) {
+  Mesh mesh;
+  mesh.header.meshName = "Building";
+  uint32_t stride = size + 1;
+  for (uint32_t y = 0; y <= size; ++y) {
+    for (uint32_t x = 0; x <= size; ++x) {
+      mesh.vertices.push_back({static_cast<float>(x), static_cast<float>(y), 0.0f});
+      mesh.normals.push_back({0.0f, 0.0f, 1.0f});
+      mesh.texCoords.push_back({static_cast<float>(x) / size, static_cast<float>(y) / size});
+    }
+  }
+
+  TextureStage stage;
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      uint32_t v = y * stride + x;
+      Triangle lower;
+      lower.vertexIndices[0] = v;
+      lower.vertexIndices[1] = v + 1;
+      lower.vertexIndices[2] = v + stride;
+      Triangle upper;
+      upper.vertexIndices[0] = v + 1;
+      upper.vertexIndices[1] = v + stride + 1;
+      upper.vertexIndices[2] = v + stride;
+      mesh.triangles.push_back(lower);
+      mesh.triangles.push_back(upper);
+      uint32_t texture = x < size / 2 ? 0 : 1;
+      stage.textureIds.insert(stage.textureIds.end(), {texture, texture});
+    }
+  }
+
+  mesh.textures.resize(2);
+  mesh.textures[0].name = "wall.tga";
+  mesh.textures[1].name = "windows.tga";
+  MaterialPass pass;
+  pass.textureStages.push_back(stage);
+  mesh.materialPasses.push_back(pass);
+  return mesh;
+}
+
+} // namespace
+
+TEST_F(MeshConverterTest, WeldingSharesIdenticalCornersOfMultiTextureMesh) {
+  const uint32_t size = 8;
+  Mesh mesh = createTwoTextureGrid(size);
+  auto converted = MeshConverter::convert(mesh);
+  ASSERT_EQ(converted.subMeshes.size(), 2);
+
+  size_t corners = 0;
+  size_t welded = 0;
+  for (const auto &subMesh : converted.subMeshes) {
+    // Each half is a (size / 2) x size block of quads
+    EXPECT_EQ(subMesh.vertices.size(), (size / 2 + 1) * (size + 1));
+    corners += subMesh.indices.size();
+    welded += subMesh.vertices.size();
+  }
+  EXPECT_EQ(corners, mesh.triangles.size() * 3);
+  RecordProperty("UnrolledVertices", static_cast<int>(corners));
+  RecordProperty("WeldedVertices", static_cast<int>(welded));
+  EXPECT_LT(welded * 3, corners);
+
+  // Every triangle still draws its own corners with their attributes, in input order
+  const auto &textureIds = mesh.materialPasses[0].textureStages[0].textureIds;
+  for (uint32_t texture = 0; texture < 2; ++texture) {
+    const auto &subMesh = converted.subMeshes[texture];
+    size_t corner = 0;
+    for (size_t t = 0; t < mesh.triangles.size(); ++t) {
+      if (textureIds[t] != texture) {
+        continue;
+      }
+      for (uint32_t source : mesh.triangles[t].vertexIndices) {
+        const auto &v = subMesh.vertices[subMesh.indices.at(corner++)];
+        EXPECT_FLOAT_EQ(v.position.x, mesh.vertices[source].x);
+        EXPECT_FLOAT_EQ(v.position.y, mesh.vertices[source].y);
+        EXPECT_FLOAT_EQ(v.texCoord.x, mesh.texCoords[source].u);
+        EXPECT_FLOAT_EQ(v.texCoord.y, mesh.texCoords[source].v);
+      }
+    }
+  }
+}
+
+TEST_F(MeshConverterTest, WeldingKeepsCornersWithDifferentBones) {
+  Mesh mesh = createTwoTextureGrid(2);
+  // Each row of vertices moves with its own bone
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    mesh.vertexInfluences.push_back({static_cast<uint16_t>(i / 3), 0});
+  }
+  // The first triangle reaches vertex 3 through a copy bound to another bone; the second
+  // triangle still uses vertex 3 itself
+  mesh.vertices.push_back(mesh.vertices[3]);
+  mesh.normals.push_back(mesh.normals[3]);
+  mesh.texCoords.push_back(mesh.texCoords[3]);
+  mesh.vertexInfluences.push_back({5, 0});
+  mesh.triangles[0].vertexIndices[2] = static_cast<uint32_t>(mesh.vertices.size() - 1);
+
+  auto converted = MeshConverter::convertSkinned(mesh, 0);
+  ASSERT_EQ(converted.subMeshes.size(), 2);
+  const auto &left = converted.subMeshes[0];
+
+  // The 2 x 3 vertices of the left half, plus the copy with its own bone
+  EXPECT_EQ(left.vertices.size(), 7u);
+  EXPECT_EQ(left.vertices[left.indices[2]].boneIndex, 5u);
+  EXPECT_EQ(left.vertices[left.indices[5]].boneIndex, 1u);
+  EXPECT_EQ(left.vertices[left.indices[2]].position, left.vertices[left.indices[5]].position);
+  EXPECT_NE(left.indices[2], left.indices[5]);
+}
+
 // =============================================================================
 // Bounding Box Tests
 // =============================================================================
@@ -594,3 +713,184 @@ TEST_F(MeshConverterTest, MultipleTexturesProduceMultipleSubMeshes) {
   EXPECT_EQ(subMesh1->indices.size(), 3);
   EXPECT_EQ(subMesh2->indices.size(), 3);
 }
+
+// =============================================================================
+// Blend Mode Tests
+// =============================================================================
+
+TEST_F(MeshConverterTest, NoShaderIsOpaque) {
+  auto mesh = createBasicMesh(3, 1);
+
+  auto converted = MeshConverter::convert(mesh);
+
+  ASSERT_EQ(converted.subMeshes.size(), 1);
+  EXPECT_EQ(converted.subMeshes[0].blendMode, BlendMode::Opaque);
+}
+
+TEST_F(MeshConverterTest, ShaderBlendFuncsSetBlendMode) {
+  auto convertWith = [this](uint8_t srcBlend, uint8_t destBlend, uint8_t alphaTest) {
+    auto mesh = createBasicMesh(3, 1);
+    ShaderDef shader;
+    shader.srcBlend = srcBlend;
+    shader.destBlend = destBlend;
+    shader.alphaTest = alphaTest;
+    mesh.shaders.push_back(shader);
+
+    MaterialPass pass;
+    pass.shaderIds.push_back(0);
+    mesh.materialPasses.push_back(pass);
+    return MeshConverter::convert(mesh).subMeshes.at(0).blendMode;
+  };
+
+  EXPECT_EQ(convertWith(Shader::SRCBLENDFUNC_ONE, Shader::DESTBLENDFUNC_ZERO,
+                        Shader::ALPHATEST_DISABLE),
+            BlendMode::Opaque);
+  EXPECT_EQ(convertWith(Shader::SRCBLENDFUNC_ONE, Shader::DESTBLENDFUNC_ZERO,
+                        Shader::ALPHATEST_ENABLE),
+            BlendMode::AlphaTest);
+  EXPECT_EQ(convertWith(Shader::SRCBLENDFUNC_SRC_ALPHA, Shader::DESTBLENDFUNC_ONE_MINUS_SRC_ALPHA,
+                        Shader::ALPHATEST_DISABLE),
+            BlendMode::AlphaBlend);
+  EXPECT_EQ(convertWith(Shader::SRCBLENDFUNC_ONE, Shader::DESTBLENDFUNC_ONE,
+                        Shader::ALPHATEST_DISABLE),
+            BlendMode::Additive);
+}
+
+// =============================================================================
+// Vertex Encoding Tests
+// =============================================================================
+
+TEST_F(MeshConverterTest, FullEncodingCopiesVertices) {
+  auto converted = MeshConverter::convert(createBasicMesh(4, 2));
+  const auto &subMesh = converted.subMeshes.at(0);
+
+  auto encoded =
+      MeshConverter::encodeVertices(subMesh.vertices, gfx::VertexFormat::Full, subMesh.bounds);
+  EXPECT_EQ(encoded.encoding.format, gfx::VertexFormat::Full);
+  EXPECT_EQ(encoded.stride, sizeof(gfx::Vertex));
+  EXPECT_EQ(encoded.count, 4u);
+  ASSERT_EQ(encoded.data.size(), 4 * sizeof(gfx::Vertex));
+  EXPECT_EQ(std::memcmp(encoded.data.data(), subMesh.vertices.data(), encoded.data.size()), 0);
+}
+
+TEST_F(MeshConverterTest, QuantizedEncodingDecodesWithinErrorBound) {
+  auto mesh = createBasicMesh(5, 3);
+  mesh.texCoords = {
+      {0.0f, 0.0f},
+      {0.5f, 0.25f},
+      {1.0f, 1.0f},
+      {2.5f, -1.0f},
+      {0.125f, 0.875f}
+  };
+  auto converted = MeshConverter::convert(mesh);
+  const auto &subMesh = converted.subMeshes.at(0);
+
+  auto encoded = MeshConverter::encodeVertices(subMesh.vertices, gfx::VertexFormat::Quantized,
+                                               subMesh.bounds);
+  ASSERT_EQ(encoded.encoding.format, gfx::VertexFormat::Quantized);
+  EXPECT_LT(2 * encoded.data.size(), subMesh.vertices.size() * sizeof(gfx::Vertex));
+
+  const auto &quantization = encoded.encoding.quantization;
+  glm::vec3 bound = quantization.maxError() + glm::vec3(1e-5f);
+  for (size_t i = 0; i < subMesh.vertices.size(); ++i) {
+    gfx::QuantizedVertex packed;
+    std::memcpy(&packed, encoded.data.data() + i * encoded.stride, sizeof(packed));
+    const auto &v = subMesh.vertices[i];
+
+    glm::vec3 position =
+        quantization.dequantize({packed.position[0], packed.position[1], packed.position[2]});
+    glm::vec3 error = glm::abs(position - v.position);
+    EXPECT_LE(error.x, bound.x);
+    EXPECT_LE(error.y, bound.y);
+    EXPECT_LE(error.z, bound.z);
+    EXPECT_LT(glm::length(gfx::unpackOctNormal(packed.normal) - v.normal), 1e-4f);
+    EXPECT_EQ(gfx::unpackHalf2(packed.texCoord), v.texCoord); // Exact in half precision
+    EXPECT_EQ(packed.color >> 24, 255u);
+  }
+}
+
+TEST_F(MeshConverterTest, SkinnedCompactEncodingKeepsBoneInAlpha) {
+  auto mesh = createBasicMesh(3, 1);
+  mesh.vertexInfluences = {{7, 0}, {12, 0}, {255, 0}};
+  auto converted = MeshConverter::convertSkinned(mesh, 0);
+  const auto &subMesh = converted.subMeshes.at(0);
+
+  auto encoded = MeshConverter::encodeVertices(subMesh.vertices, gfx::VertexFormat::Compact,
+                                               subMesh.bounds);
+  ASSERT_EQ(encoded.encoding.format, gfx::VertexFormat::Compact);
+  ASSERT_EQ(encoded.stride, sizeof(gfx::CompactVertex));
+  for (size_t i = 0; i < subMesh.vertices.size(); ++i) {
+    gfx::CompactVertex packed;
+    std::memcpy(&packed, encoded.data.data() + i * encoded.stride, sizeof(packed));
+    EXPECT_EQ(packed.position, subMesh.vertices[i].position);
+    EXPECT_EQ(packed.color >> 24, subMesh.vertices[i].boneIndex);
+  }
+
+  // A bone the alpha byte cannot hold keeps the whole set in the full format
+  auto highBone = subMesh.vertices;
+  highBone[1].boneIndex = 300;
+  auto full =
+      MeshConverter::encodeVertices(highBone, gfx::VertexFormat::Compact, subMesh.bounds);
+  EXPECT_EQ(full.encoding.format, gfx::VertexFormat::Full);
+  EXPECT_EQ(full.stride, sizeof(gfx::SkinnedVertex));
+}
+
+// =============================================================================
+// Optimization Tests
+// =============================================================================
+
+namespace {
+
+// Corner positions of each triangle, in draw order
+std::vector<std::array<float, 3>> trianglePositions(const ConvertedSubMesh &subMesh) {
+  std::vector<std::array<float, 3>> triangles;
+  for (size_t i = 0; i + 2 < subMesh.indices.size(); i += 3) {
+    triangles.push_back({subMesh.vertices[subMesh.indices[i]].position.x,
+                         subMesh.vertices[subMesh.indices[i + 1]].position.x,
+                         subMesh.vertices[subMesh.indices[i + 2]].position.x});
+  }
+  return triangles;
+}
+
+} // namespace
+
+TEST_F(MeshConverterTest, OptimizeKeepsTrianglesAndOrdersVerticesByFirstUse) {
+  auto converted = MeshConverter::convert(createBasicMesh(12, 10));
+  auto &subMesh = converted.subMeshes.at(0);
+  // Scatter the triangles so there is something to reorder
+  std::vector<uint32_t> scattered;
+  for (size_t t : {7, 2, 9, 0, 5, 3, 8, 1, 6, 4}) {
+    scattered.insert(scattered.end(), subMesh.indices.begin() + t * 3,
+                     subMesh.indices.begin() + t * 3 + 3);
+  }
+  subMesh.indices = scattered;
+
+  auto before = trianglePositions(subMesh);
+  auto stats = MeshConverter::optimize(converted);
+  auto after = trianglePositions(subMesh);
+
+  EXPECT_EQ(stats.triangles, 10u);
+  EXPECT_LE(stats.missesAfter, stats.missesBefore);
+  std::sort(before.begin(), before.end());
+  std::sort(after.begin(), after.end());
+  EXPECT_EQ(after, before);
+
+  // Vertices are numbered in the order the triangles first use them
+  uint32_t highest = 0;
+  for (uint32_t index : subMesh.indices) {
+    EXPECT_LE(index, highest + 1);
+    highest = std::max(highest, index);
+  }
+}
+
+TEST_F(MeshConverterTest, OptimizeKeepsAlphaBlendedTriangleOrder) {
+  auto converted = MeshConverter::convert(createBasicMesh(8, 6));
+  auto &subMesh = converted.subMeshes.at(0);
+  subMesh.blendMode = BlendMode::AlphaBlend;
+  std::reverse(subMesh.indices.begin(), subMesh.indices.end());
+
+  auto before = trianglePositions(subMesh);
+  MeshConverter::optimize(converted);
+  EXPECT_EQ(trianglePositions(subMesh), before);
+  EXPECT_EQ(subMesh.indices.front(), 0u);
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "render/mesh_simplifier.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+namespace {
+
+struct Grid {
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> outline; // Vertices on the grid's edge
+};
+
+// A size x size grid of quads in the XY plane, displaced in Z by height(x, y)
+template <typename HeightFunc>
+Grid makeGrid(uint32_t size, HeightFunc height) {
+  Grid grid;
+  uint32_t stride = size + 1;
+  for (uint32_t y = 0; y <= size; ++y) {
+    for (uint32_t x = 0; x <= size; ++x) {
+      float fx = static_cast<float>(x);
+      float fy = static_cast<float>(y);
+      grid.positions.push_back({fx, fy, height(fx, fy)});
+      if (x == 0 || y == 0 || x == size || y == size) {
+        grid.outline.push_back(y * stride + x);
+      }
+    }
+  }
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      uint32_t v = y * stride + x;
+      grid.indices.insert(grid.indices.end(),
+                          {v, v + 1, v + stride, v + 1, v + stride + 1, v + stride});
+    }
+  }
+  return grid;
+}
+
+Grid flatGrid(uint32_t size) {
+  return makeGrid(size, [](float, float) { return 0.0f; });
+}
+
+Grid bumpGrid(uint32_t size) {
+  return makeGrid(size, [](float x, float y) { return std::sin(x * 0.4f) * std::cos(y * 0.3f); });
+}
+
+// Sum of the triangles' normals: unchanged in direction when no triangle folds over
+glm::vec3 normalSum(const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &p) {
+  glm::vec3 sum(0.0f);
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    sum += glm::cross(p[indices[i + 1]] - p[indices[i]], p[indices[i + 2]] - p[indices[i]]);
+  }
+  return sum;
+}
+
+} // namespace
+
+TEST(MeshSimplifierTest, FlatGridReachesTargetWithoutError) {
+  Grid grid = flatGrid(16);
+  size_t target = grid.indices.size() / 4;
+
+  SimplifiedMesh simplified = simplifyMesh(grid.indices, grid.positions, target);
+  EXPECT_LE(simplified.indices.size(), target);
+  EXPECT_EQ(simplified.indices.size() % 3, 0u);
+  EXPECT_FLOAT_EQ(simplified.error, 0.0f);
+
+  // Same area and facing as the original: nothing folded over
+  glm::vec3 before = normalSum(grid.indices, grid.positions);
+  glm::vec3 after = normalSum(simplified.indices, grid.positions);
+  EXPECT_NEAR(after.z, before.z, 1e-3f);
+}
+
+TEST(MeshSimplifierTest, OpenEdgeVerticesAreKept) {
+  Grid grid = bumpGrid(12);
+  SimplifiedMesh simplified = simplifyMesh(grid.indices, grid.positions, 0);
+
+  std::set<uint32_t> used(simplified.indices.begin(), simplified.indices.end());
+  for (uint32_t v : grid.outline) {
+    EXPECT_TRUE(used.count(v)) << "outline vertex " << v;
+  }
+  EXPECT_LT(simplified.indices.size(), grid.indices.size());
+}
+
+TEST(MeshSimplifierTest, CurvedGridReportsErrorAndIsDeterministic) {
+  Grid grid = bumpGrid(24);
+  size_t target = grid.indices.size() / 2;
+
+  SimplifiedMesh first = simplifyMesh(grid.indices, grid.positions, target);
+  SimplifiedMesh second = simplifyMesh(grid.indices, grid.positions, target);
+  EXPECT_LE(first.indices.size(), target);
+  EXPECT_GT(first.error, 0.0f);
+  EXPECT_LT(first.error, 1.0f);
+  EXPECT_EQ(first.indices, second.indices);
+  EXPECT_EQ(first.error, second.error);
+
+  // A coarser level moves vertices further
+  SimplifiedMesh coarser = simplifyMesh(grid.indices, grid.positions, target / 4);
+  EXPECT_LT(coarser.indices.size(), first.indices.size());
+  EXPECT_GE(coarser.error, first.error);
+}
+
+TEST(MeshSimplifierTest, VerticesOnlyCollapseWithinTheirGroup) {
+  Grid grid = flatGrid(8);
+
+  // Every vertex in a group of its own: nothing can collapse
+  std::vector<uint32_t> ownGroups(grid.positions.size());
+  for (size_t v = 0; v < ownGroups.size(); ++v) {
+    ownGroups[v] = static_cast<uint32_t>(v);
+  }
+  EXPECT_EQ(simplifyMesh(grid.indices, grid.positions, 0, &ownGroups).indices, grid.indices);
+
+  // The column at x = 4 in groups of its own, like vertices weighted to a different bone
+  // each: the rest still simplifies, but nothing merges into or out of the column
+  std::vector<uint32_t> column(grid.positions.size(), 0u);
+  for (size_t v = 0; v < column.size(); ++v) {
+    if (grid.positions[v].x == 4.0f) {
+      column[v] = 1u + static_cast<uint32_t>(v);
+    }
+  }
+  SimplifiedMesh simplified = simplifyMesh(grid.indices, grid.positions, 0, &column);
+  EXPECT_LT(simplified.indices.size(), grid.indices.size());
+  std::set<uint32_t> used(simplified.indices.begin(), simplified.indices.end());
+  for (size_t v = 0; v < grid.positions.size(); ++v) {
+    if (column[v] != 0u) {
+      EXPECT_TRUE(used.count(static_cast<uint32_t>(v))) << "vertex " << v;
+    }
+  }
+}
+
+TEST(MeshSimplifierTest, InvalidInputIsReturnedUnchanged) {
+  std::vector<glm::vec3> positions(3);
+  std::vector<uint32_t> outOfRange = {0, 1, 5};
+  EXPECT_EQ(simplifyMesh(outOfRange, positions, 0).indices, outOfRange);
+
+  std::vector<uint32_t> partial = {0, 1};
+  EXPECT_EQ(simplifyMesh(partial, positions, 0).indices, partial);
+}
+
+TEST(MeshSimplifierTest, MaxScreenSizeKeepsErrorWithinPixelBudget) {
+  EXPECT_FLOAT_EQ(lodMaxScreenSize(0.1f, 10.0f), 200.0f * LOD_PIXEL_ERROR);
+  EXPECT_EQ(lodMaxScreenSize(0.0f, 10.0f), std::numeric_limits<float>::max());
+}
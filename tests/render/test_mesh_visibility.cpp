@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -35,6 +36,38 @@ private:
   std::vector<bool> visibility_;
 };
 
+enum class MockSelectionMode { Auto, Manual };
+
+// Simulate HLodModel's revision rules for LOD selection: a setter bumps the revision only
+// when the state the draws (and the instance buckets) depend on actually changes
+class MockLODState {
+public:
+  explicit MockLODState(size_t levels) : levels_(levels) {}
+
+  void setSelectionMode(MockSelectionMode mode) {
+    if (mode != mode_) {
+      mode_ = mode;
+      ++revision_;
+    }
+  }
+
+  void setCurrentLOD(size_t level) {
+    if (level < levels_ && level != current_) {
+      current_ = level;
+      ++revision_;
+    }
+  }
+
+  MockSelectionMode selectionMode() const { return mode_; }
+  uint64_t revision() const { return revision_; }
+
+private:
+  size_t levels_;
+  size_t current_ = 0;
+  MockSelectionMode mode_ = MockSelectionMode::Auto;
+  uint64_t revision_ = 0;
+};
+
 } // namespace
 
 // =============================================================================
@@ -174,3 +207,33 @@ TEST(MeshVisibilityTest, SingleMeshModel) {
   state.setAllHidden(false);
   EXPECT_FALSE(state.isHidden(0));
 }
+
+// =============================================================================
+// LOD Selection Revision Tests
+// =============================================================================
+
+TEST(LODSelectionRevisionTest, ChangingTheLevelBumpsTheRevision) {
+  MockLODState state(3);
+
+  state.setCurrentLOD(1);
+  EXPECT_EQ(state.revision(), 1u);
+
+  state.setCurrentLOD(1); // Unchanged
+  state.setCurrentLOD(5); // Out of range
+  EXPECT_EQ(state.revision(), 1u);
+}
+
+// Instance buckets depend on the mode, so reused draws must be re-recorded when it changes
+TEST(LODSelectionRevisionTest, ChangingTheSelectionModeBumpsTheRevision) {
+  MockLODState state(3);
+
+  state.setSelectionMode(MockSelectionMode::Manual);
+  EXPECT_EQ(state.selectionMode(), MockSelectionMode::Manual);
+  EXPECT_EQ(state.revision(), 1u);
+
+  state.setSelectionMode(MockSelectionMode::Manual); // Unchanged
+  EXPECT_EQ(state.revision(), 1u);
+
+  state.setSelectionMode(MockSelectionMode::Auto);
+  EXPECT_EQ(state.revision(), 2u);
+}
@@ -0,0 +1,122 @@
+#include "render/pick_id.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+namespace {
+
+glm::mat4 vulkanProjection(const glm::vec2 &screenSize) {
+  glm::mat4 proj = glm::perspective(glm::radians(45.0f), screenSize.x / screenSize.y, 0.01f,
+                                    10000.0f);
+  proj[1][1] *= -1;
+  return proj;
+}
+
+glm::vec3 ndc(const glm::mat4 &viewProj, const glm::vec3 &point) {
+  glm::vec4 clip = viewProj * glm::vec4(point, 1.0f);
+  return glm::vec3(clip) / clip.w;
+}
+
+} // namespace
+
+TEST(PickIdTest, RoundTripsMeshAndTriangle) {
+  EXPECT_FALSE(decodePickId(PICK_NONE).has_value());
+
+  for (uint32_t mesh : {0u, 1u, 17u, PICK_MAX_MESHES - 1}) {
+    for (uint32_t triangle : {0u, 5u, PICK_TRIANGLE_MASK}) {
+      uint32_t id = encodePickId(mesh, triangle);
+      EXPECT_NE(id, PICK_NONE);
+
+      auto picked = decodePickId(id);
+      ASSERT_TRUE(picked.has_value());
+      EXPECT_EQ(picked->meshIndex, mesh);
+      EXPECT_EQ(picked->triangleIndex, triangle);
+    }
+  }
+
+  // Triangles past the mask wrap within their mesh, never into the next mesh
+  auto aliased = decodePickId(encodePickId(3, PICK_TRIANGLE_MASK + 2));
+  ASSERT_TRUE(aliased.has_value());
+  EXPECT_EQ(aliased->meshIndex, 3u);
+  EXPECT_EQ(aliased->triangleIndex, 1u);
+}
+
+// The target's center is where screenToWorldRay casts the cursor's ray
+TEST(PickIdTest, ProjectionCentersTheCursor) {
+  glm::vec2 screenSize(1280.0f, 720.0f);
+  glm::vec2 cursor(900.0f, 200.0f);
+  glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 2.0f, 10.0f), glm::vec3(0.0f),
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj = vulkanProjection(screenSize);
+
+  Ray ray = screenToWorldRay(cursor, screenSize, view, proj);
+  glm::mat4 pick = pickProjection(proj, cursor, screenSize, 1.0f) * view;
+
+  for (float distance : {1.0f, 10.0f, 500.0f}) {
+    glm::vec3 onRay = ndc(pick, ray.origin + ray.direction * distance);
+    EXPECT_NEAR(onRay.x, 0.0f, 1e-3f);
+    EXPECT_NEAR(onRay.y, 0.0f, 1e-3f);
+  }
+
+  // Depth is unchanged, so the depth test orders surfaces as in the frame
+  glm::vec3 point(0.5f, -0.25f, 1.0f);
+  EXPECT_NEAR(ndc(pick, point).z, ndc(proj * view, point).z, 1e-6f);
+}
+
+TEST(PickIdTest, ProjectionCoversTheRegionAroundTheCursor) {
+  glm::vec2 screenSize(800.0f, 600.0f);
+  glm::vec2 cursor(100.0f, 450.0f);
+  float targetSize = 8.0f;
+  glm::mat4 proj = vulkanProjection(screenSize);
+  glm::mat4 pick = pickProjection(proj, cursor, screenSize, targetSize);
+
+  // A point drawn at a screen pixel lands at the matching offset from the target's center
+  auto throughPixel = [&](const glm::vec2 &pixel) {
+    Ray ray = screenToWorldRay(pixel, screenSize, glm::mat4(1.0f), proj);
+    return ndc(pick, ray.origin + ray.direction * 5.0f);
+  };
+  glm::vec3 corner = throughPixel(cursor + glm::vec2(targetSize / 2.0f));
+  EXPECT_NEAR(corner.x, 1.0f, 1e-3f);
+  EXPECT_NEAR(corner.y, 1.0f, 1e-3f);
+
+  glm::vec3 left = throughPixel(cursor - glm::vec2(targetSize / 4.0f, 0.0f));
+  EXPECT_NEAR(left.x, -0.5f, 1e-3f);
+  EXPECT_NEAR(left.y, 0.0f, 1e-3f);
+}
+
+TEST(PickIdTest, PickedTriangleHitMatchesTheRayTest) {
+  glm::vec3 v0(0.0f, 0.0f, 2.0f);
+  glm::vec3 v1(1.0f, 0.0f, 2.0f);
+  glm::vec3 v2(0.0f, 1.0f, 2.0f);
+
+  Ray inside{glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+  TriangleHit hit = pickedTriangleHit(inside, v0, v1, v2);
+  TriangleHit reference = intersectRayTriangle(inside, v0, v1, v2);
+  ASSERT_TRUE(hit.hit);
+  EXPECT_FLOAT_EQ(hit.distance, reference.distance);
+  EXPECT_EQ(hit.point, reference.point);
+}
+
+// The GPU covered the cursor with the triangle, but its ray passes just outside the edge
+TEST(PickIdTest, PickedTriangleHitFallsBackToThePlane) {
+  glm::vec3 v0(0.0f, 0.0f, 2.0f);
+  glm::vec3 v1(1.0f, 0.0f, 2.0f);
+  glm::vec3 v2(0.0f, 1.0f, 2.0f);
+
+  Ray edge{glm::vec3(0.5001f, 0.5001f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+  EXPECT_FALSE(intersectRayTriangle(edge, v0, v1, v2).hit);
+
+  TriangleHit hit = pickedTriangleHit(edge, v0, v1, v2);
+  ASSERT_TRUE(hit.hit);
+  EXPECT_NEAR(hit.distance, 2.0f, 1e-5f);
+  EXPECT_NEAR(hit.point.z, 2.0f, 1e-5f);
+
+  Ray away{glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)};
+  EXPECT_FALSE(pickedTriangleHit(away, v0, v1, v2).hit);
+
+  Ray parallel{glm::vec3(0.25f, 0.25f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f)};
+  EXPECT_FALSE(pickedTriangleHit(parallel, v0, v1, v2).hit);
+}
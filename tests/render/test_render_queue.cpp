@@ -0,0 +1,230 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "render/draw_packet.hpp"
+#include "render/render_queue.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace w3d;
+
+class RenderQueueTest : public ::testing::Test {
+protected:
+  RenderItem makeItem(uint32_t pipeline, const GPUMaterial &material, float depth,
+                      uint32_t draw, uint32_t vertexBuffer = 0) const {
+    return {pipeline, vertexBuffer, &material, glm::vec3(1.0f), depth, draw};
+  }
+
+  std::vector<uint32_t> sortedDraws(const RenderQueue &queue) const {
+    std::vector<uint32_t> draws;
+    for (size_t i = 0; i < queue.size(); ++i) {
+      draws.push_back(queue[i].draw);
+    }
+    return draws;
+  }
+
+  GPUMaterial texA_ = packetMaterial(1);
+  GPUMaterial texB_ = packetMaterial(2);
+  GPUMaterial blended_ = packetMaterial(1, BlendMode::AlphaBlend);
+  GPUMaterial additive_ = packetMaterial(3, BlendMode::Additive);
+};
+
+// =============================================================================
+// Key Tests
+// =============================================================================
+
+TEST_F(RenderQueueTest, PipelineOutranksTextureAndDepth) {
+  uint64_t a = RenderQueue::sortKey(makeItem(0, texB_, 100.0f, 0));
+  uint64_t b = RenderQueue::sortKey(makeItem(1, texA_, 1.0f, 0));
+  EXPECT_LT(a, b);
+}
+
+TEST_F(RenderQueueTest, OpaqueDepthSortsNearToFar) {
+  uint64_t nearKey = RenderQueue::sortKey(makeItem(0, texA_, 2.0f, 0));
+  uint64_t farKey = RenderQueue::sortKey(makeItem(0, texA_, 50.0f, 0));
+  EXPECT_LT(nearKey, farKey);
+}
+
+TEST_F(RenderQueueTest, TranslucentSortsAfterOpaqueAndFarToNear) {
+  uint64_t opaque = RenderQueue::sortKey(makeItem(RenderQueue::MAX_PIPELINES - 1, texB_, 1e6f, 0));
+  uint64_t nearKey = RenderQueue::sortKey(makeItem(0, blended_, 2.0f, 0));
+  uint64_t farKey = RenderQueue::sortKey(makeItem(0, additive_, 50.0f, 0));
+  EXPECT_LT(opaque, farKey);
+  EXPECT_LT(farKey, nearKey);
+}
+
+TEST_F(RenderQueueTest, DepthBehindCameraClampsToNearest) {
+  uint64_t behind = RenderQueue::sortKey(makeItem(0, texA_, -5.0f, 0));
+  uint64_t zero = RenderQueue::sortKey(makeItem(0, texA_, 0.0f, 0));
+  EXPECT_EQ(behind, zero);
+}
+
+// =============================================================================
+// Sort Tests
+// =============================================================================
+
+TEST_F(RenderQueueTest, SortGroupsStateAndOrdersTranslucentLast) {
+  RenderQueue queue;
+  queue.submit(makeItem(0, blended_, 10.0f, 0));
+  queue.submit(makeItem(0, texB_, 5.0f, 1));
+  queue.submit(makeItem(0, additive_, 30.0f, 2));
+  queue.submit(makeItem(0, texA_, 8.0f, 3));
+  queue.submit(makeItem(0, texB_, 1.0f, 4));
+  queue.submit(makeItem(0, texA_, 2.0f, 5));
+  queue.sort();
+
+  EXPECT_EQ(sortedDraws(queue), (std::vector<uint32_t>{5, 3, 4, 1, 2, 0}));
+}
+
+TEST_F(RenderQueueTest, EqualKeysKeepSubmissionOrder) {
+  RenderQueue queue;
+  for (uint32_t i = 0; i < 5; ++i) {
+    queue.submit(makeItem(0, texA_, 4.0f, i));
+  }
+  queue.sort();
+
+  EXPECT_EQ(sortedDraws(queue), (std::vector<uint32_t>{0, 1, 2, 3, 4}));
+}
+
+TEST_F(RenderQueueTest, RadixSortMatchesStableSortOnKeys) {
+  std::vector<GPUMaterial> materials;
+  for (uint32_t t = 0; t < 6; ++t) {
+    materials.push_back(packetMaterial(t, t % 3 == 0 ? BlendMode::AlphaBlend : BlendMode::Opaque));
+  }
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> pick(0, 5);
+  std::uniform_real_distribution<float> depth(-1.0f, 500.0f);
+
+  RenderQueue queue;
+  std::vector<RenderItem> items;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    RenderItem item = makeItem(pick(rng) % 4, materials[pick(rng)], depth(rng), i, pick(rng));
+    items.push_back(item);
+    queue.submit(item);
+  }
+  queue.sort();
+
+  std::stable_sort(items.begin(), items.end(), [](const RenderItem &a, const RenderItem &b) {
+    return RenderQueue::sortKey(a) < RenderQueue::sortKey(b);
+  });
+  ASSERT_EQ(queue.size(), items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    EXPECT_EQ(queue[i].draw, items[i].draw) << "at " << i;
+  }
+}
+
+TEST_F(RenderQueueTest, ClearEmptiesQueue) {
+  RenderQueue queue;
+  queue.submit(makeItem(0, texA_, 1.0f, 0));
+  queue.clear();
+  queue.sort();
+  EXPECT_TRUE(queue.empty());
+}
+
+// =============================================================================
+// Redundant State Tests
+// =============================================================================
+
+TEST_F(RenderQueueTest, BoundStateSkipsRepeatedBinds) {
+  BoundState state;
+  EXPECT_TRUE(state.setPipeline(0));
+  EXPECT_FALSE(state.setPipeline(0));
+  EXPECT_TRUE(state.setPipeline(1));
+
+  EXPECT_TRUE(state.setVertexBuffer(3));
+  EXPECT_FALSE(state.setVertexBuffer(3));
+
+  GPUMaterial copy = texA_;
+  EXPECT_TRUE(state.setMaterial(texA_, glm::vec3(1.0f)));
+  EXPECT_FALSE(state.setMaterial(copy, glm::vec3(1.0f)));
+  EXPECT_TRUE(state.setMaterial(copy, glm::vec3(1.5f)));
+  EXPECT_TRUE(state.setMaterial(texB_, glm::vec3(1.5f)));
+
+  EXPECT_EQ(state.counts().pipelines, 2u);
+  EXPECT_EQ(state.counts().vertexBuffers, 1u);
+  EXPECT_EQ(state.counts().materials, 3u);
+}
+
+TEST_F(RenderQueueTest, StatsCompareSubmissionAndSortedOrder) {
+  RenderQueue queue;
+  // Alternating textures and pipelines: every draw changes state in submission order
+  queue.submit(makeItem(0, texA_, 1.0f, 0));
+  queue.submit(makeItem(1, texB_, 1.0f, 1));
+  queue.submit(makeItem(0, texA_, 2.0f, 2));
+  queue.submit(makeItem(1, texB_, 2.0f, 3));
+  queue.submit(makeItem(0, blended_, 3.0f, 4));
+  queue.sort();
+
+  RenderQueueStats stats = queue.stats();
+  EXPECT_EQ(stats.draws, 5u);
+  EXPECT_EQ(stats.translucentDraws, 1u);
+  EXPECT_EQ(stats.submitted.pipelines, 5u);
+  EXPECT_EQ(stats.submitted.materials, 5u);
+  EXPECT_EQ(stats.sorted.pipelines, 3u);
+  EXPECT_EQ(stats.sorted.materials, 3u);
+  EXPECT_EQ(stats.sorted.vertexBuffers, 1u);
+}
+
+TEST_F(RenderQueueTest, BatchDepthIsNearestDraw) {
+  DrawList list;
+  list.batches.push_back({&texA_, glm::vec3(1.0f), 0, 2});
+  CullInput near{};
+  near.sphere = glm::vec4(0.0f, 0.0f, -3.0f, 1.0f);
+  near.boneIndex = CullInput::NO_BONE;
+  CullInput far = near;
+  far.sphere = glm::vec4(0.0f, 0.0f, -9.0f, 1.0f);
+  list.draws = {far, near};
+
+  // w = -z, as a perspective projection of a camera looking down -Z gives
+  glm::mat4 viewProj(1.0f);
+  viewProj[2][3] = -1.0f;
+  viewProj[3][3] = 0.0f;
+  EXPECT_FLOAT_EQ(batchDepth(list, 0, viewProj, nullptr, 0), 3.0f);
+}
+
+// =============================================================================
+// Pipeline Permutation Tests
+// =============================================================================
+
+TEST_F(RenderQueueTest, PipelineKeyIdsRoundTrip) {
+  for (uint32_t id = 0; id < gfx::PipelineKey::COUNT; ++id) {
+    EXPECT_EQ(gfx::PipelineKey::fromId(id).id(), id);
+  }
+  EXPECT_LE(gfx::PipelineKey::COUNT, RenderQueue::MAX_PIPELINES);
+}
+
+TEST_F(RenderQueueTest, PipelineKeyFollowsMaterial) {
+  gfx::PipelineKey textured = pipelineKey(texA_, false);
+  EXPECT_FALSE(textured.skinned);
+  EXPECT_EQ(textured.blend, gfx::PipelineBlend::Opaque);
+  EXPECT_EQ(textured.shaderFeatures, gfx::ShaderFeature::Textured);
+
+  GPUMaterial untextured = packetMaterial(0);
+  EXPECT_EQ(pipelineKey(untextured, false).shaderFeatures, 0u);
+
+  GPUMaterial cutout = packetMaterial(4, BlendMode::AlphaTest);
+  cutout.flags |= MaterialFlags::Unlit;
+  EXPECT_EQ(pipelineKey(cutout, true).shaderFeatures,
+            gfx::ShaderFeature::Textured | gfx::ShaderFeature::AlphaTest |
+                gfx::ShaderFeature::Unlit);
+  EXPECT_TRUE(pipelineKey(cutout, true).skinned);
+
+  EXPECT_EQ(pipelineKey(blended_, false).blend, gfx::PipelineBlend::AlphaBlend);
+  EXPECT_EQ(pipelineKey(additive_, true).blend, gfx::PipelineBlend::Additive);
+}
+
+TEST_F(RenderQueueTest, PipelineKeyGroupsByLayoutThenBlend) {
+  // Every static permutation sorts before every skinned one, opaque before blended
+  gfx::PipelineKey lastStatic{false, gfx::PipelineBlend::Additive, 7};
+  gfx::PipelineKey firstSkinned{true, gfx::PipelineBlend::Opaque, 0};
+  EXPECT_LT(lastStatic.id(), firstSkinned.id());
+
+  gfx::PipelineKey opaque{false, gfx::PipelineBlend::Opaque, 7};
+  gfx::PipelineKey blended{false, gfx::PipelineBlend::AlphaBlend, 0};
+  EXPECT_LT(opaque.id(), blended.id());
+}
@@ -0,0 +1,92 @@
+#include "render/skinning.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace w3d;
+
+namespace {
+
+gfx::SkinnedVertex vertex(const glm::vec3 &position, const glm::vec3 &normal,
+                          uint32_t boneIndex) {
+  gfx::SkinnedVertex v{};
+  v.position = position;
+  v.normal = normal;
+  v.texCoord = glm::vec2(0.25f, 0.75f);
+  v.color = glm::vec3(0.1f, 0.2f, 0.3f);
+  v.boneIndex = boneIndex;
+  return v;
+}
+
+std::vector<glm::mat4> palette() {
+  glm::mat4 turned = glm::rotate(glm::mat4(1.0f), 0.7f, glm::vec3(0.0f, 1.0f, 0.0f));
+  turned[3] = glm::vec4(1.0f, 2.0f, 3.0f, 1.0f);
+  glm::mat4 scaled = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f));
+  scaled[3] = glm::vec4(-4.0f, 0.0f, 0.5f, 1.0f);
+  return {glm::mat4(1.0f), turned, scaled};
+}
+
+bool near(const glm::vec3 &a, const glm::vec3 &b) {
+  return glm::length(a - b) < 1e-5f;
+}
+
+} // namespace
+
+// skinned.vert: bones[boneIndex] * vec4(position, 1) and mat3(bone) * normal
+TEST(SkinningTest, PosesLikeTheSkinnedVertexShader) {
+  auto bones = palette();
+  std::vector<gfx::SkinnedVertex> vertices = {
+      vertex(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), 0),
+      vertex(glm::vec3(0.5f, -1.0f, 2.0f), glm::vec3(1.0f, 0.0f, 0.0f), 1),
+      vertex(glm::vec3(-3.0f, 4.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f), 2)};
+
+  std::vector<gfx::Vertex> posed(vertices.size());
+  skinVertices(vertices.data(), vertices.size(), bones.data(), bones.size(), posed.data());
+
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    SCOPED_TRACE(i);
+    const glm::mat4 &bone = bones[vertices[i].boneIndex];
+    EXPECT_TRUE(near(posed[i].position, glm::vec3(bone * glm::vec4(vertices[i].position, 1.0f))));
+    EXPECT_TRUE(near(posed[i].normal, glm::mat3(bone) * vertices[i].normal));
+    EXPECT_EQ(posed[i].texCoord, vertices[i].texCoord);
+    EXPECT_EQ(posed[i].color, vertices[i].color);
+    EXPECT_EQ(posed[i].position, skinPosition(vertices[i], bones.data(), bones.size()));
+  }
+
+  // Normals are not renormalized: the scaled bone doubles its length, as in the shader
+  EXPECT_NEAR(glm::length(posed[2].normal), 2.0f, 1e-5f);
+}
+
+TEST(SkinningTest, BonesPastThePaletteKeepTheRestPose) {
+  auto bones = palette();
+  gfx::SkinnedVertex v = vertex(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f), 7);
+
+  gfx::Vertex posed{};
+  skinVertices(&v, 1, bones.data(), bones.size(), &posed);
+  EXPECT_EQ(posed.position, v.position);
+  EXPECT_EQ(posed.normal, v.normal);
+
+  // The palette's live bones only: bone 2 exists but is not current
+  v.boneIndex = 2;
+  EXPECT_EQ(skinPosition(v, bones.data(), 2), v.position);
+  EXPECT_EQ(skinPosition(v, nullptr, 0), v.position);
+}
+
+// The posed vertices are drawn with the static pipeline, which applies instance and model
+// after them: the same world position the skinned pipeline computes from the rest pose
+TEST(SkinningTest, PosedVerticesDrawWhereTheSkinnedPipelineDraws) {
+  auto bones = palette();
+  gfx::SkinnedVertex v = vertex(glm::vec3(0.3f, -0.2f, 1.5f), glm::vec3(0.0f, 0.0f, 1.0f), 1);
+  glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 5.0f, 0.0f));
+  glm::mat4 instance = glm::rotate(glm::mat4(1.0f), 1.2f, glm::vec3(0.0f, 0.0f, 1.0f));
+
+  gfx::Vertex posed{};
+  skinVertices(&v, 1, bones.data(), bones.size(), &posed);
+
+  glm::vec4 skinnedPipeline = model * instance * bones[1] * glm::vec4(v.position, 1.0f);
+  glm::vec4 staticPipeline = model * instance * glm::vec4(posed.position, 1.0f);
+  EXPECT_TRUE(near(glm::vec3(staticPipeline), glm::vec3(skinnedPipeline)));
+}
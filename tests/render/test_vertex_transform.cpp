@@ -0,0 +1,103 @@
+#include "render/vertex_transform.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace w3d;
+using gfx::BoundingBox;
+using gfx::Vertex;
+
+namespace {
+
+// Deterministic vertices with unit normals and distinct texCoords and colors
+std::vector<Vertex> makeVertices(size_t count) {
+  std::vector<Vertex> vertices(count);
+  for (size_t i = 0; i < count; ++i) {
+    float f = static_cast<float>(i);
+    Vertex &v = vertices[i];
+    v.position = glm::vec3(std::sin(f) * 10.0f, f * 0.25f - 3.0f, std::cos(f * 0.7f) * 5.0f);
+    v.normal = glm::normalize(glm::vec3(std::cos(f), 0.5f, std::sin(f * 1.3f)));
+    v.texCoord = glm::vec2(f * 0.1f, 1.0f - f * 0.05f);
+    v.color = glm::vec3(f / 32.0f, 0.5f, 1.0f - f / 64.0f);
+  }
+  return vertices;
+}
+
+// Rotation about a skewed axis, non-uniform scale and a translation, so normals need the
+// inverse transpose and renormalization
+glm::mat4 boneTransform() {
+  float c = std::cos(0.6f);
+  float s = std::sin(0.6f);
+  glm::mat4 rotation(glm::vec4(c, s, 0.0f, 0.0f), glm::vec4(-s, c, 0.0f, 0.0f),
+                     glm::vec4(0.0f, 0.0f, 1.0f, 0.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  glm::mat4 scale(glm::vec4(2.0f, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, 0.5f, 0.0f, 0.0f),
+                  glm::vec4(0.0f, 0.0f, 3.0f, 0.0f), glm::vec4(12.0f, -4.0f, 7.5f, 1.0f));
+  return scale * rotation;
+}
+
+void expectVec3Near(const glm::vec3 &a, const glm::vec3 &b, float tolerance) {
+  EXPECT_NEAR(a.x, b.x, tolerance);
+  EXPECT_NEAR(a.y, b.y, tolerance);
+  EXPECT_NEAR(a.z, b.z, tolerance);
+}
+
+} // namespace
+
+// Counts around the four-vertex block size cover the scalar tail
+TEST(VertexTransformTest, BatchedMatchesScalarPath) {
+  glm::mat4 transform = boneTransform();
+  for (size_t count : {0u, 1u, 3u, 4u, 5u, 8u, 17u, 1000u}) {
+    SCOPED_TRACE(count);
+    auto batched = makeVertices(count);
+    auto scalar = batched;
+    BoundingBox batchedBounds;
+    BoundingBox scalarBounds;
+    transformVertices(batched.data(), batched.size(), transform, batchedBounds);
+    transformVerticesScalar(scalar.data(), scalar.size(), transform, scalarBounds);
+
+    for (size_t i = 0; i < count; ++i) {
+      expectVec3Near(batched[i].position, scalar[i].position, 1e-4f);
+      expectVec3Near(batched[i].normal, scalar[i].normal, 1e-5f);
+      EXPECT_NEAR(glm::length(batched[i].normal), 1.0f, 1e-5f);
+      EXPECT_EQ(batched[i].texCoord, scalar[i].texCoord);
+      EXPECT_EQ(batched[i].color, scalar[i].color);
+    }
+    EXPECT_EQ(batchedBounds.valid(), count > 0);
+    if (count > 0) {
+      expectVec3Near(batchedBounds.min, scalarBounds.min, 1e-4f);
+      expectVec3Near(batchedBounds.max, scalarBounds.max, 1e-4f);
+    }
+  }
+}
+
+TEST(VertexTransformTest, PositionsAreTranslatedAndNormalsAreNot) {
+  std::vector<Vertex> vertices(5);
+  for (auto &v : vertices) {
+    v.position = glm::vec3(1.0f, 2.0f, 3.0f);
+    v.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+  }
+  glm::mat4 translation(1.0f);
+  translation[3] = glm::vec4(10.0f, 20.0f, 30.0f, 1.0f);
+
+  BoundingBox bounds;
+  transformVertices(vertices.data(), vertices.size(), translation, bounds);
+  for (const auto &v : vertices) {
+    EXPECT_EQ(v.position, glm::vec3(11.0f, 22.0f, 33.0f));
+    EXPECT_EQ(v.normal, glm::vec3(0.0f, 0.0f, 1.0f));
+  }
+  EXPECT_EQ(bounds.min, glm::vec3(11.0f, 22.0f, 33.0f));
+  EXPECT_EQ(bounds.max, glm::vec3(11.0f, 22.0f, 33.0f));
+}
+
+TEST(VertexTransformTest, BoundsAreExpandedNotReplaced) {
+  auto vertices = makeVertices(8);
+  BoundingBox bounds;
+  bounds.expand(glm::vec3(-1000.0f));
+  bounds.expand(glm::vec3(1000.0f));
+
+  transformVertices(vertices.data(), vertices.size(), glm::mat4(1.0f), bounds);
+  EXPECT_EQ(bounds.min, glm::vec3(-1000.0f));
+  EXPECT_EQ(bounds.max, glm::vec3(1000.0f));
+}